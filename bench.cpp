@@ -0,0 +1,99 @@
+#include "lib/bench.hpp"
+#include "lib/bench_options.hpp"
+#include "lib/functional.hpp"
+
+#include <expected>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Measure the whole pipeline of pcap_parser on generated captures of several sizes, in several modes, and
+// compare with a baseline of earlier results
+auto main(int argc, char const **argv) -> int
+try {
+  auto const args = std::span<char const *const>(argv, argc).subspan(1);
+  if (not args.empty() && args.front() == bench::child_argument) {
+    return bench::child(args.subspan(1));
+  }
+
+  return (bench_options::make(args) // tested in bench_options.cpp
+          | and_then([](bench_options const &opts) -> std::expected<int, error> {
+              // untested (direct filesystem and OS calls)
+              std::vector<bench_result> results;
+              for (auto const size : opts.sizes) {
+                auto const capture = bench::prepare(opts.path, size);
+                if (not capture) {
+                  return std::unexpected<error>(capture.error());
+                }
+                for (auto const &mode : opts.modes) {
+                  std::optional<bench_result> best;
+                  for (unsigned i = 0; i < opts.repeat; ++i) {
+                    auto const result = bench::measure("/proc/self/exe", mode.args, *capture);
+                    if (not result) {
+                      return std::unexpected<error>(result.error());
+                    }
+                    if (not best || result->seconds < best->seconds) {
+                      best = *result;
+                    }
+                  }
+                  best->mode = mode.name;
+                  best->name = mode.name + '/' + std::to_string(size);
+                  std::cerr << "measured " << best->name << std::endl;
+                  results.push_back(std::move(*best));
+                }
+              }
+              bench::print(std::cerr, results);
+
+              auto const write = [&results](std::string const &filename) -> std::expected<int, error> {
+                std::ofstream output(filename);
+                bench::write_json(output, results);
+                if (not output) {
+                  return error::make(error::bench, "failed to write file: ", filename);
+                }
+                return 0;
+              };
+              if (opts.output.empty()) {
+                bench::write_json(std::cout, results);
+              } else if (auto const written = write(opts.output); !written) {
+                return written;
+              }
+
+              if (opts.baseline.empty()) {
+                return 0;
+              }
+              // NOTE: results depend on the machine, so the first run on it records the baseline for later runs
+              std::ifstream input(opts.baseline);
+              if (not input) {
+                std::cerr << "recording baseline: " << opts.baseline << std::endl;
+                return write(opts.baseline);
+              }
+              std::string const json{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+              return bench::parse_json(json) // tested in bench.cpp
+                     | and_then([&](std::vector<bench_result> const &baseline) -> std::expected<int, error> {
+                         auto const regressions = bench::compare(baseline, results, opts.threshold);
+                         if (regressions.empty()) {
+                           return 0;
+                         }
+                         std::ostringstream ss;
+                         for (auto const &item : regressions) {
+                           ss << "\n  " << item.name << ": " << item.baseline_ns_per_packet << " -> "
+                              << item.ns_per_packet << " ns/packet";
+                         }
+                         return error::make(error::bench, regressions.size(), " regressions above ",
+                                            opts.threshold, "% of baseline ", opts.baseline, ':', ss.str());
+                       });
+            })
+          | or_else([](error const &err) -> std::expected<int, error> {
+              std::cerr << err << std::endl;
+              return err.code();
+            }))
+      .value();
+} catch (std::exception const &e) {
+  std::cerr << e.what() << '\n';
+  return 3;
+}
@@ -0,0 +1,30 @@
+# - Try to find liburing include dirs and libraries
+#
+# Usage of this module as follows:
+#
+#     find_package(liburing)
+#
+# Variables defined by this module:
+#
+#  LIBURING_FOUND            System has liburing, include and library dirs found
+#  LIBURING_INCLUDE_DIR      The liburing include directories.
+#  LIBURING_LIBRARY          The liburing library
+
+find_path(LIBURING_INCLUDE_DIR
+    NAMES liburing.h
+)
+
+find_library(LIBURING_LIBRARY
+    NAMES uring
+)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(liburing DEFAULT_MSG
+    LIBURING_LIBRARY
+    LIBURING_INCLUDE_DIR
+)
+
+mark_as_advanced(
+    LIBURING_INCLUDE_DIR
+    LIBURING_LIBRARY
+)
@@ -0,0 +1,30 @@
+# - Try to find zstd include dirs and libraries
+#
+# Usage of this module as follows:
+#
+#     find_package(zstd)
+#
+# Variables defined by this module:
+#
+#  ZSTD_FOUND                System has zstd, include and library dirs found
+#  ZSTD_INCLUDE_DIR          The zstd include directories.
+#  ZSTD_LIBRARY              The zstd library
+
+find_path(ZSTD_INCLUDE_DIR
+    NAMES zstd.h
+)
+
+find_library(ZSTD_LIBRARY
+    NAMES zstd
+)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(zstd DEFAULT_MSG
+    ZSTD_LIBRARY
+    ZSTD_INCLUDE_DIR
+)
+
+mark_as_advanced(
+    ZSTD_INCLUDE_DIR
+    ZSTD_LIBRARY
+)
@@ -0,0 +1,28 @@
+#include "lib/functional.hpp"
+#include "lib/generate_options.hpp"
+#include "lib/synthetic.hpp"
+
+#include <expected>
+#include <iostream>
+#include <span>
+
+// Write a synthetic A/B capture pair, and print the stats which pcap_parser should report for it
+auto main(int argc, char const **argv) -> int
+try {
+  auto const args = std::span<char const *const>(argv, argc).subspan(1);
+
+  return (generate_options::make(args) // tested in generate_options.cpp
+          | and_then(synthetic::write) // untested (direct filesystem calls)
+          | transform([](stats const &truth) -> int {
+              std::cout << truth << std::endl;
+              return 0;
+            })
+          | or_else([](error const &err) -> std::expected<int, error> {
+              std::cerr << err << std::endl;
+              return err.code();
+            }))
+      .value();
+} catch (std::exception const &e) {
+  std::cerr << e.what() << '\n';
+  return 3;
+}
@@ -0,0 +1,45 @@
+#include "lib/find_inputs.hpp"
+#include "lib/functional.hpp"
+#include "lib/pcap_index.hpp"
+#include "lib/sort_channels.hpp"
+
+#include <expected>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+// Write a sidecar pcap_index next to each capture of both channels in a directory, to be used by PcapInputs
+auto main(int argc, char const **argv) -> int
+try {
+  auto const args = std::span<char const *const>(argv, argc).subspan(1);
+  if (args.size() != 1) {
+    std::cerr << "received " << args.size() << " parameters but expected 1" << std::endl;
+    return error::main;
+  }
+
+  return (find_inputs(args.front()) // untested (direct filesystem calls)
+          | and_then(sort_channels) // tested in sort_channels.cpp
+          | and_then([](pair<std::vector<std::string>> const &segments) -> std::expected<int, error> {
+              // untested (direct filesystem calls)
+              for (auto const *files : {&segments.A, &segments.B}) {
+                for (auto const &file : *files) {
+                  auto const index = pcap_index::save(file);
+                  if (not index) {
+                    return std::unexpected<error>(index.error());
+                  }
+                  std::cout << file << sidecar_suffix << ": " << index->records << " records, "
+                            << index->entries.size() << " entries" << std::endl;
+                }
+              }
+              return 0;
+            })
+          | or_else([](error const &err) -> std::expected<int, error> {
+              std::cerr << err << std::endl;
+              return err.code();
+            }))
+      .value();
+} catch (std::exception const &e) {
+  std::cerr << e.what() << '\n';
+  return 3;
+}
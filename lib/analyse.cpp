@@ -0,0 +1,257 @@
+#include "analyse.hpp"
+#include "cached_inputs.hpp"
+#include "compressed_pcap_inputs.hpp"
+#include "follow_pcap_inputs.hpp"
+#include "functional.hpp"
+#include "match_export.hpp"
+#include "mmap_feed_inputs.hpp"
+#include "mmap_pcap_inputs.hpp"
+#include "parallel_inputs.hpp"
+#include "pcap_inputs.hpp"
+#include "pcapng_inputs.hpp"
+#include "prefetch_inputs.hpp"
+#include "segmented_pcap_inputs.hpp"
+#include "sharded_inputs.hpp"
+#include "uring_pcap_inputs.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stop_token>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+namespace {
+auto file_size(std::string const &filename) -> std::size_t
+{
+  std::error_code ec;
+  auto const ret = std::filesystem::file_size(filename, ec);
+  return ec ? 0 : static_cast<std::size_t>(ret);
+}
+
+auto is_pcapng(std::string const &filename) -> bool
+{
+  unsigned char magic[4] = {};
+  std::ifstream file(filename, std::ios::binary);
+  file.read(reinterpret_cast<char *>(magic), sizeof(magic));
+  return file.good() && pcapng::is_pcapng(magic);
+}
+
+// Set by SIGINT or SIGTERM, which end follow mode; another signal terminates the program as usual
+std::atomic<bool> interrupted = false;
+void interrupt(int signal) noexcept
+{
+  interrupted.store(true);
+  std::signal(signal, SIG_DFL);
+}
+
+auto follow(options const &opts, pair<std::string> const &files, stats::snapshot_callback_t snapshot)
+    -> std::expected<stats, error>
+{
+  std::signal(SIGINT, interrupt);
+  std::signal(SIGTERM, interrupt);
+
+  // NOTE: signal handler can only set a flag, the ticker turns it into a stop request for FollowPcapInputs
+  std::stop_source stop;
+  std::atomic<bool> due = false;
+  std::jthread ticker([&stop, &due, interval = opts.interval](std::stop_token token) {
+    auto next = std::chrono::steady_clock::now() + interval;
+    while (not token.stop_requested()) {
+      std::this_thread::sleep_for(follow_source::poll_interval);
+      if (interrupted.load()) {
+        stop.request_stop();
+      }
+      if (auto const now = std::chrono::steady_clock::now(); now >= next) {
+        due.store(true, std::memory_order_relaxed);
+        next = now + interval;
+      }
+    }
+  });
+
+  return FollowPcapInputs::make(files, stop.get_token(), &due) | transform([&](FollowPcapInputs &&inputs) -> stats {
+           return stats::make(std::move(inputs), stop.get_token(), due, std::move(snapshot));
+         });
+}
+} // namespace
+
+auto analyse_t::operator()(options const &opts, pair<std::vector<std::string>> const &segments,
+                           stats::snapshot_callback_t snapshot) const -> std::expected<report, error>
+{
+  profiler disabled(false);
+  return (*this)(opts, segments, disabled, std::move(snapshot));
+}
+
+auto analyse_t::operator()(options const &opts, pair<std::vector<std::string>> const &segments, profiler &prof,
+                           stats::snapshot_callback_t snapshot) const -> std::expected<report, error>
+{
+  std::optional<match_export> exported = std::nullopt;
+  if (not opts.export_prefix.empty()) {
+    auto made = match_export::make(opts.export_prefix);
+    if (not made) {
+      return std::unexpected<error>(made.error());
+    }
+    exported.emplace(std::move(*made));
+  }
+
+  // Select stats::make overload, for either some_inputs or some_readers
+  pair<sequence_gaps> gaps = {};
+  merge_extras const extras{.range = opts.range,
+                            .gaps = opts.gaps ? &gaps : nullptr,
+                            .prof = prof.enabled() ? &prof : nullptr,
+                            .output = exported ? &*exported : nullptr,
+                            .window = opts.window};
+  auto const make = [&extras]<typename T>(T &&inputs) -> stats {
+    if (not extras.empty()) {
+      return stats::make(std::move(inputs), extras);
+    }
+    return stats::make(std::move(inputs));
+  };
+  auto const run = [&opts, &make]<some_inputs T>(T &&inputs) -> stats {
+    if (opts.prefetch) {
+      return make(prefetch_inputs<T>(std::move(inputs)));
+    }
+    return make(std::move(inputs));
+  };
+
+  auto const start = std::chrono::steady_clock::now();
+  auto const analysed = [&]() -> std::expected<stats, error> {
+    // NOTE: everything other than the merge, which is a nested stage, is attributed to opening the inputs
+    auto const scope = prof.scope(profile::stage_t::open);
+    if (opts.follow) {
+      if (segments.A.size() != 1 || segments.B.size() != 1) {
+        return error::make(error::open_pcap, "cannot follow a channel split into many segments");
+      }
+      return follow(opts, {.A = segments.A.front(), .B = segments.B.front()}, std::move(snapshot));
+    }
+
+    // NOTE: sharded reader works with a single file or many segments per channel alike
+    if (opts.reader == options::reader_t::sharded) {
+      return sharded_inputs::make(segments) | transform([](sharded_inputs const &inputs) -> stats {
+               work_stealing_pool pool(std::thread::hardware_concurrency());
+               return inputs.merge(pool);
+             });
+    }
+    if (segments.A.size() != 1 || segments.B.size() != 1) {
+      if (opts.cache) {
+        return error::make(error::open_cache, "option --cache cannot be used with a channel split into many segments");
+      }
+      return SegmentedPcapInputs::make(segments) | transform(run);
+    }
+    auto const files = pair<std::string>{.A = segments.A.front(), .B = segments.B.front()};
+
+    // NOTE: cached_inputs parse each file once, and later runs only read the cache files; a range is not seeked
+    // to, but packets outside of it are still skipped by stats::make, same as with other readers
+    if (opts.cache) {
+      if (compression_from_name(files.A) != compression_t::none
+          || compression_from_name(files.B) != compression_t::none) {
+        return error::make(error::open_cache, "option --cache cannot be used with compressed files");
+      }
+      return cached_inputs::make(files) | transform([&make](cached_inputs &&inputs) -> stats { //
+               return make(std::move(inputs));
+             });
+    }
+
+    // NOTE: compressed files can be only read in one pass, regardless of the selected reader
+    if (compression_from_name(files.A) != compression_t::none || compression_from_name(files.B) != compression_t::none) {
+      return CompressedPcapInputs::make(files) | transform(run);
+    }
+
+    // NOTE: libpcap can read both pcap and pcapng, use it if only one file is pcapng
+    if (bool const a = is_pcapng(files.A), b = is_pcapng(files.B); a && b) {
+      return PcapngInputs::make(files) | transform(run);
+    } else if (a || b) {
+      return PcapInputs::make(files) | transform(run);
+    }
+
+    switch (opts.reader) {
+    case options::reader_t::pcap:
+      // NOTE: only PcapInputs can seek to the start and end of range, other readers read everything
+      return PcapInputs::make(files) | transform([&](PcapInputs &&inputs) -> stats {
+               if (not opts.range.empty()) {
+                 inputs.seek(opts.range);
+               }
+               return run(std::move(inputs));
+             });
+    case options::reader_t::mmap:
+      return MmapPcapInputs::make(files) | transform(run);
+    case options::reader_t::uring:
+      return UringPcapInputs::make(files) | transform(run)
+             | or_else([&](error const &err) -> std::expected<stats, error> {
+                 if (err.code() == error::open_uring) {
+                   return PcapInputs::make(files) | transform(run);
+                 }
+                 return std::unexpected<error>(err);
+               });
+    case options::reader_t::parallel:
+      return parallel_inputs::make(files) | transform([&make](parallel_inputs &&inputs) -> stats { //
+               return make(std::move(inputs));
+             });
+    case options::reader_t::sharded: // handled above
+    default:
+      std::unreachable();
+    }
+  }();
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+
+  // NOTE: rows still in memory are written after the merge, which is not included in throughput
+  if (exported && analysed) {
+    if (auto const closed = exported->close(); not closed) {
+      return std::unexpected<error>(closed.error());
+    }
+  }
+
+  return analysed | transform([&](stats const &result) -> report {
+           auto const found = opts.gaps ? std::optional(std::move(gaps)) : std::nullopt;
+           auto const profiled = prof.enabled() ? std::optional(prof.result()) : std::nullopt;
+           if (not opts.throughput) {
+             return {.result = result, .gaps = found, .profiled = profiled};
+           }
+           std::size_t bytes = 0;
+           for (auto const &file : segments.A) {
+             bytes += file_size(file);
+           }
+           for (auto const &file : segments.B) {
+             bytes += file_size(file);
+           }
+           return {.result = result,
+                   .speed = throughput{.bytes = bytes,
+                                       .elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)},
+                   .gaps = found,
+                   .profiled = profiled};
+         });
+}
+
+auto analyse_feeds_t::operator()(options const &opts, std::vector<feed_file> const &feeds) const
+    -> std::expected<report, error>
+{
+  std::vector<std::string> files;
+  for (auto const &feed : feeds) {
+    files.push_back(feed.file);
+  }
+
+  auto const start = std::chrono::steady_clock::now();
+  auto analysed = MmapFeedInputs::make(files) | transform([](MmapFeedInputs &&inputs) -> feed_stats {
+                    return feed_stats::make(std::move(inputs));
+                  });
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+
+  return std::move(analysed) | transform([&](feed_stats result) -> report {
+           for (std::size_t i = 0; i < feeds.size(); ++i) {
+             result.channels[i] = feeds[i].channel;
+           }
+           if (not opts.throughput) {
+             return {.result = std::move(result)};
+           }
+           std::size_t bytes = 0;
+           for (auto const &file : files) {
+             bytes += file_size(file);
+           }
+           return {.result = std::move(result),
+                   .speed = throughput{.bytes = bytes,
+                                       .elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)}};
+         });
+}
@@ -0,0 +1,35 @@
+#ifndef LIB_ANALYSE
+#define LIB_ANALYSE
+
+#include "error.hpp"
+#include "options.hpp"
+#include "pair.hpp"
+#include "profiler.hpp"
+#include "report.hpp"
+#include "sort_channels.hpp"
+
+#include <expected>
+#include <string>
+#include <vector>
+
+// Open A/B files with the Inputs implementation selected in options, and produce stats from them
+// NOTE: if io_uring is not available, --reader=uring falls back to PcapInputs
+// NOTE: if any channel is split into many segments, these are read with SegmentedPcapInputs
+// NOTE: in follow mode, snapshot is called with stats so far after each interval, until SIGINT or SIGTERM
+constexpr inline struct analyse_t final {
+  [[nodiscard]] auto operator()(options const &opts, pair<std::vector<std::string>> const &segments,
+                                stats::snapshot_callback_t snapshot = {}) const -> std::expected<report, error>;
+
+  // Same as above, and also attribute time of opening and merging to stages of prof, if it is enabled; the
+  // resulting profile, including stages measured by the caller, is then included in the report
+  [[nodiscard]] auto operator()(options const &opts, pair<std::vector<std::string>> const &segments, profiler &prof,
+                                stats::snapshot_callback_t snapshot = {}) const -> std::expected<report, error>;
+} analyse;
+
+// Open files of many feeds with MmapFeedInputs, and produce feed_stats from them
+constexpr inline struct analyse_feeds_t final {
+  [[nodiscard]] auto operator()(options const &opts, std::vector<feed_file> const &feeds) const
+      -> std::expected<report, error>;
+} analyse_feeds;
+
+#endif // LIB_ANALYSE
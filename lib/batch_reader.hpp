@@ -0,0 +1,68 @@
+#ifndef LIB_BATCH_READER
+#define LIB_BATCH_READER
+
+#include "inputs.hpp"
+#include "link_layer.hpp"
+#include "packet.hpp"
+#include "pair.hpp"
+#include "parse_batch.hpp"
+#include "profiler.hpp"
+
+#include <concepts>
+#include <cstddef>
+
+namespace detail {
+
+// Reads one channel of inputs in batches, and parses packets for the merge loop of stats::make or feed_stats::make.
+// The channel is selected by pair_select for some_inputs, or by index for some_feed_inputs. If prof is set, reading
+// and parsing of each batch are attributed to its stages, see merge_extras.
+template <typename T, typename Channel = pair_select>
+  requires requires(T &inputs, Channel which) {
+    { inputs.next_batch(which) } -> std::same_as<Inputs::batch_t>;
+    { inputs.link(which) } -> std::same_as<packet::link_t>;
+  }
+struct batch_reader final {
+  T &inputs;
+  Channel const which;
+  profiler *prof = nullptr;
+  packet::link_t const link = inputs.link(which);
+
+  // Batch of packets read from Inputs and parsed, and position of the next packet to use from it
+  packet::batch_properties parsed = {};
+  std::size_t position = 0;
+
+  auto next(auto &&callback) -> bool
+  {
+    if (position == parsed.size()) {
+      position = 0;
+      if (not(prof == nullptr ? read() : read_profiled())) {
+        return false;
+      }
+    }
+    callback(parsed.at(position++));
+    return true;
+  }
+
+  // Read and parse the next batch, return false at the end of inputs
+  auto read() -> bool
+  {
+    auto const batch = inputs.next_batch(which);
+    packet::parse_batch(batch, parsed, link);
+    return not batch.empty();
+  }
+
+  auto read_profiled() -> bool
+  {
+    auto const batch = [this] {
+      auto const scope = prof->scope(profile::stage_t::read);
+      return inputs.next_batch(which);
+    }();
+    auto const scope = prof->scope(profile::stage_t::parse);
+    packet::parse_batch(batch, parsed, link);
+    return not batch.empty();
+  }
+};
+
+} // namespace detail
+
+#endif // LIB_BATCH_READER
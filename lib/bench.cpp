@@ -0,0 +1,369 @@
+#include "bench.hpp"
+#include "analyse.hpp"
+#include "find_inputs.hpp"
+#include "functional.hpp"
+#include "generate_options.hpp"
+#include "options.hpp"
+#include "sort_channels.hpp"
+#include "synthetic.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+auto bench_result::packets_per_second() const noexcept -> double
+{
+  return seconds > 0 ? static_cast<double>(packets) / seconds : 0.0;
+}
+
+auto bench_result::megabytes_per_second() const noexcept -> double
+{
+  return seconds > 0 ? static_cast<double>(bytes) / 1e6 / seconds : 0.0;
+}
+
+auto bench_result::ns_per_packet() const noexcept -> double
+{
+  return packets > 0 ? seconds * 1e9 / static_cast<double>(packets) : 0.0;
+}
+
+void bench::write_json(std::ostream &output, std::vector<bench_result> const &results)
+{
+  auto const quoted = [](std::string const &value) { return std::quoted(value, '"', '\\'); };
+  output << "{\"results\": [";
+  char const *separator = "\n";
+  for (auto const &item : results) {
+    output << separator << "  {\"name\": " << quoted(item.name) << ", \"mode\": " << quoted(item.mode)
+           << ", \"packets\": " << item.packets << ", \"bytes\": " << item.bytes << ", \"seconds\": "
+           << std::setprecision(std::numeric_limits<double>::max_digits10) << item.seconds << ", \"peak_rss_kb\": " << item.peak_rss_kb
+           << ", \"packets_per_second\": " << std::setprecision(6) << item.packets_per_second()
+           << ", \"megabytes_per_second\": " << item.megabytes_per_second()
+           << ", \"ns_per_packet\": " << item.ns_per_packet() << '}';
+    separator = ",\n";
+  }
+  output << "\n]}\n";
+}
+
+namespace {
+// Cursor over JSON text, skipping whitespace before each token
+struct json_cursor final {
+  std::string_view text;
+
+  auto peek() -> char
+  {
+    auto const start = text.find_first_not_of(" \t\r\n");
+    text.remove_prefix(start == std::string_view::npos ? text.size() : start);
+    return text.empty() ? '\0' : text.front();
+  }
+
+  auto consume(char expected) -> bool
+  {
+    if (peek() != expected) {
+      return false;
+    }
+    text.remove_prefix(1);
+    return true;
+  }
+
+  auto string() -> std::optional<std::string>
+  {
+    if (not consume('"')) {
+      return std::nullopt;
+    }
+    std::string ret;
+    while (not text.empty() && text.front() != '"') {
+      if (text.front() == '\\' && text.size() > 1) {
+        text.remove_prefix(1);
+      }
+      ret += text.front();
+      text.remove_prefix(1);
+    }
+    if (text.empty()) {
+      return std::nullopt;
+    }
+    text.remove_prefix(1);
+    return ret;
+  }
+
+  auto number() -> std::optional<double>
+  {
+    peek();
+    double ret = 0;
+    auto const [end, ec] = std::from_chars(text.data(), text.data() + text.size(), ret);
+    if (ec != std::errc{}) {
+      return std::nullopt;
+    }
+    text.remove_prefix(static_cast<std::size_t>(end - text.data()));
+    return ret;
+  }
+};
+
+// Flat object of strings and numbers
+auto parse_result(json_cursor &cursor) -> std::optional<bench_result>
+{
+  if (not cursor.consume('{')) {
+    return std::nullopt;
+  }
+  bench_result ret;
+  std::map<std::string, double> numbers;
+  for (bool first = true; not cursor.consume('}'); first = false) {
+    if (not first && not cursor.consume(',')) {
+      return std::nullopt;
+    }
+    auto const key = cursor.string();
+    if (not key || not cursor.consume(':')) {
+      return std::nullopt;
+    }
+    if (cursor.peek() == '"') {
+      auto const value = cursor.string();
+      if (not value) {
+        return std::nullopt;
+      }
+      if (*key == "name") {
+        ret.name = *value;
+      } else if (*key == "mode") {
+        ret.mode = *value;
+      }
+    } else {
+      auto const value = cursor.number();
+      if (not value) {
+        return std::nullopt;
+      }
+      numbers[*key] = *value;
+    }
+  }
+  ret.packets = static_cast<std::uint64_t>(numbers["packets"]);
+  ret.bytes = static_cast<std::uint64_t>(numbers["bytes"]);
+  ret.seconds = numbers["seconds"];
+  ret.peak_rss_kb = static_cast<std::uint64_t>(numbers["peak_rss_kb"]);
+  return ret;
+}
+} // namespace
+
+auto bench::parse_json_t::operator()(std::string_view json) const -> std::expected<std::vector<bench_result>, error>
+{
+  json_cursor cursor{.text = json};
+  if (not cursor.consume('{') || cursor.string() != "results" || not cursor.consume(':') || not cursor.consume('[')) {
+    return error::make(error::bench, "expected {\"results\": [...]} in baseline");
+  }
+  std::vector<bench_result> ret;
+  for (bool first = true; not cursor.consume(']'); first = false) {
+    if (not first && not cursor.consume(',')) {
+      return error::make(error::bench, "expected ',' or ']' in baseline, at: ", cursor.text.substr(0, 20));
+    }
+    auto result = parse_result(cursor);
+    if (not result) {
+      return error::make(error::bench, "invalid result in baseline, at: ", cursor.text.substr(0, 20));
+    }
+    ret.push_back(std::move(*result));
+  }
+  if (not cursor.consume('}') || cursor.peek() != '\0') {
+    return error::make(error::bench, "unexpected end of baseline");
+  }
+  return ret;
+}
+
+auto bench::compare(std::vector<bench_result> const &baseline, std::vector<bench_result> const &results,
+                    double threshold) -> std::vector<bench_regression>
+{
+  std::vector<bench_regression> ret;
+  for (auto const &item : results) {
+    auto const before = std::ranges::find(baseline, item.name, &bench_result::name);
+    if (before == baseline.end() || before->ns_per_packet() <= 0) {
+      continue;
+    }
+    if (item.ns_per_packet() > before->ns_per_packet() * (1.0 + threshold / 100.0)) {
+      ret.push_back({.name = item.name,
+                     .baseline_ns_per_packet = before->ns_per_packet(),
+                     .ns_per_packet = item.ns_per_packet()});
+    }
+  }
+  return ret;
+}
+
+void bench::print(std::ostream &output, std::vector<bench_result> const &results)
+{
+  auto const flags = output.flags();
+  output << std::left << std::setw(28) << "name" << std::right << std::setw(12) << "Mpackets/s" << std::setw(10)
+         << "MB/s" << std::setw(12) << "ns/packet" << std::setw(14) << "peak RSS MB" << '\n'
+         << std::fixed << std::setprecision(2);
+  for (auto const &item : results) {
+    output << std::left << std::setw(28) << item.name << std::right << std::setw(12)
+           << item.packets_per_second() / 1e6 << std::setw(10) << item.megabytes_per_second() << std::setw(12)
+           << item.ns_per_packet() << std::setw(14) << static_cast<double>(item.peak_rss_kb) / 1e3 << '\n';
+  }
+  output.flags(flags);
+}
+
+auto bench::prepare_t::operator()(std::string const &path, std::uint64_t packets) const
+    -> std::expected<bench_capture, error>
+{
+  // NOTE: the marker is outside of the directory, since pcap_parser expects only capture files in it
+  auto const directory = path + '/' + std::to_string(packets);
+  auto const marker = directory + ".done";
+  if (std::ifstream input(marker); input) {
+    bench_capture ret{.directory = directory, .packets = 0};
+    if (input >> ret.packets) {
+      return ret;
+    }
+  }
+
+  std::filesystem::remove_all(directory);
+  generate_options const options{.path = directory, .packets = packets, .drop = {.A = 0.001, .B = 0.001}};
+  return synthetic::write(options) //
+         | and_then([&](stats const &truth) -> std::expected<bench_capture, error> {
+             bench_capture ret{.directory = directory, .packets = truth.packet_count.A + truth.packet_count.B};
+             if (not(std::ofstream(marker) << ret.packets << '\n')) {
+               return error::make(error::bench, "failed to create file: ", marker);
+             }
+             return ret;
+           });
+}
+
+namespace {
+// Sent from the process started by bench::measure
+struct measurement final {
+  int code;                   // zero, or of the error
+  std::uint64_t bytes;
+  std::int64_t nanoseconds;
+  std::uint64_t peak_rss_kb;
+  char what[256];             // of the error
+};
+
+// NOTE: ru_maxrss of wait4 would include pages inherited from the parent, even across exec, while VmHWM is only of
+// the current address space
+auto peak_rss_kb() -> std::uint64_t
+{
+  std::ifstream input("/proc/self/status");
+  for (std::string line; std::getline(input, line);) {
+    if (line.starts_with("VmHWM:")) {
+      return std::strtoull(line.c_str() + 6, nullptr, 10);
+    }
+  }
+  return 0;
+}
+} // namespace
+
+auto bench::run_t::operator()(std::vector<std::string> const &args, bench_capture const &capture) const
+    -> std::expected<bench_result, error>
+{
+  std::vector<char const *> argv;
+  for (auto const &arg : args) {
+    argv.push_back(arg.c_str());
+  }
+  argv.push_back("--throughput");
+  argv.push_back(capture.directory.c_str());
+
+  auto const start = std::chrono::steady_clock::now();
+  return options::make(argv) //
+         | and_then([](options const &opts) {
+             return find_inputs(opts.path) //
+                    | and_then(sort_channels)
+                    | and_then([&opts](pair<std::vector<std::string>> const &segments) {
+                        return analyse(opts, segments);
+                      });
+           })
+         | transform([&](report const &result) {
+             auto const elapsed = std::chrono::steady_clock::now() - start;
+             return bench_result{.mode = {},
+                                 .packets = capture.packets,
+                                 .bytes = result.speed.has_value() ? result.speed->bytes : 0,
+                                 .seconds = std::chrono::duration<double>(elapsed).count(),
+                                 .peak_rss_kb = peak_rss_kb(),
+                                 .name = {}};
+           });
+}
+
+auto bench::child(std::span<char const *const> args) -> int
+{
+  if (args.empty()) {
+    return 1;
+  }
+  std::vector<std::string> const options(args.begin(), args.end() - 1);
+  auto const result = run(options, bench_capture{.directory = args.back(), .packets = 0});
+
+  measurement ret = {};
+  if (result) {
+    ret.bytes = result->bytes;
+    ret.nanoseconds = static_cast<std::int64_t>(result->seconds * 1e9);
+    ret.peak_rss_kb = result->peak_rss_kb;
+  } else {
+    ret.code = result.error().code();
+    auto const &what = result.error().what();
+    std::memcpy(ret.what, what.data(), std::min(what.size(), sizeof(ret.what) - 1));
+  }
+  return ::write(child_fd, &ret, sizeof(ret)) == sizeof(ret) ? 0 : 1;
+}
+
+auto bench::measure_t::operator()(std::string const &executable, std::vector<std::string> const &args,
+                                  bench_capture const &capture) const -> std::expected<bench_result, error>
+{
+  int fds[2] = {};
+  if (::pipe2(fds, O_CLOEXEC) != 0) {
+    return error::make(error::bench, "failed to create pipe");
+  }
+
+  std::vector<char *> argv;
+  auto const push = [&argv](std::string const &arg) { argv.push_back(const_cast<char *>(arg.c_str())); };
+  std::string const child_arg(child_argument);
+  push(executable);
+  push(child_arg);
+  for (auto const &arg : args) {
+    push(arg);
+  }
+  push(capture.directory);
+  argv.push_back(nullptr);
+
+  // NOTE: dup2 clears close-on-exec, so only the write end is inherited, as child_fd
+  ::posix_spawn_file_actions_t actions;
+  ::posix_spawn_file_actions_init(&actions);
+  ::posix_spawn_file_actions_adddup2(&actions, fds[1], child_fd);
+  pid_t child = 0;
+  int const spawned = ::posix_spawn(&child, executable.c_str(), &actions, nullptr, argv.data(), environ);
+  ::posix_spawn_file_actions_destroy(&actions);
+  ::close(fds[1]);
+  if (spawned != 0) {
+    ::close(fds[0]);
+    return error::make(error::bench, "failed to start process: ", executable);
+  }
+
+  measurement result = {};
+  std::size_t received = 0;
+  while (received < sizeof(result)) {
+    auto const size = ::read(fds[0], reinterpret_cast<char *>(&result) + received, sizeof(result) - received);
+    if (size <= 0) {
+      break;
+    }
+    received += static_cast<std::size_t>(size);
+  }
+  ::close(fds[0]);
+
+  int status = 0;
+  ::waitpid(child, &status, 0);
+  if (received != sizeof(result) || not WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    return error::make(error::bench, "process running the pipeline failed, with status ", status);
+  }
+  if (result.code != 0) {
+    return error::make(error::bench, "pipeline failed: ", result.what);
+  }
+  return bench_result{.mode = {},
+                      .packets = capture.packets,
+                      .bytes = result.bytes,
+                      .seconds = static_cast<double>(result.nanoseconds) / 1e9,
+                      .peak_rss_kb = result.peak_rss_kb,
+                      .name = {}};
+}
@@ -0,0 +1,104 @@
+#ifndef LIB_BENCH
+#define LIB_BENCH
+
+#include "error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+
+// Measurement of one run of the whole pipeline, i.e. find_inputs | sort_channels | analyse, for one mode
+// (reader and options of pcap_parser) on a generated capture pair
+struct bench_result final {
+  std::string mode = {};
+  std::uint64_t packets = 0;     // in both files, regardless of mode
+  std::uint64_t bytes = 0;       // total size of both files
+  double seconds = 0;            // wall time of the best run
+  std::uint64_t peak_rss_kb = 0; // of the process running the pipeline
+
+  // Identifies the same measurement in a baseline, e.g. "mmap/1000000" for the capture of 10^6 packets
+  std::string name = {};
+
+  // NOTE: MB is 10^6 bytes, same as throughput in report.hpp
+  [[nodiscard]] auto packets_per_second() const noexcept -> double;
+  [[nodiscard]] auto megabytes_per_second() const noexcept -> double;
+  [[nodiscard]] auto ns_per_packet() const noexcept -> double;
+
+  [[nodiscard]] auto operator==(bench_result const &other) const noexcept -> bool = default;
+};
+
+// Generated capture pair to measure, see bench::prepare
+struct bench_capture final {
+  std::string directory;
+  std::uint64_t packets; // in both files
+
+  [[nodiscard]] auto operator==(bench_capture const &other) const noexcept -> bool = default;
+};
+
+// Result slower than in the baseline by more than the threshold
+struct bench_regression final {
+  std::string name = {};
+  double baseline_ns_per_packet;
+  double ns_per_packet;
+
+  [[nodiscard]] auto operator==(bench_regression const &other) const noexcept -> bool = default;
+};
+
+namespace bench {
+
+// Write results as JSON, i.e. {"results": [{"name": ..., "mode": ..., ...}, ...]}, one result per line
+void write_json(std::ostream &output, std::vector<bench_result> const &results);
+
+// Read results written by write_json. Only the subset of JSON produced by write_json is accepted, i.e. an
+// object with array of flat objects of strings and numbers; unknown fields are ignored.
+constexpr inline struct parse_json_t final {
+  [[nodiscard]] auto operator()(std::string_view json) const -> std::expected<std::vector<bench_result>, error>;
+} parse_json;
+
+// Results with ns per packet more than threshold percent above the result of the same name in the baseline;
+// results missing from the baseline are not compared
+[[nodiscard]] auto compare(std::vector<bench_result> const &baseline, std::vector<bench_result> const &results,
+                           double threshold) -> std::vector<bench_regression>;
+
+// Table of results, for comparing modes side by side
+void print(std::ostream &output, std::vector<bench_result> const &results);
+
+// Capture pair generated from given number of packets sent, in a directory under path; generated only once
+// and kept for later runs, which then measure the same input
+constexpr inline struct prepare_t final {
+  [[nodiscard]] auto operator()(std::string const &path, std::uint64_t packets) const
+      -> std::expected<bench_capture, error>;
+} prepare;
+
+// Run the whole pipeline with given pcap_parser arguments (options other than the directory) on a capture, in
+// this process; peak RSS is of this process so far
+constexpr inline struct run_t final {
+  [[nodiscard]] auto operator()(std::vector<std::string> const &args, bench_capture const &capture) const
+      -> std::expected<bench_result, error>;
+} run;
+
+// First argument of the executable started by measure, followed by arguments of run and the directory
+inline constexpr std::string_view child_argument = "--child";
+// Descriptor of the pipe to measure, in the started process
+inline constexpr int child_fd = 3;
+
+// Entry point of the process started by measure, with arguments after child_argument: calls run and writes the
+// result to child_fd. Returns the exit code.
+[[nodiscard]] auto child(std::span<char const *const> args) -> int;
+
+// Same as run, but in a freshly started executable which calls child, so that peak RSS is measured separately
+// from this process and other runs
+constexpr inline struct measure_t final {
+  [[nodiscard]] auto operator()(std::string const &executable, std::vector<std::string> const &args,
+                                bench_capture const &capture) const -> std::expected<bench_result, error>;
+} measure;
+
+} // namespace bench
+
+#endif // LIB_BENCH
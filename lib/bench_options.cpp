@@ -0,0 +1,98 @@
+#include "bench_options.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+#include <system_error>
+
+namespace {
+template <typename T> auto parse_number(std::string_view value, T &out) -> bool
+{
+  auto const [end, ec] = std::from_chars(value.data(), value.data() + value.size(), out);
+  return ec == std::errc{} && end == value.data() + value.size();
+}
+
+// Items of a list separated with ','
+auto split(std::string_view value) -> std::vector<std::string_view>
+{
+  std::vector<std::string_view> ret;
+  for (auto separator = value.find(','); separator != std::string_view::npos; separator = value.find(',')) {
+    ret.push_back(value.substr(0, separator));
+    value.remove_prefix(separator + 1);
+  }
+  ret.push_back(value);
+  return ret;
+}
+} // namespace
+
+auto bench_options::known_modes() -> std::vector<mode_t> const &
+{
+  static std::vector<mode_t> const ret = {
+      {.name = "pcap", .args = {"--reader=pcap"}},
+      {.name = "mmap", .args = {"--reader=mmap"}},
+      {.name = "uring", .args = {"--reader=uring"}},
+      {.name = "parallel", .args = {"--reader=parallel"}},
+      {.name = "sharded", .args = {"--reader=sharded"}},
+      {.name = "prefetch", .args = {"--reader=mmap", "--prefetch"}},
+      {.name = "window", .args = {"--reader=mmap", "--window=64"}},
+      {.name = "gaps", .args = {"--reader=mmap", "--gaps"}},
+  };
+  return ret;
+}
+
+auto bench_options::make_t::operator()(std::span<char const *const> args) const -> std::expected<bench_options, error>
+{
+  bench_options ret;
+  std::vector<std::string_view> positional;
+  for (std::string_view const arg : args) {
+    if (!arg.starts_with("--")) {
+      positional.push_back(arg);
+      continue;
+    }
+
+    auto const separator = arg.find('=');
+    auto const name = arg.substr(2, separator == std::string_view::npos ? arg.npos : separator - 2);
+    auto const value = separator == std::string_view::npos ? std::string_view{} : arg.substr(separator + 1);
+    if (name == "sizes") {
+      ret.sizes.clear();
+      for (auto const item : split(value)) {
+        std::uint64_t size = 0;
+        if (not parse_number(item, size) || size == 0) {
+          return error::make(error::main, "invalid sizes: ", value, ", expected positive numbers of packets");
+        }
+        ret.sizes.push_back(size);
+      }
+    } else if (name == "modes") {
+      ret.modes.clear();
+      for (auto const item : split(value)) {
+        auto const &known = known_modes();
+        auto const mode = std::ranges::find(known, item, &mode_t::name);
+        if (mode == known.end()) {
+          return error::make(error::main, "unknown mode: ", item,
+                             ", expected one of: pcap, mmap, uring, parallel, sharded, prefetch, window, gaps");
+        }
+        ret.modes.push_back(*mode);
+      }
+    } else if (name == "repeat") {
+      if (not parse_number(value, ret.repeat) || ret.repeat == 0) {
+        return error::make(error::main, "invalid repeat: ", value, ", expected positive number of runs");
+      }
+    } else if (name == "baseline" && not value.empty()) {
+      ret.baseline = value;
+    } else if (name == "threshold") {
+      if (not parse_number(value, ret.threshold) || not(ret.threshold >= 0.0)) {
+        return error::make(error::main, "invalid threshold: ", value, ", expected percent");
+      }
+    } else if (name == "output" && not value.empty()) {
+      ret.output = value;
+    } else {
+      return error::make(error::main, "unknown option: ", arg);
+    }
+  }
+
+  if (positional.size() != 1) {
+    return error::make(error::main, "received ", positional.size(), " parameters but expected 1");
+  }
+  ret.path = positional.front();
+  return ret;
+}
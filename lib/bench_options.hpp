@@ -0,0 +1,41 @@
+#ifndef LIB_BENCH_OPTIONS
+#define LIB_BENCH_OPTIONS
+
+#include "error.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <vector>
+
+// Options of the end-to-end benchmark, see bench.hpp
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct bench_options final {
+  // Reader and other options of pcap_parser to measure, e.g. "prefetch" is "--reader=mmap --prefetch"
+  struct mode_t final {
+    std::string name;
+    std::vector<std::string> args;
+
+    [[nodiscard]] auto operator==(mode_t const &) const -> bool = default;
+  };
+  [[nodiscard]] static auto known_modes() -> std::vector<mode_t> const &;
+
+  std::string path = {};                                          // generated captures are kept here between runs
+  std::vector<std::uint64_t> sizes = {100'000, 1'000'000, 10'000'000}; // packets of each generated capture
+  std::vector<mode_t> modes = known_modes();
+  unsigned repeat = 3;                                            // runs of each mode and size, the best is reported
+  std::string baseline = {};                                      // JSON file of results to compare with, or to record
+  double threshold = 10;                                          // percent of ns per packet above the baseline
+  std::string output = {};                                        // JSON file to write results to, or stdout
+
+  // Parse command line arguments, excluding program name, e.g. "--sizes=1000000 --modes=pcap,mmap some/directory"
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(std::span<char const *const> args) const -> std::expected<bench_options, error>;
+  } make = {};
+
+  [[nodiscard]] auto operator==(bench_options const &other) const -> bool = default;
+};
+
+#endif // LIB_BENCH_OPTIONS
@@ -0,0 +1,32 @@
+#include "cached_inputs.hpp"
+#include "functional.hpp"
+
+namespace {
+auto open(std::string const &filename) -> std::expected<mapped_file, error>
+{
+  // NOTE: a missing or stale cache is not an error, it is written again
+  return packet_cache::load(filename) | or_else([&filename](error const &) -> std::expected<mapped_file, error> {
+           return packet_cache::save(filename) | and_then([&filename]() { return packet_cache::load(filename); });
+         });
+}
+} // namespace
+
+auto cached_inputs::make_t::operator()(pair<std::string> filenames) const -> std::expected<cached_inputs, error>
+{
+  auto file_a = open(filenames.A);
+  if (!file_a) {
+    return error::make(error::open_cache, "failed to open file A: ", filenames.A, ", error: ", file_a.error());
+  }
+  auto file_b = open(filenames.B);
+  if (!file_b) {
+    return error::make(error::open_cache, "failed to open file B: ", filenames.B, ", error: ", file_b.error());
+  }
+
+  // NOTE: mapped data does not move with mapped_file, and was already decoded once by packet_cache::load
+  auto const cache_a = packet_cache::decode(file_a->data());
+  auto const cache_b = packet_cache::decode(file_b->data());
+  if (!cache_a || !cache_b) {
+    return std::unexpected<error>(cache_a ? cache_b.error() : cache_a.error());
+  }
+  return cached_inputs({.A = std::move(*file_a), .B = std::move(*file_b)}, {.A = *cache_a, .B = *cache_b});
+}
@@ -0,0 +1,34 @@
+#ifndef LIB_CACHED_INPUTS
+#define LIB_CACHED_INPUTS
+
+#include "error.hpp"
+#include "mapped_file.hpp"
+#include "packet_cache.hpp"
+#include "pair.hpp"
+
+#include <expected>
+#include <string>
+#include <utility>
+
+// Maps the cache files of both files, see packet_cache, writing them first if they are missing or stale. Unlike
+// implementations of Inputs, this hands out parsed packets, so it can be only used with stats::make. Reading the
+// columns is bound by memory bandwidth, rather than by parsing frames.
+struct cached_inputs final {
+  // Create cached_inputs from a pair of pcap files.
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(pair<std::string> filenames) const -> std::expected<cached_inputs, error>;
+  } make = {};
+
+  [[nodiscard]] auto readers() const noexcept -> pair<packet_cache::reader>
+  {
+    return {.A = {.cache = caches_.A}, .B = {.cache = caches_.B}};
+  }
+
+private:
+  cached_inputs(pair<mapped_file> f, pair<packet_cache> c) noexcept : files_(std::move(f)), caches_(c) {}
+
+  pair<mapped_file> files_; // NOTE: caches_ point to the mapped data
+  pair<packet_cache> caches_;
+};
+
+#endif // LIB_CACHED_INPUTS
@@ -0,0 +1,122 @@
+#ifndef LIB_CHUNKED_PCAP_INPUTS
+#define LIB_CHUNKED_PCAP_INPUTS
+
+#include "chunked_records.hpp"
+#include "error.hpp"
+#include "inputs.hpp"
+#include "link_layer.hpp"
+#include "packet.hpp"
+#include "savefile.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <vector>
+
+// Source of chunks which can be opened from a file name, e.g. uring_source
+template <typename T>
+concept some_file_chunk_source = some_chunk_source<T> && requires(std::string const &filename, std::size_t slots) {
+  { T::make(filename, slots) } -> std::same_as<std::expected<T, error>>;
+};
+
+// Alternative to PcapInputs which reads both files in large chunks with Source, with several chunks
+// in flight per file, and walks pcap records directly in the chunk buffers (see chunked_records).
+// TODO: this is untestable, because sources call the OS directly (but chunked_records is tested)
+template <some_file_chunk_source Source> struct ChunkedPcapInputs final : Inputs {
+  using data_t = Inputs::data_t;
+  static_assert(std::is_same_v<packet::data_t, data_t>);
+  using records_t = chunked_records<Source>;
+
+  // Chunks in flight per file is config.buffers - 1, one more buffer is being parsed
+  static constexpr typename records_t::config config = {.buffers = 8, .chunk = 2 * 1024 * 1024};
+
+  // Create ChunkedPcapInputs from a pair of pcap files. Errors other than error::open_pcap from
+  // Source::make are returned as they are, e.g. error::open_uring
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(pair<std::string> filenames) const -> std::expected<ChunkedPcapInputs, error>
+    {
+      auto source_a = Source::make(filenames.A, config.buffers);
+      if (!source_a && source_a.error().code() != error::open_pcap) {
+        return std::unexpected<error>(source_a.error());
+      }
+      auto source_b = Source::make(filenames.B, config.buffers);
+      if (!source_b && source_b.error().code() != error::open_pcap) {
+        return std::unexpected<error>(source_b.error());
+      }
+      if (!source_a && !source_b) {
+        return error::make(error::open_pcap, "failed to open both files: ", filenames.A, ", ", filenames.B);
+      }
+      if (!source_a) {
+        return error::make(error::open_pcap, "failed to open file A: ", filenames.A, ", error: ", source_a.error());
+      }
+      if (!source_b) {
+        return error::make(error::open_pcap, "failed to open file B: ", filenames.B, ", error: ", source_b.error());
+      }
+
+      auto records_a = records_t::make(std::move(*source_a), config);
+      if (!records_a) {
+        return error::make(error::open_pcap, "invalid file A, error: ", records_a.error());
+      }
+      auto records_b = records_t::make(std::move(*source_b), config);
+      if (!records_b) {
+        return error::make(error::open_pcap, "invalid file B, error: ", records_b.error());
+      }
+
+      // NOTE: first record is very likely to be in the first buffer; if not, we will assume Ethernet
+      auto const link_a
+          = packet::detect_link(records_a->header().linktype, records_a->peek().value_or(savefile::record{}).data);
+      auto const link_b
+          = packet::detect_link(records_b->header().linktype, records_b->peek().value_or(savefile::record{}).data);
+      return ChunkedPcapInputs({.A = {.records = std::move(*records_a), .link = link_a},
+                                .B = {.records = std::move(*records_b), .link = link_b}});
+    }
+  } make = {};
+
+  // Hides Inputs::next_batch, to enable static dispatch in stats::make
+  auto next_batch(pair_select which) -> batch_t { return batch_(which == pair_select::A ? A_ : B_); }
+
+  // noncopyable, but moveable
+  ChunkedPcapInputs(ChunkedPcapInputs const &) = delete;
+  ChunkedPcapInputs(ChunkedPcapInputs &&other) = default;
+
+private:
+  struct channel final {
+    records_t records;
+    packet::link_t link;
+    std::vector<data_t> views = {};
+  };
+
+  explicit ChunkedPcapInputs(pair<channel> src) noexcept : A_(std::move(src.A)), B_(std::move(src.B)) {}
+
+  // NOTE: Same as in PcapInputs, incomplete packet is of no use to us, just report that we had "something"
+  static auto view_(savefile::record const &record) -> data_t
+  {
+    return record.header.caplen == record.header.len ? record.data : record.data.first(0);
+  }
+
+  static auto next_(channel &input, auto &&callback) -> bool
+  {
+    return input.records.next(1, [&callback](savefile::record const &record) { callback(view_(record)); }) > 0;
+  }
+
+  // Data in the batch points directly to the read buffer, only views need to be stored. The batch
+  // might be shorter than batch_size at the end of a buffer, but it is empty only at the end of file.
+  static auto batch_(channel &input) -> batch_t
+  {
+    input.views.clear();
+    input.records.next(batch_size, [&input](savefile::record const &record) { input.views.push_back(view_(record)); });
+    return input.views;
+  }
+
+  auto next_a(data_callback_t callback) -> bool override { return next_(A_, std::move(callback)); }
+  auto next_b(data_callback_t callback) -> bool override { return next_(B_, std::move(callback)); }
+  auto batch_a() -> batch_t override { return next_batch(pair_select::A); }
+  auto batch_b() -> batch_t override { return next_batch(pair_select::B); }
+  auto link_a() const -> packet::link_t override { return A_.link; }
+  auto link_b() const -> packet::link_t override { return B_.link; }
+
+  channel A_;
+  channel B_;
+};
+
+#endif // LIB_CHUNKED_PCAP_INPUTS
@@ -0,0 +1,179 @@
+#ifndef LIB_CHUNKED_RECORDS
+#define LIB_CHUNKED_RECORDS
+
+#include "error.hpp"
+#include "savefile.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Source of consecutive chunks of a pcap file, e.g. asynchronous reads of a file or output of decompression.
+// Requests are started in file order, at most once per slot until finished, but may complete in any order.
+template <typename T>
+concept some_chunk_source = requires(T &source, std::size_t slot, std::span<unsigned char> dest) {
+  // Start filling dest with the next bytes of the file
+  { source.start(slot, dest) } -> std::same_as<void>;
+  // Wait until the request for slot is done, and return the number of bytes read. Fewer bytes than requested
+  // mean end of file (or a read error), so a source must itself resume short reads of the OS before that.
+  { source.finish(slot) } -> std::same_as<std::size_t>;
+};
+
+// Walk records of a pcap file which is read in chunks into a ring of buffers, so more than one read can be
+// in flight at the same time. Records are handed out directly from the buffers, without copying. Each buffer
+// is preceded by "slack" space, into which the unparsed tail of the previous buffer is copied before moving
+// on, so a record crossing the end of a chunk also ends up in contiguous memory.
+template <some_chunk_source Source> struct chunked_records final {
+  using data_t = std::span<unsigned char const>;
+
+  struct config final {
+    std::size_t buffers = 4;
+    std::size_t chunk = 1024 * 1024;
+    std::size_t slack = 256 * 1024 + 4096; // maximum snaplen in libpcap, plus header and alignment
+    std::size_t alignment = 4096;
+  };
+
+  // Start reading all buffers and parse the file header
+  static auto make(Source &&source, config cfg) -> std::expected<chunked_records, error>
+  {
+    cfg.slack = (cfg.slack + cfg.alignment - 1) / cfg.alignment * cfg.alignment;
+    cfg.buffers = cfg.buffers < 2 ? 2 : cfg.buffers; // need at least one buffer to parse, and one to read
+    chunked_records ret(std::move(source), cfg);
+    for (std::size_t i = 0; i < ret.buffers_.size(); ++i) {
+      ret.start_(i);
+    }
+
+    auto &first = ret.buffers_.front();
+    first.pending = false;
+    first.end = ret.cfg_.slack + ret.source_.finish(0);
+    ret.eof_ = first.end < ret.cfg_.slack + ret.cfg_.chunk;
+    auto const header = savefile::file_header::make(
+        data_t(first.storage.get() + ret.cfg_.slack, first.end - ret.cfg_.slack));
+    if (!header) {
+      return std::unexpected<error>(header.error());
+    }
+    ret.header_ = *header;
+    ret.position_ = ret.cfg_.slack + savefile::file_header_length;
+    return ret;
+  }
+
+  // noncopyable, but moveable; buffers are on the heap, hence not affected by move
+  chunked_records(chunked_records const &) = delete;
+  chunked_records(chunked_records &&other) noexcept = default;
+  ~chunked_records() noexcept
+  {
+    // Buffers might be still written to, must wait before we can free them
+    for (std::size_t i = 0; i < buffers_.size(); ++i) {
+      if (buffers_[i].pending) {
+        source_.finish(i);
+      }
+    }
+  }
+
+  [[nodiscard]] auto header() const noexcept -> savefile::file_header const & { return header_; }
+
+  // The next record, if it is already read in full. Data remains valid until the next call to next.
+  [[nodiscard]] auto peek() const noexcept -> std::optional<savefile::record>
+  {
+    auto const &buffer = buffers_[current_];
+    return savefile::records{.header = header_, .file = data_t(buffer.storage.get(), buffer.end), .offset = position_}
+        .peek();
+  }
+
+  // Read up to count records, stopping early at the end of a buffer. Data remains valid until the next call.
+  // Empty result means end of file (or the remainder of file is a truncated record).
+  template <typename Fn> auto next(std::size_t count, Fn &&fn) -> std::size_t
+  {
+    std::size_t ret = 0;
+    while (ret < count) {
+      auto &buffer = buffers_[current_];
+      savefile::records records{
+          .header = header_, .file = data_t(buffer.storage.get(), buffer.end), .offset = position_};
+      if (auto const record = records.next(); record.has_value()) {
+        position_ = records.offset;
+        fn(*record);
+        ++ret;
+        continue;
+      }
+
+      // Records handed out earlier point to the current buffer, cannot reuse it yet
+      if (ret > 0 || !advance_()) {
+        break;
+      }
+    }
+    return ret;
+  }
+
+private:
+  struct aligned_delete final {
+    std::size_t alignment;
+    void operator()(unsigned char *p) const noexcept { ::operator delete[](p, std::align_val_t{alignment}); }
+  };
+
+  struct buffer final {
+    std::unique_ptr<unsigned char[], aligned_delete> storage;
+    std::size_t end = 0; // data in [slack, end), preceded by the remainder of previous buffer
+    bool pending = false;
+  };
+
+  chunked_records(Source &&source, config cfg) : source_(std::move(source)), cfg_(cfg)
+  {
+    buffers_.reserve(cfg_.buffers);
+    for (std::size_t i = 0; i < cfg_.buffers; ++i) {
+      auto *const p = static_cast<unsigned char *>(
+          ::operator new[](cfg_.slack + cfg_.chunk, std::align_val_t{cfg_.alignment}));
+      buffers_.push_back({.storage = {p, aligned_delete{cfg_.alignment}}, .end = 0, .pending = false});
+    }
+  }
+
+  void start_(std::size_t i)
+  {
+    source_.start(i, std::span<unsigned char>(buffers_[i].storage.get() + cfg_.slack, cfg_.chunk));
+    buffers_[i].pending = true;
+  }
+
+  // Move the unparsed remainder of the current buffer to the next one, and start reading into the current buffer
+  auto advance_() -> bool
+  {
+    auto &current = buffers_[current_];
+    auto const next_index = (current_ + 1) % buffers_.size();
+    auto &next = buffers_[next_index];
+    if (!next.pending) {
+      return false; // end of file was reached earlier
+    }
+
+    auto const bytes = source_.finish(next_index);
+    next.pending = false;
+    next.end = cfg_.slack + bytes;
+    auto const remainder = current.end - position_;
+    if (bytes == 0 || remainder > cfg_.slack) {
+      return false; // truncated or oversized record
+    }
+    std::copy(current.storage.get() + position_, current.storage.get() + current.end,
+              next.storage.get() + cfg_.slack - remainder);
+    position_ = cfg_.slack - remainder;
+
+    eof_ = eof_ || bytes < cfg_.chunk;
+    if (!eof_) {
+      start_(current_);
+    }
+    current_ = next_index;
+    return true;
+  }
+
+  Source source_;
+  config cfg_;
+  std::vector<buffer> buffers_ = {};
+  savefile::file_header header_ = {};
+  std::size_t current_ = 0;
+  std::size_t position_ = 0;
+  bool eof_ = false;
+};
+
+#endif // LIB_CHUNKED_RECORDS
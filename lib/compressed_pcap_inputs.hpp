@@ -0,0 +1,11 @@
+#ifndef LIB_COMPRESSED_PCAP_INPUTS
+#define LIB_COMPRESSED_PCAP_INPUTS
+
+#include "chunked_pcap_inputs.hpp"
+#include "decompress_source.hpp"
+
+// Alternative to PcapInputs which reads gzip or zstd compressed pcap files in one pass, with each file
+// decompressed on its own background thread into a bounded ring of buffers.
+using CompressedPcapInputs = ChunkedPcapInputs<decompress_source>;
+
+#endif // LIB_COMPRESSED_PCAP_INPUTS
@@ -0,0 +1,261 @@
+#include "decompress_source.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef PCAP_PARSER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef PCAP_PARSER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+auto compression_from_name(std::string_view filename) noexcept -> compression_t
+{
+  if (filename.ends_with(".gz")) {
+    return compression_t::gzip;
+  }
+  if (filename.ends_with(".zst")) {
+    return compression_t::zstd;
+  }
+  return compression_t::none;
+}
+
+namespace {
+constexpr std::size_t input_size = 256 * 1024;
+
+auto detect(int fd) noexcept -> compression_t
+{
+  unsigned char magic[4] = {};
+  if (::pread(fd, magic, sizeof(magic), 0) != sizeof(magic)) {
+    return compression_t::none;
+  }
+  if (magic[0] == 0x1f && magic[1] == 0x8b) {
+    return compression_t::gzip;
+  }
+  if (magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+    return compression_t::zstd;
+  }
+  return compression_t::none;
+}
+} // namespace
+
+struct decompress_source::state final {
+  struct request final {
+    std::size_t slot;
+    std::span<unsigned char> dest;
+  };
+
+  int const fd;
+  compression_t const compression;
+  std::vector<unsigned char> input = std::vector<unsigned char>(input_size);
+  std::size_t input_begin = 0; // unused compressed data in [input_begin, input_end)
+  std::size_t input_end = 0;
+  bool eof = false;
+#ifdef PCAP_PARSER_HAVE_ZLIB
+  ::z_stream gzip = {};
+#endif
+#ifdef PCAP_PARSER_HAVE_ZSTD
+  ::ZSTD_DCtx *zstd = nullptr;
+#endif
+
+  // Requests are passed to the background thread in a queue, and results are passed back per slot
+  std::mutex mutex = {};
+  std::condition_variable_any cv = {};
+  std::deque<request> requests = {};
+  std::vector<std::optional<std::size_t>> results = {};
+  std::jthread thread = {}; // started last, by make, and joined first
+
+  state(int fd, compression_t compression, std::size_t slots) : fd(fd), compression(compression), results(slots) {}
+
+  ~state() noexcept
+  {
+    if (thread.joinable()) {
+      thread.request_stop();
+      thread.join();
+    }
+#ifdef PCAP_PARSER_HAVE_ZLIB
+    if (compression == compression_t::gzip) {
+      ::inflateEnd(&gzip);
+    }
+#endif
+#ifdef PCAP_PARSER_HAVE_ZSTD
+    ::ZSTD_freeDCtx(zstd);
+#endif
+    ::close(fd);
+  }
+
+  // Refill input buffer if it is empty, return false on end of file
+  auto refill() -> bool
+  {
+    if (input_begin < input_end) {
+      return true;
+    }
+    if (eof) {
+      return false;
+    }
+    auto const size = ::read(fd, input.data(), input.size());
+    input_begin = 0;
+    input_end = size > 0 ? static_cast<std::size_t>(size) : 0;
+    eof = size <= 0;
+    return not eof;
+  }
+
+  auto fill_none(std::span<unsigned char> dest) -> std::size_t
+  {
+    std::size_t ret = 0;
+    while (ret < dest.size()) {
+      auto const size = ::read(fd, dest.data() + ret, dest.size() - ret);
+      if (size <= 0) {
+        break;
+      }
+      ret += static_cast<std::size_t>(size);
+    }
+    return ret;
+  }
+
+#ifdef PCAP_PARSER_HAVE_ZLIB
+  auto fill_gzip(std::span<unsigned char> dest) -> std::size_t
+  {
+    gzip.next_out = dest.data();
+    gzip.avail_out = static_cast<::uInt>(dest.size());
+    while (gzip.avail_out > 0 && refill()) {
+      gzip.next_in = input.data() + input_begin;
+      gzip.avail_in = static_cast<::uInt>(input_end - input_begin);
+      auto const ret = ::inflate(&gzip, Z_NO_FLUSH);
+      input_begin = input_end - gzip.avail_in;
+      if (ret == Z_STREAM_END) {
+        ::inflateReset(&gzip); // there might be another gzip member following
+      } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        eof = true;
+        input_begin = input_end;
+        break;
+      }
+    }
+    return dest.size() - gzip.avail_out;
+  }
+#endif
+
+#ifdef PCAP_PARSER_HAVE_ZSTD
+  auto fill_zstd(std::span<unsigned char> dest) -> std::size_t
+  {
+    ::ZSTD_outBuffer out = {.dst = dest.data(), .size = dest.size(), .pos = 0};
+    while (out.pos < out.size && refill()) {
+      ::ZSTD_inBuffer in = {.src = input.data() + input_begin, .size = input_end - input_begin, .pos = 0};
+      auto const ret = ::ZSTD_decompressStream(zstd, &out, &in);
+      input_begin += in.pos;
+      if (::ZSTD_isError(ret)) {
+        eof = true;
+        input_begin = input_end;
+        break;
+      }
+    }
+    return out.pos;
+  }
+#endif
+
+  auto fill(std::span<unsigned char> dest) -> std::size_t
+  {
+    switch (compression) {
+#ifdef PCAP_PARSER_HAVE_ZLIB
+    case compression_t::gzip:
+      return fill_gzip(dest);
+#endif
+#ifdef PCAP_PARSER_HAVE_ZSTD
+    case compression_t::zstd:
+      return fill_zstd(dest);
+#endif
+    default:
+      return fill_none(dest);
+    }
+  }
+
+  void run(std::stop_token stop)
+  {
+    while (true) {
+      request req = {};
+      {
+        std::unique_lock lock(mutex);
+        if (not cv.wait(lock, stop, [this] { return not requests.empty(); })) {
+          return;
+        }
+        req = requests.front();
+        requests.pop_front();
+      }
+
+      auto const size = fill(req.dest);
+      {
+        std::lock_guard lock(mutex);
+        results[req.slot] = size;
+      }
+      cv.notify_all();
+    }
+  }
+};
+
+void decompress_source::state_delete::operator()(state *s) const noexcept { delete s; }
+
+auto decompress_source::make_t::operator()(std::string const &filename, std::size_t slots) const
+    -> std::expected<decompress_source, error>
+{
+  int const fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::make(error::open_pcap, "failed to open file: ", filename);
+  }
+
+  auto ret = std::unique_ptr<state, state_delete>(new state(fd, detect(fd), slots));
+  switch (ret->compression) {
+  case compression_t::gzip:
+#ifdef PCAP_PARSER_HAVE_ZLIB
+    // NOTE: 15 + 32 is the largest window, with automatic detection of gzip or zlib header
+    if (::inflateInit2(&ret->gzip, 15 + 32) != Z_OK) {
+      return error::make(error::open_pcap, "failed to initialize gzip decompression: ", filename);
+    }
+    break;
+#else
+    return error::make(error::open_pcap, "built without zlib support, cannot read: ", filename);
+#endif
+  case compression_t::zstd:
+#ifdef PCAP_PARSER_HAVE_ZSTD
+    ret->zstd = ::ZSTD_createDCtx();
+    if (ret->zstd == nullptr) {
+      return error::make(error::open_pcap, "failed to initialize zstd decompression: ", filename);
+    }
+    break;
+#else
+    return error::make(error::open_pcap, "built without zstd support, cannot read: ", filename);
+#endif
+  default:
+    break;
+  }
+
+  ret->thread = std::jthread([s = ret.get()](std::stop_token stop) { s->run(stop); });
+  return decompress_source(std::move(ret));
+}
+
+void decompress_source::start(std::size_t slot, std::span<unsigned char> dest)
+{
+  {
+    std::lock_guard lock(state_->mutex);
+    state_->requests.push_back({.slot = slot, .dest = dest});
+  }
+  state_->cv.notify_all();
+}
+
+auto decompress_source::finish(std::size_t slot) -> std::size_t
+{
+  std::unique_lock lock(state_->mutex);
+  state_->cv.wait(lock, [this, slot] { return state_->results[slot].has_value(); });
+  auto const ret = *state_->results[slot];
+  state_->results[slot].reset();
+  return ret;
+}
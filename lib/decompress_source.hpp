@@ -0,0 +1,45 @@
+#ifndef LIB_DECOMPRESS_SOURCE
+#define LIB_DECOMPRESS_SOURCE
+
+#include "error.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Compression of a capture file, detected from the file name
+enum class compression_t { none, gzip, zstd };
+
+[[nodiscard]] auto compression_from_name(std::string_view filename) noexcept -> compression_t;
+
+// Sequential reading of a file, decompressed on a background thread. Meets some_chunk_source.
+// Chunks are decompressed directly into the buffers of chunked_records, in the order they were started,
+// so memory used does not depend on the size of file. The format is detected from the magic bytes at
+// the start of the file, and a file which is not compressed is just read as is. Decompression of
+// concatenated gzip members or zstd frames continues to the end of file. A decompression error is
+// reported as the end of file, same as libpcap would stop reading on a read error.
+// NOTE: gzip and zstd support are optional at build time, see CMakeLists.txt
+struct decompress_source final {
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(std::string const &filename, std::size_t slots) const
+        -> std::expected<decompress_source, error>;
+  } make = {};
+
+  void start(std::size_t slot, std::span<unsigned char> dest);
+  auto finish(std::size_t slot) -> std::size_t;
+
+private:
+  struct state;
+  struct state_delete final {
+    void operator()(state *) const noexcept;
+  };
+
+  explicit decompress_source(std::unique_ptr<state, state_delete> state) noexcept : state_(std::move(state)) {}
+
+  std::unique_ptr<state, state_delete> state_;
+};
+
+#endif // LIB_DECOMPRESS_SOURCE
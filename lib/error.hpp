@@ -24,7 +24,15 @@ struct error final {
     find_inputs,
     find_channels,
     open_pcap,
-    packet_parse,
+    open_uring,
+    write_pcap,
+    bench,
+    open_perf,
+    open_index,
+    write_index,
+    open_cache,
+    write_cache,
+    write_export,
   };
 
   error(facility f, std::string what) : facility_(f), what_(std::move(what)) { check_(); }
@@ -0,0 +1,40 @@
+#ifndef LIB_FEED_INPUTS
+#define LIB_FEED_INPUTS
+
+#include "inputs.hpp"
+#include "link_layer.hpp"
+
+#include <concepts>
+#include <cstddef>
+
+// Generalisation of Inputs from an A/B pair to any number of channels, selected by index
+//
+// NOTE: polymorphic for the same reason as Inputs, i.e. to provide a customization point for unit tests
+struct FeedInputs {
+  using data_t = Inputs::data_t;
+  using batch_t = Inputs::batch_t;
+  static constexpr std::size_t batch_size = Inputs::batch_size;
+
+  [[nodiscard]] auto channels() const -> std::size_t { return this->channels_(); }
+
+  // Same contract as Inputs::next_batch, for channel in [0, channels())
+  auto next_batch(std::size_t channel) -> batch_t { return this->batch_(channel); }
+
+  // Link layer of packets in the selected channel, selected once when the channel is opened
+  auto link(std::size_t channel) const -> packet::link_t { return this->link_(channel); }
+
+private:
+  virtual auto channels_() const -> std::size_t = 0;
+  virtual auto batch_(std::size_t channel) -> batch_t = 0;
+  virtual auto link_(std::size_t channel) const -> packet::link_t = 0;
+};
+
+// Either FeedInputs (dynamic dispatch), or a concrete implementation which hides next_batch (static dispatch)
+template <typename T>
+concept some_feed_inputs = requires(T &inputs, std::size_t channel) {
+  { inputs.channels() } -> std::same_as<std::size_t>;
+  { inputs.next_batch(channel) } -> std::same_as<Inputs::batch_t>;
+  { inputs.link(channel) } -> std::same_as<packet::link_t>;
+};
+
+#endif // LIB_FEED_INPUTS
@@ -0,0 +1,11 @@
+#include "feed_stats.hpp"
+
+auto feed_stats::make_t::operator()(FeedInputs &&inputs, error_callback_t log) const -> feed_stats
+{
+  std::vector<detail::batch_reader<FeedInputs, std::size_t>> readers;
+  readers.reserve(inputs.channels());
+  for (std::size_t i = 0; i < inputs.channels(); ++i) {
+    readers.push_back({.inputs = inputs, .which = i});
+  }
+  return merge_(readers, log);
+}
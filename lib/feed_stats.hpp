@@ -0,0 +1,201 @@
+#ifndef LIB_FEED_STATS
+#define LIB_FEED_STATS
+
+#include "batch_reader.hpp"
+#include "error.hpp"
+#include "feed_inputs.hpp"
+#include "functional.hpp"
+#include "loser_tree.hpp"
+#include "packet.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Statistics of any number of redundant feeds, compared in a single pass. Unlike stats, which walks
+// an A/B pair in lock-step, the channels are merged in the order of sequence numbers by a loser_tree,
+// and all packets with the same sequence number are compared with each other at once.
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct feed_stats final {
+  std::vector<std::string> channels;       // names of channels, for printing
+  std::vector<std::size_t> packet_count;   // packets in sequence, excluding duplicates
+  std::vector<std::size_t> dropped_count;  // sequence numbers received by another channel, but not this one
+  std::vector<std::size_t> first_count;    // sequence numbers received by this channel strictly before others
+  std::vector<double> advantage_total_ns;  // sum of leads over the runner-up, when first
+  std::vector<packet::parse_error_counts> error_count = {}; // of packets which could not be parsed, for each reason
+
+  [[nodiscard]] auto advantage_ns() const -> std::vector<double>
+  {
+    std::vector<double> ret(first_count.size());
+    for (std::size_t i = 0; i < ret.size(); ++i) {
+      ret[i] = advantage_total_ns[i] / static_cast<double>(first_count[i] > 0 ? first_count[i] : 1);
+    }
+    return ret;
+  }
+
+  // Produce feed statistics based on network inputs, in pcap format. Channels are named by their index.
+  using error_callback_t = std::move_only_function<void(std::string)>;
+  static constexpr struct make_t final {
+    // Dynamic dispatch, i.e. one virtual call per batch of packets
+    [[nodiscard]] auto operator()(FeedInputs &&inputs, error_callback_t log = {}) const -> feed_stats;
+
+    // Static dispatch for a concrete type of inputs
+    template <some_feed_inputs T>
+      requires(not std::is_reference_v<T>) && (not std::same_as<T, FeedInputs>)
+    [[nodiscard]] auto operator()(T &&inputs, error_callback_t log = {}) const -> feed_stats
+    {
+      std::vector<detail::batch_reader<T, std::size_t>> readers;
+      readers.reserve(inputs.channels());
+      for (std::size_t i = 0; i < inputs.channels(); ++i) {
+        readers.push_back({.inputs = inputs, .which = i});
+      }
+      return merge_(readers, log);
+    }
+
+  private:
+    template <typename Reader> static auto merge_(std::vector<Reader> &readers, error_callback_t &log) -> feed_stats;
+  } make = {};
+
+  [[nodiscard]] auto operator==(feed_stats const &other) const noexcept -> bool = default;
+};
+
+template <typename Reader>
+auto feed_stats::make_t::merge_(std::vector<Reader> &readers, error_callback_t &log) -> feed_stats
+{
+  using parsed_t = packet::parsed_t;
+  using time_point = packet::properties::time_point;
+  auto const size = readers.size();
+  feed_stats ret{.channels = {},
+                 .packet_count = std::vector<std::size_t>(size),
+                 .dropped_count = std::vector<std::size_t>(size),
+                 .first_count = std::vector<std::size_t>(size),
+                 .advantage_total_ns = std::vector<double>(size),
+                 .error_count = std::vector<packet::parse_error_counts>(size)};
+  for (std::size_t i = 0; i < size; ++i) {
+    ret.channels.push_back(std::to_string(i));
+  }
+
+  // Next packet of the channel which is in sequence, skipping errors, duplicates and late packets
+  std::vector<std::optional<std::uint32_t>> last(size);
+  auto const pull = [&](std::size_t channel) -> std::optional<packet::properties> {
+    std::optional<packet::properties> next;
+    while (not next.has_value() && readers[channel].next([&](parsed_t &&parsed) {
+      std::move(parsed) //
+          | transform([&](packet::properties p) {
+              if (not last[channel].has_value() || *last[channel] < p.sequence) {
+                next = p;
+              } else if (*last[channel] != p.sequence && log) {
+                log(std::to_string(channel) + ",out of sequence");
+              }
+            })
+          | or_else([&](packet::parse_error e) -> std::expected<void, packet::parse_error> {
+              ret.error_count[channel].record(e);
+              if (log) [[unlikely]] {
+                log(std::to_string(channel) + ',' + packet::message(e));
+              }
+              return {};
+            })
+          | discard();
+    })) {
+    }
+    if (next.has_value()) {
+      last[channel] = next->sequence;
+    }
+    return next;
+  };
+
+  constexpr auto by_sequence = [](packet::properties const &a, packet::properties const &b) {
+    return a.sequence < b.sequence;
+  };
+  std::vector<std::optional<packet::properties>> heads;
+  heads.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    heads.push_back(pull(i));
+  }
+  loser_tree<packet::properties, decltype(by_sequence)> tree(std::move(heads), by_sequence);
+
+  // NOTE: only channels which have not ended yet can drop a packet, so each channel dropped all sequence numbers
+  // merged until its last packet, which it did not receive. These are counted once when it ends, rather than by
+  // checking every channel for each sequence number.
+  std::size_t merged = 0;
+  while (not tree.empty()) {
+    // Take all packets with the smallest sequence number, and find the earliest two timestamps
+    auto const sequence = tree.key(tree.winner())->sequence;
+    constexpr auto never = time_point::max();
+    time_point first = never;
+    time_point second = never;
+    std::size_t first_channel = size;
+    merged += 1;
+    do {
+      auto const channel = tree.winner();
+      auto const timestamp = tree.key(channel)->timestamp;
+      ret.packet_count[channel] += 1;
+      if (timestamp < first) {
+        second = first;
+        first = timestamp;
+        first_channel = channel;
+      } else if (timestamp < second) {
+        second = timestamp;
+      }
+      auto next = pull(channel);
+      if (not next.has_value()) {
+        ret.dropped_count[channel] = merged - ret.packet_count[channel];
+      }
+      tree.replace(std::move(next));
+    } while (not tree.empty() && tree.key(tree.winner())->sequence == sequence);
+
+    // NOTE: if the earliest two are equal neither channel has advantage, that's unusual but possible
+    if (second != never && first < second) {
+      ret.first_count[first_channel] += 1;
+      ret.advantage_total_ns[first_channel] += //
+          static_cast<double>(second.time_since_epoch().count() - first.time_since_epoch().count());
+    }
+  }
+
+  return ret;
+}
+
+namespace detail {
+template <typename T>
+auto print_channels(std::ostream &output, std::vector<std::string> const &names, std::vector<T> const &values)
+    -> std::ostream &
+{
+  output << '(';
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    output << (i > 0 ? ", " : "") << (i < names.size() ? names[i] : std::to_string(i)) << '=' << values[i];
+  }
+  return (output << ')');
+}
+} // namespace detail
+
+inline auto operator<<(std::ostream &output, feed_stats const &self) -> std::ostream &
+{
+  detail::print_channels(output << "packet count: ", self.channels, self.packet_count) << '\n';
+  detail::print_channels(output << "dropped packets count: ", self.channels, self.dropped_count) << '\n';
+  detail::print_channels(output << "first arrivals count: ", self.channels, self.first_count) << '\n';
+  detail::print_channels(output << "average advantage in ns: ", self.channels, self.advantage_ns());
+
+  // NOTE: only reasons which occurred, same as for stats
+  std::vector<std::size_t> counts(self.error_count.size());
+  for (std::size_t i = 1; i < packet::parse_error_count; ++i) {
+    auto const reason = static_cast<packet::parse_error>(i);
+    bool occurred = false;
+    for (std::size_t channel = 0; channel < counts.size(); ++channel) {
+      counts[channel] = self.error_count[channel][reason];
+      occurred = occurred || counts[channel] > 0;
+    }
+    if (occurred) {
+      detail::print_channels(output << "\nparse errors, " << reason << ": ", self.channels, counts);
+    }
+  }
+  return output;
+}
+
+#endif // LIB_FEED_STATS
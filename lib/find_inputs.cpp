@@ -1,5 +1,6 @@
 #include "find_inputs.hpp"
 
+#include <algorithm>
 #include <filesystem>
 
 // TODO: write a std::filesystem wrapper to make this testable.
@@ -15,20 +16,17 @@ auto find_inputs_t::operator()(std::string const &strpath) const -> std::expecte
   }
 
   input_files result;
-  int i = 0;
   for (auto const &direntry : fs::directory_iterator(path)) {
     if (!direntry.is_regular_file()) {
       continue; // Ignore subdirectories etc.
     }
-
-    if (i > 1) {
-      return error::make(error::find_inputs, "too many files in directory, expected exactly 2: ", path.c_str());
-    }
-    result[i++] = direntry.path().string();
+    result.push_back(direntry.path().string());
   }
-  if (i != 2) {
-    return error::make(error::find_inputs, "too few files in directory, expected exactly 2: ", path.c_str());
+  if (result.size() < 2) {
+    return error::make(error::find_inputs, "too few files in directory, expected at least 2: ", path.c_str());
   }
 
+  // NOTE: order of directory entries is unspecified, make it deterministic
+  std::ranges::sort(result);
   return result;
 }
@@ -3,13 +3,13 @@
 
 #include "error.hpp"
 
-#include <array>
 #include <expected>
 #include <string>
+#include <vector>
 
-using input_files = std::array<std::string, 2>;
+using input_files = std::vector<std::string>;
 
-// Extract two filenames from a given directory.
+// Extract all filenames from a given directory, at least two.
 constexpr inline struct find_inputs_t final {
   [[nodiscard]] auto operator()(std::string const &strpath) const -> std::expected<input_files, error>;
 } find_inputs;
@@ -0,0 +1,37 @@
+#include "follow_pcap_inputs.hpp"
+
+#include <utility>
+
+auto FollowPcapInputs::make_t::operator()(pair<std::string> filenames, std::stop_token stop,
+                                          std::atomic<bool> const *wake) const -> std::expected<FollowPcapInputs, error>
+{
+  auto source_a = follow_source::make(filenames.A, stop);
+  auto source_b = follow_source::make(filenames.B, stop);
+  if (!source_a && !source_b) {
+    return error::make(error::open_pcap, "failed to open both files: ", filenames.A, ", ", filenames.B);
+  }
+  if (!source_a) {
+    return error::make(error::open_pcap, "failed to open file A: ", filenames.A);
+  }
+  if (!source_b) {
+    return error::make(error::open_pcap, "failed to open file B: ", filenames.B);
+  }
+
+  auto records_a = records_t::make(std::move(*source_a));
+  if (!records_a) {
+    return error::make(error::open_pcap, "invalid file A, error: ", records_a.error());
+  }
+  auto records_b = records_t::make(std::move(*source_b));
+  if (!records_b) {
+    return error::make(error::open_pcap, "invalid file B, error: ", records_b.error());
+  }
+
+  // NOTE: if stop is requested before the first packet is written, we will assume Ethernet
+  auto const link_a = packet::detect_link(records_a->header().linktype, records_a->peek().value_or(savefile::record{}).data);
+  auto const link_b = packet::detect_link(records_b->header().linktype, records_b->peek().value_or(savefile::record{}).data);
+  // NOTE: only now, so that waking does not end the wait for the header or the first packet
+  records_a->source().wake_when(wake);
+  records_b->source().wake_when(wake);
+  return FollowPcapInputs({.A = {.records = std::move(*records_a), .link = link_a},
+                           .B = {.records = std::move(*records_b), .link = link_b}});
+}
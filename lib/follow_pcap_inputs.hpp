@@ -0,0 +1,84 @@
+#ifndef LIB_FOLLOW_PCAP_INPUTS
+#define LIB_FOLLOW_PCAP_INPUTS
+
+#include "error.hpp"
+#include "follow_records.hpp"
+#include "follow_source.hpp"
+#include "inputs.hpp"
+#include "link_layer.hpp"
+#include "packet.hpp"
+#include "savefile.hpp"
+
+#include <atomic>
+#include <expected>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+// Alternative to PcapInputs for files which are still being written to. At the end of a file the merge loop
+// of stats::make does not end, but waits until more packets are written, or until stop is requested.
+// NOTE: a channel which is not written to also stops the other channel, since stats::make reads them in lock-step;
+// snapshots of stats so far are still taken while waiting, see make with wake
+// TODO: this is untestable, because follow_source calls the OS directly (but follow_records is tested)
+struct FollowPcapInputs final : Inputs {
+  using data_t = Inputs::data_t;
+  static_assert(std::is_same_v<packet::data_t, data_t>);
+  using records_t = follow_records<follow_source>;
+
+  // Create FollowPcapInputs from a pair of pcap files, waiting until the first packet of each is written. After
+  // that, waiting for more packets also ends while wake is set, if given, see follow_source::wake_when.
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(pair<std::string> filenames, std::stop_token stop,
+                                  std::atomic<bool> const *wake = nullptr) const
+        -> std::expected<FollowPcapInputs, error>;
+  } make = {};
+
+  // Hides Inputs::next_batch, to enable static dispatch in stats::make
+  auto next_batch(pair_select which) -> batch_t { return batch_(which == pair_select::A ? A_ : B_); }
+
+  // noncopyable, but moveable
+  FollowPcapInputs(FollowPcapInputs const &) = delete;
+  FollowPcapInputs(FollowPcapInputs &&other) = default;
+
+private:
+  struct channel final {
+    records_t records;
+    packet::link_t link;
+    std::vector<data_t> views = {};
+  };
+
+  explicit FollowPcapInputs(pair<channel> src) noexcept : A_(std::move(src.A)), B_(std::move(src.B)) {}
+
+  // NOTE: Same as in PcapInputs, incomplete packet is of no use to us, just report that we had "something"
+  static auto view_(savefile::record const &record) -> data_t
+  {
+    return record.header.caplen == record.header.len ? record.data : record.data.first(0);
+  }
+
+  static auto next_(channel &input, auto &&callback) -> bool
+  {
+    return input.records.next(1, [&callback](savefile::record const &record) { callback(view_(record)); }) > 0;
+  }
+
+  // Data in the batch points directly to the read buffer, only views need to be stored. The batch holds
+  // whatever packets were written so far, up to batch_size; it is empty only after stop was requested, or while
+  // wake is set.
+  static auto batch_(channel &input) -> batch_t
+  {
+    input.views.clear();
+    input.records.next(batch_size, [&input](savefile::record const &record) { input.views.push_back(view_(record)); });
+    return input.views;
+  }
+
+  auto next_a(data_callback_t callback) -> bool override { return next_(A_, std::move(callback)); }
+  auto next_b(data_callback_t callback) -> bool override { return next_(B_, std::move(callback)); }
+  auto batch_a() -> batch_t override { return next_batch(pair_select::A); }
+  auto batch_b() -> batch_t override { return next_batch(pair_select::B); }
+  auto link_a() const -> packet::link_t override { return A_.link; }
+  auto link_b() const -> packet::link_t override { return B_.link; }
+
+  channel A_;
+  channel B_;
+};
+
+#endif // LIB_FOLLOW_PCAP_INPUTS
@@ -0,0 +1,131 @@
+#ifndef LIB_FOLLOW_RECORDS
+#define LIB_FOLLOW_RECORDS
+
+#include "error.hpp"
+#include "savefile.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <expected>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Source of bytes of a file which is still being written to, e.g. follow_source
+template <typename T>
+concept some_follow_source = requires(T &source, std::span<unsigned char> dest) {
+  // Read up to dest.size() bytes which are available now; 0 means nothing was written since the last read
+  { source.read(dest) } -> std::same_as<std::size_t>;
+  // Wait until more bytes might be available; false means the file is not followed anymore, or that waiting was
+  // interrupted for other reasons, in which case a later call may wait again
+  { source.wait() } -> std::same_as<bool>;
+};
+
+// Walk records of a pcap file which is still being written to. At the end of data, including in the middle of
+// a record, this waits for the file to grow rather than stopping, until the source stops waiting. Unparsed bytes
+// are moved to the start of the buffer before reading more, and the buffer grows if a record does not fit in it.
+template <some_follow_source Source> struct follow_records final {
+  using data_t = std::span<unsigned char const>;
+  static constexpr std::size_t initial_size = 1024 * 1024;
+
+  // Wait for the file header, and parse it
+  static auto make(Source &&source, std::size_t size = initial_size) -> std::expected<follow_records, error>
+  {
+    follow_records ret(std::move(source), size);
+    // NOTE: a file which has just been created might not have the header yet
+    while (ret.end_ < savefile::file_header_length && ret.more_()) {
+    }
+    auto const header = savefile::file_header::make(data_t(ret.buffer_.data(), ret.end_));
+    if (!header) {
+      return std::unexpected<error>(header.error());
+    }
+    ret.header_ = *header;
+    ret.position_ = savefile::file_header_length;
+    return ret;
+  }
+
+  // noncopyable, but moveable
+  follow_records(follow_records const &) = delete;
+  follow_records(follow_records &&other) noexcept = default;
+
+  [[nodiscard]] auto header() const noexcept -> savefile::file_header const & { return header_; }
+  [[nodiscard]] auto source() noexcept -> Source & { return source_; }
+
+  // The next record, waiting until it is written in full. Data remains valid until the next call to next.
+  [[nodiscard]] auto peek() -> std::optional<savefile::record>
+  {
+    for (;;) {
+      if (auto const ret = records_().peek(); ret.has_value() || not more_()) {
+        return ret;
+      }
+    }
+  }
+
+  // Read up to count records, waiting only if none is available. Data remains valid until the next call.
+  // Empty result means the source stopped waiting, e.g. the file is not followed anymore, and all records written
+  // in full so far were read.
+  template <typename Fn> auto next(std::size_t count, Fn &&fn) -> std::size_t
+  {
+    std::size_t ret = 0;
+    while (ret < count) {
+      auto records = records_();
+      if (auto const record = records.next(); record.has_value()) {
+        position_ = records.offset;
+        fn(*record);
+        ++ret;
+        continue;
+      }
+
+      // Records handed out earlier point to the buffer, cannot move data yet
+      if (ret > 0 || not more_()) {
+        break;
+      }
+    }
+    return ret;
+  }
+
+private:
+  follow_records(Source &&source, std::size_t size) : source_(std::move(source)), buffer_(size > 0 ? size : 1) {}
+
+  [[nodiscard]] auto records_() const noexcept -> savefile::records
+  {
+    return {.header = header_, .file = data_t(buffer_.data(), end_), .offset = position_};
+  }
+
+  // Move the unparsed remainder to the start of the buffer and read more data, waiting for it if needed
+  auto more_() -> bool
+  {
+    if (position_ > 0) {
+      std::copy(buffer_.begin() + static_cast<std::ptrdiff_t>(position_),
+                buffer_.begin() + static_cast<std::ptrdiff_t>(end_), buffer_.begin());
+      end_ -= position_;
+      position_ = 0;
+    }
+    if (end_ == buffer_.size()) {
+      buffer_.resize(buffer_.size() * 2);
+    }
+
+    auto const dest = std::span<unsigned char>(buffer_).subspan(end_);
+    for (bool waiting = true;;) {
+      if (auto const bytes = source_.read(dest); bytes > 0) {
+        end_ += bytes;
+        return true;
+      }
+      // NOTE: one more read after the source stopped waiting, in case data was written just before that
+      if (not waiting) {
+        return false;
+      }
+      waiting = source_.wait();
+    }
+  }
+
+  Source source_;
+  std::vector<unsigned char> buffer_;
+  savefile::file_header header_ = {};
+  std::size_t position_ = 0; // start of unparsed data in buffer_
+  std::size_t end_ = 0;      // end of data in buffer_
+};
+
+#endif // LIB_FOLLOW_RECORDS
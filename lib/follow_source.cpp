@@ -0,0 +1,90 @@
+#include "follow_source.hpp"
+
+#include <thread>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#if __has_include(<sys/inotify.h>)
+#include <sys/inotify.h>
+#define PCAP_PARSER_HAVE_INOTIFY 1
+#endif
+
+struct follow_source::state final {
+  int fd = -1;
+  int notify = -1; // inotify instance watching fd, or -1 if not available
+  std::stop_token stop = {};
+  std::atomic<bool> const *wake = nullptr;
+
+  ~state() noexcept
+  {
+    if (notify >= 0) {
+      ::close(notify);
+    }
+    ::close(fd);
+  }
+};
+
+void follow_source::state_delete::operator()(state *s) const noexcept { delete s; }
+
+auto follow_source::make_t::operator()(std::string const &filename, std::stop_token stop) const
+    -> std::expected<follow_source, error>
+{
+  int const fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::make(error::open_pcap, "failed to open file: ", filename);
+  }
+  auto ret = std::unique_ptr<state, state_delete>(
+      new state{.fd = fd, .notify = -1, .stop = std::move(stop), .wake = nullptr});
+
+#ifdef PCAP_PARSER_HAVE_INOTIFY
+  // NOTE: the watch is added before the first read, so no modification can be missed between a read and wait
+  if (int const notify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC); notify >= 0) {
+    if (::inotify_add_watch(notify, filename.c_str(), IN_MODIFY | IN_CLOSE_WRITE) >= 0) {
+      ret->notify = notify;
+    } else {
+      ::close(notify);
+    }
+  }
+#endif
+  return follow_source(std::move(ret));
+}
+
+auto follow_source::read(std::span<unsigned char> dest) -> std::size_t
+{
+  for (;;) {
+    auto const res = ::read(state_->fd, dest.data(), dest.size());
+    if (res < 0 && errno == EINTR) {
+      continue;
+    }
+    // NOTE: read error is reported as no data, same as end of file; the stop token ends the wait
+    return res > 0 ? static_cast<std::size_t>(res) : 0;
+  }
+}
+
+void follow_source::wake_when(std::atomic<bool> const *flag) noexcept { state_->wake = flag; }
+
+auto follow_source::wait() -> bool
+{
+  while (not state_->stop.stop_requested()) {
+    if (state_->wake != nullptr && state_->wake->load(std::memory_order_relaxed)) {
+      return false;
+    }
+    if (state_->notify < 0) {
+      std::this_thread::sleep_for(poll_interval);
+      return not state_->stop.stop_requested();
+    }
+
+    ::pollfd fds = {.fd = state_->notify, .events = POLLIN, .revents = 0};
+    if (::poll(&fds, 1, static_cast<int>(poll_interval.count())) > 0) {
+      // Drain all pending events, we only need to know that the file was modified
+      alignas(8) char buffer[4096];
+      while (::read(state_->notify, buffer, sizeof(buffer)) > 0) {
+      }
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,46 @@
+#ifndef LIB_FOLLOW_SOURCE
+#define LIB_FOLLOW_SOURCE
+
+#include "error.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <span>
+#include <stop_token>
+#include <string>
+
+// Reading of a file which is still being written to, e.g. by a capture process. At the end of file wait
+// blocks until the file is modified (watched with inotify), until stop is requested, or until woken, see wake_when.
+// Meets some_follow_source.
+// NOTE: truncation or rotation of the file is not detected, the writer is expected to only append to it
+struct follow_source final {
+  // How often the stop token is checked while waiting, also the polling interval if inotify is not available
+  static constexpr std::chrono::milliseconds poll_interval{100};
+
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(std::string const &filename, std::stop_token stop) const
+        -> std::expected<follow_source, error>;
+  } make = {};
+
+  auto read(std::span<unsigned char> dest) -> std::size_t;
+  auto wait() -> bool;
+
+  // Also end wait, without ending the file, while flag is set, e.g. when a snapshot of stats is due. The flag is
+  // checked as often as the stop token; wait blocks again once it is cleared.
+  void wake_when(std::atomic<bool> const *flag) noexcept;
+
+private:
+  struct state;
+  struct state_delete final {
+    void operator()(state *) const noexcept;
+  };
+
+  explicit follow_source(std::unique_ptr<state, state_delete> state) noexcept : state_(std::move(state)) {}
+
+  std::unique_ptr<state, state_delete> state_;
+};
+
+#endif // LIB_FOLLOW_SOURCE
@@ -0,0 +1,178 @@
+#include "generate_options.hpp"
+
+#include <charconv>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace {
+template <typename T> auto parse_number(std::string_view value) -> std::optional<T>
+{
+  T ret = {};
+  auto const [end, ec] = std::from_chars(value.data(), value.data() + value.size(), ret);
+  if (ec != std::errc{} || end != value.data() + value.size()) {
+    return std::nullopt;
+  }
+  return ret;
+}
+
+// Either one value for both channels, or two values separated with ',' for A and B
+template <typename T> auto parse_pair(std::string_view value, auto &&parse) -> std::optional<pair<T>>
+{
+  auto const separator = value.find(',');
+  if (separator == std::string_view::npos) {
+    auto const both = parse(value);
+    if (not both) {
+      return std::nullopt;
+    }
+    return pair<T>{.A = *both, .B = *both};
+  }
+  auto const a = parse(value.substr(0, separator));
+  auto const b = parse(value.substr(separator + 1));
+  if (not a || not b) {
+    return std::nullopt;
+  }
+  return pair<T>{.A = *a, .B = *b};
+}
+
+auto parse_probability(std::string_view value) -> std::optional<double>
+{
+  auto const ret = parse_number<double>(value);
+  if (not ret || not(*ret >= 0.0 && *ret <= 1.0)) {
+    return std::nullopt;
+  }
+  return ret;
+}
+
+// One of "constant:MEAN", "uniform:MEAN:JITTER", "normal:MEAN:JITTER" or "exponential:MEAN", in ns
+auto parse_latency(std::string_view value) -> std::optional<generate_options::latency_t>
+{
+  using kind_t = generate_options::latency_t::kind_t;
+  std::vector<std::string_view> fields;
+  for (auto separator = value.find(':'); separator != std::string_view::npos; separator = value.find(':')) {
+    fields.push_back(value.substr(0, separator));
+    value.remove_prefix(separator + 1);
+  }
+  fields.push_back(value);
+
+  generate_options::latency_t ret;
+  if (fields.front() == "constant" && fields.size() == 2) {
+    ret.kind = kind_t::constant;
+  } else if (fields.front() == "uniform" && fields.size() == 3) {
+    ret.kind = kind_t::uniform;
+  } else if (fields.front() == "normal" && fields.size() == 3) {
+    ret.kind = kind_t::normal;
+  } else if (fields.front() == "exponential" && fields.size() == 2) {
+    ret.kind = kind_t::exponential;
+  } else {
+    return std::nullopt;
+  }
+
+  auto const mean = parse_number<double>(fields[1]);
+  auto const jitter = fields.size() == 3 ? parse_number<double>(fields[2]) : std::optional<double>{0.0};
+  if (not mean || not jitter || not(*mean >= 0.0) || not(*jitter >= 0.0)) {
+    return std::nullopt;
+  }
+  ret.mean_ns = *mean;
+  ret.jitter_ns = *jitter;
+  return ret;
+}
+
+// NOTE: 1472 is the largest UDP payload in an Ethernet frame with MTU 1500 and IPv4 header without options
+constexpr std::uint16_t maximum_payload = 1472;
+constexpr std::uint16_t minimum_payload = 4;
+} // namespace
+
+auto generate_options::make_t::operator()(std::span<char const *const> args) const
+    -> std::expected<generate_options, error>
+{
+  generate_options ret;
+  std::vector<std::string_view> positional;
+  for (std::string_view const arg : args) {
+    if (!arg.starts_with("--")) {
+      positional.push_back(arg);
+      continue;
+    }
+
+    auto const separator = arg.find('=');
+    auto const name = arg.substr(2, separator == std::string_view::npos ? arg.npos : separator - 2);
+    auto const value = separator == std::string_view::npos ? std::string_view{} : arg.substr(separator + 1);
+    if (name == "packets") {
+      auto const packets = parse_number<std::uint64_t>(value);
+      if (not packets || *packets == 0) {
+        return error::make(error::main, "invalid packets: ", value, ", expected positive number of packets");
+      }
+      ret.packets = *packets;
+    } else if (name == "first") {
+      auto const first = parse_number<std::uint32_t>(value);
+      if (not first) {
+        return error::make(error::main, "invalid first: ", value, ", expected sequence number");
+      }
+      ret.first_sequence = *first;
+    } else if (name == "rate") {
+      auto const rate = parse_number<double>(value);
+      if (not rate || not(*rate > 0.0)) {
+        return error::make(error::main, "invalid rate: ", value, ", expected positive number of packets per second");
+      }
+      ret.rate = *rate;
+    } else if (name == "payload") {
+      auto const dash = value.find('-');
+      auto const min = parse_number<std::uint16_t>(value.substr(0, dash));
+      auto const max = dash == std::string_view::npos ? min : parse_number<std::uint16_t>(value.substr(dash + 1));
+      if (not min || not max || *min < minimum_payload || *max > maximum_payload || *max < *min) {
+        return error::make(error::main, "invalid payload: ", value, ", expected size or range of sizes between ",
+                           minimum_payload, " and ", maximum_payload);
+      }
+      ret.payload_min = *min;
+      ret.payload_max = *max;
+    } else if (name == "drop" || name == "reorder" || name == "duplicate") {
+      auto const probability = parse_pair<double>(value, parse_probability);
+      if (not probability) {
+        return error::make(error::main, "invalid ", name, ": ", value,
+                           ", expected probability between 0 and 1, or two separated with ','");
+      }
+      (name == "drop" ? ret.drop : name == "reorder" ? ret.reorder : ret.duplicate) = *probability;
+    } else if (name == "latency") {
+      auto const latency = parse_pair<latency_t>(value, parse_latency);
+      if (not latency) {
+        return error::make(error::main, "invalid latency: ", value,
+                           ", expected constant:MEAN, uniform:MEAN:JITTER, normal:MEAN:JITTER or exponential:MEAN"
+                           " in ns, or two separated with ','");
+      }
+      ret.latency = *latency;
+    } else if (name == "segment") {
+      auto const segment = parse_number<std::uint64_t>(value);
+      if (not segment || *segment == 0) {
+        return error::make(error::main, "invalid segment: ", value, ", expected positive number of packets");
+      }
+      ret.segment_packets = *segment;
+    } else if (name == "seed") {
+      auto const seed = parse_number<std::uint64_t>(value);
+      if (not seed) {
+        return error::make(error::main, "invalid seed: ", value, ", expected number");
+      }
+      ret.seed = *seed;
+    } else if (name == "prefix") {
+      if (value.empty() || value.find('/') != std::string_view::npos) {
+        return error::make(error::main, "invalid prefix: ", value, ", expected file name");
+      }
+      ret.prefix = value;
+    } else {
+      return error::make(error::main, "unknown option: ", arg);
+    }
+  }
+
+  // NOTE: merge loops compare sequence numbers without wrapping around
+  if (ret.packets - 1 > std::numeric_limits<std::uint32_t>::max() - ret.first_sequence) {
+    return error::make(error::main, "too many packets: ", ret.packets, " after first sequence number ",
+                       ret.first_sequence);
+  }
+
+  if (positional.size() != 1) {
+    return error::make(error::main, "received ", positional.size(), " parameters but expected 1");
+  }
+  ret.path = positional.front();
+  return ret;
+}
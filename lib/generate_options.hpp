@@ -0,0 +1,50 @@
+#ifndef LIB_GENERATE_OPTIONS
+#define LIB_GENERATE_OPTIONS
+
+#include "error.hpp"
+#include "pair.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+
+// Options of the generator of synthetic A/B capture pairs, see synthetic::generate
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct generate_options final {
+  // Distribution of the latency of one channel, i.e. from sending a packet until it is captured
+  struct latency_t final {
+    enum class kind_t { constant, uniform, normal, exponential };
+
+    kind_t kind = kind_t::constant;
+    double mean_ns = 0;
+    double jitter_ns = 0; // half-width of uniform, standard deviation of normal, unused otherwise
+
+    [[nodiscard]] constexpr auto operator==(latency_t const &) const noexcept -> bool = default;
+  };
+
+  std::string path = {};
+  std::string prefix = "synthetic";        // files are named e.g. synthetic_14310-0.pcap
+  std::uint64_t packets = 1'000'000;       // sent by the source, before drops and duplicates
+  std::uint32_t first_sequence = 1;
+  double rate = 1'000'000;                 // mean packets per second, sent as a Poisson process
+  std::uint16_t payload_min = 16;          // UDP payload size in bytes, including 4 bytes of sequence number
+  std::uint16_t payload_max = 16;          // payload sizes are uniform between min and max
+  pair<double> drop = {.A = 0, .B = 0};    // probability of a packet not being captured
+  pair<double> reorder = {.A = 0, .B = 0}; // probability of a packet being delayed behind a few later ones
+  pair<double> duplicate = {.A = 0, .B = 0}; // probability of a packet being captured twice
+  pair<latency_t> latency = {.A = {.kind = latency_t::kind_t::exponential, .mean_ns = 1000},
+                             .B = {.kind = latency_t::kind_t::exponential, .mean_ns = 1000}};
+  std::uint64_t segment_packets = 0;       // rotate files after this many packets, or never if 0
+  std::uint64_t seed = 1;
+
+  // Parse command line arguments, excluding program name, e.g. "--packets=1000 --drop=0.01,0 some/directory"
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(std::span<char const *const> args) const -> std::expected<generate_options, error>;
+  } make = {};
+
+  [[nodiscard]] auto operator==(generate_options const &other) const noexcept -> bool = default;
+};
+
+#endif // LIB_GENERATE_OPTIONS
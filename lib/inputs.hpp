@@ -1,8 +1,11 @@
 #ifndef LIB_INPUTS
 #define LIB_INPUTS
 
+#include "link_layer.hpp"
 #include "pair.hpp"
 
+#include <concepts>
+#include <cstddef>
 #include <functional>
 #include <span>
 #include <utility>
@@ -26,9 +29,52 @@ struct Inputs {
   using data_t = std::span<unsigned char const>;
   using data_callback_t = std::move_only_function<void(data_t)>;
 
+  // Read up to batch_size packets from the selected channel at once, which amortizes the cost of
+  // virtual call over the whole batch. Data in a batch is only valid until the next call to next_batch
+  // for the same channel. Empty batch means there is no more data in this channel.
+  using batch_t = std::span<data_t const>;
+  static constexpr std::size_t batch_size = 256;
+
+  auto next_batch(pair_select which) -> batch_t
+  {
+    switch (which) {
+    case pair_select::A:
+      return this->batch_a();
+    case pair_select::B:
+      return this->batch_b();
+    default:
+      std::unreachable();
+    }
+  }
+
+  // Link layer of packets in the selected channel, selected once when the channel is opened
+  auto link(pair_select which) const -> packet::link_t
+  {
+    switch (which) {
+    case pair_select::A:
+      return this->link_a();
+    case pair_select::B:
+      return this->link_b();
+    default:
+      std::unreachable();
+    }
+  }
+
 private:
   virtual auto next_a(data_callback_t) -> bool = 0;
   virtual auto next_b(data_callback_t) -> bool = 0;
+  virtual auto batch_a() -> batch_t = 0;
+  virtual auto batch_b() -> batch_t = 0;
+  virtual auto link_a() const -> packet::link_t = 0;
+  virtual auto link_b() const -> packet::link_t = 0;
+};
+
+// Any source of batches of packets. This is either Inputs (dynamic dispatch), or a concrete implementation of
+// Inputs which hides Inputs::next_batch with its own non-virtual function (static dispatch).
+template <typename T>
+concept some_inputs = requires(T &inputs, pair_select which) {
+  { inputs.next_batch(which) } -> std::same_as<Inputs::batch_t>;
+  { inputs.link(which) } -> std::same_as<packet::link_t>;
 };
 
-#endif // LIB_ERROR
+#endif // LIB_INPUTS
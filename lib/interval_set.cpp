@@ -0,0 +1,85 @@
+#include "interval_set.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+auto interval_set::size() const noexcept -> std::uint64_t
+{
+  std::uint64_t ret = 0;
+  for (auto const &item : intervals_) {
+    ret += std::uint64_t{item.last} - item.first + 1;
+  }
+  return ret;
+}
+
+auto interval_set::contains(std::uint32_t value) const noexcept -> bool
+{
+  // First interval which ends at or after value
+  auto const it = std::ranges::lower_bound(intervals_, value, {}, &interval::last);
+  return it != intervals_.end() && it->first <= value;
+}
+
+void interval_set::insert(std::uint32_t first, std::uint32_t last)
+{
+  if (last < first) {
+    return;
+  }
+
+  // NOTE: fast path, values are mostly inserted in increasing order
+  if (intervals_.empty() || (intervals_.back().last < first && intervals_.back().last + 1 < first)) {
+    intervals_.push_back({.first = first, .last = last});
+    return;
+  }
+
+  // All intervals which overlap or are adjacent to [first, last], i.e. [begin, end), are merged into one
+  auto const begin = std::ranges::lower_bound(intervals_, first, [](std::uint32_t lh, std::uint32_t rh) {
+    return lh < rh && lh + 1 < rh; // lh is the end of an interval, not adjacent to rh
+  }, &interval::last);
+  auto const end = std::ranges::upper_bound(begin, intervals_.end(), last, [](std::uint32_t lh, std::uint32_t rh) {
+    return lh < rh && lh + 1 < rh; // rh is the start of an interval, not adjacent to lh
+  }, &interval::first);
+  if (begin == end) {
+    intervals_.insert(begin, {.first = first, .last = last});
+    return;
+  }
+  begin->first = std::min(begin->first, first);
+  begin->last = std::max(std::prev(end)->last, last);
+  intervals_.erase(std::next(begin), end);
+}
+
+auto interval_set::erase(std::uint32_t value) -> bool
+{
+  auto const it = std::ranges::lower_bound(intervals_, value, {}, &interval::last);
+  if (it == intervals_.end() || value < it->first) {
+    return false;
+  }
+
+  if (it->first == it->last) {
+    intervals_.erase(it);
+  } else if (it->first == value) {
+    it->first += 1;
+  } else if (it->last == value) {
+    it->last -= 1;
+  } else {
+    auto const last = it->last;
+    it->last = value - 1;
+    intervals_.insert(std::next(it), {.first = value + 1, .last = last});
+  }
+  return true;
+}
+
+auto operator<<(std::ostream &output, interval_set const &self) -> std::ostream &
+{
+  if (self.empty()) {
+    return (output << "none");
+  }
+  char const *separator = "";
+  for (auto const &item : self.intervals()) {
+    output << separator << item.first;
+    if (item.last != item.first) {
+      output << '-' << item.last;
+    }
+    separator = ", ";
+  }
+  return output;
+}
@@ -0,0 +1,43 @@
+#ifndef LIB_INTERVAL_SET
+#define LIB_INTERVAL_SET
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Set of sequence numbers, stored as sorted, disjoint and non-adjacent closed intervals. Memory is proportional
+// to the number of intervals rather than the number of values. Values are expected to be inserted mostly in
+// increasing order, which only appends to (or extends) the last interval.
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct interval_set final {
+  struct interval final {
+    std::uint32_t first;
+    std::uint32_t last; // inclusive
+
+    [[nodiscard]] constexpr auto operator==(interval const &) const noexcept -> bool = default;
+  };
+
+  [[nodiscard]] auto intervals() const noexcept -> std::vector<interval> const & { return intervals_; }
+  [[nodiscard]] auto empty() const noexcept -> bool { return intervals_.empty(); }
+  [[nodiscard]] auto size() const noexcept -> std::uint64_t; // number of values, not intervals
+  [[nodiscard]] auto contains(std::uint32_t value) const noexcept -> bool;
+
+  // Insert all values in [first, last], merging with overlapping or adjacent intervals
+  void insert(std::uint32_t first, std::uint32_t last);
+  void insert(std::uint32_t value) { insert(value, value); }
+
+  // Remove a value, splitting its interval if needed; returns false if the value was not in the set
+  auto erase(std::uint32_t value) -> bool;
+
+  [[nodiscard]] auto operator==(interval_set const &) const noexcept -> bool = default;
+
+private:
+  std::vector<interval> intervals_ = {};
+};
+
+// Print e.g. "5-7, 10, 12-20", or "none" if empty
+auto operator<<(std::ostream &output, interval_set const &self) -> std::ostream &;
+
+#endif // LIB_INTERVAL_SET
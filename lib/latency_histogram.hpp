@@ -0,0 +1,93 @@
+#ifndef LIB_LATENCY_HISTOGRAM
+#define LIB_LATENCY_HISTOGRAM
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear histogram of latencies in ns, in the style of HdrHistogram. Values below 2^sub_bucket_bits are
+// counted exactly; above that, every power of 2 is split into 2^(sub_bucket_bits - 1) buckets of equal width,
+// so any value is known within 1 / 2^(sub_bucket_bits - 1) of itself. Memory is fixed, recording is O(1) (one
+// count of leading zeros, a shift and an increment), and histograms of consecutive parts of the input add up.
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct latency_histogram final {
+  static constexpr unsigned sub_bucket_bits = 7;                    // i.e. within 1/64, about 1.6%
+  static constexpr unsigned value_bits = 40;                        // 2^40 ns is about 18 minutes
+  static constexpr std::size_t half = std::size_t{1} << (sub_bucket_bits - 1); // buckets per power of 2
+  static constexpr std::size_t bucket_count = (value_bits - sub_bucket_bits + 2) * half;
+
+  std::array<std::uint64_t, bucket_count> counts = {};
+  std::uint64_t count = 0;
+  std::uint64_t max = 0;
+
+  // Index of the bucket for value; values of 2^value_bits or more are counted in the last bucket
+  [[nodiscard]] static constexpr auto bucket(std::uint64_t value) noexcept -> std::size_t
+  {
+    if (value < 2 * half) {
+      return static_cast<std::size_t>(value);
+    }
+    auto const shift = static_cast<unsigned>(std::bit_width(value)) - sub_bucket_bits;
+    if (shift > value_bits - sub_bucket_bits) [[unlikely]] {
+      return bucket_count - 1;
+    }
+    return shift * half + static_cast<std::size_t>(value >> shift);
+  }
+
+  // Highest value counted in a bucket, e.g. p99 is reported as the highest value which can be p99
+  [[nodiscard]] static constexpr auto highest(std::size_t bucket) noexcept -> std::uint64_t
+  {
+    if (bucket < 2 * half) {
+      return bucket;
+    }
+    auto const shift = static_cast<unsigned>(bucket / half - 1);
+    return ((static_cast<std::uint64_t>(bucket - shift * half) + 1) << shift) - 1;
+  }
+
+  constexpr void record(std::uint64_t value) noexcept
+  {
+    counts[bucket(value)] += 1;
+    count += 1;
+    max = value > max ? value : max;
+  }
+
+  // Smallest value such that at least percent of recorded values are less or equal, within the precision of
+  // buckets (but never more than max). Zero if nothing was recorded.
+  [[nodiscard]] constexpr auto percentile(double percent) const noexcept -> std::uint64_t
+  {
+    if (count == 0) {
+      return 0;
+    }
+    auto rank = static_cast<std::uint64_t>(percent / 100.0 * static_cast<double>(count) + 0.5);
+    rank = rank < 1 ? 1 : (rank > count ? count : rank);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        auto const ret = highest(i);
+        return ret < max ? ret : max;
+      }
+    }
+    return max;
+  }
+
+  constexpr auto operator+=(latency_histogram const &other) noexcept -> latency_histogram &
+  {
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+      counts[i] += other.counts[i];
+    }
+    count += other.count;
+    max = other.max > max ? other.max : max;
+    return *this;
+  }
+
+  [[nodiscard]] constexpr auto operator==(latency_histogram const &) const noexcept -> bool = default;
+};
+
+[[nodiscard]] constexpr auto operator+(latency_histogram lh, latency_histogram const &rh) noexcept -> latency_histogram
+{
+  return lh += rh;
+}
+
+#endif // LIB_LATENCY_HISTOGRAM
@@ -0,0 +1,32 @@
+#include "link_layer.hpp"
+
+auto packet::detect_link(std::uint32_t linktype, data_t first_frame) noexcept -> link_t
+{
+  constexpr std::uint16_t tpid_8021q = 0x8100;
+  constexpr std::uint16_t tpid_8021ad = 0x88a8;
+  constexpr std::uint16_t tpid_qinq = 0x9100; // pre-standard QinQ
+  auto const ethertype = [&first_frame](std::size_t offset) -> std::uint16_t {
+    if (first_frame.size() < offset + 2) {
+      return 0;
+    }
+    return static_cast<std::uint16_t>((first_frame[offset] << 8) | first_frame[offset + 1]);
+  };
+
+  switch (linktype) {
+  case linktype_linux_sll:
+    return link_t::sll;
+  case linktype_linux_sll2:
+    return link_t::sll2;
+  default:
+    break;
+  }
+
+  auto const outer = ethertype(12);
+  if (outer == tpid_8021ad || outer == tpid_qinq || (outer == tpid_8021q && ethertype(16) == tpid_8021q)) {
+    return link_t::qinq;
+  }
+  if (outer == tpid_8021q) {
+    return link_t::vlan;
+  }
+  return link_t::ethernet;
+}
@@ -0,0 +1,30 @@
+#ifndef LIB_LINK_LAYER
+#define LIB_LINK_LAYER
+
+#include "packet.hpp"
+
+#include <cstdint>
+
+namespace packet {
+
+// Stack of link layer headers in front of IPv4 header. See https://www.tcpdump.org/linktypes.html
+enum class link_t {
+  ethernet, // LINKTYPE_ETHERNET
+  vlan,     // LINKTYPE_ETHERNET with one 802.1Q tag
+  qinq,     // LINKTYPE_ETHERNET with two tags, 802.1ad QinQ
+  sll,      // LINKTYPE_LINUX_SLL
+  sll2,     // LINKTYPE_LINUX_SLL2
+};
+
+constexpr std::uint32_t linktype_ethernet = 1;
+constexpr std::uint32_t linktype_linux_sll = 113;
+constexpr std::uint32_t linktype_linux_sll2 = 276;
+
+// Select link layer from the link type in pcap file header and, for Ethernet, VLAN tags in the first
+// frame. This is done once per file, so parsing of packets does not need to branch on encapsulation.
+// NOTE: unknown link types are parsed as Ethernet, which will most likely fail with "not IPv4"
+[[nodiscard]] auto detect_link(std::uint32_t linktype, data_t first_frame) noexcept -> link_t;
+
+} // namespace packet
+
+#endif // LIB_LINK_LAYER
@@ -0,0 +1,81 @@
+#ifndef LIB_LOSER_TREE
+#define LIB_LOSER_TREE
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Tournament tree of K keys, one per input, which tracks the input with the smallest key. Replacing
+// the key of the winner only replays the matches on its path to the root, i.e. O(log K) comparisons.
+// Inputs without a key (std::nullopt) are exhausted and lose against everyone; ties are won by the
+// input with the lower index, so the order of inputs is deterministic.
+//
+// Internal nodes [1, K) store the loser of the match played at that node, node 0 stores the overall
+// winner. Leaf of input i is at position K + i, so the parent of every node p is p / 2.
+template <typename Key, typename Less = std::less<>> struct loser_tree final {
+  explicit loser_tree(std::vector<std::optional<Key>> keys, Less less = {})
+      : keys_(std::move(keys)), nodes_(keys_.empty() ? 1 : keys_.size(), 0), less_(std::move(less))
+  {
+    auto const size = keys_.size();
+    if (size == 0) {
+      return;
+    }
+
+    std::vector<std::size_t> winners(2 * size);
+    for (std::size_t i = 0; i < size; ++i) {
+      winners[size + i] = i;
+    }
+    for (std::size_t p = size - 1; p > 0; --p) {
+      auto const a = winners[2 * p];
+      auto const b = winners[2 * p + 1];
+      bool const a_wins = beats_(a, b);
+      winners[p] = a_wins ? a : b;
+      nodes_[p] = a_wins ? b : a;
+    }
+    nodes_[0] = winners[1];
+  }
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t { return keys_.size(); }
+
+  // True if all inputs are exhausted
+  [[nodiscard]] auto empty() const noexcept -> bool { return keys_.empty() || not keys_[nodes_[0]].has_value(); }
+
+  // Index of the input with the smallest key; only meaningful if not empty
+  [[nodiscard]] auto winner() const noexcept -> std::size_t { return nodes_[0]; }
+  [[nodiscard]] auto key(std::size_t input) const noexcept -> std::optional<Key> const & { return keys_[input]; }
+
+  // Set the next key of the current winner (std::nullopt if it is exhausted) and find the new winner
+  void replace(std::optional<Key> key)
+  {
+    auto winner = nodes_[0];
+    keys_[winner] = std::move(key);
+    for (auto p = (keys_.size() + winner) / 2; p > 0; p /= 2) {
+      if (beats_(nodes_[p], winner)) {
+        std::swap(nodes_[p], winner);
+      }
+    }
+    nodes_[0] = winner;
+  }
+
+private:
+  auto beats_(std::size_t a, std::size_t b) const -> bool
+  {
+    auto const &ka = keys_[a];
+    auto const &kb = keys_[b];
+    if (not ka.has_value() || not kb.has_value()) {
+      return ka.has_value() || (not kb.has_value() && a < b);
+    }
+    if (less_(*ka, *kb)) {
+      return true;
+    }
+    return not less_(*kb, *ka) && a < b;
+  }
+
+  std::vector<std::optional<Key>> keys_;
+  std::vector<std::size_t> nodes_;
+  Less less_;
+};
+
+#endif // LIB_LOSER_TREE
@@ -0,0 +1,56 @@
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+auto mapped_file::make_t::operator()(std::string const &filename) const -> std::expected<mapped_file, error>
+{
+  int const fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::make(error::open_pcap, "failed to open file: ", filename);
+  }
+
+  struct ::stat st = {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    return error::make(error::open_pcap, "failed to read size of file: ", filename);
+  }
+  if (st.st_size <= 0) {
+    ::close(fd); // mmap does not accept zero length
+    return error::make(error::open_pcap, "file is empty: ", filename);
+  }
+
+  auto const size = static_cast<std::size_t>(st.st_size);
+  void *const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // mapping remains valid after the file descriptor is closed
+  if (data == MAP_FAILED) {
+    return error::make(error::open_pcap, "failed to map file: ", filename);
+  }
+
+  // We only ever read the file from front to back; ask the kernel for aggressive readahead
+  ::madvise(data, size, MADV_SEQUENTIAL);
+  return mapped_file(static_cast<unsigned char const *>(data), size);
+}
+
+auto mapped_file::populate() const noexcept -> unsigned char
+{
+  if (data_ == nullptr) {
+    return 0;
+  }
+  ::madvise(const_cast<unsigned char *>(data_), size_, MADV_WILLNEED);
+  auto const page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  unsigned char ret = 0;
+  for (std::size_t i = 0; i < size_; i += page) {
+    ret ^= *static_cast<unsigned char const volatile *>(data_ + i);
+  }
+  return ret;
+}
+
+mapped_file::~mapped_file() noexcept
+{
+  if (data_ != nullptr) {
+    ::munmap(const_cast<unsigned char *>(data_), size_);
+  }
+}
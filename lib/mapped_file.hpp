@@ -0,0 +1,48 @@
+#ifndef LIB_MAPPED_FILE
+#define LIB_MAPPED_FILE
+
+#include "error.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string>
+#include <utility>
+
+// Read-only memory mapping of a whole file
+struct mapped_file final {
+  using data_t = std::span<unsigned char const>;
+
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(std::string const &filename) const -> std::expected<mapped_file, error>;
+  } make = {};
+
+  [[nodiscard]] auto data() const noexcept -> data_t { return {data_, size_}; }
+
+  // Read the whole file into memory by touching every page, e.g. on a background thread, so that
+  // later reads of data do not stall on the disk. Returns a checksum, to stop this being optimised away.
+  auto populate() const noexcept -> unsigned char;
+
+  // noncopyable, but moveable
+  mapped_file(mapped_file const &) = delete;
+  auto operator=(mapped_file const &) -> mapped_file & = delete;
+  mapped_file(mapped_file &&other) noexcept
+      : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+  {
+  }
+  auto operator=(mapped_file &&other) noexcept -> mapped_file &
+  {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+  ~mapped_file() noexcept;
+
+private:
+  mapped_file(unsigned char const *data, std::size_t size) noexcept : data_(data), size_(size) {}
+
+  unsigned char const *data_;
+  std::size_t size_;
+};
+
+#endif // LIB_MAPPED_FILE
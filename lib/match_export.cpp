@@ -0,0 +1,76 @@
+#include "match_export.hpp"
+
+#include <span>
+
+namespace {
+constexpr std::array<char const *, 5> suffixes
+    = {".sequence.u32", ".a_timestamp.i64", ".b_timestamp.i64", ".delta.i64", ".status.u8"};
+
+template <typename T> auto bytes(std::vector<T> const &column, std::size_t rows) -> std::span<unsigned char const>
+{
+  return {reinterpret_cast<unsigned char const *>(column.data()), rows * sizeof(T)};
+}
+} // namespace
+
+auto match_export::make_t::operator()(std::string const &prefix) const -> std::expected<match_export, error>
+{
+  match_export ret(prefix);
+  for (std::size_t i = 0; i < column_count; ++i) {
+    auto const filename = prefix + suffixes[i];
+    ret.files_[i].reset(std::fopen(filename.c_str(), "wb"));
+    if (not ret.files_[i]) {
+      return error::make(error::write_export, "failed to create file: ", filename);
+    }
+    std::setvbuf(ret.files_[i].get(), nullptr, _IONBF, 0);
+  }
+  return ret;
+}
+
+void match_export::flush_()
+{
+  wait_();
+  std::swap(filling_, writing_);
+  std::array<std::FILE *, column_count> files = {};
+  for (std::size_t i = 0; i < column_count; ++i) {
+    files[i] = files_[i].get();
+  }
+  auto const columns = std::array<std::span<unsigned char const>, column_count>{
+      bytes(writing_.sequences, size_), bytes(writing_.a_timestamps, size_), bytes(writing_.b_timestamps, size_),
+      bytes(writing_.deltas, size_), bytes(writing_.statuses, size_)};
+  pending_ = std::async(std::launch::async, [files, columns]() -> std::size_t {
+    for (std::size_t i = 0; i < column_count; ++i) {
+      if (std::fwrite(columns[i].data(), 1, columns[i].size(), files[i]) != columns[i].size()) {
+        return i;
+      }
+    }
+    return column_count;
+  });
+  size_ = 0;
+}
+
+void match_export::wait_()
+{
+  if (not pending_.valid()) {
+    return;
+  }
+  if (auto const failed = pending_.get(); failed < column_count && failed_.empty()) {
+    failed_ = prefix_ + suffixes[failed];
+  }
+}
+
+auto match_export::close() -> std::expected<void, error>
+{
+  if (size_ > 0) {
+    flush_();
+  }
+  wait_();
+  for (std::size_t i = 0; i < column_count; ++i) {
+    if (files_[i] && std::fclose(files_[i].release()) != 0 && failed_.empty()) {
+      failed_ = prefix_ + suffixes[i];
+    }
+  }
+  if (not failed_.empty()) {
+    return error::make(error::write_export, "failed to write to file: ", failed_);
+  }
+  return {};
+}
@@ -0,0 +1,111 @@
+#ifndef LIB_MATCH_EXPORT
+#define LIB_MATCH_EXPORT
+
+#include "error.hpp"
+#include "packet.hpp"
+#include "pair.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <expected>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Export of each sequence number counted as matched or dropped by the merge loop of stats::make, as one file per
+// column of fixed width numbers in host byte order, e.g. for numpy.fromfile:
+//   prefix.sequence.u32    sequence number
+//   prefix.a_timestamp.i64 timestamp of channel A in ns since epoch, 0 if A dropped it
+//   prefix.b_timestamp.i64 same for channel B
+//   prefix.delta.i64       timestamp of B minus timestamp of A in ns, i.e. positive if A was faster, 0 if dropped
+//   prefix.status.u8       see status_t
+// Rows are collected in memory, and each column is written in large blocks in a background thread while the merge
+// loop fills the next block, so the merge loop only stores rows and rarely waits.
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct match_export final {
+  using time_point = packet::properties::time_point;
+
+  enum class status_t : std::uint8_t { matched = 0, dropped_a = 1, dropped_b = 2 };
+
+  static constexpr std::size_t buffer_rows = 1 << 16;
+
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(std::string const &prefix) const -> std::expected<match_export, error>;
+  } make = {};
+
+  // Called by the merge loop when both channels have a packet with the same sequence number
+  void matched(packet::properties const &a, packet::properties const &b)
+  {
+    auto const delta = (b.timestamp - a.timestamp).count();
+    append_(a.sequence, a.timestamp.time_since_epoch().count(), b.timestamp.time_since_epoch().count(), delta,
+            status_t::matched);
+  }
+
+  // Called by the merge loop when the selected channel dropped the packet which the other one has
+  void dropped(pair_select which, packet::properties const &other)
+  {
+    auto const timestamp = other.timestamp.time_since_epoch().count();
+    if (which == pair_select::A) {
+      append_(other.sequence, 0, timestamp, 0, status_t::dropped_a);
+    } else {
+      append_(other.sequence, timestamp, 0, 0, status_t::dropped_b);
+    }
+  }
+
+  // Write remaining rows and close all files; this reports the first error of all writes
+  auto close() -> std::expected<void, error>;
+
+  [[nodiscard]] auto rows() const noexcept -> std::uint64_t { return rows_; }
+
+private:
+  struct closer final {
+    void operator()(std::FILE *file) const noexcept { std::fclose(file); }
+  };
+  static constexpr std::size_t column_count = 5;
+
+  explicit match_export(std::string prefix) : prefix_(std::move(prefix)) {}
+
+  // Block of rows, as columns
+  struct block_t final {
+    std::vector<std::uint32_t> sequences = std::vector<std::uint32_t>(buffer_rows);
+    std::vector<std::int64_t> a_timestamps = std::vector<std::int64_t>(buffer_rows);
+    std::vector<std::int64_t> b_timestamps = std::vector<std::int64_t>(buffer_rows);
+    std::vector<std::int64_t> deltas = std::vector<std::int64_t>(buffer_rows);
+    std::vector<status_t> statuses = std::vector<status_t>(buffer_rows);
+  };
+
+  void append_(std::uint32_t sequence, std::int64_t a, std::int64_t b, std::int64_t delta, status_t status)
+  {
+    filling_.sequences[size_] = sequence;
+    filling_.a_timestamps[size_] = a;
+    filling_.b_timestamps[size_] = b;
+    filling_.deltas[size_] = delta;
+    filling_.statuses[size_] = status;
+    rows_ += 1;
+    if (++size_ == buffer_rows) [[unlikely]] {
+      flush_();
+    }
+  }
+  // Start writing the rows filled so far in the background, after the previous block is written
+  void flush_();
+  // Wait for the block being written in the background, if any
+  void wait_();
+
+  std::string prefix_;
+  std::array<std::unique_ptr<std::FILE, closer>, column_count> files_ = {};
+  std::string failed_ = {}; // name of the first file which failed to write, if any
+  block_t filling_ = {};    // by the merge loop
+  block_t writing_ = {};    // by the background thread
+  std::size_t size_ = 0;    // of rows in filling_
+  std::uint64_t rows_ = 0;  // written or in buffers
+  // NOTE: the background thread only uses files and data of writing_, which do not move with match_export, and
+  // must be the last member, so it is joined first
+  std::future<std::size_t> pending_ = {}; // index of the first column which failed to write, or column_count
+};
+
+#endif // LIB_MATCH_EXPORT
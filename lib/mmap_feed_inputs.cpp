@@ -0,0 +1,20 @@
+#include "mmap_feed_inputs.hpp"
+
+[[nodiscard]] auto MmapFeedInputs::make_t::operator()(std::vector<std::string> const &filenames) const
+    -> std::expected<MmapFeedInputs, error>
+{
+  std::vector<channel> channels;
+  channels.reserve(filenames.size());
+  for (auto const &filename : filenames) {
+    auto file = mapped_file::make(filename);
+    if (!file) {
+      return error::make(error::open_pcap, "failed to open file: ", filename, ", error: ", file.error());
+    }
+    auto input = channel::make(std::move(*file));
+    if (!input) {
+      return error::make(error::open_pcap, "invalid file: ", filename, ", error: ", input.error());
+    }
+    channels.push_back(std::move(*input));
+  }
+  return MmapFeedInputs(std::move(channels));
+}
@@ -0,0 +1,42 @@
+#ifndef LIB_MMAP_FEED_INPUTS
+#define LIB_MMAP_FEED_INPUTS
+
+#include "error.hpp"
+#include "feed_inputs.hpp"
+#include "link_layer.hpp"
+#include "mmap_pcap_inputs.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <vector>
+
+// Implementation of FeedInputs which maps all files in memory, with the same channels as MmapPcapInputs
+// TODO: this is untestable, because mapped_file calls the OS directly (but savefile::records is tested)
+struct MmapFeedInputs final : FeedInputs {
+  // Create MmapFeedInputs from pcap files, one per channel
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(std::vector<std::string> const &filenames) const
+        -> std::expected<MmapFeedInputs, error>;
+  } make = {};
+
+  // Hides FeedInputs::next_batch, to enable static dispatch in feed_stats::make
+  auto next_batch(std::size_t channel) -> batch_t { return inputs_[channel].batch(); }
+
+  // noncopyable, but moveable
+  MmapFeedInputs(MmapFeedInputs const &) = delete;
+  MmapFeedInputs(MmapFeedInputs &&other) = default;
+
+private:
+  using channel = MmapPcapInputs::channel;
+
+  explicit MmapFeedInputs(std::vector<channel> src) noexcept : inputs_(std::move(src)) {}
+
+  auto channels_() const -> std::size_t override { return inputs_.size(); }
+  auto batch_(std::size_t channel) -> batch_t override { return next_batch(channel); }
+  auto link_(std::size_t channel) const -> packet::link_t override { return inputs_[channel].link; }
+
+  std::vector<channel> inputs_;
+};
+
+#endif // LIB_MMAP_FEED_INPUTS
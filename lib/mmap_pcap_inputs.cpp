@@ -0,0 +1,40 @@
+#include "mmap_pcap_inputs.hpp"
+
+[[nodiscard]] auto MmapPcapInputs::make_t::operator()(pair<std::string> filenames) const
+    -> std::expected<MmapPcapInputs, error>
+{
+  auto file_a = mapped_file::make(filenames.A);
+  auto file_b = mapped_file::make(filenames.B);
+  if (!file_a && !file_b) {
+    return error::make(error::open_pcap, "failed to open both files: ", filenames.A, ", ", filenames.B);
+  }
+  if (!file_a) {
+    return error::make(error::open_pcap, "failed to open file A: ", filenames.A, ", error: ", file_a.error());
+  }
+  if (!file_b) {
+    return error::make(error::open_pcap, "failed to open file B: ", filenames.B, ", error: ", file_b.error());
+  }
+
+  auto channel_a = channel::make(std::move(*file_a));
+  if (!channel_a) {
+    return error::make(error::open_pcap, "invalid file A, error: ", channel_a.error());
+  }
+  auto channel_b = channel::make(std::move(*file_b));
+  if (!channel_b) {
+    return error::make(error::open_pcap, "invalid file B, error: ", channel_b.error());
+  }
+  return MmapPcapInputs({.A = std::move(*channel_a), .B = std::move(*channel_b)});
+}
+
+auto MmapPcapInputs::channel::make(mapped_file file) -> std::expected<channel, error>
+{
+  auto const header = savefile::file_header::make(file.data());
+  if (!header) {
+    return std::unexpected<error>(header.error());
+  }
+
+  // NOTE: mapped data does not move with mapped_file, so records can be created before the move
+  savefile::records records{.header = *header, .file = file.data()};
+  auto const link = packet::detect_link(header->linktype, records.peek().value_or(savefile::record{}).data);
+  return channel{.file = std::move(file), .records = records, .link = link};
+}
@@ -0,0 +1,84 @@
+#ifndef LIB_MMAP_PCAP_INPUTS
+#define LIB_MMAP_PCAP_INPUTS
+
+#include "error.hpp"
+#include "inputs.hpp"
+#include "link_layer.hpp"
+#include "mapped_file.hpp"
+#include "packet.hpp"
+#include "savefile.hpp"
+
+#include <expected>
+#include <string>
+#include <vector>
+
+// Alternative to PcapInputs which maps both files in memory and walks pcap records directly, handing
+// out data which points inside the mapping. Unlike libpcap, this does not copy any data.
+// TODO: this is untestable, because mapped_file calls the OS directly (but savefile::records is tested)
+struct MmapPcapInputs final : Inputs {
+  using data_t = Inputs::data_t;
+  static_assert(std::is_same_v<packet::data_t, data_t>);
+
+  // Create MmapPcapInputs from a pair of pcap files.
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(pair<std::string> filenames) const -> std::expected<MmapPcapInputs, error>;
+  } make = {};
+
+  // Hides Inputs::next_batch, to enable static dispatch in stats::make
+  auto next_batch(pair_select which) -> batch_t { return batch_(which == pair_select::A ? A_ : B_); }
+
+  // noncopyable, but moveable
+  MmapPcapInputs(MmapPcapInputs const &) = delete;
+  MmapPcapInputs(MmapPcapInputs &&other) = default;
+
+  // One mapped file, also each channel of MmapFeedInputs
+  struct channel final {
+    mapped_file file;
+    savefile::records records;
+    packet::link_t link;
+    std::vector<data_t> views = {};
+
+    // Parse the file header, and detect link layer from the first packet; errors do not name the file
+    static auto make(mapped_file file) -> std::expected<channel, error>;
+
+    auto next(auto &&callback) -> bool
+    {
+      if (auto const record = records.next(); record.has_value()) {
+        // NOTE: Same as in PcapInputs, incomplete packet is of no use to us, just report that we had "something"
+        if (record->header.caplen == record->header.len) {
+          callback(record->data);
+        } else {
+          callback(record->data.first(0));
+        }
+        return true;
+      }
+      return false;
+    }
+
+    // Data in the batch points directly to the mapped file, only views need to be stored
+    auto batch() -> batch_t
+    {
+      views.clear();
+      while (views.size() < batch_size && next([this](data_t data) { views.push_back(data); })) {
+      }
+      return views;
+    }
+  };
+
+private:
+  explicit MmapPcapInputs(pair<channel> src) noexcept : A_(std::move(src.A)), B_(std::move(src.B)) {}
+
+  static auto batch_(channel &input) -> batch_t { return input.batch(); }
+
+  auto next_a(data_callback_t callback) -> bool override { return A_.next(std::move(callback)); }
+  auto next_b(data_callback_t callback) -> bool override { return B_.next(std::move(callback)); }
+  auto batch_a() -> batch_t override { return next_batch(pair_select::A); }
+  auto batch_b() -> batch_t override { return next_batch(pair_select::B); }
+  auto link_a() const -> packet::link_t override { return A_.link; }
+  auto link_b() const -> packet::link_t override { return B_.link; }
+
+  channel A_;
+  channel B_;
+};
+
+#endif // LIB_MMAP_PCAP_INPUTS
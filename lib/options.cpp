@@ -0,0 +1,126 @@
+#include "options.hpp"
+
+#include <charconv>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+auto options::make_t::operator()(std::span<char const *const> args) const -> std::expected<options, error>
+{
+  options ret;
+  std::vector<std::string_view> positional;
+  bool reader_set = false;
+  bool interval_set = false;
+  for (std::string_view const arg : args) {
+    if (!arg.starts_with("--")) {
+      positional.push_back(arg);
+      continue;
+    }
+
+    auto const separator = arg.find('=');
+    auto const name = arg.substr(2, separator == std::string_view::npos ? arg.npos : separator - 2);
+    auto const value = separator == std::string_view::npos ? std::string_view{} : arg.substr(separator + 1);
+    if (name == "reader") {
+      reader_set = true;
+      if (value == "pcap") {
+        ret.reader = reader_t::pcap;
+      } else if (value == "mmap") {
+        ret.reader = reader_t::mmap;
+      } else if (value == "uring") {
+        ret.reader = reader_t::uring;
+      } else if (value == "parallel") {
+        ret.reader = reader_t::parallel;
+      } else if (value == "sharded") {
+        ret.reader = reader_t::sharded;
+      } else {
+        return error::make(error::main, "unknown reader: ", value,
+                           ", expected one of: pcap, mmap, uring, parallel, sharded");
+      }
+    } else if (name == "prefetch" && separator == std::string_view::npos) {
+      ret.prefetch = true;
+    } else if (name == "throughput" && separator == std::string_view::npos) {
+      ret.throughput = true;
+    } else if (name == "feeds" && separator == std::string_view::npos) {
+      ret.feeds = true;
+    } else if (name == "gaps" && separator == std::string_view::npos) {
+      ret.gaps = true;
+    } else if (name == "profile" && separator == std::string_view::npos) {
+      ret.profile = true;
+    } else if (name == "cache" && separator == std::string_view::npos) {
+      ret.cache = true;
+    } else if (name == "window") {
+      auto const [end, ec] = std::from_chars(value.data(), value.data() + value.size(), ret.window);
+      if (ec != std::errc{} || end != value.data() + value.size() || ret.window == 0) {
+        return error::make(error::main, "invalid window: ", value, ", expected positive number of packets");
+      }
+    } else if (name == "from" || name == "to") {
+      auto const bound = packet_range::parse(value);
+      if (not bound) {
+        return error::make(error::main, "invalid ", name, ": ", value,
+                           ", expected sequence number or UTC time e.g. 2023-11-14T14:30:00.5");
+      }
+      (name == "from" ? ret.range.from : ret.range.to) = *bound;
+    } else if (name == "export") {
+      if (value.empty()) {
+        return error::make(error::main, "invalid export: ", value, ", expected prefix of output files");
+      }
+      ret.export_prefix = value;
+    } else if (name == "follow" && separator == std::string_view::npos) {
+      ret.follow = true;
+    } else if (name == "interval") {
+      interval_set = true;
+      std::chrono::seconds::rep seconds = 0;
+      auto const [end, ec] = std::from_chars(value.data(), value.data() + value.size(), seconds);
+      if (ec != std::errc{} || end != value.data() + value.size() || seconds <= 0) {
+        return error::make(error::main, "invalid interval: ", value, ", expected positive number of seconds");
+      }
+      ret.interval = std::chrono::seconds{seconds};
+    } else {
+      return error::make(error::main, "unknown option: ", arg);
+    }
+  }
+
+  // NOTE: parallel and sharded readers already parse packets in background threads
+  if (ret.prefetch && ret.reader == reader_t::parallel) {
+    return error::make(error::main, "option --prefetch cannot be used with --reader=parallel");
+  }
+  if (ret.prefetch && ret.reader == reader_t::sharded) {
+    return error::make(error::main, "option --prefetch cannot be used with --reader=sharded");
+  }
+
+  // NOTE: feeds are always read with MmapFeedInputs
+  if (ret.feeds && (reader_set || ret.prefetch)) {
+    return error::make(error::main, "options --reader and --prefetch cannot be used with --feeds");
+  }
+
+  // NOTE: followed files are always read with FollowPcapInputs
+  if (ret.follow && (reader_set || ret.prefetch || ret.feeds)) {
+    return error::make(error::main, "options --reader, --prefetch and --feeds cannot be used with --follow");
+  }
+  if (interval_set && not ret.follow) {
+    return error::make(error::main, "option --interval requires --follow");
+  }
+
+  // NOTE: these are merge_extras of stats::make, which the sharded merge, follow mode and feeds do not use
+  bool const extras
+      = ret.gaps || ret.window > 0 || ret.profile || not ret.range.empty() || not ret.export_prefix.empty();
+  if (extras && (ret.reader == reader_t::sharded || ret.follow || ret.feeds)) {
+    return error::make(error::main, "options --gaps, --window, --profile, --from, --to and --export cannot be used "
+                                    "with --reader=sharded, --follow or --feeds");
+  }
+
+  // NOTE: cached packets are already parsed, and cached_inputs only read whole files
+  if (ret.cache && (reader_set || ret.prefetch || ret.follow || ret.feeds)) {
+    return error::make(error::main, "option --cache cannot be used with --reader, --prefetch, --follow or --feeds");
+  }
+
+  if (ret.range.from.index() == ret.range.to.index() && ret.range.to < ret.range.from) {
+    return error::make(error::main, "option --from cannot be after --to");
+  }
+
+  if (positional.size() != 1) {
+    return error::make(error::main, "received ", positional.size(), " parameters but expected 1");
+  }
+  ret.path = positional.front();
+  return ret;
+}
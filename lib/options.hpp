@@ -0,0 +1,40 @@
+#ifndef LIB_OPTIONS
+#define LIB_OPTIONS
+
+#include "error.hpp"
+#include "packet_range.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct options final {
+  // Implementation of Inputs to read pcap files with
+  enum class reader_t { pcap, mmap, uring, parallel, sharded };
+
+  std::string path = {};
+  reader_t reader = reader_t::pcap;
+  bool prefetch = false;             // read and parse each channel in a background thread, see prefetch_inputs
+  bool throughput = false;           // report MB/s read from input files
+  bool feeds = false;                // compare all files in the directory, see feed_stats
+  bool follow = false;               // keep reading files which are still being written to, see FollowPcapInputs
+  std::chrono::seconds interval{10}; // between snapshots of stats in follow mode
+  bool gaps = false;                 // report gaps in sequence numbers of each channel, see sequence_gaps
+  std::uint32_t window = 0;          // match reordered packets within this many sequence numbers, see reorder_window
+  bool profile = false;              // report time and hardware counters of each stage, see profiler
+  packet_range range = {};           // only packets from and to a sequence number or time, see PcapInputs::seek
+  bool cache = false;                // read parsed packets from cache files next to inputs, see cached_inputs
+  std::string export_prefix = {};    // export matched and dropped sequence numbers to files, see match_export
+
+  // Parse command line arguments, excluding program name, e.g. "--reader=mmap --prefetch some/directory"
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(std::span<char const *const> args) const -> std::expected<options, error>;
+  } make = {};
+
+  [[nodiscard]] auto operator==(options const &other) const noexcept -> bool = default;
+};
+
+#endif // LIB_OPTIONS
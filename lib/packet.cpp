@@ -3,6 +3,7 @@
 
 #include <iomanip>
 #include <sstream>
+#include <utility>
 
 #include <net/ethernet.h>
 #include <netinet/in.h>
@@ -50,11 +51,11 @@ struct payload_t : udp_t {
 
 } // namespace
 
-auto packet::parse_t::operator()(data_t const &data) const -> std::expected<properties, error>
+auto packet::parse_t::operator()(data_t const &data) const -> parsed_t
 {
   // TODO: clean up C-style casts and type punning.
-  return std::expected<void, error>() //
-         | and_then([&data]() noexcept -> std::expected<void, error> {
+  return std::expected<void, parse_error>() //
+         | and_then([&data]() noexcept -> std::expected<void, parse_error> {
              // Is this Ethernet frame an actual IPv4 packet, and does it have the minimum lenght for one ?
              constexpr auto minimum_frame_length = //
                  ethernet_header_length            // Ethernet frame
@@ -62,41 +63,41 @@ auto packet::parse_t::operator()(data_t const &data) const -> std::expected<prop
                  + minimum_payload_length          // UDP header + 4 bytes sequence number
                  + metamako_trailer_length;        // Metamako trailer with timestamp
              if (data.size() < minimum_frame_length) {
-               return error::make(error::packet_parse, "not enough data");
+               return std::unexpected(parse_error::not_enough_data);
              }
 
              auto const *eth_header = (::ether_header const *)data.data();
              if (::ntohs(eth_header->ether_type) != ETHERTYPE_IP) {
-               return error::make(error::packet_parse, "not IPv4");
+               return std::unexpected(parse_error::not_ipv4);
              }
 
              return {};
            })
-         | and_then([&data]() noexcept -> std::expected<udp_t, error> {
+         | and_then([&data]() noexcept -> std::expected<udp_t, parse_error> {
              // Is this an UDP packet, does it have the required size and what is its IP header length ?
              auto const *ip_header = (data.data() + ethernet_header_length);
              int const ip_header_length = (*ip_header & 0x0F) * 4;
              if (*(ip_header + ip_protocol_offset) != IPPROTO_UDP) {
-               return error::make(error::packet_parse, "not UDP");
+               return std::unexpected(parse_error::not_udp);
              }
 
              if (ip_header_length < static_cast<int>(minimum_ip_header_length)
                  || ip_header_length > static_cast<int>(maximum_ip_header_length)
                  || data.size() < ethernet_header_length + ip_header_length + minimum_payload_length
                                       + metamako_trailer_length) {
-               return error::make(error::packet_parse, "bad IP header");
+               return std::unexpected(parse_error::bad_ip_header);
              }
 
              return udp_t{ip_header_length};
            })
-         | and_then([&data](udp_t udp) noexcept -> std::expected<payload_t, error> {
+         | and_then([&data](udp_t udp) noexcept -> std::expected<payload_t, parse_error> {
              // Extract payload size and validate frame size
              auto const *udp_header = (::udphdr const *)(data.data() + ethernet_header_length + udp.ip_header_len);
              auto const payload_length = ::ntohs(udp_header->len);
              if (payload_length < minimum_payload_length
                  || data.size()
                         != ethernet_header_length + udp.ip_header_len + payload_length + metamako_trailer_length) {
-               return error::make(error::packet_parse, "bad UDP header");
+               return std::unexpected(parse_error::bad_udp_header);
              }
 
              return payload_t{udp, payload_length};
@@ -115,3 +116,22 @@ auto packet::parse_t::operator()(data_t const &data) const -> std::expected<prop
              return packet::properties{.timestamp = timestamp, .sequence = sequence};
            });
 }
+
+auto packet::message(parse_error e) noexcept -> char const *
+{
+  switch (e) {
+  case parse_error::none:
+    return "";
+  case parse_error::not_enough_data:
+    return "not enough data";
+  case parse_error::not_ipv4:
+    return "not IPv4";
+  case parse_error::not_udp:
+    return "not UDP";
+  case parse_error::bad_ip_header:
+    return "bad IP header";
+  case parse_error::bad_udp_header:
+    return "bad UDP header";
+  }
+  std::unreachable();
+}
@@ -1,9 +1,11 @@
 #ifndef LIB_PACKET
 #define LIB_PACKET
 
-#include "error.hpp"
-
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
 #include <ostream>
 #include <span>
 
@@ -24,8 +26,59 @@ struct properties final {
   [[nodiscard]] constexpr bool operator==(properties const &other) const noexcept = default;
 };
 
+// Reason why a frame could not be parsed. This is a small code rather than error, so that a malformed frame costs
+// no allocation; the message is only formatted when someone asks for it, e.g. a log callback of stats::make.
+enum class parse_error : std::uint8_t {
+  none = 0,
+  not_enough_data,
+  not_ipv4,
+  not_udp,
+  bad_ip_header,
+  bad_udp_header,
+};
+constexpr std::size_t parse_error_count = 6;
+
+[[nodiscard]] auto message(parse_error e) noexcept -> char const *;
+
+inline auto operator<<(std::ostream &output, parse_error e) -> std::ostream & { return (output << message(e)); }
+
+// Count of frames which could not be parsed, for each parse_error
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct parse_error_counts final {
+  std::array<std::size_t, parse_error_count> counts = {};
+
+  constexpr void record(parse_error e) noexcept { counts[static_cast<std::size_t>(e)] += 1; }
+
+  [[nodiscard]] constexpr auto operator[](parse_error e) const noexcept -> std::size_t
+  {
+    return counts[static_cast<std::size_t>(e)];
+  }
+
+  [[nodiscard]] constexpr auto total() const noexcept -> std::size_t
+  {
+    std::size_t ret = 0;
+    for (auto const count : counts) {
+      ret += count;
+    }
+    return ret;
+  }
+
+  constexpr auto operator+=(parse_error_counts const &other) noexcept -> parse_error_counts &
+  {
+    for (std::size_t i = 0; i < parse_error_count; ++i) {
+      counts[i] += other.counts[i];
+    }
+    return *this;
+  }
+
+  [[nodiscard]] constexpr auto operator==(parse_error_counts const &) const noexcept -> bool = default;
+};
+
+// Result of parsing a frame
+using parsed_t = std::expected<properties, parse_error>;
+
 constexpr inline struct parse_t final {
-  [[nodiscard]] auto operator()(data_t const &) const -> std::expected<properties, error>;
+  [[nodiscard]] auto operator()(data_t const &) const -> parsed_t;
 } parse;
 
 } // namespace packet
@@ -0,0 +1,188 @@
+#include "packet_cache.hpp"
+#include "link_layer.hpp"
+#include "savefile.hpp"
+#include "sidecar.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace {
+constexpr std::array<unsigned char, 7> magic = {'P', 'C', 'A', 'P', 'C', 'O', 'L'};
+constexpr unsigned char version = 1;
+constexpr std::size_t header_length = 40;
+constexpr std::size_t record_length = sizeof(std::int64_t) + sizeof(std::uint32_t) + sizeof(packet::parse_error);
+constexpr std::size_t chunk_size = 4096;
+
+// NOTE: columns are read in place, which is only portable between hosts of the same byte order. This is written
+// in native byte order, hence it reads differently on a host of the other byte order.
+constexpr std::uint64_t byte_order_mark = 0x0102030405060708;
+static_assert(sizeof(packet::parse_error) == 1);
+
+void put(auto value, unsigned char *out) { std::memcpy(out, &value, sizeof(value)); }
+
+template <typename T> auto get(unsigned char const *src) -> T
+{
+  T ret = {};
+  std::memcpy(&ret, src, sizeof(ret));
+  return ret;
+}
+
+// Parse records of a pcap file into a cache file of count records, written in place into out of encoded_size
+void encode(savefile::records records, std::uint64_t count, std::int64_t file_mtime_ns, std::span<unsigned char> out)
+{
+  auto const link = packet::detect_link(records.header.linktype, records.peek().value_or(savefile::record{}).data);
+  std::ranges::copy(magic, out.begin());
+  out[magic.size()] = version;
+  put(byte_order_mark, out.data() + 8);
+  put(count, out.data() + 16);
+  put(std::uint64_t{records.file.size()}, out.data() + 24);
+  put(file_mtime_ns, out.data() + 32);
+
+  auto *const timestamps = out.data() + header_length;
+  auto *const sequences = timestamps + count * sizeof(std::int64_t);
+  auto *const errors = sequences + count * sizeof(std::uint32_t);
+  std::size_t done = 0;
+  std::vector<packet_cache::data_t> frames;
+  frames.reserve(chunk_size);
+  packet::batch_properties parsed;
+  auto const flush = [&] {
+    packet::parse_batch(frames, parsed, link);
+    for (std::size_t i = 0; i < parsed.size(); ++i, ++done) {
+      auto const ok = parsed.errors[i] == packet::parse_error::none;
+      put(ok ? std::int64_t{parsed.timestamps[i].time_since_epoch().count()} : std::int64_t{0},
+          timestamps + done * sizeof(std::int64_t));
+      put(ok ? parsed.sequences[i] : std::uint32_t{0}, sequences + done * sizeof(std::uint32_t));
+      put(parsed.errors[i], errors + done);
+    }
+    frames.clear();
+  };
+  while (auto const record = records.next()) {
+    // NOTE: same as PcapInputs, incomplete packets are reported as empty, hence cannot be parsed
+    frames.push_back(record->header.caplen == record->header.len ? record->data : packet_cache::data_t{});
+    if (frames.size() == chunk_size) {
+      flush();
+    }
+  }
+  flush();
+}
+
+// NOTE: offsets of columns depend on the number of records, count them first to write columns in place
+auto count_records(savefile::records records) -> std::uint64_t
+{
+  std::uint64_t ret = 0;
+  for (; records.next(); ++ret) {
+  }
+  return ret;
+}
+
+auto encoded_size(std::uint64_t count) -> std::size_t { return header_length + count * record_length; }
+} // namespace
+
+auto packet_cache::build_t::operator()(data_t file, std::int64_t file_mtime_ns) const
+    -> std::expected<std::vector<unsigned char>, error>
+{
+  auto const header = savefile::file_header::make(file);
+  if (not header) {
+    return std::unexpected<error>(header.error());
+  }
+  auto const records = savefile::records{.header = *header, .file = file};
+  auto const count = count_records(records);
+  std::vector<unsigned char> ret(encoded_size(count));
+  encode(records, count, file_mtime_ns, ret);
+  return ret;
+}
+
+auto packet_cache::decode_t::operator()(data_t data) const -> std::expected<packet_cache, error>
+{
+  if (data.size() < magic.size() + 1 || not std::ranges::equal(data.first(magic.size()), magic)) {
+    return error::make(error::open_cache, "invalid cache: unknown file format");
+  }
+  if (data[magic.size()] != version) {
+    return error::make(error::open_cache, "invalid cache: unsupported version ", int{data[magic.size()]});
+  }
+  if (data.size() < header_length) {
+    return error::make(error::open_cache, "invalid cache: truncated header");
+  }
+  if (reinterpret_cast<std::uintptr_t>(data.data()) % alignof(std::int64_t) != 0) {
+    return error::make(error::open_cache, "invalid cache: misaligned data");
+  }
+
+  if (get<std::uint64_t>(data.data() + 8) != byte_order_mark) {
+    return error::make(error::open_cache, "invalid cache: byte order of another host");
+  }
+
+  auto const count = get<std::uint64_t>(data.data() + 16);
+  if (count > (data.size() - header_length) / record_length
+      || data.size() != header_length + count * record_length) {
+    return error::make(error::open_cache, "invalid cache: size does not match number of records");
+  }
+
+  auto const *const columns = data.data() + header_length;
+  auto const *const timestamps = reinterpret_cast<std::int64_t const *>(columns);
+  auto const *const sequences = reinterpret_cast<std::uint32_t const *>(columns + count * sizeof(std::int64_t));
+  auto const *const errors = reinterpret_cast<packet::parse_error const *>(
+      columns + count * (sizeof(std::int64_t) + sizeof(std::uint32_t)));
+  packet_cache ret{.file_size = get<std::uint64_t>(data.data() + 24),
+                   .file_mtime_ns = get<std::int64_t>(data.data() + 32),
+                   .timestamps = {timestamps, count},
+                   .sequences = {sequences, count},
+                   .errors = {errors, count}};
+
+  // NOTE: packet::message only knows the values of parse_error
+  if (std::ranges::any_of(ret.errors, [](packet::parse_error e) {
+        return static_cast<std::size_t>(e) >= packet::parse_error_count;
+      })) {
+    return error::make(error::open_cache, "invalid cache: unknown parse error");
+  }
+  return ret;
+}
+
+auto packet_cache::load_t::operator()(std::string const &filename) const -> std::expected<mapped_file, error>
+{
+  auto const name = filename + std::string(cache_suffix);
+  auto ret = mapped_file::make(name);
+  if (not ret) {
+    return error::make(error::open_cache, "failed to open cache: ", name);
+  }
+  auto const cache = decode(ret->data());
+  if (not cache) {
+    return std::unexpected<error>(cache.error());
+  }
+
+  if (sidecar::stamp(filename) != sidecar::file_stamp{.size = cache->file_size, .mtime_ns = cache->file_mtime_ns}) {
+    return error::make(error::open_cache, "stale cache: ", name);
+  }
+  return ret;
+}
+
+auto packet_cache::save_t::operator()(std::string const &filename) const -> std::expected<void, error>
+{
+  // NOTE: take modification time before reading the file, so that the cache is stale if it changes meanwhile
+  auto const stamp = sidecar::stamp(filename);
+  if (not stamp) {
+    return error::make(error::write_cache, "failed to cache file: ", filename);
+  }
+  auto const file = mapped_file::make(filename);
+  if (not file) {
+    return std::unexpected<error>(file.error());
+  }
+  auto const header = savefile::file_header::make(file->data());
+  if (not header) {
+    return error::make(error::write_cache, "failed to cache file: ", filename, ", error: ", header.error());
+  }
+
+  // NOTE: same as build, but columns are written directly into the cache file, which can be large
+  auto const records = savefile::records{.header = *header, .file = file->data()};
+  auto const count = count_records(records);
+  auto const name = filename + std::string(cache_suffix);
+  if (not sidecar::write(name, encoded_size(count), [&](std::span<unsigned char> out) { //
+        encode(records, count, stamp->mtime_ns, out);
+      })) {
+    return error::make(error::write_cache, "failed to write cache: ", name);
+  }
+  return {};
+}
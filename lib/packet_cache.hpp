@@ -0,0 +1,91 @@
+#ifndef LIB_PACKET_CACHE
+#define LIB_PACKET_CACHE
+
+#include "error.hpp"
+#include "mapped_file.hpp"
+#include "packet.hpp"
+#include "parse_batch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Cache files are named after the cached file, with this appended, e.g. some_14310-0.pcap.cols
+inline constexpr std::string_view cache_suffix = ".cols";
+
+// Properties of all packets of a classic pcap file, as parsed by packet::parse_batch, stored as columns in a
+// cache file next to it. Analysing the same captures again only reads the columns, rather than parsing frames.
+//
+// Cache file format: magic and version, byte order mark, number of records, size and modification time of the
+// cached file, each as 8 bytes, followed by columns of timestamps (8 bytes), sequence numbers (4 bytes) and
+// packet::parse_error (1 byte) of each record. Numbers are in native byte order and each column is aligned to the
+// size of its elements, so a mapped cache file is read in place; a cache written on a host of the other byte
+// order is rejected, and hence written again. This is a view of such columns.
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct packet_cache final {
+  using data_t = std::span<unsigned char const>;
+
+  std::uint64_t file_size = 0;                      // of the cached file, to detect a stale cache
+  std::int64_t file_mtime_ns = 0;                   // of the cached file, to detect a stale cache
+  std::span<std::int64_t const> timestamps = {};    // in ns since epoch, unspecified for an error
+  std::span<std::uint32_t const> sequences = {};    // unspecified for an error
+  std::span<packet::parse_error const> errors = {}; // one for each record in the cached file
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t { return errors.size(); }
+
+  // Same as the result of packet::parse for the record at index i
+  [[nodiscard]] auto at(std::size_t i) const noexcept -> packet::parsed_t
+  {
+    if (errors[i] != packet::parse_error::none) [[unlikely]] {
+      return std::unexpected(errors[i]);
+    }
+    return packet::properties{
+        .timestamp = packet::properties::time_point(packet::properties::duration(timestamps[i])),
+        .sequence = sequences[i]};
+  }
+
+  // Parse all records of a whole pcap file held in memory, and encode them as a cache file. File size is set
+  // from file, modification time is set as given.
+  static constexpr struct build_t final {
+    [[nodiscard]] auto operator()(data_t file, std::int64_t file_mtime_ns = 0) const
+        -> std::expected<std::vector<unsigned char>, error>;
+  } build = {};
+
+  // View of the columns in a cache file, which must be aligned to 8 bytes, as is any mapped file
+  static constexpr struct decode_t final {
+    [[nodiscard]] auto operator()(data_t data) const -> std::expected<packet_cache, error>;
+  } decode = {};
+
+  // Map the cache file of a file, and check that it is up to date with the file
+  static constexpr struct load_t final {
+    [[nodiscard]] auto operator()(std::string const &filename) const -> std::expected<mapped_file, error>;
+  } load = {};
+
+  // Parse a file and write its cache file, replacing any existing one. Columns are written directly into the
+  // cache file, see sidecar::write, rather than built in memory first.
+  static constexpr struct save_t final {
+    [[nodiscard]] auto operator()(std::string const &filename) const -> std::expected<void, error>;
+  } save = {};
+
+  // Reads one channel from columns, in order of records, see cached_inputs and stats::make
+  struct reader final {
+    packet_cache const &cache;
+    std::size_t position = 0;
+
+    auto next(auto &&callback) -> bool
+    {
+      if (position == cache.size()) {
+        return false;
+      }
+      callback(cache.at(position++));
+      return true;
+    }
+  };
+};
+
+#endif // LIB_PACKET_CACHE
@@ -0,0 +1,84 @@
+#include "packet_range.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <system_error>
+
+namespace {
+// Parse a number of exactly digits decimal digits, and move value past it
+auto fixed(std::string_view &value, std::size_t digits, int &out) -> bool
+{
+  if (value.size() < digits || value.front() == '-') {
+    return false;
+  }
+  auto const [end, ec] = std::from_chars(value.data(), value.data() + digits, out);
+  if (ec != std::errc{} || end != value.data() + digits) {
+    return false;
+  }
+  value.remove_prefix(digits);
+  return true;
+}
+
+auto separator(std::string_view &value, char expected) -> bool
+{
+  if (value.empty() || value.front() != expected) {
+    return false;
+  }
+  value.remove_prefix(1);
+  return true;
+}
+} // namespace
+
+auto packet_range::parse(std::string_view value) -> std::optional<bound_t>
+{
+  if (value.empty()) {
+    return std::nullopt;
+  }
+  if (value.find_first_not_of("0123456789") == std::string_view::npos) {
+    std::uint32_t sequence = 0;
+    auto const [end, ec] = std::from_chars(value.data(), value.data() + value.size(), sequence);
+    if (ec != std::errc{} || end != value.data() + value.size()) {
+      return std::nullopt;
+    }
+    return sequence;
+  }
+
+  using namespace std::chrono;
+  int year = 0;
+  int month = 0;
+  int day = 0;
+  int hour = 0;
+  int minute = 0;
+  int second = 0;
+  if (not fixed(value, 4, year) || not separator(value, '-') || not fixed(value, 2, month)
+      || not separator(value, '-') || not fixed(value, 2, day) || not separator(value, 'T')
+      || not fixed(value, 2, hour) || not separator(value, ':') || not fixed(value, 2, minute)
+      || not separator(value, ':') || not fixed(value, 2, second)) {
+    return std::nullopt;
+  }
+  auto const date = year_month_day(std::chrono::year(year), std::chrono::month(static_cast<unsigned>(month)),
+                                   std::chrono::day(static_cast<unsigned>(day)));
+  if (not date.ok() || hour > 23 || minute > 59 || second > 59) {
+    return std::nullopt;
+  }
+
+  nanoseconds fraction{0};
+  if (separator(value, '.')) {
+    auto const digits = value.find_first_not_of("0123456789");
+    auto const length = digits == std::string_view::npos ? value.size() : digits;
+    if (length == 0 || length > 9) {
+      return std::nullopt;
+    }
+    int number = 0;
+    fixed(value, length, number);
+    for (auto i = length; i < 9; ++i) {
+      number *= 10;
+    }
+    fraction = nanoseconds(number);
+  }
+  // NOTE: only UTC is supported, same as Metamako timestamps
+  if (separator(value, 'Z'); not value.empty()) {
+    return std::nullopt;
+  }
+  return time_point(sys_days(date)) + hours(hour) + minutes(minute) + seconds(second) + fraction;
+}
@@ -0,0 +1,55 @@
+#ifndef LIB_PACKET_RANGE
+#define LIB_PACKET_RANGE
+
+#include "packet.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <variant>
+
+// Packets selected with --from and --to, each bound either a sequence number or a Metamako timestamp. Both
+// bounds are inclusive, and either can be left open.
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct packet_range final {
+  using time_point = packet::properties::time_point;
+  using bound_t = std::variant<std::monostate, std::uint32_t, time_point>;
+
+  bound_t from = {};
+  bound_t to = {};
+
+  // Either a sequence number, or UTC time e.g. 2023-11-14T14:30:00 with optional fraction of a second, up to ns
+  [[nodiscard]] static auto parse(std::string_view value) -> std::optional<bound_t>;
+
+  [[nodiscard]] constexpr auto empty() const noexcept -> bool
+  {
+    return std::holds_alternative<std::monostate>(from) && std::holds_alternative<std::monostate>(to);
+  }
+
+  // Packet is before from, e.g. arrived late after reading was positioned at from
+  [[nodiscard]] constexpr auto before(packet::properties const &p) const noexcept -> bool
+  {
+    if (auto const *sequence = std::get_if<std::uint32_t>(&from)) {
+      return p.sequence < *sequence;
+    } else if (auto const *timestamp = std::get_if<time_point>(&from)) {
+      return p.timestamp < *timestamp;
+    }
+    return false;
+  }
+
+  // Packet is after to, i.e. reading of its channel should stop
+  [[nodiscard]] constexpr auto after(packet::properties const &p) const noexcept -> bool
+  {
+    if (auto const *sequence = std::get_if<std::uint32_t>(&to)) {
+      return p.sequence > *sequence;
+    } else if (auto const *timestamp = std::get_if<time_point>(&to)) {
+      return p.timestamp > *timestamp;
+    }
+    return false;
+  }
+
+  [[nodiscard]] constexpr auto operator==(packet_range const &) const noexcept -> bool = default;
+};
+
+#endif // LIB_PACKET_RANGE
@@ -15,6 +15,7 @@ template <typename T> struct pair final {
 };
 
 template <typename T>
+  requires requires(std::ostream &output, T const &value) { output << value; }
 auto operator<<(std::ostream &output, pair<T> const &self) -> std::ostream &
 { //
   return (output << "(A=" << self.A << ", B=" << self.B << ')');
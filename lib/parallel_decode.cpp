@@ -0,0 +1,91 @@
+#include "parallel_decode.hpp"
+
+#include <algorithm>
+
+auto decoded_range::make_t::operator()(savefile::file_header const &header, packet::link_t link,
+                                       savefile::data_t file, std::size_t begin, std::size_t end) const
+    -> decoded_range
+{
+  decoded_range ret{.begin = begin};
+  std::vector<packet::data_t> views;
+  packet::batch_properties parsed;
+  auto const flush = [&]() {
+    packet::parse_batch(views, parsed, link);
+    for (std::size_t i = 0; i < parsed.size(); ++i) {
+      if (parsed.errors[i] == packet::parse_error::none) {
+        ret.timestamps.push_back(parsed.timestamps[i]);
+        ret.sequences.push_back(parsed.sequences[i]);
+      } else {
+        ret.errors.emplace_back(ret.size(), parsed.errors[i]);
+      }
+    }
+    views.clear();
+  };
+
+  savefile::records records{.header = header, .file = file, .offset = begin};
+  while (records.offset < end) {
+    auto const record = records.next();
+    if (not record.has_value()) {
+      ret.complete = false;
+      break;
+    }
+
+    // NOTE: Same as in PcapInputs, incomplete packet is of no use to us, just report that we had "something"
+    views.push_back(record->header.caplen == record->header.len ? record->data : record->data.first(0));
+    if (views.size() == batch_size) {
+      flush();
+    }
+  }
+  flush();
+  ret.end = std::max(begin, records.offset);
+  return ret;
+}
+
+auto parallel_decoder::range_end_(std::size_t i) const noexcept -> std::size_t
+{
+  return std::min((i + 1) * range_size_, file_.size());
+}
+
+void parallel_decoder::launch_()
+{
+  if (launched_ == ranges_) {
+    return;
+  }
+
+  auto const i = launched_++;
+  auto const end = range_end_(i);
+  pending_.push_back(std::async(std::launch::async, [header = header_, link = link_, file = file_, i, end, size = range_size_] {
+    auto const begin = i == 0 ? savefile::file_header_length : savefile::resync(header, file, i * size, end);
+    return decoded_range::make(header, link, file, begin, end);
+  }));
+}
+
+auto parallel_decoder::advance_() -> bool
+{
+  while (pending_.size() < window_ && launched_ < ranges_) {
+    launch_();
+  }
+
+  while (not done_ && taken_ < ranges_) {
+    auto range = pending_.front().get();
+    pending_.pop_front();
+    auto const end = range_end_(taken_++);
+    launch_();
+
+    // Stitch the ranges together. If the range did not start where the previous one ended, parse it again
+    if (range.begin != verified_) {
+      range = decoded_range::make(header_, link_, file_, verified_, end);
+    }
+    verified_ = range.end;
+    done_ = not range.complete;
+
+    if (range.size() > 0) {
+      current_ = std::move(range);
+      position_ = 0;
+      parsed_ = 0;
+      error_ = 0;
+      return true;
+    }
+  }
+  return false;
+}
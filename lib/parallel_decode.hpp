@@ -0,0 +1,103 @@
+#ifndef LIB_PARALLEL_DECODE
+#define LIB_PARALLEL_DECODE
+
+#include "error.hpp"
+#include "link_layer.hpp"
+#include "packet.hpp"
+#include "parse_batch.hpp"
+#include "savefile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <future>
+#include <utility>
+#include <vector>
+
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+
+// Packets from a byte range of a pcap file, parsed into compact columns
+struct decoded_range final {
+  static constexpr std::size_t batch_size = 256; // packets parsed together with packet::parse_batch
+
+  std::size_t begin = 0;  // offset of the first record
+  std::size_t end = 0;    // offset after the last record
+  bool complete = true;   // false if stopped at a truncated record, i.e. there is no more data to read
+  std::vector<packet::properties::time_point> timestamps = {};
+  std::vector<std::uint32_t> sequences = {};
+  std::vector<std::pair<std::size_t, packet::parse_error>> errors = {}; // position among all packets in range
+
+  // Parse all records starting at begin, until the first record starting at or after end
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(savefile::file_header const &header, packet::link_t link, savefile::data_t file,
+                                  std::size_t begin, std::size_t end) const -> decoded_range;
+  } make = {};
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t { return sequences.size() + errors.size(); }
+};
+
+// Split a pcap file held in memory into ranges of range_size bytes, and parse up to window ranges in parallel
+// ahead of the reader. Start of each range (except the first) is found with savefile::resync, and verified
+// against the end of the previous range when stitched. If this does not match, e.g. because the guess of
+// resync was wrong, the range is parsed again on the reader thread. Hence packets are read in exactly the
+// same order as they would be by walking savefile::records.
+struct parallel_decoder final {
+  using parsed_t = packet::parsed_t;
+
+  parallel_decoder(savefile::file_header header, savefile::data_t file, std::size_t range_size, std::size_t window)
+      : header_(header), file_(file), range_size_(range_size < 1 ? 1 : range_size), window_(window < 1 ? 1 : window),
+        ranges_((file.size() + range_size_ - 1) / range_size_),
+        link_(packet::detect_link(
+            header.linktype,
+            savefile::records{.header = header, .file = file}.peek().value_or(savefile::record{}).data))
+  {
+  }
+
+  // noncopyable, but moveable; ranges are parsed from the file data, which does not move with this object
+  parallel_decoder(parallel_decoder const &) = delete;
+  parallel_decoder(parallel_decoder &&) = default;
+
+  // Meets the requirements of Reader in stats::make_t::merge_
+  auto next(auto &&callback) -> bool
+  {
+    if (position_ == current_.size() && not advance_()) {
+      return false;
+    }
+
+    auto const position = position_++;
+    if (error_ < current_.errors.size() && current_.errors[error_].first == position) {
+      callback(parsed_t(std::unexpect, current_.errors[error_++].second));
+    } else {
+      callback(parsed_t(packet::properties{.timestamp = current_.timestamps[parsed_],
+                                           .sequence = current_.sequences[parsed_]}));
+      ++parsed_;
+    }
+    return true;
+  }
+
+private:
+  [[nodiscard]] auto range_end_(std::size_t i) const noexcept -> std::size_t;
+  void launch_();
+  auto advance_() -> bool;
+
+  savefile::file_header header_;
+  savefile::data_t file_;
+  std::size_t range_size_;
+  std::size_t window_;
+  std::size_t ranges_;
+  packet::link_t link_;
+
+  std::deque<std::future<decoded_range>> pending_ = {};
+  std::size_t launched_ = 0;                            // count of ranges launched in background
+  std::size_t taken_ = 0;                               // count of ranges taken by the reader
+  std::size_t verified_ = savefile::file_header_length; // offset of the next record, as seen by the reader
+  bool done_ = false;
+
+  decoded_range current_ = {};
+  std::size_t position_ = 0; // next packet to read from current_, and its position in the columns
+  std::size_t parsed_ = 0;
+  std::size_t error_ = 0;
+};
+
+#endif // LIB_PARALLEL_DECODE
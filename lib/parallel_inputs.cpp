@@ -0,0 +1,35 @@
+#include "parallel_inputs.hpp"
+
+#include <thread>
+
+[[nodiscard]] auto parallel_inputs::make_t::operator()(pair<std::string> filenames) const
+    -> std::expected<parallel_inputs, error>
+{
+  auto file_a = mapped_file::make(filenames.A);
+  auto file_b = mapped_file::make(filenames.B);
+  if (!file_a && !file_b) {
+    return error::make(error::open_pcap, "failed to open both files: ", filenames.A, ", ", filenames.B);
+  }
+  if (!file_a) {
+    return error::make(error::open_pcap, "failed to open file A: ", filenames.A, ", error: ", file_a.error());
+  }
+  if (!file_b) {
+    return error::make(error::open_pcap, "failed to open file B: ", filenames.B, ", error: ", file_b.error());
+  }
+
+  auto const header_a = savefile::file_header::make(file_a->data());
+  if (!header_a) {
+    return error::make(error::open_pcap, "invalid file A, error: ", header_a.error());
+  }
+  auto const header_b = savefile::file_header::make(file_b->data());
+  if (!header_b) {
+    return error::make(error::open_pcap, "invalid file B, error: ", header_b.error());
+  }
+
+  // Both channels are decoded at the same time, split available cores between them
+  auto const window = std::max(1u, std::thread::hardware_concurrency() / 2);
+  // NOTE: mapped data does not move with mapped_file, so decoders can be created before the move
+  auto decoders = pair<parallel_decoder>{.A = parallel_decoder(*header_a, file_a->data(), range_size, window),
+                                         .B = parallel_decoder(*header_b, file_b->data(), range_size, window)};
+  return parallel_inputs({.A = std::move(*file_a), .B = std::move(*file_b)}, std::move(decoders));
+}
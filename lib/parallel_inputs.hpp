@@ -0,0 +1,46 @@
+#ifndef LIB_PARALLEL_INPUTS
+#define LIB_PARALLEL_INPUTS
+
+#include "error.hpp"
+#include "mapped_file.hpp"
+#include "pair.hpp"
+#include "parallel_decode.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <string>
+
+// Maps both files in memory, and parses each of them in parallel ranges with parallel_decoder. Unlike
+// implementations of Inputs, this hands out parsed packets, so it can be only used with stats::make.
+// TODO: this is untestable, because mapped_file calls the OS directly (but parallel_decoder is tested)
+struct parallel_inputs final {
+  static constexpr std::size_t range_size = 64 * 1024 * 1024;
+
+  // Create parallel_inputs from a pair of pcap files.
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(pair<std::string> filenames) const -> std::expected<parallel_inputs, error>;
+  } make = {};
+
+  // Consumer side of one channel, used by stats::make
+  struct reader final {
+    parallel_decoder &decoder;
+
+    auto next(auto &&callback) -> bool { return decoder.next(callback); }
+  };
+
+  [[nodiscard]] auto readers() noexcept -> pair<reader>
+  {
+    return {.A = {.decoder = decoders_.A}, .B = {.decoder = decoders_.B}};
+  }
+
+private:
+  parallel_inputs(pair<mapped_file> f, pair<parallel_decoder> d) noexcept
+      : files_(std::move(f)), decoders_(std::move(d))
+  {
+  }
+
+  pair<mapped_file> files_; // NOTE: decoders_ point to the mapped data
+  pair<parallel_decoder> decoders_;
+};
+
+#endif // LIB_PARALLEL_INPUTS
@@ -0,0 +1,323 @@
+#include "parse_batch.hpp"
+#include "link_layer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <netinet/in.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define PCAP_PARSER_X86 1
+#endif
+
+namespace {
+
+// NOTE: same layout as assumed in packet::parse, except link layer header which is selected by link_t
+constexpr std::uint32_t ethernet_header_length = 14;
+constexpr std::uint32_t minimum_ip_header_length = 20;
+constexpr std::uint32_t maximum_ip_header_length = 60;
+constexpr std::uint32_t ip_protocol_offset = 9;
+constexpr std::uint32_t udp_header_length = 8;
+constexpr std::uint32_t minimum_payload_length = udp_header_length + 4;
+constexpr std::uint32_t metamako_trailer_length = 20;
+constexpr std::uint32_t metamako_seconds_offset = 8;
+constexpr std::uint32_t metamako_nanoseconds_offset = 12;
+constexpr std::uint32_t minimum_frame_length
+    = ethernet_header_length + minimum_ip_header_length + minimum_payload_length + metamako_trailer_length;
+constexpr std::uint32_t ethertype_ip = 0x0800;
+constexpr std::uint32_t protocol_udp = 17;
+
+// Header fields of a group of frames, one lane per frame, loaded with scalar code
+constexpr std::size_t lanes = 8;
+struct fields final {
+  alignas(32) std::uint32_t size[lanes];
+  alignas(32) std::uint32_t ethertype[lanes];
+  alignas(32) std::uint32_t protocol[lanes];
+  alignas(32) std::uint32_t ip_header_len[lanes];
+  alignas(32) std::uint32_t payload_len[lanes];
+  alignas(32) std::uint32_t error[lanes];
+};
+
+auto load_u16(unsigned char const *src) noexcept -> std::uint32_t
+{
+  std::uint16_t ret = 0;
+  std::memcpy(&ret, src, sizeof(ret));
+  return ::ntohs(ret);
+}
+
+auto load_u32(unsigned char const *src) noexcept -> std::uint32_t
+{
+  std::uint32_t ret = 0;
+  std::memcpy(&ret, src, sizeof(ret));
+  return ret;
+}
+
+// Link layer header in front of IPv4 header; protocol returns ethertype of the payload, or 0 if the
+// encapsulation of the frame is not what was expected (which will fail validation with not_ipv4)
+template <packet::link_t> struct link_traits;
+
+template <> struct link_traits<packet::link_t::ethernet> final {
+  static constexpr std::uint32_t header_length = ethernet_header_length;
+  static auto protocol(unsigned char const *data) noexcept -> std::uint32_t { return load_u16(data + 12); }
+};
+
+template <> struct link_traits<packet::link_t::vlan> final {
+  static constexpr std::uint32_t header_length = ethernet_header_length + 4;
+  static auto protocol(unsigned char const *data) noexcept -> std::uint32_t
+  {
+    return load_u16(data + 12) == 0x8100 ? load_u16(data + 16) : 0;
+  }
+};
+
+template <> struct link_traits<packet::link_t::qinq> final {
+  static constexpr std::uint32_t header_length = ethernet_header_length + 8;
+  static auto protocol(unsigned char const *data) noexcept -> std::uint32_t
+  {
+    auto const outer = load_u16(data + 12);
+    return (outer == 0x88a8 || outer == 0x9100 || outer == 0x8100) && load_u16(data + 16) == 0x8100
+               ? load_u16(data + 20)
+               : 0;
+  }
+};
+
+template <> struct link_traits<packet::link_t::sll> final {
+  static constexpr std::uint32_t header_length = 16;
+  static auto protocol(unsigned char const *data) noexcept -> std::uint32_t { return load_u16(data + 14); }
+};
+
+template <> struct link_traits<packet::link_t::sll2> final {
+  static constexpr std::uint32_t header_length = 20;
+  static auto protocol(unsigned char const *data) noexcept -> std::uint32_t { return load_u16(data); }
+};
+
+// Lanes past count are filled with zeros, which will fail validation with not_enough_data
+// NOTE: size is adjusted as if the link layer header was Ethernet, so validation does not depend on link layer
+template <packet::link_t Link> void gather(std::span<packet::data_t const> frames, fields &out) noexcept
+{
+  using traits = link_traits<Link>;
+  constexpr std::uint32_t header_length = traits::header_length;
+  std::memset(&out, 0, sizeof(out));
+  for (std::size_t i = 0; i < frames.size(); ++i) {
+    auto const &data = frames[i];
+    if (data.size() < header_length + minimum_frame_length - ethernet_header_length) {
+      continue;
+    }
+    // NOTE: frames larger than 4GiB are not possible in pcap, caplen is 32 bits
+    out.size[i] = static_cast<std::uint32_t>(data.size() - header_length + ethernet_header_length);
+    out.ethertype[i] = traits::protocol(data.data());
+    out.protocol[i] = data[header_length + ip_protocol_offset];
+    auto const ip_header_len = static_cast<std::uint32_t>(data[header_length] & 0x0F) * 4;
+    out.ip_header_len[i] = ip_header_len;
+    // Only read UDP header if it is within the frame, otherwise validation of IP header will fail
+    if (ip_header_len >= minimum_ip_header_length
+        && data.size() >= header_length + ip_header_len + minimum_payload_length + metamako_trailer_length) {
+      out.payload_len[i] = load_u16(data.data() + header_length + ip_header_len + 4);
+    }
+  }
+}
+
+// Reference implementation of validation, the order of checks is the same as in packet::parse
+void validate_scalar(fields &f, std::size_t count) noexcept
+{
+  using enum packet::parse_error;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const ihl = f.ip_header_len[i];
+    auto const size = f.size[i];
+    packet::parse_error e = none;
+    if (size < minimum_frame_length) {
+      e = not_enough_data;
+    } else if (f.ethertype[i] != ethertype_ip) {
+      e = not_ipv4;
+    } else if (f.protocol[i] != protocol_udp) {
+      e = not_udp;
+    } else if (ihl < minimum_ip_header_length || ihl > maximum_ip_header_length
+               || size < ethernet_header_length + ihl + minimum_payload_length + metamako_trailer_length) {
+      e = bad_ip_header;
+    } else if (f.payload_len[i] < minimum_payload_length
+               || size != ethernet_header_length + ihl + f.payload_len[i] + metamako_trailer_length) {
+      e = bad_udp_header;
+    }
+    f.error[i] = static_cast<std::uint32_t>(e);
+  }
+}
+
+#ifdef PCAP_PARSER_X86
+
+// NOTE: all values in fields are much smaller than 2^31, so signed comparisons are fine
+void validate_sse2(fields &f, std::size_t) noexcept
+{
+  auto const set = [](std::uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); };
+  auto const blend = [](__m128i a, __m128i b, __m128i mask) {
+    return _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a));
+  };
+  for (std::size_t i = 0; i < lanes; i += 4) {
+    auto const size = _mm_load_si128(reinterpret_cast<__m128i const *>(f.size + i));
+    auto const ethertype = _mm_load_si128(reinterpret_cast<__m128i const *>(f.ethertype + i));
+    auto const protocol = _mm_load_si128(reinterpret_cast<__m128i const *>(f.protocol + i));
+    auto const ihl = _mm_load_si128(reinterpret_cast<__m128i const *>(f.ip_header_len + i));
+    auto const payload = _mm_load_si128(reinterpret_cast<__m128i const *>(f.payload_len + i));
+    auto const ones = _mm_set1_epi32(-1);
+
+    auto const short_frame = _mm_cmpgt_epi32(set(minimum_frame_length), size);
+    auto const wrong_ethertype = _mm_xor_si128(_mm_cmpeq_epi32(ethertype, set(ethertype_ip)), ones);
+    auto const wrong_protocol = _mm_xor_si128(_mm_cmpeq_epi32(protocol, set(protocol_udp)), ones);
+    auto const bad_ip = _mm_or_si128(
+        _mm_or_si128(_mm_cmpgt_epi32(set(minimum_ip_header_length), ihl),
+                     _mm_cmpgt_epi32(ihl, set(maximum_ip_header_length))),
+        _mm_cmpgt_epi32(
+            _mm_add_epi32(ihl, set(ethernet_header_length + minimum_payload_length + metamako_trailer_length)),
+            size));
+    auto const bad_udp = _mm_or_si128(
+        _mm_cmpgt_epi32(set(minimum_payload_length), payload),
+        _mm_xor_si128(
+            _mm_cmpeq_epi32(size, _mm_add_epi32(_mm_add_epi32(ihl, payload),
+                                                set(ethernet_header_length + metamako_trailer_length))),
+            ones));
+
+    // Apply in reverse order of checks in packet::parse, so the first failed check wins
+    using enum packet::parse_error;
+    auto e = _mm_setzero_si128();
+    e = blend(e, set(static_cast<std::uint32_t>(bad_udp_header)), bad_udp);
+    e = blend(e, set(static_cast<std::uint32_t>(bad_ip_header)), bad_ip);
+    e = blend(e, set(static_cast<std::uint32_t>(not_udp)), wrong_protocol);
+    e = blend(e, set(static_cast<std::uint32_t>(not_ipv4)), wrong_ethertype);
+    e = blend(e, set(static_cast<std::uint32_t>(not_enough_data)), short_frame);
+    _mm_store_si128(reinterpret_cast<__m128i *>(f.error + i), e);
+  }
+}
+
+__attribute__((target("avx2"))) auto set256(std::uint32_t v) noexcept -> __m256i
+{
+  return _mm256_set1_epi32(static_cast<int>(v));
+}
+
+__attribute__((target("avx2"))) void validate_avx2(fields &f, std::size_t) noexcept
+{
+  auto const size = _mm256_load_si256(reinterpret_cast<__m256i const *>(f.size));
+  auto const ethertype = _mm256_load_si256(reinterpret_cast<__m256i const *>(f.ethertype));
+  auto const protocol = _mm256_load_si256(reinterpret_cast<__m256i const *>(f.protocol));
+  auto const ihl = _mm256_load_si256(reinterpret_cast<__m256i const *>(f.ip_header_len));
+  auto const payload = _mm256_load_si256(reinterpret_cast<__m256i const *>(f.payload_len));
+  auto const ones = _mm256_set1_epi32(-1);
+
+  auto const short_frame = _mm256_cmpgt_epi32(set256(minimum_frame_length), size);
+  auto const wrong_ethertype = _mm256_xor_si256(_mm256_cmpeq_epi32(ethertype, set256(ethertype_ip)), ones);
+  auto const wrong_protocol = _mm256_xor_si256(_mm256_cmpeq_epi32(protocol, set256(protocol_udp)), ones);
+  auto const bad_ip = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpgt_epi32(set256(minimum_ip_header_length), ihl),
+                      _mm256_cmpgt_epi32(ihl, set256(maximum_ip_header_length))),
+      _mm256_cmpgt_epi32(
+          _mm256_add_epi32(ihl, set256(ethernet_header_length + minimum_payload_length + metamako_trailer_length)),
+          size));
+  auto const bad_udp = _mm256_or_si256(
+      _mm256_cmpgt_epi32(set256(minimum_payload_length), payload),
+      _mm256_xor_si256(
+          _mm256_cmpeq_epi32(size, _mm256_add_epi32(_mm256_add_epi32(ihl, payload),
+                                                    set256(ethernet_header_length + metamako_trailer_length))),
+          ones));
+
+  // Apply in reverse order of checks in packet::parse, so the first failed check wins
+  using enum packet::parse_error;
+  auto e = _mm256_setzero_si256();
+  e = _mm256_blendv_epi8(e, set256(static_cast<std::uint32_t>(bad_udp_header)), bad_udp);
+  e = _mm256_blendv_epi8(e, set256(static_cast<std::uint32_t>(bad_ip_header)), bad_ip);
+  e = _mm256_blendv_epi8(e, set256(static_cast<std::uint32_t>(not_udp)), wrong_protocol);
+  e = _mm256_blendv_epi8(e, set256(static_cast<std::uint32_t>(not_ipv4)), wrong_ethertype);
+  e = _mm256_blendv_epi8(e, set256(static_cast<std::uint32_t>(not_enough_data)), short_frame);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(f.error), e);
+}
+
+#endif
+
+using validate_t = void (*)(fields &, std::size_t) noexcept;
+
+auto select(packet::simd_level level) noexcept -> validate_t
+{
+  switch (std::min(level, packet::parse_batch_t::supported())) {
+#ifdef PCAP_PARSER_X86
+  case packet::simd_level::avx2:
+    return validate_avx2;
+  case packet::simd_level::sse2:
+    return validate_sse2;
+#endif
+  default:
+    return validate_scalar;
+  }
+}
+
+template <packet::link_t Link>
+void parse_with(std::span<packet::data_t const> frames, packet::batch_properties &out, validate_t validate)
+{
+  constexpr std::uint32_t header_length = link_traits<Link>::header_length;
+  out.timestamps.resize(frames.size());
+  out.sequences.resize(frames.size());
+  out.errors.resize(frames.size());
+
+  fields f;
+  for (std::size_t first = 0; first < frames.size(); first += lanes) {
+    auto const group = frames.subspan(first, std::min(lanes, frames.size() - first));
+    gather<Link>(group, f);
+    validate(f, group.size());
+
+    // Extract packet properties, i.e. sequence and Metamako timestamp
+    for (std::size_t i = 0; i < group.size(); ++i) {
+      auto const e = static_cast<packet::parse_error>(f.error[i]);
+      out.errors[first + i] = e;
+      if (e != packet::parse_error::none) [[unlikely]] {
+        continue;
+      }
+      auto const *ip_payload = group[i].data() + header_length + f.ip_header_len[i];
+      auto const *trailer = ip_payload + f.payload_len[i];
+      auto const seconds = ::ntohl(load_u32(trailer + metamako_seconds_offset));
+      auto const nanoseconds = ::ntohl(load_u32(trailer + metamako_nanoseconds_offset));
+      out.sequences[first + i] = load_u32(ip_payload + udp_header_length);
+      out.timestamps[first + i] = packet::properties::time_point(std::chrono::seconds(seconds)
+                                                                 + std::chrono::nanoseconds(nanoseconds));
+    }
+  }
+}
+
+// Select specialisation for the link layer once per batch, there is no branching on it per packet
+void parse_with(std::span<packet::data_t const> frames, packet::batch_properties &out, packet::link_t link,
+                validate_t validate)
+{
+  switch (link) {
+  case packet::link_t::ethernet:
+    return parse_with<packet::link_t::ethernet>(frames, out, validate);
+  case packet::link_t::vlan:
+    return parse_with<packet::link_t::vlan>(frames, out, validate);
+  case packet::link_t::qinq:
+    return parse_with<packet::link_t::qinq>(frames, out, validate);
+  case packet::link_t::sll:
+    return parse_with<packet::link_t::sll>(frames, out, validate);
+  case packet::link_t::sll2:
+    return parse_with<packet::link_t::sll2>(frames, out, validate);
+  }
+  std::unreachable();
+}
+
+} // namespace
+
+auto packet::parse_batch_t::supported() noexcept -> simd_level
+{
+#ifdef PCAP_PARSER_X86
+  static simd_level const level = __builtin_cpu_supports("avx2") ? simd_level::avx2 : simd_level::sse2;
+  return level;
+#else
+  return simd_level::scalar;
+#endif
+}
+
+void packet::parse_batch_t::operator()(std::span<data_t const> frames, batch_properties &out, link_t link) const
+{
+  static validate_t const validate = select(simd_level::avx2);
+  parse_with(frames, out, link, validate);
+}
+
+void packet::parse_batch_t::operator()(std::span<data_t const> frames, batch_properties &out, link_t link,
+                                       simd_level level) const
+{
+  parse_with(frames, out, link, select(level));
+}
@@ -0,0 +1,51 @@
+#ifndef LIB_PARSE_BATCH
+#define LIB_PARSE_BATCH
+
+#include "link_layer.hpp"
+#include "packet.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <vector>
+
+namespace packet {
+
+// Properties of a batch of frames as a struct of arrays. Values for frames with an error are unspecified.
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct batch_properties final {
+  std::vector<properties::time_point> timestamps = {};
+  std::vector<std::uint32_t> sequences = {};
+  std::vector<parse_error> errors = {};
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t { return errors.size(); }
+
+  // Same as the result of packet::parse for the frame at index i
+  [[nodiscard]] auto at(std::size_t i) const noexcept -> parsed_t
+  {
+    if (errors[i] != parse_error::none) [[unlikely]] {
+      return std::unexpected(errors[i]);
+    }
+    return properties{.timestamp = timestamps[i], .sequence = sequences[i]};
+  }
+};
+
+// Instruction set used by parse_batch, selected at runtime from what the CPU supports
+enum class simd_level { scalar, sse2, avx2 };
+
+// Parse many frames at a time. Loads of header fields are scalar, but validation of the fields
+// is done with vector instructions, several frames at a time. For link_t::ethernet, the result is
+// the same as from packet::parse; other link layers differ only in headers in front of IPv4.
+constexpr inline struct parse_batch_t final {
+  // Use the best instruction set supported by the CPU
+  void operator()(std::span<data_t const> frames, batch_properties &out, link_t link = link_t::ethernet) const;
+  // Use selected instruction set, or the best one supported by the CPU if it is lower; used in tests
+  void operator()(std::span<data_t const> frames, batch_properties &out, link_t link, simd_level level) const;
+
+  [[nodiscard]] static auto supported() noexcept -> simd_level;
+} parse_batch;
+
+} // namespace packet
+
+#endif // LIB_PARSE_BATCH
@@ -0,0 +1,264 @@
+#include "pcap_index.hpp"
+#include "link_layer.hpp"
+#include "mapped_file.hpp"
+#include "parse_batch.hpp"
+#include "savefile.hpp"
+#include "sidecar.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <utility>
+
+namespace {
+constexpr std::array<unsigned char, 7> magic = {'P', 'C', 'A', 'P', 'I', 'D', 'X'};
+constexpr unsigned char version = 2;
+
+void put_varint(std::uint64_t value, std::vector<unsigned char> &out)
+{
+  while (value >= 0x80) {
+    out.push_back(static_cast<unsigned char>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<unsigned char>(value));
+}
+
+// Read a varint and move data past it, or return nullopt if it is truncated or longer than 64 bits
+auto get_varint(pcap_index::data_t &data) -> std::optional<std::uint64_t>
+{
+  std::uint64_t ret = 0;
+  for (unsigned shift = 0; shift < 64 && not data.empty(); shift += 7) {
+    auto const byte = data.front();
+    data = data.subspan(1);
+    ret |= std::uint64_t{byte & 0x7Fu} << shift;
+    if ((byte & 0x80) == 0) {
+      return ret;
+    }
+  }
+  return std::nullopt;
+}
+} // namespace
+
+auto pcap_index::build_t::operator()(data_t file, std::uint32_t interval) const -> std::expected<pcap_index, error>
+{
+  if (interval == 0) {
+    return error::make(error::write_index, "invalid index interval: 0, expected positive number of records");
+  }
+  auto const header = savefile::file_header::make(file);
+  if (not header) {
+    return std::unexpected<error>(header.error());
+  }
+  auto records = savefile::records{.header = *header, .file = file};
+  auto const link = packet::detect_link(header->linktype, records.peek().value_or(savefile::record{}).data);
+
+  pcap_index ret{.interval = interval, .records = 0, .file_size = file.size(), .file_mtime_ns = 0, .entries = {}};
+  std::vector<data_t> frames;
+  frames.reserve(std::min<std::uint32_t>(interval, 1 << 16));
+  packet::batch_properties parsed;
+  std::uint32_t sequence = 0;
+  time_point timestamp = {};
+  // NOTE: smallest of each interval of records, i.e. of records between consecutive entries
+  std::vector<std::pair<std::uint32_t, time_point>> smallest;
+  auto const flush = [&] {
+    packet::parse_batch(frames, parsed, link);
+    auto &[low_sequence, low_timestamp] = smallest.emplace_back(std::numeric_limits<std::uint32_t>::max(),
+                                                                time_point::max());
+    for (std::size_t i = 0; i < parsed.size(); ++i) {
+      if (parsed.errors[i] == packet::parse_error::none) {
+        sequence = std::max(sequence, parsed.sequences[i]);
+        timestamp = std::max(timestamp, parsed.timestamps[i]);
+        low_sequence = std::min(low_sequence, parsed.sequences[i]);
+        low_timestamp = std::min(low_timestamp, parsed.timestamps[i]);
+      }
+    }
+    frames.clear();
+  };
+
+  for (auto offset = records.offset; auto const record = records.next(); offset = records.offset) {
+    if (ret.records > 0 && ret.records % interval == 0) {
+      flush();
+      ret.entries.push_back({.offset = offset, .sequence = sequence, .timestamp = timestamp});
+    }
+    ret.records += 1;
+    // NOTE: same as PcapInputs, incomplete packets are reported as empty, hence cannot be parsed
+    frames.push_back(record->header.caplen == record->header.len ? record->data : data_t{});
+  }
+  flush();
+
+  // Records from each entry on are those of all intervals after it
+  auto rest = smallest.back();
+  for (std::size_t i = ret.entries.size(); i > 0; --i) {
+    rest = {std::min(rest.first, smallest[i].first), std::min(rest.second, smallest[i].second)};
+    ret.entries[i - 1].rest_sequence = rest.first;
+    ret.entries[i - 1].rest_timestamp = rest.second;
+  }
+  return ret;
+}
+
+auto pcap_index::encode() const -> std::vector<unsigned char>
+{
+  std::vector<unsigned char> ret(magic.begin(), magic.end());
+  ret.push_back(version);
+  put_varint(interval, ret);
+  put_varint(records, ret);
+  put_varint(file_size, ret);
+  put_varint(static_cast<std::uint64_t>(file_mtime_ns), ret);
+  put_varint(entries.size(), ret);
+
+  // NOTE: unsigned arithmetic wraps around, so timestamps before the epoch are encoded correctly too
+  entry_t last = {};
+  for (auto const &entry : entries) {
+    put_varint(entry.offset - last.offset, ret);
+    put_varint(entry.sequence - last.sequence, ret);
+    put_varint(static_cast<std::uint64_t>((entry.timestamp - last.timestamp).count()), ret);
+    put_varint(entry.rest_sequence - last.rest_sequence, ret);
+    put_varint(static_cast<std::uint64_t>((entry.rest_timestamp - last.rest_timestamp).count()), ret);
+    last = entry;
+  }
+  return ret;
+}
+
+auto pcap_index::decode_t::operator()(data_t data) const -> std::expected<pcap_index, error>
+{
+  if (data.size() < magic.size() + 1 || not std::ranges::equal(data.first(magic.size()), magic)) {
+    return error::make(error::open_index, "invalid index: unknown file format");
+  }
+  if (data[magic.size()] != version) {
+    return error::make(error::open_index, "invalid index: unsupported version ", int{data[magic.size()]});
+  }
+  data = data.subspan(magic.size() + 1);
+
+  auto const interval = get_varint(data);
+  auto const records = get_varint(data);
+  auto const file_size = get_varint(data);
+  auto const file_mtime_ns = get_varint(data);
+  auto const count = get_varint(data);
+  if (not interval || not records || not file_size || not file_mtime_ns || not count) {
+    return error::make(error::open_index, "invalid index: truncated header");
+  }
+  // NOTE: each entry takes at least 5 bytes, check this before allocating memory for entries
+  if (*interval == 0 || *interval > std::numeric_limits<std::uint32_t>::max() || *count > data.size() / 5
+      || *count != (*records == 0 ? 0 : (*records - 1) / *interval)) {
+    return error::make(error::open_index, "invalid index: inconsistent header");
+  }
+
+  pcap_index ret{.interval = static_cast<std::uint32_t>(*interval),
+                 .records = *records,
+                 .file_size = *file_size,
+                 .file_mtime_ns = static_cast<std::int64_t>(*file_mtime_ns),
+                 .entries = {}};
+  ret.entries.reserve(*count);
+  std::uint64_t offset = 0;
+  std::uint64_t sequence = 0;
+  std::uint64_t timestamp = 0;
+  std::uint64_t rest_sequence = 0;
+  std::uint64_t rest_timestamp = 0;
+  auto const at = [](std::uint64_t ns) { return time_point(std::chrono::nanoseconds(static_cast<std::int64_t>(ns))); };
+  for (std::uint64_t i = 0; i < *count; ++i) {
+    auto const offset_delta = get_varint(data);
+    auto const sequence_delta = get_varint(data);
+    auto const timestamp_delta = get_varint(data);
+    auto const rest_sequence_delta = get_varint(data);
+    auto const rest_timestamp_delta = get_varint(data);
+    if (not offset_delta || not sequence_delta || not timestamp_delta || not rest_sequence_delta
+        || not rest_timestamp_delta) {
+      return error::make(error::open_index, "invalid index: truncated entries");
+    }
+    // NOTE: offsets of records only grow, and all records are after the file header
+    offset += *offset_delta;
+    sequence += *sequence_delta;
+    timestamp += *timestamp_delta;
+    rest_sequence += *rest_sequence_delta;
+    rest_timestamp += *rest_timestamp_delta;
+    if (*offset_delta == 0 || offset < savefile::file_header_length || offset >= ret.file_size
+        || sequence > std::numeric_limits<std::uint32_t>::max()
+        || rest_sequence > std::numeric_limits<std::uint32_t>::max()) {
+      return error::make(error::open_index, "invalid index: inconsistent entries");
+    }
+    ret.entries.push_back({.offset = offset,
+                           .sequence = static_cast<std::uint32_t>(sequence),
+                           .timestamp = at(timestamp),
+                           .rest_sequence = static_cast<std::uint32_t>(rest_sequence),
+                           .rest_timestamp = at(rest_timestamp)});
+  }
+  if (not data.empty()) {
+    return error::make(error::open_index, "invalid index: unexpected data after entries");
+  }
+  return ret;
+}
+
+auto pcap_index::seek(std::uint32_t sequence) const noexcept -> std::uint64_t
+{
+  auto const found = std::ranges::partition_point(entries, [sequence](entry_t const &e) { return e.sequence < sequence; });
+  return found == entries.begin() ? savefile::file_header_length : std::prev(found)->offset;
+}
+
+auto pcap_index::seek(time_point timestamp) const noexcept -> std::uint64_t
+{
+  auto const found
+      = std::ranges::partition_point(entries, [timestamp](entry_t const &e) { return e.timestamp < timestamp; });
+  return found == entries.begin() ? savefile::file_header_length : std::prev(found)->offset;
+}
+
+auto pcap_index::end(std::uint32_t sequence) const noexcept -> std::uint64_t
+{
+  auto const found
+      = std::ranges::partition_point(entries, [sequence](entry_t const &e) { return e.rest_sequence <= sequence; });
+  return found == entries.end() ? file_size : found->offset;
+}
+
+auto pcap_index::end(time_point timestamp) const noexcept -> std::uint64_t
+{
+  auto const found = std::ranges::partition_point(entries, [timestamp](entry_t const &e) { //
+    return e.rest_timestamp <= timestamp;
+  });
+  return found == entries.end() ? file_size : found->offset;
+}
+
+auto pcap_index::load_t::operator()(std::string const &filename) const -> std::expected<pcap_index, error>
+{
+  auto const name = filename + std::string(sidecar_suffix);
+  std::ifstream input(name, std::ios::binary);
+  if (not input) {
+    return error::make(error::open_index, "failed to open index: ", name);
+  }
+  std::vector<unsigned char> const data{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+  auto ret = decode(data);
+  if (not ret) {
+    return ret;
+  }
+
+  if (sidecar::stamp(filename) != sidecar::file_stamp{.size = ret->file_size, .mtime_ns = ret->file_mtime_ns}) {
+    return error::make(error::open_index, "stale index: ", name);
+  }
+  return ret;
+}
+
+auto pcap_index::save_t::operator()(std::string const &filename, std::uint32_t interval) const
+    -> std::expected<pcap_index, error>
+{
+  // NOTE: take modification time before reading the file, so that the index is stale if it changes meanwhile
+  auto const stamp = sidecar::stamp(filename);
+  if (not stamp) {
+    return error::make(error::write_index, "failed to index file: ", filename);
+  }
+  auto const file = mapped_file::make(filename);
+  if (not file) {
+    return std::unexpected<error>(file.error());
+  }
+  auto ret = build(file->data(), interval);
+  if (not ret) {
+    return error::make(error::write_index, "failed to index file: ", filename, ", error: ", ret.error());
+  }
+  ret->file_mtime_ns = stamp->mtime_ns;
+
+  auto const name = filename + std::string(sidecar_suffix);
+  if (not sidecar::write(name, ret->encode())) {
+    return error::make(error::write_index, "failed to write index: ", name);
+  }
+  return ret;
+}
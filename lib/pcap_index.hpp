@@ -0,0 +1,86 @@
+#ifndef LIB_PCAP_INDEX
+#define LIB_PCAP_INDEX
+
+#include "error.hpp"
+#include "packet.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Sidecar files are named after the indexed file, with this appended, e.g. some_14310-0.pcap.idx
+inline constexpr std::string_view sidecar_suffix = ".idx";
+
+// Sparse index of a classic pcap file, which maps sequence numbers and Metamako timestamps to offsets of records,
+// so that reading can start close to a given sequence number or time rather than at the start of the file.
+//
+// Every interval records, the index stores the offset of the record together with the largest sequence number
+// and timestamp of all records before it, and the smallest of all records from it on. These only grow, so a
+// binary search finds the last offset before which all records are lower than a given value, and the first offset
+// from which all records are higher, even if packets were captured out of order. Records which cannot be parsed
+// do not contribute to either.
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct pcap_index final {
+  using data_t = std::span<unsigned char const>;
+  using time_point = packet::properties::time_point;
+
+  static constexpr std::uint32_t default_interval = 4096;
+
+  struct entry_t final {
+    std::uint64_t offset = 0;        // of a record in the file
+    std::uint32_t sequence = 0;      // largest sequence number of all records before offset
+    time_point timestamp = {};       // largest timestamp of all records before offset
+    std::uint32_t rest_sequence = 0; // smallest sequence number of all records from offset on, or max if none
+    time_point rest_timestamp = {};  // smallest timestamp of all records from offset on, or max if none
+
+    [[nodiscard]] constexpr auto operator==(entry_t const &) const noexcept -> bool = default;
+  };
+
+  std::uint32_t interval = default_interval;
+  std::uint64_t records = 0;      // in the indexed file
+  std::uint64_t file_size = 0;    // of the indexed file, to detect a stale index
+  std::int64_t file_mtime_ns = 0; // of the indexed file, to detect a stale index
+  std::vector<entry_t> entries = {};
+
+  // Index a whole pcap file held in memory. File size is set from data, modification time is left as 0
+  static constexpr struct build_t final {
+    [[nodiscard]] auto operator()(data_t file, std::uint32_t interval = default_interval) const
+        -> std::expected<pcap_index, error>;
+  } build = {};
+
+  // Sidecar file format: magic and version, then fields above and entries as LEB128 varints. Entries are
+  // delta-encoded, which is lossless because all their fields only grow, so a typical entry takes 10-14 bytes.
+  [[nodiscard]] auto encode() const -> std::vector<unsigned char>;
+  static constexpr struct decode_t final {
+    [[nodiscard]] auto operator()(data_t data) const -> std::expected<pcap_index, error>;
+  } decode = {};
+
+  // Offset of the record to start reading from, so that all records skipped have lower sequence number or
+  // timestamp than given. This is the start of the first record if there is no such entry.
+  [[nodiscard]] auto seek(std::uint32_t sequence) const noexcept -> std::uint64_t;
+  [[nodiscard]] auto seek(time_point timestamp) const noexcept -> std::uint64_t;
+
+  // Offset of the record to stop reading at, so that all records from it on have higher sequence number or later
+  // timestamp than given. This is the size of the file if there is no such entry.
+  [[nodiscard]] auto end(std::uint32_t sequence) const noexcept -> std::uint64_t;
+  [[nodiscard]] auto end(time_point timestamp) const noexcept -> std::uint64_t;
+
+  // Read the sidecar of a file, and check that it is up to date with the file
+  static constexpr struct load_t final {
+    [[nodiscard]] auto operator()(std::string const &filename) const -> std::expected<pcap_index, error>;
+  } load = {};
+
+  // Index a file and write its sidecar, replacing any existing one
+  static constexpr struct save_t final {
+    [[nodiscard]] auto operator()(std::string const &filename, std::uint32_t interval = default_interval) const
+        -> std::expected<pcap_index, error>;
+  } save = {};
+
+  [[nodiscard]] auto operator==(pcap_index const &other) const noexcept -> bool = default;
+};
+
+#endif // LIB_PCAP_INDEX
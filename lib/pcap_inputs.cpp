@@ -1,4 +1,13 @@
 #include "pcap_inputs.hpp"
+#include "mapped_file.hpp"
+#include "parse_batch.hpp"
+#include "savefile.hpp"
+
+#include <cstdio>
+#include <optional>
+#include <span>
+#include <utility>
+#include <variant>
 
 namespace {
 
@@ -41,5 +50,131 @@ using file_handle = std::unique_ptr<FILE, file_closer>;
   }
   _ = files.B.release(); // now owned by ret.B
 
-  return PcapInputs(std::move(ret));
+  auto const links = pair<packet::link_t>{.A = detect_link_(filenames.A, ret.A.get()),
+                                          .B = detect_link_(filenames.B, ret.B.get())};
+  // NOTE: a missing or stale index is not an error, seek falls back to reading all records
+  auto const index = [](std::string const &filename) -> std::optional<pcap_index> {
+    auto ret = pcap_index::load(filename);
+    return ret ? std::optional(std::move(*ret)) : std::nullopt;
+  };
+  return PcapInputs(std::move(ret), links, filenames, {.A = index(filenames.A), .B = index(filenames.B)});
+}
+
+void PcapInputs::seek_(pair_select which, std::uint64_t offset, auto &&skip)
+{
+  // NOTE: libpcap reads records from FILE* with fread, without buffering of its own, so it is safe to move it
+  // to the start of any record
+  auto *const input = which == pair_select::A ? A_.get() : B_.get();
+  auto *const file = ::pcap_file(input);
+  if (std::cmp_greater(offset, ::ftello(file))) {
+    ::fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+  }
+
+  packet::batch_properties parsed;
+  while (true) {
+    auto const position = ::ftello(file);
+    pcap_pkthdr *pkt_header = nullptr;
+    unsigned char const *data = nullptr;
+    if (::pcap_next_ex(input, &pkt_header, &data) != 1) {
+      // NOTE: move back, so that the next read reports end of file or error
+      ::fseeko(file, position, SEEK_SET);
+      return;
+    }
+    if (pkt_header->caplen == pkt_header->len) {
+      auto const frame = data_t(data, pkt_header->caplen);
+      packet::parse_batch(std::span(&frame, 1), parsed, link(which));
+      if (parsed.errors.front() == packet::parse_error::none
+          && not skip(packet::properties{.timestamp = parsed.timestamps.front(), .sequence = parsed.sequences.front()})) {
+        ::fseeko(file, position, SEEK_SET);
+        return;
+      }
+    }
+  }
+}
+
+auto PcapInputs::bisect_(pair_select which, auto &&skip) const -> std::uint64_t
+{
+  // NOTE: libpcap also reads pcapng files, which have no fixed record headers to resync on; read these through
+  auto const file = mapped_file::make(which == pair_select::A ? filenames_.A : filenames_.B);
+  if (!file) {
+    return 0;
+  }
+  auto const header = savefile::file_header::make(file->data());
+  if (!header) {
+    return 0;
+  }
+
+  packet::batch_properties parsed;
+  return savefile::bisect(*header, file->data(), [&](savefile::record const &record) -> std::optional<bool> {
+    if (record.header.caplen != record.header.len) {
+      return std::nullopt;
+    }
+    packet::parse_batch(std::span(&record.data, 1), parsed, link(which));
+    auto const properties = parsed.at(0);
+    return properties.has_value() ? std::optional(skip(*properties)) : std::nullopt;
+  });
+}
+
+void PcapInputs::seek(pair_select which, std::uint32_t sequence)
+{
+  auto const &index = which == pair_select::A ? indexes_.A : indexes_.B;
+  auto const skip = [sequence](packet::properties const &p) { return p.sequence < sequence; };
+  seek_(which, index ? index->seek(sequence) : bisect_(which, skip), skip);
+}
+
+void PcapInputs::seek(pair_select which, time_point timestamp)
+{
+  auto const &index = which == pair_select::A ? indexes_.A : indexes_.B;
+  auto const skip = [timestamp](packet::properties const &p) { return p.timestamp < timestamp; };
+  seek_(which, index ? index->seek(timestamp) : bisect_(which, skip), skip);
+}
+
+void PcapInputs::seek(packet_range const &range)
+{
+  for (auto const which : {pair_select::A, pair_select::B}) {
+    auto const &index = which == pair_select::A ? indexes_.A : indexes_.B;
+    if (auto const *sequence = std::get_if<std::uint32_t>(&range.from)) {
+      seek(which, *sequence);
+    } else if (auto const *timestamp = std::get_if<time_point>(&range.from)) {
+      seek(which, *timestamp);
+    }
+
+    auto &end = which == pair_select::A ? ends_.A : ends_.B;
+    if (auto const *sequence = std::get_if<std::uint32_t>(&range.to); sequence && index) {
+      end = index->end(*sequence);
+    } else if (auto const *timestamp = std::get_if<time_point>(&range.to); timestamp && index) {
+      end = index->end(*timestamp);
+    }
+  }
+
+  auto const a = peek(pair_select::A);
+  auto const b = peek(pair_select::B);
+  if (a && b && a->sequence < b->sequence) {
+    seek(pair_select::A, b->sequence);
+  } else if (a && b && b->sequence < a->sequence) {
+    seek(pair_select::B, a->sequence);
+  }
+}
+
+auto PcapInputs::peek(pair_select which) -> std::optional<packet::properties>
+{
+  std::optional<packet::properties> ret = std::nullopt;
+  seek_(which, 0, [&ret](packet::properties const &p) {
+    ret = p;
+    return false;
+  });
+  return ret;
+}
+
+auto PcapInputs::detect_link_(std::string const &filename, pcap_t *input) -> packet::link_t
+{
+  // NOTE: DLT_ values used by libpcap are the same as LINKTYPE_ values in the file, for link types we support
+  auto const linktype = static_cast<std::uint32_t>(::pcap_datalink(input));
+  char buffer[PCAP_ERRBUF_SIZE + 1] = {};
+  auto const peek = pcap_handle(::pcap_open_offline(filename.c_str(), buffer));
+  packet::data_t first = {};
+  if (peek != nullptr) {
+    next_(peek.get(), [&first](data_t data) { first = data; });
+  }
+  return packet::detect_link(linktype, first);
 }
@@ -3,9 +3,19 @@
 
 #include "error.hpp"
 #include "inputs.hpp"
+#include "link_layer.hpp"
 #include "packet.hpp"
+#include "packet_range.hpp"
+#include "pcap_index.hpp"
 
+#include <cstdint>
+#include <cstdio>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <pcap.h>
 #include <pcap/pcap.h>
@@ -15,14 +25,42 @@ struct PcapInputs final : Inputs {
   using data_t = Inputs::data_t;
   static_assert(std::is_same_v<packet::data_t, data_t>);
 
-  // Create PcapInputs from a pair of pcap files.
+  using time_point = packet::properties::time_point;
+
+  // Create PcapInputs from a pair of pcap files. Sidecar pcap_index of each file is used by seek, if up to date.
   static constexpr struct make_t final {
     [[nodiscard]] auto operator()(pair<std::string> filenames) const -> std::expected<PcapInputs, error>;
   } make = {};
 
+  // Hides Inputs::next_batch, to enable static dispatch in stats::make
+  auto next_batch(pair_select which) -> batch_t
+  {
+    return which == pair_select::A ? batch_(A_.get(), buffers_.A, ends_.A) : batch_(B_.get(), buffers_.B, ends_.B);
+  }
+
+  // Skip records of a channel before the first one with sequence number not lower than given, or with timestamp
+  // not earlier than given, so that it is read next; records which cannot be parsed are skipped as well. With an
+  // up to date index of the file this jumps over most records in O(log n), otherwise with a binary search over
+  // records of the file, see savefile::bisect, which assumes that records are roughly in order.
+  // NOTE: reading only moves forward, this does nothing if the channel is already past that record
+  void seek(pair_select which, std::uint32_t sequence);
+  void seek(pair_select which, time_point timestamp);
+
+  // Seek both channels to the start of range, then skip records of the channel which starts with a lower
+  // sequence number up to the first sequence number of the other, so that packets captured on one line only
+  // are not counted as dropped by the other. Each channel also ends where its index shows that all records
+  // left are after the range, see pcap_index::end; packets between are still read, and must be filtered by
+  // the caller, e.g. stats::make with merge_extras.
+  // NOTE: a missing or stale index is not written, this only reads files; without one each channel is read to
+  // its end, and packets reordered to before the record found by the binary search are missed
+  void seek(packet_range const &range);
+
+  // Parsed properties of the next record of a channel which can be parsed, without consuming it
+  [[nodiscard]] auto peek(pair_select which) -> std::optional<packet::properties>;
+
   // noncopyable, but moveable
   PcapInputs(PcapInputs const &) = delete;
-  PcapInputs(PcapInputs &&other) : A_(std::move(other.A_)), B_(std::move(other.B_)) {}
+  PcapInputs(PcapInputs &&other) = default;
 
 private:
   struct pcap_closer final {
@@ -30,7 +68,26 @@ private:
   };
   using pcap_handle = std::unique_ptr<pcap_t, pcap_closer>;
 
-  explicit PcapInputs(pair<pcap_handle> src) noexcept : A_(std::move(src.A)), B_(std::move(src.B)) {}
+  PcapInputs(pair<pcap_handle> src, pair<packet::link_t> links, pair<std::string> filenames,
+             pair<std::optional<pcap_index>> indexes) noexcept
+      : A_(std::move(src.A)), B_(std::move(src.B)), links_(links), filenames_(std::move(filenames)),
+        indexes_(std::move(indexes))
+  {
+  }
+
+  // Offset of a record before the first one for which skip returns false, found without an index
+  auto bisect_(pair_select which, auto &&skip) const -> std::uint64_t;
+
+  // Move to offset, if it is ahead of the channel, then skip records for which skip returns true
+  void seek_(pair_select which, std::uint64_t offset, auto &&skip);
+
+  // Inspect link type and the first frame of a file, which is opened again so that no packets are consumed
+  static auto detect_link_(std::string const &filename, pcap_t *input) -> packet::link_t;
+
+  static constexpr std::uint64_t no_end_ = std::numeric_limits<std::uint64_t>::max();
+
+  // Dummy needed because std::span does not like nullptr even when size is 0 (this should be fixed in C++26)
+  static constexpr unsigned char dummy_[4] = {};
 
   static auto next_(pcap_t *input, auto &&callback) -> bool
   {
@@ -43,20 +100,58 @@ private:
       } else {
         // NOTE: Incomplete packet is unlikely to have Metamako trailer with timestamp
         // hence it is not useful for our purposes. Just report that we had "something" here and move on.
-        // Dummy needed because std::span does not like nullptr even when size is 0 (this should be fixed in C++26)
-        static unsigned char const dummy[4] = {};
-        callback(data_t(dummy, 0));
+        callback(data_t(dummy_, 0));
       }
       return true;
     }
     return false;
   }
 
+  // NOTE: libpcap reuses its buffer on every call to pcap_next_ex, hence data in a batch must be copied
+  struct batch_buffer final {
+    std::vector<unsigned char> bytes;
+    std::vector<std::size_t> sizes;
+    std::vector<data_t> views;
+  };
+
+  static auto batch_(pcap_t *input, batch_buffer &buffer, std::uint64_t end) -> batch_t
+  {
+    buffer.bytes.clear();
+    buffer.sizes.clear();
+    buffer.views.clear();
+    // NOTE: checked once per batch, records read past end are after the range, see seek
+    if (end != no_end_ && std::cmp_greater_equal(::ftello(::pcap_file(input)), end)) {
+      return buffer.views;
+    }
+    while (buffer.sizes.size() < batch_size && next_(input, [&buffer](data_t data) {
+             buffer.bytes.insert(buffer.bytes.end(), data.begin(), data.end());
+             buffer.sizes.push_back(data.size());
+           })) {
+    }
+
+    // Only take pointers to bytes after we are done appending to it
+    unsigned char const *data = buffer.bytes.data();
+    for (auto const size : buffer.sizes) {
+      buffer.views.emplace_back(size == 0 ? dummy_ : data, size);
+      data += size;
+    }
+    return buffer.views;
+  }
+
   auto next_a(data_callback_t callback) -> bool override { return next_(A_.get(), std::move(callback)); }
   auto next_b(data_callback_t callback) -> bool override { return next_(B_.get(), std::move(callback)); }
+  auto batch_a() -> batch_t override { return next_batch(pair_select::A); }
+  auto batch_b() -> batch_t override { return next_batch(pair_select::B); }
+  auto link_a() const -> packet::link_t override { return links_.A; }
+  auto link_b() const -> packet::link_t override { return links_.B; }
 
   pcap_handle A_;
   pcap_handle B_;
+  pair<packet::link_t> links_;
+  pair<std::string> filenames_;
+  pair<std::optional<pcap_index>> indexes_;
+  pair<std::uint64_t> ends_ = {.A = no_end_, .B = no_end_}; // offsets to stop reading at, see seek
+  pair<batch_buffer> buffers_ = {};
 };
 
 #endif // LIB_PCAP_INPUTS
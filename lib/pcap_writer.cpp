@@ -0,0 +1,81 @@
+#include "pcap_writer.hpp"
+#include "functional.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstring>
+
+namespace {
+constexpr std::uint32_t nanosecond_magic = 0xa1b23c4d;
+constexpr std::uint32_t ethernet_link = 1;
+constexpr std::uint32_t snapshot_length = 262144;
+constexpr std::size_t buffer_size = 1 << 20;
+
+// NOTE: pcap headers are written in host byte order, readers detect it by the magic number
+template <typename... T> auto put(std::FILE *file, T... values) -> bool
+{
+  std::array<unsigned char, (sizeof(T) + ...)> bytes = {};
+  std::size_t offset = 0;
+  ((std::memcpy(bytes.data() + offset, &values, sizeof(T)), offset += sizeof(T)), ...);
+  return std::fwrite(bytes.data(), bytes.size(), 1, file) == 1;
+}
+} // namespace
+
+auto pcap_writer::make_t::operator()(std::string const &directory, std::string const &prefix,
+                                     std::string const &channel, std::uint64_t segment_packets) const
+    -> std::expected<pcap_writer, error>
+{
+  pcap_writer ret(directory + '/' + prefix + '_' + channel + '-', segment_packets);
+  return ret.open_() | transform([&ret]() { return std::move(ret); });
+}
+
+auto pcap_writer::open_() -> std::expected<void, error>
+{
+  filename_ = base_ + std::to_string(segment_) + ".pcap";
+  file_.reset(std::fopen(filename_.c_str(), "wb"));
+  if (not file_) {
+    return error::make(error::write_pcap, "failed to create file: ", filename_);
+  }
+  std::setvbuf(file_.get(), nullptr, _IOFBF, buffer_size);
+  if (not put(file_.get(), nanosecond_magic, std::uint16_t{2}, std::uint16_t{4}, std::int32_t{0}, std::uint32_t{0},
+              snapshot_length, ethernet_link)) {
+    return error::make(error::write_pcap, "failed to write to file: ", filename_);
+  }
+  bytes_ += 24;
+  packets_ = 0;
+  return {};
+}
+
+auto pcap_writer::write(time_point timestamp, packet::data_t data) -> std::expected<void, error>
+{
+  if (segment_packets_ > 0 && packets_ == segment_packets_) {
+    auto const closed = close();
+    if (not closed) {
+      return closed;
+    }
+    segment_ += 1;
+    auto const opened = open_();
+    if (not opened) {
+      return opened;
+    }
+  }
+
+  auto const exact = std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+  auto const length = static_cast<std::uint32_t>(data.size());
+  if (not put(file_.get(), static_cast<std::uint32_t>(exact / 1'000'000'000),
+              static_cast<std::uint32_t>(exact % 1'000'000'000), length, length)
+      || std::fwrite(data.data(), 1, data.size(), file_.get()) != data.size()) {
+    return error::make(error::write_pcap, "failed to write to file: ", filename_);
+  }
+  packets_ += 1;
+  bytes_ += 16 + data.size();
+  return {};
+}
+
+auto pcap_writer::close() -> std::expected<void, error>
+{
+  if (file_ && std::fclose(file_.release()) != 0) {
+    return error::make(error::write_pcap, "failed to write to file: ", filename_);
+  }
+  return {};
+}
@@ -0,0 +1,52 @@
+#ifndef LIB_PCAP_WRITER
+#define LIB_PCAP_WRITER
+
+#include "error.hpp"
+#include "packet.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <expected>
+#include <memory>
+#include <string>
+#include <utility>
+
+// Writing of one channel of a capture as pcap files with nanosecond timestamps and Ethernet link type, rotated
+// after a number of packets, e.g. directory/prefix_14310-0.pcap, directory/prefix_14310-1.pcap etc.
+struct pcap_writer final {
+  using time_point = packet::properties::time_point;
+
+  static constexpr struct make_t final {
+    // Rotate after segment_packets, or never if 0
+    [[nodiscard]] auto operator()(std::string const &directory, std::string const &prefix, std::string const &channel,
+                                  std::uint64_t segment_packets) const -> std::expected<pcap_writer, error>;
+  } make = {};
+
+  auto write(time_point timestamp, packet::data_t data) -> std::expected<void, error>;
+
+  // Flush and close the current file
+  auto close() -> std::expected<void, error>;
+
+  [[nodiscard]] auto bytes() const noexcept -> std::uint64_t { return bytes_; }
+
+private:
+  struct closer final {
+    void operator()(std::FILE *file) const noexcept { std::fclose(file); }
+  };
+
+  pcap_writer(std::string base, std::uint64_t segment_packets) noexcept
+      : base_(std::move(base)), segment_packets_(segment_packets)
+  {
+  }
+  auto open_() -> std::expected<void, error>;
+
+  std::string base_; // file name without segment number and extension
+  std::uint64_t segment_packets_;
+  std::unique_ptr<std::FILE, closer> file_ = {};
+  std::string filename_ = {};
+  std::uint64_t segment_ = 0;
+  std::uint64_t packets_ = 0; // in the current segment
+  std::uint64_t bytes_ = 0;   // in all segments
+};
+
+#endif // LIB_PCAP_WRITER
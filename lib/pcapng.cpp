@@ -0,0 +1,161 @@
+#include "pcapng.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+namespace {
+auto load_u16(unsigned char const *src, bool swapped) noexcept -> std::uint16_t
+{
+  std::uint16_t ret = 0;
+  std::memcpy(&ret, src, sizeof(ret));
+  return swapped ? std::byteswap(ret) : ret;
+}
+
+// Parse options of Interface Description Block, we only need if_tsresol
+auto ticks_per_second(pcapng::data_t options, bool swapped) noexcept -> std::uint64_t
+{
+  constexpr std::uint16_t opt_endofopt = 0;
+  constexpr std::uint16_t if_tsresol = 9;
+  std::size_t offset = 0;
+  while (options.size() - offset >= 4) {
+    auto const code = load_u16(options.data() + offset, swapped);
+    auto const length = load_u16(options.data() + offset + 2, swapped);
+    offset += 4;
+    if (code == opt_endofopt || options.size() - offset < length) {
+      break;
+    }
+    if (code == if_tsresol && length == 1) {
+      // Most significant bit selects power of 2, otherwise power of 10
+      auto const resolution = options[offset];
+      auto const exponent = resolution & 0x7F;
+      if ((resolution & 0x80) != 0) {
+        return exponent < 64 ? std::uint64_t{1} << exponent : 0;
+      }
+      std::uint64_t ret = 1;
+      for (int i = 0; i < exponent && i < 19; ++i) {
+        ret *= 10;
+      }
+      return ret;
+    }
+    offset += (length + 3) & ~std::size_t{3}; // options are padded to 32 bits
+  }
+  return 1'000'000;
+}
+} // namespace
+
+auto pcapng::to_nanoseconds(std::uint64_t ticks, std::uint64_t ticks_per_second) noexcept -> std::uint64_t
+{
+  constexpr std::uint64_t nanoseconds_per_second = 1'000'000'000;
+  if (ticks_per_second == 0) {
+    return 0; // resolution not representable, see ticks_per_second above
+  }
+  auto const seconds = ticks / ticks_per_second;
+  auto const rest = ticks % ticks_per_second;
+  // NOTE: rest * nanoseconds_per_second only overflows for resolutions finer than about 1/2^34 s
+  auto const fraction = rest <= std::numeric_limits<std::uint64_t>::max() / nanoseconds_per_second
+                            ? rest * nanoseconds_per_second / ticks_per_second
+                            : static_cast<std::uint64_t>(static_cast<long double>(rest) * nanoseconds_per_second
+                                                         / static_cast<long double>(ticks_per_second));
+  return seconds * nanoseconds_per_second + fraction;
+}
+
+auto pcapng::is_pcapng(data_t file) noexcept -> bool
+{
+  // NOTE: block type of Section Header Block is a palindrome, does not depend on byte order
+  return file.size() >= 4 && savefile::load_u32(file.data(), false) == section_header_block;
+}
+
+auto pcapng::blocks::make_t::operator()(data_t file) const -> std::expected<blocks, error>
+{
+  if (file.size() >= sizeof(std::uint32_t) && not is_pcapng(file)) {
+    return error::make(error::open_pcap, "unknown file format");
+  }
+  if (file.size() < section_header_length) {
+    return error::make(error::open_pcap, "truncated section header block");
+  }
+  auto const magic = savefile::load_u32(file.data() + block_header_length, false);
+  if (magic != byte_order_magic && std::byteswap(magic) != byte_order_magic) {
+    return error::make(error::open_pcap, "invalid byte order magic");
+  }
+  return blocks{.file = file, .offset = 0, .swapped = magic != byte_order_magic};
+}
+
+auto pcapng::blocks::next() -> std::optional<packet>
+{
+  while (file.size() - offset >= block_header_length + block_trailer_length) {
+    auto const *block = file.data() + offset;
+    auto const type = savefile::load_u32(block, false);
+    if (type == section_header_block) {
+      // Each section can have a different byte order, and has its own interfaces
+      auto const magic = savefile::load_u32(block + block_header_length, false);
+      if (magic != byte_order_magic && std::byteswap(magic) != byte_order_magic) {
+        return std::nullopt;
+      }
+      swapped = magic != byte_order_magic;
+      interfaces.clear();
+    }
+
+    auto const length = savefile::load_u32(block + 4, swapped);
+    if (length < block_header_length + block_trailer_length || length % 4 != 0 || file.size() - offset < length) {
+      return std::nullopt;
+    }
+    auto const body = file.subspan(offset + block_header_length, length - block_header_length - block_trailer_length);
+    auto const end = offset + length; // NOTE: offset is not moved past an invalid block
+
+    switch (savefile::load_u32(block, swapped)) {
+    case section_header_block:
+      offset = end;
+      break;
+    case interface_description_block:
+      if (body.size() < 8) {
+        return std::nullopt;
+      }
+      interfaces.push_back({.linktype = load_u16(body.data(), swapped),
+                            .snaplen = savefile::load_u32(body.data() + 4, swapped),
+                            .ticks_per_second = ticks_per_second(body.subspan(8), swapped)});
+      offset = end;
+      break;
+    case enhanced_packet_block: {
+      if (body.size() < 20) {
+        return std::nullopt;
+      }
+      packet ret{.interface = savefile::load_u32(body.data(), swapped),
+                 .timestamp = (std::uint64_t{savefile::load_u32(body.data() + 4, swapped)} << 32)
+                              | savefile::load_u32(body.data() + 8, swapped),
+                 .caplen = savefile::load_u32(body.data() + 12, swapped),
+                 .len = savefile::load_u32(body.data() + 16, swapped),
+                 .data = {}};
+      if (ret.interface >= interfaces.size() || body.size() - 20 < ret.caplen) {
+        return std::nullopt;
+      }
+      ret.timestamp = to_nanoseconds(ret.timestamp, interfaces[ret.interface].ticks_per_second);
+      ret.data = body.subspan(20, ret.caplen);
+      offset = end;
+      return ret;
+    }
+    case simple_packet_block: {
+      // Captured length is implied by block length, and snaplen of the first interface
+      if (body.size() < 4 || interfaces.empty()) {
+        return std::nullopt;
+      }
+      auto const len = savefile::load_u32(body.data(), swapped);
+      auto caplen = std::min<std::size_t>(len, body.size() - 4);
+      if (interfaces.front().snaplen != 0) {
+        caplen = std::min<std::size_t>(caplen, interfaces.front().snaplen);
+      }
+      offset = end;
+      return packet{.interface = 0,
+                    .timestamp = 0,
+                    .caplen = static_cast<std::uint32_t>(caplen),
+                    .len = len,
+                    .data = body.subspan(4, caplen)};
+    }
+    default:
+      offset = end; // skip other blocks
+      break;
+    }
+  }
+  return std::nullopt;
+}
@@ -0,0 +1,76 @@
+#ifndef LIB_PCAPNG
+#define LIB_PCAPNG
+
+#include "error.hpp"
+#include "savefile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <vector>
+
+// pcapng file format, as described in https://www.ietf.org/archive/id/draft-ietf-opsawg-pcapng-02.html
+// Only blocks needed to read packets are parsed, i.e. Section Header, Interface Description, Enhanced
+// Packet and Simple Packet blocks; all other blocks are skipped.
+namespace pcapng {
+
+using data_t = std::span<unsigned char const>;
+
+constexpr std::uint32_t section_header_block = 0x0A0D0D0A;
+constexpr std::uint32_t interface_description_block = 1;
+constexpr std::uint32_t simple_packet_block = 3;
+constexpr std::uint32_t enhanced_packet_block = 6;
+constexpr std::uint32_t byte_order_magic = 0x1A2B3C4D;
+constexpr std::size_t block_header_length = 8;  // block type, block total length
+constexpr std::size_t block_trailer_length = 4; // block total length, again
+constexpr std::size_t section_header_length = block_header_length + 16 + block_trailer_length;
+
+// Check if the file starts with a Section Header Block
+[[nodiscard]] auto is_pcapng(data_t file) noexcept -> bool;
+
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct interface final {
+  std::uint32_t linktype = 0;
+  std::uint32_t snaplen = 0;
+  std::uint64_t ticks_per_second = 1'000'000; // from if_tsresol option, microseconds if not present
+};
+
+struct packet final {
+  std::uint32_t interface = 0; // index in blocks::interfaces
+  std::uint64_t timestamp = 0; // in ns, converted from ticks of the interface, zero for Simple Packet Block
+  std::uint32_t caplen = 0;
+  std::uint32_t len = 0;
+  data_t data; // captured bytes, i.e. caplen long
+};
+
+// Convert a timestamp in ticks of an interface to nanoseconds, e.g. to be compared with timestamps in pcap files
+[[nodiscard]] auto to_nanoseconds(std::uint64_t ticks, std::uint64_t ticks_per_second) noexcept -> std::uint64_t;
+
+// Walk blocks of a pcapng file held in memory, without copying any packet data. Stops at the end of data,
+// or at the first block which is truncated or invalid (libpcap would report an error)
+struct blocks final {
+  data_t file;
+  std::size_t offset = 0;
+  bool swapped = false;
+  std::vector<interface> interfaces = {}; // in the current section
+
+  // Verify that file starts with a Section Header Block
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(data_t file) const -> std::expected<blocks, error>;
+  } make = {};
+
+  [[nodiscard]] auto next() -> std::optional<packet>;
+
+  // Same as next, but without moving to the following packet
+  [[nodiscard]] auto peek() const -> std::optional<packet>
+  {
+    auto copy = *this;
+    return copy.next();
+  }
+};
+
+} // namespace pcapng
+
+#endif // LIB_PCAPNG
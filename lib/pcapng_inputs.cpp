@@ -0,0 +1,43 @@
+#include "pcapng_inputs.hpp"
+
+namespace {
+auto detect_link(pcapng::blocks blocks) -> packet::link_t
+{
+  auto const first = blocks.next();
+  if (not first.has_value()) {
+    return packet::link_t::ethernet;
+  }
+  return packet::detect_link(blocks.interfaces[first->interface].linktype, first->data);
+}
+} // namespace
+
+[[nodiscard]] auto PcapngInputs::make_t::operator()(pair<std::string> filenames) const
+    -> std::expected<PcapngInputs, error>
+{
+  auto file_a = mapped_file::make(filenames.A);
+  auto file_b = mapped_file::make(filenames.B);
+  if (!file_a && !file_b) {
+    return error::make(error::open_pcap, "failed to open both files: ", filenames.A, ", ", filenames.B);
+  }
+  if (!file_a) {
+    return error::make(error::open_pcap, "failed to open file A: ", filenames.A, ", error: ", file_a.error());
+  }
+  if (!file_b) {
+    return error::make(error::open_pcap, "failed to open file B: ", filenames.B, ", error: ", file_b.error());
+  }
+
+  auto blocks_a = pcapng::blocks::make(file_a->data());
+  if (!blocks_a) {
+    return error::make(error::open_pcap, "invalid file A, error: ", blocks_a.error());
+  }
+  auto blocks_b = pcapng::blocks::make(file_b->data());
+  if (!blocks_b) {
+    return error::make(error::open_pcap, "invalid file B, error: ", blocks_b.error());
+  }
+
+  // NOTE: mapped data does not move with mapped_file, so blocks can be created before the move
+  auto const link_a = detect_link(*blocks_a);
+  auto const link_b = detect_link(*blocks_b);
+  return PcapngInputs({.A = {.file = std::move(*file_a), .blocks = std::move(*blocks_a), .link = link_a},
+                       .B = {.file = std::move(*file_b), .blocks = std::move(*blocks_b), .link = link_b}});
+}
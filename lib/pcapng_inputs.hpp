@@ -0,0 +1,81 @@
+#ifndef LIB_PCAPNG_INPUTS
+#define LIB_PCAPNG_INPUTS
+
+#include "error.hpp"
+#include "inputs.hpp"
+#include "link_layer.hpp"
+#include "mapped_file.hpp"
+#include "packet.hpp"
+#include "pcapng.hpp"
+
+#include <expected>
+#include <string>
+#include <vector>
+
+// Reads pcapng files, mapped in memory, handing out data which points inside the mapping. Same as
+// MmapPcapInputs, but for pcapng blocks rather than pcap records.
+// NOTE: link layer is selected from the interface of the first packet; if a file has interfaces with
+// different link types, packets from the other interfaces are likely to fail parsing
+// TODO: this is untestable, because mapped_file calls the OS directly (but pcapng::blocks is tested)
+struct PcapngInputs final : Inputs {
+  using data_t = Inputs::data_t;
+  static_assert(std::is_same_v<packet::data_t, data_t>);
+
+  // Create PcapngInputs from a pair of pcapng files.
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(pair<std::string> filenames) const -> std::expected<PcapngInputs, error>;
+  } make = {};
+
+  // Hides Inputs::next_batch, to enable static dispatch in stats::make
+  auto next_batch(pair_select which) -> batch_t { return batch_(which == pair_select::A ? A_ : B_); }
+
+  // noncopyable, but moveable
+  PcapngInputs(PcapngInputs const &) = delete;
+  PcapngInputs(PcapngInputs &&other) = default;
+
+private:
+  struct channel final {
+    mapped_file file;
+    pcapng::blocks blocks;
+    packet::link_t link;
+    std::vector<data_t> views = {};
+  };
+
+  explicit PcapngInputs(pair<channel> src) noexcept : A_(std::move(src.A)), B_(std::move(src.B)) {}
+
+  static auto next_(channel &input, auto &&callback) -> bool
+  {
+    if (auto const packet = input.blocks.next(); packet.has_value()) {
+      // NOTE: Same as in PcapInputs, incomplete packet is of no use to us, just report that we had "something"
+      if (packet->caplen == packet->len) {
+        callback(packet->data);
+      } else {
+        callback(packet->data.first(0));
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // Data in the batch points directly to the mapped file, only views need to be stored
+  static auto batch_(channel &input) -> batch_t
+  {
+    input.views.clear();
+    while (input.views.size() < batch_size
+           && next_(input, [&input](data_t data) { input.views.push_back(data); })) {
+    }
+    return input.views;
+  }
+
+  auto next_a(data_callback_t callback) -> bool override { return next_(A_, std::move(callback)); }
+  auto next_b(data_callback_t callback) -> bool override { return next_(B_, std::move(callback)); }
+  auto batch_a() -> batch_t override { return next_batch(pair_select::A); }
+  auto batch_b() -> batch_t override { return next_batch(pair_select::B); }
+  auto link_a() const -> packet::link_t override { return A_.link; }
+  auto link_b() const -> packet::link_t override { return B_.link; }
+
+  channel A_;
+  channel B_;
+};
+
+#endif // LIB_PCAPNG_INPUTS
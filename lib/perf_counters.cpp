@@ -0,0 +1,70 @@
+#include "perf_counters.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+constexpr std::array<std::uint64_t, 4> events = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                 PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+constexpr std::array<char const *, 4> names = {"cycles", "instructions", "cache misses", "branch misses"};
+
+auto open_event(std::uint64_t event, int group) -> int
+{
+  ::perf_event_attr attr = {};
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = event;
+  attr.disabled = group < 0 ? 1 : 0; // the leader enables the whole group at once
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // NOTE: pid 0 and cpu -1 is the calling thread, on any CPU
+  return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC));
+}
+} // namespace
+
+auto perf_counters::make_t::operator()() const -> std::expected<perf_counters, error>
+{
+  auto fds = closed;
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    fds[i] = open_event(events[i], fds[0]);
+    if (fds[i] < 0) {
+      auto const reason = std::strerror(errno);
+      perf_counters const cleanup(fds); // closes the counters opened so far
+      return error::make(error::open_perf, "failed to open counter of ", names[i], ": ", reason);
+    }
+  }
+  ::ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ::ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return perf_counters(fds);
+}
+
+auto perf_counters::read() noexcept -> std::optional<values>
+{
+  // NOTE: with PERF_FORMAT_GROUP, the number of counters, times enabled and running, followed by their values
+  std::uint64_t data[3 + events.size()] = {};
+  if (::read(fds_[0], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[0] != events.size()) {
+    return std::nullopt;
+  }
+  auto const enabled = data[1];
+  auto const running = data[2];
+  multiplexed_ = multiplexed_ || running < enabled;
+  return values{.cycles = scale(data[3], enabled, running),
+                .instructions = scale(data[4], enabled, running),
+                .cache_misses = scale(data[5], enabled, running),
+                .branch_misses = scale(data[6], enabled, running)};
+}
+
+perf_counters::~perf_counters() noexcept
+{
+  for (auto const fd : fds_) {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+}
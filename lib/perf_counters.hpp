@@ -0,0 +1,92 @@
+#ifndef LIB_PERF_COUNTERS
+#define LIB_PERF_COUNTERS
+
+#include "error.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <utility>
+
+// Hardware counters of the calling thread, opened as one group with perf_event_open, so that all of them are
+// read at once with a single system call. Only user space is counted, which is allowed for own threads with
+// the default kernel.perf_event_paranoid = 2; time spent in system calls is not included. If the kernel has to
+// share the hardware with other events, the group is counted only part of the time and counts are scaled up.
+struct perf_counters final {
+  // NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+  struct values final {
+    std::uint64_t cycles = 0;
+    std::uint64_t instructions = 0;
+    std::uint64_t cache_misses = 0; // last level cache
+    std::uint64_t branch_misses = 0;
+
+    constexpr auto operator+=(values const &other) noexcept -> values &
+    {
+      cycles += other.cycles;
+      instructions += other.instructions;
+      cache_misses += other.cache_misses;
+      branch_misses += other.branch_misses;
+      return *this;
+    }
+
+    // NOTE: saturates at zero, because scaled counts are estimates and need not grow between two reads
+    [[nodiscard]] constexpr auto operator-(values const &other) const noexcept -> values
+    {
+      constexpr auto minus = [](std::uint64_t a, std::uint64_t b) { return a > b ? a - b : 0; };
+      return {.cycles = minus(cycles, other.cycles),
+              .instructions = minus(instructions, other.instructions),
+              .cache_misses = minus(cache_misses, other.cache_misses),
+              .branch_misses = minus(branch_misses, other.branch_misses)};
+    }
+
+    [[nodiscard]] constexpr auto operator==(values const &) const noexcept -> bool = default;
+  };
+
+  // Fails with error::open_perf if any of the counters is not available, e.g. in a virtual machine
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()() const -> std::expected<perf_counters, error>;
+  } make = {};
+
+  // Counted since make, or nullopt if the read failed
+  [[nodiscard]] auto read() noexcept -> std::optional<values>;
+
+  // True if any read so far was scaled, i.e. its counts are estimates
+  [[nodiscard]] auto multiplexed() const noexcept -> bool { return multiplexed_; }
+
+  // Count of a counter which was enabled for time_enabled, but counting only for time_running
+  [[nodiscard]] static constexpr auto scale(std::uint64_t count, std::uint64_t time_enabled,
+                                            std::uint64_t time_running) noexcept -> std::uint64_t
+  {
+    if (time_running == 0 || time_running >= time_enabled) {
+      return count;
+    }
+    return static_cast<std::uint64_t>(static_cast<double>(count) * static_cast<double>(time_enabled)
+                                      / static_cast<double>(time_running));
+  }
+
+  // noncopyable, but moveable
+  perf_counters(perf_counters const &) = delete;
+  auto operator=(perf_counters const &) -> perf_counters & = delete;
+  perf_counters(perf_counters &&other) noexcept
+      : fds_(std::exchange(other.fds_, closed)), multiplexed_(other.multiplexed_)
+  {
+  }
+  auto operator=(perf_counters &&other) noexcept -> perf_counters &
+  {
+    std::swap(fds_, other.fds_);
+    std::swap(multiplexed_, other.multiplexed_);
+    return *this;
+  }
+  ~perf_counters() noexcept;
+
+private:
+  static constexpr std::array<int, 4> closed = {-1, -1, -1, -1};
+
+  explicit perf_counters(std::array<int, 4> fds) noexcept : fds_(fds) {}
+
+  std::array<int, 4> fds_; // group leader first, in the order of fields of values
+  bool multiplexed_ = false;
+};
+
+#endif // LIB_PERF_COUNTERS
@@ -0,0 +1,90 @@
+#ifndef LIB_PREFETCH_INPUTS
+#define LIB_PREFETCH_INPUTS
+
+#include "error.hpp"
+#include "inputs.hpp"
+#include "packet.hpp"
+#include "pair.hpp"
+#include "parse_batch.hpp"
+#include "spsc_ring.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Pipelined reading of Inputs, with one background thread per channel. Each thread reads its channel,
+// parses the packets and pushes the results into a ring, from which they are popped by stats::make.
+// This way disk stalls in one channel do not block reading of the other channel, or the merge loop.
+//
+// NOTE: Threads are started by the constructor and call T::next_batch concurrently for both channels.
+// NOTE: Not moveable (threads refer to this object), pass as a temporary to stats::make
+template <some_inputs T>
+  requires(not std::is_abstract_v<T>)
+struct prefetch_inputs final {
+  using parsed_t = packet::parsed_t;
+  static constexpr std::size_t ring_capacity = 8192;
+
+  explicit prefetch_inputs(T &&inputs)
+      : inputs_(std::move(inputs)),
+        rings_{.A = spsc_ring<parsed_t>(ring_capacity), .B = spsc_ring<parsed_t>(ring_capacity)},
+        threads_{.A = std::jthread([this](std::stop_token stop) { read_(stop, pair_select::A); }),
+                 .B = std::jthread([this](std::stop_token stop) { read_(stop, pair_select::B); })}
+  {
+  }
+
+  prefetch_inputs(prefetch_inputs const &) = delete;
+  auto operator=(prefetch_inputs const &) -> prefetch_inputs & = delete;
+
+  // Consumer side of one channel, used by stats::make
+  struct reader final {
+    spsc_ring<parsed_t> &ring;
+    parsed_t item = {};
+
+    auto next(auto &&callback) -> bool
+    {
+      while (not ring.try_pop(item)) {
+        if (ring.closed()) {
+          if (not ring.try_pop(item)) {
+            return false;
+          }
+          break;
+        }
+        std::this_thread::yield();
+      }
+      callback(std::move(item));
+      return true;
+    }
+  };
+
+  [[nodiscard]] auto readers() noexcept -> pair<reader> { return {.A = {.ring = rings_.A}, .B = {.ring = rings_.B}}; }
+
+private:
+  void read_(std::stop_token stop, pair_select which)
+  {
+    auto &ring = which == pair_select::A ? rings_.A : rings_.B;
+    auto const link = inputs_.link(which);
+    packet::batch_properties properties;
+    for (auto batch = inputs_.next_batch(which); not batch.empty(); batch = inputs_.next_batch(which)) {
+      packet::parse_batch(batch, properties, link);
+      for (std::size_t i = 0; i < properties.size(); ++i) {
+        auto parsed = properties.at(i);
+        while (not ring.try_push(std::move(parsed))) {
+          if (stop.stop_requested()) {
+            return;
+          }
+          std::this_thread::yield();
+        }
+      }
+    }
+    ring.close();
+  }
+
+  T inputs_;
+  pair<spsc_ring<parsed_t>> rings_;
+  pair<std::jthread> threads_; // must be the last member, so threads are joined first
+};
+
+#endif // LIB_PREFETCH_INPUTS
@@ -0,0 +1,95 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+constexpr std::array<char const *, profile::stage_count> stage_names
+    = {"find inputs", "sort channels", "open", "read", "parse", "merge", "log"};
+} // namespace
+
+auto operator<<(std::ostream &output, profile const &self) -> std::ostream &
+{
+  auto const flags = output.flags();
+  output << std::left << std::setw(16) << "stage" << std::right << std::setw(10) << "calls" << std::setw(12)
+         << "time ms";
+  bool const counters = self.counters_error.empty();
+  if (counters) {
+    output << std::setw(16) << "cycles" << std::setw(16) << "instructions" << std::setw(8) << "IPC" << std::setw(14)
+           << "cache misses" << std::setw(14) << "branch misses";
+  }
+  for (std::size_t i = 0; i < profile::stage_count; ++i) {
+    auto const &item = self.stages[i];
+    output << '\n'
+           << std::left << std::setw(16) << stage_names[i] << std::right << std::setw(10) << item.calls
+           << std::setw(12) << std::fixed << std::setprecision(3) << static_cast<double>(item.elapsed.count()) / 1e6;
+    if (counters) {
+      auto const ipc = item.counters.cycles > 0
+                           ? static_cast<double>(item.counters.instructions) / static_cast<double>(item.counters.cycles)
+                           : 0.0;
+      output << std::setw(16) << item.counters.cycles << std::setw(16) << item.counters.instructions << std::setw(8)
+             << std::setprecision(2) << ipc << std::setw(14) << item.counters.cache_misses << std::setw(14)
+             << item.counters.branch_misses;
+    }
+  }
+  if (not counters) {
+    output << "\nhardware counters not available: " << self.counters_error;
+  } else if (self.counters_scaled) {
+    output << "\nhardware counters are estimates, scaled for time shared with other events";
+  }
+  output.flags(flags);
+  return output;
+}
+
+profiler::profiler(bool enabled) : enabled_(enabled)
+{
+  if (not enabled_) {
+    return;
+  }
+  auto counters = perf_counters::make();
+  if (counters) {
+    counters_.emplace(std::move(*counters));
+  } else {
+    profile_.counters_error = counters.error().what();
+  }
+}
+
+void profiler::sample_() noexcept
+{
+  auto const now = std::chrono::steady_clock::now();
+  auto const counters = counters_.has_value() ? counters_->read() : std::nullopt;
+  if (depth_ > 0) {
+    auto &item = profile_.stages[static_cast<std::size_t>(stack_[std::min(depth_, max_depth) - 1])];
+    item.elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_time_);
+    // NOTE: counters of a sample are skipped if either read failed
+    if (counters.has_value() && last_counters_.has_value()) {
+      item.counters += *counters - *last_counters_;
+    }
+  }
+  last_time_ = now;
+  last_counters_ = counters;
+  profile_.counters_scaled = counters_.has_value() && counters_->multiplexed();
+}
+
+void profiler::enter(stage_t stage) noexcept
+{
+  if (not enabled_) {
+    return;
+  }
+  sample_();
+  // NOTE: stages nested deeper than max_depth are attributed to the innermost one which fits
+  if (depth_ < max_depth) {
+    stack_[depth_] = stage;
+  }
+  depth_ += 1;
+  profile_.stages[static_cast<std::size_t>(stage)].calls += 1;
+}
+
+void profiler::leave() noexcept
+{
+  if (not enabled_ || depth_ == 0) {
+    return;
+  }
+  sample_();
+  depth_ -= 1;
+}
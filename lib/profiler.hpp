@@ -0,0 +1,98 @@
+#ifndef LIB_PROFILER
+#define LIB_PROFILER
+
+#include "perf_counters.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+
+// Wall time and hardware counters attributed to stages of the pipeline, see profiler
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct profile final {
+  enum class stage_t : std::size_t { find_inputs, sort_channels, open, read, parse, merge, log };
+  static constexpr std::size_t stage_count = 7;
+
+  struct sample_t final {
+    std::chrono::nanoseconds elapsed = {};
+    perf_counters::values counters = {};
+    std::uint64_t calls = 0;
+
+    [[nodiscard]] constexpr auto operator==(sample_t const &) const noexcept -> bool = default;
+  };
+
+  std::array<sample_t, stage_count> stages = {};
+  std::string counters_error = {}; // why hardware counters are not reported, if they are not
+  bool counters_scaled = false;     // true if hardware counters are estimates, see perf_counters
+
+  [[nodiscard]] constexpr auto operator[](stage_t stage) const noexcept -> sample_t const &
+  {
+    return stages[static_cast<std::size_t>(stage)];
+  }
+
+  [[nodiscard]] auto operator==(profile const &other) const noexcept -> bool = default;
+};
+
+// Print a table of stages, with time in ms and counters, if available
+auto operator<<(std::ostream &output, profile const &self) -> std::ostream &;
+
+// Opt-in instrumentation of the pipeline, enabled with --profile. Time between two consecutive calls to enter
+// or leave is attributed to the innermost stage entered, i.e. stages are exclusive of stages nested in them;
+// each call reads the clock and, if available, perf_counters of the calling thread once.
+// NOTE: stages running in background threads, e.g. reading with --prefetch, are not attributed; the time the
+// calling thread spends waiting for them is attributed to the stage it waits in.
+// NOTE: a disabled profiler does nothing, but callers should not use it in hot loops at all; stats::make only
+// takes a profiler in merge_extras, so the merge loop is unchanged when profiling is not requested.
+struct profiler final {
+  using stage_t = profile::stage_t;
+
+  explicit profiler(bool enabled);
+
+  [[nodiscard]] auto enabled() const noexcept -> bool { return enabled_; }
+  [[nodiscard]] auto result() const noexcept -> profile const & { return profile_; }
+
+  void enter(stage_t stage) noexcept;
+  void leave() noexcept;
+
+  // Leaves the stage when destroyed
+  struct scope_t final {
+    explicit scope_t(profiler *self) noexcept : self(self) {}
+    scope_t(scope_t const &) = delete;
+    auto operator=(scope_t const &) -> scope_t & = delete;
+    ~scope_t() noexcept
+    {
+      if (self != nullptr) {
+        self->leave();
+      }
+    }
+
+  private:
+    profiler *self;
+  };
+  [[nodiscard]] auto scope(stage_t stage) noexcept -> scope_t
+  {
+    enter(stage);
+    return scope_t(this);
+  }
+
+private:
+  static constexpr std::size_t max_depth = 8;
+
+  // Attribute the time and counters since the previous call to the innermost stage entered
+  void sample_() noexcept;
+
+  bool enabled_;
+  std::optional<perf_counters> counters_ = std::nullopt;
+  profile profile_ = {};
+  std::array<stage_t, max_depth> stack_ = {};
+  std::size_t depth_ = 0;
+  std::chrono::steady_clock::time_point last_time_ = {};
+  std::optional<perf_counters::values> last_counters_ = std::nullopt; // nullopt if the read failed
+};
+
+#endif // LIB_PROFILER
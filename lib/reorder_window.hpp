@@ -0,0 +1,118 @@
+#ifndef LIB_REORDER_WINDOW
+#define LIB_REORDER_WINDOW
+
+#include "pair.hpp"
+
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Sliding windows of the most recent sequence numbers of each channel, for the reorder-tolerant merge in
+// stats::make. The window of a channel ends at the highest sequence number seen on it so far, and a packet before
+// the start of the window of its own channel is too late to be matched. Each sequence number up to the highest of
+// both channels has a slot in a flat table, which records the channels it was received on and the timestamp of
+// its first copy.
+//
+// The table is indexed by the low bits of the sequence number. Since its size is a power of 2 not smaller than
+// the window, sequence numbers in the window never collide, so there is no probing and no tombstones. Slots of
+// sequence numbers which fall out of the window are passed to a callback, e.g. to count drops, and reused.
+// NOTE: the table holds only the window which ends at the highest sequence number of both channels. Packets
+// should be added in the order of sequence numbers of the next packet of each channel, as the join in
+// stats::make does, so that a burst lost by one channel does not move the table past the window of the other.
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct reorder_window final {
+  using time_point = std::chrono::system_clock::time_point;
+
+  struct slot final {
+    std::uint32_t sequence = 0;
+    pair<bool> received = {.A = false, .B = false};
+    time_point timestamp = {}; // of the first copy received
+    pair_select first = pair_select::A;
+
+    [[nodiscard]] constexpr auto used() const noexcept -> bool { return received.A || received.B; }
+  };
+
+  explicit reorder_window(std::uint32_t size)
+      : size_(size > 0 ? size : 1), slots_(std::bit_ceil(std::size_t{size_})), mask_(slots_.size() - 1)
+  {
+  }
+
+  [[nodiscard]] auto size() const noexcept -> std::uint32_t { return size_; }
+
+  // Move the end of the window of a channel to sequence, if it is higher than the current end, and pass each used
+  // slot which falls out of the table to evicted. Returns false if sequence is before the start of the window of
+  // the channel, or of the table.
+  auto advance(pair_select which, std::uint32_t sequence, auto &&evicted) -> bool
+  {
+    auto &top = which == pair_select::A ? top_.A : top_.B;
+    if (not top.has_value() || *top < sequence) {
+      top = sequence;
+    } else if (*top - sequence >= size_) {
+      return false;
+    }
+
+    if (not started_) {
+      started_ = true;
+      end_ = sequence;
+      return true;
+    }
+    if (sequence <= end_) {
+      return end_ - sequence < size_;
+    }
+
+    // Sequence numbers (end_ - size_, sequence - size_] fall out of the table; all of them if it moved that far
+    auto const distance = sequence - end_;
+    if (distance >= size_) {
+      for (auto &item : slots_) {
+        evict_(item, item.sequence, evicted);
+      }
+    } else {
+      for (std::uint32_t i = 1; i <= distance; ++i) {
+        auto const old = end_ - size_ + i; // NOTE: can wrap around near zero, never matches a used slot then
+        evict_(slots_[old & mask_], old, evicted);
+      }
+    }
+    end_ = sequence;
+    return true;
+  }
+
+  // Slot of a sequence number in the window, either used by it or free
+  [[nodiscard]] auto at(std::uint32_t sequence) noexcept -> slot &
+  {
+    auto &ret = slots_[sequence & mask_];
+    if (ret.used() && ret.sequence != sequence) [[unlikely]] {
+      ret = {}; // NOTE: only possible for sequence numbers not in the window, which callers do not ask for
+    }
+    return ret;
+  }
+
+  // Pass all used slots to evicted, e.g. at the end of input
+  void flush(auto &&evicted)
+  {
+    for (auto &item : slots_) {
+      evict_(item, item.sequence, evicted);
+    }
+  }
+
+private:
+  static void evict_(slot &item, std::uint32_t sequence, auto &&evicted)
+  {
+    if (item.used() && item.sequence == sequence) {
+      evicted(static_cast<slot const &>(item));
+      item = {};
+    }
+  }
+
+  std::uint32_t size_;
+  std::vector<slot> slots_;
+  std::size_t mask_;
+  pair<std::optional<std::uint32_t>> top_ = {}; // highest sequence number of each channel
+  std::uint32_t end_ = 0;                       // highest sequence number of both channels
+  bool started_ = false;
+};
+
+#endif // LIB_REORDER_WINDOW
@@ -0,0 +1,60 @@
+#ifndef LIB_REPORT
+#define LIB_REPORT
+
+#include "feed_stats.hpp"
+#include "pair.hpp"
+#include "profiler.hpp"
+#include "sequence_gaps.hpp"
+#include "stats.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <variant>
+
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+
+// Total size of input files and time taken to read and analyse them
+struct throughput final {
+  std::size_t bytes;
+  std::chrono::nanoseconds elapsed;
+
+  // NOTE: MB is 10^6 bytes, same as reported by disk benchmarking tools
+  [[nodiscard]] auto megabytes_per_second() const noexcept -> double
+  {
+    if (elapsed.count() <= 0) {
+      return 0.0;
+    }
+    return static_cast<double>(bytes) * 1e3 / static_cast<double>(elapsed.count());
+  }
+
+  [[nodiscard]] auto operator==(throughput const &other) const noexcept -> bool = default;
+};
+
+// Result of analyse or analyse_feeds, printed by main
+struct report final {
+  std::variant<stats, feed_stats> result;
+  std::optional<throughput> speed = std::nullopt;         // only if requested in options
+  std::optional<pair<sequence_gaps>> gaps = std::nullopt; // only if requested in options
+  std::optional<profile> profiled = std::nullopt;         // only if requested in options
+
+  [[nodiscard]] auto operator==(report const &other) const noexcept -> bool = default;
+};
+
+inline auto operator<<(std::ostream &output, report const &self) -> std::ostream &
+{
+  std::visit([&output](auto const &result) { output << result; }, self.result);
+  if (self.gaps.has_value()) {
+    output << '\n' << "sequence gaps in A: " << self.gaps->A << '\n' << "sequence gaps in B: " << self.gaps->B;
+  }
+  if (self.speed.has_value()) {
+    output << '\n' << "throughput in MB/s: " << self.speed->megabytes_per_second();
+  }
+  if (self.profiled.has_value()) {
+    output << '\n' << "profile:" << '\n' << *self.profiled;
+  }
+  return output;
+}
+
+#endif // LIB_REPORT
@@ -0,0 +1,66 @@
+#include "savefile.hpp"
+
+#include <algorithm>
+
+auto savefile::file_header::make_t::operator()(data_t file) const -> std::expected<file_header, error>
+{
+  if (file.size() < file_header_length) {
+    return error::make(error::open_pcap, "truncated dump file header");
+  }
+
+  file_header ret;
+  auto const magic = load_u32(file.data(), false);
+  if (magic == magic_microseconds || magic == magic_nanoseconds) {
+    ret.swapped = false;
+  } else if (std::byteswap(magic) == magic_microseconds || std::byteswap(magic) == magic_nanoseconds) {
+    ret.swapped = true;
+  } else {
+    return error::make(error::open_pcap, "unknown file format");
+  }
+  ret.nanoseconds = load_u32(file.data(), ret.swapped) == magic_nanoseconds;
+
+  // Skip version (2 x 16 bits), thiszone and sigfigs (2 x 32 bits); none are used by libpcap
+  ret.snaplen = load_u32(file.data() + 16, ret.swapped);
+  // Upper bits of link type may carry FCS length, same as LT_LINKTYPE in libpcap we only use lower 16 bits
+  ret.linktype = load_u32(file.data() + 20, ret.swapped) & 0xFFFF;
+  return ret;
+}
+
+namespace {
+// Check if a record header at offset looks valid, and return the offset of the next record
+auto plausible(savefile::file_header const &header, savefile::data_t file, std::size_t offset) noexcept
+    -> std::optional<std::size_t>
+{
+  // NOTE: snaplen in file header is sometimes wrong, tolerate up to the maximum snaplen of libpcap. Also
+  // assume that no packet on the wire is longer than this, which rejects most offsets inside a record header
+  constexpr std::uint32_t max_snaplen = 262144;
+  if (file.size() - offset < savefile::record_header_length) {
+    return std::nullopt;
+  }
+  auto const rec = savefile::record_header::load(header, file.data() + offset);
+  if (rec.fraction >= (header.nanoseconds ? 1'000'000'000u : 1'000'000u) //
+      || rec.caplen > std::max(header.snaplen, max_snaplen) || rec.caplen > rec.len || rec.len > max_snaplen
+      || file.size() - offset - savefile::record_header_length < rec.caplen) {
+    return std::nullopt;
+  }
+  return offset + savefile::record_header_length + rec.caplen;
+}
+} // namespace
+
+auto savefile::resync(file_header const &header, data_t file, std::size_t from, std::size_t to) noexcept
+    -> std::size_t
+{
+  // Number of consecutive plausible records needed to accept an offset, unless the chain ends at end of file
+  constexpr int chain = 8;
+  to = std::min(to, file.size());
+  for (auto offset = std::max(from, file_header_length); offset < to; ++offset) {
+    auto next = std::optional<std::size_t>(offset);
+    for (int i = 0; i < chain && next.has_value() && *next < file.size(); ++i) {
+      next = plausible(header, file, *next);
+    }
+    if (next.has_value()) {
+      return offset;
+    }
+  }
+  return to;
+}
@@ -0,0 +1,141 @@
+#ifndef LIB_SAVEFILE
+#define LIB_SAVEFILE
+
+#include "error.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <optional>
+#include <span>
+
+// Classic pcap file format (as opposed to pcapng), as described in
+// https://www.tcpdump.org/manpages/pcap-savefile.5.html
+//
+// NOTE: namespace is not called "pcap" because libpcap already uses this name for its own struct pcap
+namespace savefile {
+
+using data_t = std::span<unsigned char const>;
+
+constexpr std::uint32_t magic_microseconds = 0xa1b2c3d4;
+constexpr std::uint32_t magic_nanoseconds = 0xa1b23c4d;
+constexpr std::size_t file_header_length = 24;
+constexpr std::size_t record_header_length = 16;
+
+[[nodiscard]] inline auto load_u32(unsigned char const *src, bool swapped) noexcept -> std::uint32_t
+{
+  std::uint32_t ret = 0;
+  std::memcpy(&ret, src, sizeof(ret));
+  return swapped ? std::byteswap(ret) : ret;
+}
+
+struct file_header final {
+  bool swapped = false;
+  bool nanoseconds = false;
+  std::uint32_t snaplen = 0;
+  std::uint32_t linktype = 0;
+
+  // Read file header from the start of a pcap file
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(data_t file) const -> std::expected<file_header, error>;
+  } make = {};
+
+  [[nodiscard]] constexpr auto operator==(file_header const &) const noexcept -> bool = default;
+};
+
+struct record_header final {
+  std::uint32_t seconds = 0;
+  std::uint32_t fraction = 0; // either microseconds or nanoseconds, depending on file_header
+  std::uint32_t caplen = 0;
+  std::uint32_t len = 0;
+
+  [[nodiscard]] static auto load(file_header const &file, unsigned char const *src) noexcept -> record_header
+  {
+    return {.seconds = load_u32(src, file.swapped),
+            .fraction = load_u32(src + 4, file.swapped),
+            .caplen = load_u32(src + 8, file.swapped),
+            .len = load_u32(src + 12, file.swapped)};
+  }
+
+  [[nodiscard]] constexpr auto operator==(record_header const &) const noexcept -> bool = default;
+};
+
+struct record final {
+  record_header header;
+  data_t data; // captured bytes, i.e. header.caplen long
+};
+
+// Walk records of a pcap file held in memory, without copying any data. Stops at the end of
+// data, or at the first record truncated by the end of data (libpcap would report an error)
+struct records final {
+  file_header header;
+  data_t file;
+  std::size_t offset = file_header_length;
+
+  [[nodiscard]] auto next() noexcept -> std::optional<record>
+  {
+    if (file.size() < offset + record_header_length) {
+      return std::nullopt;
+    }
+    auto const rec = record_header::load(header, file.data() + offset);
+    if (file.size() - offset - record_header_length < rec.caplen) {
+      return std::nullopt;
+    }
+    auto const data = file.subspan(offset + record_header_length, rec.caplen);
+    offset += record_header_length + rec.caplen;
+    return record{.header = rec, .data = data};
+  }
+
+  // Same as next, but without moving to the following record
+  [[nodiscard]] auto peek() const noexcept -> std::optional<record>
+  {
+    auto copy = *this;
+    return copy.next();
+  }
+};
+
+// Find the first offset in [from, to) where a chain of plausible record headers starts, or return to if none
+// is found. This is only a guess, e.g. packet data can look like a chain of record headers. The result must be
+// verified by walking records from a known offset, e.g. from the end of the file header.
+[[nodiscard]] auto resync(file_header const &header, data_t file, std::size_t from, std::size_t to) noexcept
+    -> std::size_t;
+
+// Find the offset of a record to start reading from, to reach the first record for which before(record) is
+// false, without reading all records before it. This is a binary search over records found with resync, so it
+// assumes that before is only true for a prefix of records, e.g. for timestamps of packets captured in order.
+// before returns nullopt for records which tell nothing, e.g. packets which cannot be parsed.
+// NOTE: result is the end of file header or the start of a record for which before is true; records between it
+// and the first record for which before is false are left for the caller to skip
+template <typename Before>
+[[nodiscard]] auto bisect(file_header const &header, data_t file, Before &&before) -> std::size_t
+{
+  // NOTE: stop when the rest is short enough to read through, resync would only scan it over and over
+  constexpr std::size_t linear = 64 * 1024;
+  std::size_t low = file_header_length;
+  std::size_t high = file.size();
+  while (high > low && high - low > linear) {
+    auto const middle = low + (high - low) / 2;
+    auto walk = records{.header = header, .file = file, .offset = resync(header, file, middle, high)};
+    auto offset = walk.offset;
+    std::optional<bool> found = std::nullopt;
+    while (not found.has_value() && walk.offset < high) {
+      offset = walk.offset;
+      auto const next = walk.next();
+      if (not next.has_value()) {
+        break;
+      }
+      found = before(*next);
+    }
+    if (found.value_or(false)) {
+      low = offset;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+} // namespace savefile
+
+#endif // LIB_SAVEFILE
@@ -0,0 +1,133 @@
+#include "segmented_pcap_inputs.hpp"
+#include "decompress_source.hpp"
+
+namespace {
+// NOTE: only the file header is needed to check a compressed segment, so it is decompressed in small chunks
+constexpr CompressedPcapInputs::records_t::config check_config = {.buffers = 2, .chunk = 4096};
+} // namespace
+
+auto SegmentedPcapInputs::pcap_segment::link() const -> packet::link_t
+{
+  return packet::detect_link(records.header.linktype, records.peek().value_or(savefile::record{}).data);
+}
+
+auto SegmentedPcapInputs::pcapng_segment::link() const -> packet::link_t
+{
+  // NOTE: same as in PcapngInputs, the interface of the first packet selects the link layer
+  auto copy = blocks;
+  auto const first = copy.next();
+  if (not first.has_value()) {
+    return packet::link_t::ethernet;
+  }
+  return packet::detect_link(copy.interfaces[first->interface].linktype, first->data);
+}
+
+auto SegmentedPcapInputs::compressed_segment::link() const -> packet::link_t
+{
+  // NOTE: first record is very likely to be in the first buffer; if not, we will assume Ethernet
+  return packet::detect_link(records.header().linktype, records.peek().value_or(savefile::record{}).data);
+}
+
+auto SegmentedPcapInputs::open_(std::string const &filename, compressed_records::config config)
+    -> std::expected<segment, error>
+{
+  if (compression_from_name(filename) != compression_t::none) {
+    auto source = decompress_source::make(filename, config.buffers);
+    if (!source) {
+      return std::unexpected<error>(source.error());
+    }
+    auto records = compressed_records::make(std::move(*source), config);
+    if (!records) {
+      return error::make(error::open_pcap, "invalid file: ", filename, ", error: ", records.error());
+    }
+    return compressed_segment{.records = std::move(*records)};
+  }
+
+  auto file = mapped_file::make(filename);
+  if (!file) {
+    return std::unexpected<error>(file.error());
+  }
+  // NOTE: mapped data does not move with mapped_file, so records or blocks can be created before the move
+  if (pcapng::is_pcapng(file->data())) {
+    auto blocks = pcapng::blocks::make(file->data());
+    if (!blocks) {
+      return error::make(error::open_pcap, "invalid file: ", filename, ", error: ", blocks.error());
+    }
+    return pcapng_segment{.file = std::move(*file), .blocks = std::move(*blocks)};
+  }
+  auto const header = savefile::file_header::make(file->data());
+  if (!header) {
+    return error::make(error::open_pcap, "invalid file: ", filename, ", error: ", header.error());
+  }
+  savefile::records const records{.header = *header, .file = file->data()};
+  return pcap_segment{.file = std::move(*file), .records = records};
+}
+
+auto SegmentedPcapInputs::open_channel_(std::vector<std::string> &&filenames, char const *name)
+    -> std::expected<channel, error>
+{
+  if (filenames.empty()) {
+    return error::make(error::open_pcap, "no segments of channel ", name);
+  }
+  auto first = open_(filenames.front(), CompressedPcapInputs::config);
+  if (!first) {
+    return error::make(error::open_pcap, "failed to open file ", name, ": ", filenames.front(),
+                       ", error: ", first.error());
+  }
+  for (std::size_t i = 1; i < filenames.size(); ++i) {
+    if (auto const checked = open_(filenames[i], check_config); !checked) {
+      return error::make(error::open_pcap, "failed to open file ", name, ": ", filenames[i],
+                         ", error: ", checked.error());
+    }
+  }
+
+  auto const link = std::visit([](auto const &kind) { return kind.link(); }, *first);
+  return channel{.filenames = std::move(filenames), .current = std::move(*first), .link = link};
+}
+
+void SegmentedPcapInputs::prefetch_(channel &input)
+{
+  if (input.next < input.filenames.size()) {
+    input.prefetched = std::async(std::launch::async, [filename = input.filenames[input.next]] {
+      auto ret = open_(filename, CompressedPcapInputs::config);
+      if (ret) {
+        std::visit([](auto const &kind) { kind.populate(); }, *ret);
+      }
+      return ret;
+    });
+  }
+}
+
+auto SegmentedPcapInputs::advance_(channel &input) -> bool
+{
+  if (not input.prefetched.valid()) {
+    return false; // this was the last segment
+  }
+  auto next = input.prefetched.get();
+  if (!next) {
+    return false;
+  }
+  // NOTE: compressed records cannot be assigned, only constructed in place of the current segment
+  std::visit([&input]<typename T>(T &kind) { input.current.emplace<T>(std::move(kind)); }, *next);
+  input.next += 1;
+  prefetch_(input);
+  return true;
+}
+
+[[nodiscard]] auto SegmentedPcapInputs::make_t::operator()(pair<std::vector<std::string>> filenames) const
+    -> std::expected<SegmentedPcapInputs, error>
+{
+  auto channel_a = open_channel_(std::move(filenames.A), "A");
+  if (!channel_a) {
+    return std::unexpected<error>(channel_a.error());
+  }
+  auto channel_b = open_channel_(std::move(filenames.B), "B");
+  if (!channel_b) {
+    return std::unexpected<error>(channel_b.error());
+  }
+
+  SegmentedPcapInputs ret({.A = std::move(*channel_a), .B = std::move(*channel_b)});
+  prefetch_(ret.A_);
+  prefetch_(ret.B_);
+  return ret;
+}
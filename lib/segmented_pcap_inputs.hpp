@@ -0,0 +1,165 @@
+#ifndef LIB_SEGMENTED_PCAP_INPUTS
+#define LIB_SEGMENTED_PCAP_INPUTS
+
+#include "compressed_pcap_inputs.hpp"
+#include "error.hpp"
+#include "inputs.hpp"
+#include "link_layer.hpp"
+#include "mapped_file.hpp"
+#include "pair.hpp"
+#include "pcapng.hpp"
+#include "savefile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <future>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Implementation of Inputs for captures rotated by the recorder into many segments per channel, which are
+// read one after another as one continuous stream. Each segment is read in the same way as a single file would
+// be, see analyse: compressed segments are decompressed in one pass as in CompressedPcapInputs, and other segments
+// are mapped in memory as in MmapPcapInputs or PcapngInputs. The next segment of each channel is opened and read
+// into memory on a background thread, while the current one is being consumed.
+// NOTE: the link layer is selected from the first segment, and is assumed to be the same in all segments.
+// NOTE: make checks that every segment can be opened, and returns the error if not; a segment which fails to open
+// later, e.g. because it was removed in the meantime, ends the channel, same as a truncated record does
+struct SegmentedPcapInputs final : Inputs {
+  using data_t = Inputs::data_t;
+
+  // Create SegmentedPcapInputs from lists of segments for both channels, in order
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(pair<std::vector<std::string>> filenames) const
+        -> std::expected<SegmentedPcapInputs, error>;
+  } make = {};
+
+  // Hides Inputs::next_batch, to enable static dispatch in stats::make
+  auto next_batch(pair_select which) -> batch_t { return batch_(which == pair_select::A ? A_ : B_); }
+
+  // noncopyable, but moveable
+  SegmentedPcapInputs(SegmentedPcapInputs const &) = delete;
+  SegmentedPcapInputs(SegmentedPcapInputs &&other) = default;
+
+private:
+  using compressed_records = CompressedPcapInputs::records_t;
+
+  // NOTE: Same as in PcapInputs, incomplete packet is of no use to us, just report that we had "something"
+  static auto view_(std::uint32_t caplen, std::uint32_t len, data_t data) -> data_t
+  {
+    return caplen == len ? data : data.first(0);
+  }
+
+  // Each kind of segment reads up to count packets, and returns how many it read; zero means the end of segment.
+  // Data of mapped segments remains valid until the segment is closed, and of compressed until the next call.
+  struct pcap_segment final {
+    mapped_file file;
+    savefile::records records;
+
+    void populate() const noexcept { file.populate(); }
+    [[nodiscard]] auto link() const -> packet::link_t;
+    auto next(std::size_t count, auto &&callback) -> std::size_t
+    {
+      std::size_t ret = 0;
+      for (; ret < count; ++ret) {
+        auto const record = records.next();
+        if (not record.has_value()) {
+          break;
+        }
+        callback(view_(record->header.caplen, record->header.len, record->data));
+      }
+      return ret;
+    }
+  };
+
+  struct pcapng_segment final {
+    mapped_file file;
+    pcapng::blocks blocks;
+
+    void populate() const noexcept { file.populate(); }
+    [[nodiscard]] auto link() const -> packet::link_t;
+    auto next(std::size_t count, auto &&callback) -> std::size_t
+    {
+      std::size_t ret = 0;
+      for (; ret < count; ++ret) {
+        auto const packet = blocks.next();
+        if (not packet.has_value()) {
+          break;
+        }
+        callback(view_(packet->caplen, packet->len, packet->data));
+      }
+      return ret;
+    }
+  };
+
+  // NOTE: decompression starts on its own thread when the segment is opened, there is nothing to populate
+  struct compressed_segment final {
+    compressed_records records;
+
+    void populate() const noexcept {}
+    [[nodiscard]] auto link() const -> packet::link_t;
+    auto next(std::size_t count, auto &&callback) -> std::size_t
+    {
+      return records.next(count, [&callback](savefile::record const &record) {
+        callback(view_(record.header.caplen, record.header.len, record.data));
+      });
+    }
+  };
+
+  using segment = std::variant<pcap_segment, pcapng_segment, compressed_segment>;
+  static auto open_(std::string const &filename, compressed_records::config config) -> std::expected<segment, error>;
+  static auto read_(segment &current, std::size_t count, auto &&callback) -> std::size_t
+  {
+    return std::visit([&](auto &kind) { return kind.next(count, callback); }, current);
+  }
+
+  struct channel final {
+    std::vector<std::string> filenames;
+    segment current;
+    packet::link_t link;
+    std::size_t next = 1; // index of the segment being prefetched
+    std::future<std::expected<segment, error>> prefetched = {};
+    std::vector<data_t> views = {};
+  };
+
+  explicit SegmentedPcapInputs(pair<channel> src) noexcept : A_(std::move(src.A)), B_(std::move(src.B)) {}
+
+  static auto open_channel_(std::vector<std::string> &&filenames, char const *name) -> std::expected<channel, error>;
+  static void prefetch_(channel &input);
+  static auto advance_(channel &input) -> bool;
+
+  static auto next_(channel &input, auto &&callback) -> bool
+  {
+    while (read_(input.current, 1, callback) == 0) {
+      if (not advance_(input)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // NOTE: a batch never crosses the end of a segment, because data in the batch points to its mapping, or to
+  // a buffer of decompressed data; the batch might be shorter than batch_size, but is empty only at the end
+  static auto batch_(channel &input) -> batch_t
+  {
+    input.views.clear();
+    while (read_(input.current, batch_size, [&input](data_t data) { input.views.push_back(data); }) == 0
+           && advance_(input)) {
+    }
+    return input.views;
+  }
+
+  auto next_a(data_callback_t callback) -> bool override { return next_(A_, callback); }
+  auto next_b(data_callback_t callback) -> bool override { return next_(B_, callback); }
+  auto batch_a() -> batch_t override { return next_batch(pair_select::A); }
+  auto batch_b() -> batch_t override { return next_batch(pair_select::B); }
+  auto link_a() const -> packet::link_t override { return A_.link; }
+  auto link_b() const -> packet::link_t override { return B_.link; }
+
+  channel A_;
+  channel B_;
+};
+
+#endif // LIB_SEGMENTED_PCAP_INPUTS
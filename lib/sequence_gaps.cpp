@@ -0,0 +1,35 @@
+#include "sequence_gaps.hpp"
+
+void sequence_gaps::record_(std::uint32_t sequence)
+{
+  if (not started) {
+    started = true;
+    first = highest = sequence;
+  } else if (sequence > highest) {
+    missing.insert(highest + 1, sequence - 1);
+    highest = sequence;
+  } else if (sequence < first) {
+    // NOTE: everything between this and the first sequence number received is now missing
+    missing.insert(sequence + 1, first - 1);
+    late.insert(sequence);
+    first = sequence;
+  } else if (missing.erase(sequence)) {
+    late.insert(sequence);
+  } else {
+    duplicate.insert(sequence);
+  }
+}
+
+auto operator<<(std::ostream &output, sequence_gaps const &self) -> std::ostream &
+{
+  auto const print = [&output](char const *name, interval_set const &set) {
+    output << name << ' ' << set.size();
+    if (not set.empty()) {
+      output << " (" << set << ')';
+    }
+  };
+  print("missing", self.missing);
+  print(", late", self.late);
+  print(", duplicate", self.duplicate);
+  return output;
+}
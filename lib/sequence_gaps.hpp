@@ -0,0 +1,39 @@
+#ifndef LIB_SEQUENCE_GAPS
+#define LIB_SEQUENCE_GAPS
+
+#include "interval_set.hpp"
+
+#include <cstdint>
+#include <ostream>
+
+// Gaps and repeats in the sequence numbers of one channel, in the order packets were read. Memory is proportional
+// to the number of gaps and repeats (see interval_set), and a packet in sequence costs one comparison.
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct sequence_gaps final {
+  interval_set missing;   // not received, between the first and the highest sequence number received
+  interval_set late;      // received after a higher sequence number, i.e. filled a gap after all
+  interval_set duplicate; // received more than once
+  std::uint32_t first = 0;
+  std::uint32_t highest = 0;
+  bool started = false;
+
+  void record(std::uint32_t sequence)
+  {
+    if (started && sequence == highest + 1) [[likely]] {
+      highest = sequence;
+      return;
+    }
+    record_(sequence);
+  }
+
+  [[nodiscard]] auto operator==(sequence_gaps const &) const noexcept -> bool = default;
+
+private:
+  void record_(std::uint32_t sequence);
+};
+
+// Print e.g. "missing 4 (5-7, 10), late 1 (3), duplicate 0"
+auto operator<<(std::ostream &output, sequence_gaps const &self) -> std::ostream &;
+
+#endif // LIB_SEQUENCE_GAPS
@@ -0,0 +1,61 @@
+#include "sharded_inputs.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+auto open(std::vector<std::string> const &filenames, char const *name)
+    -> std::expected<std::pair<std::vector<mapped_file>, sharded_merge::channel>, error>
+{
+  if (filenames.empty()) {
+    return error::make(error::open_pcap, "no segments of channel ", name);
+  }
+
+  std::vector<mapped_file> files;
+  sharded_merge::channel channel;
+  for (auto const &filename : filenames) {
+    auto file = mapped_file::make(filename);
+    if (!file) {
+      return error::make(error::open_pcap, "failed to open file ", name, ": ", filename, ", error: ", file.error());
+    }
+    auto const header = savefile::file_header::make(file->data());
+    if (!header) {
+      return error::make(error::open_pcap, "invalid file ", name, ": ", filename, ", error: ", header.error());
+    }
+    // NOTE: mapped data does not move with mapped_file, so records can be created before the move
+    channel.segments.push_back({.header = *header, .file = file->data()});
+    files.push_back(std::move(*file));
+  }
+
+  // NOTE: same as in SegmentedPcapInputs, link layer is selected from the first segment
+  auto const &first = channel.segments.front();
+  channel.link = packet::detect_link(first.header.linktype, first.peek().value_or(savefile::record{}).data);
+  return std::pair{std::move(files), std::move(channel)};
+}
+} // namespace
+
+[[nodiscard]] auto sharded_inputs::make_t::operator()(pair<std::vector<std::string>> filenames) const
+    -> std::expected<sharded_inputs, error>
+{
+  auto a = open(filenames.A, "A");
+  if (!a) {
+    return std::unexpected<error>(a.error());
+  }
+  auto b = open(filenames.B, "B");
+  if (!b) {
+    return std::unexpected<error>(b.error());
+  }
+  return sharded_inputs({.A = {.segments = std::move(a->first)}, .B = {.segments = std::move(b->first)}},
+                        {.A = std::move(a->second), .B = std::move(b->second)});
+}
+
+auto sharded_inputs::merge(work_stealing_pool &pool, stats::error_callback_t log) const -> stats
+{
+  std::size_t total = 0;
+  for (auto const &records : channels_.A.segments) {
+    total += records.file.size();
+  }
+  auto const shards = std::clamp<std::size_t>(total / shard_size, 1, pool.size() * shards_per_thread);
+  return sharded_merge::merge(channels_, sharded_merge::find_boundaries(channels_, shards, pool), pool,
+                              std::move(log));
+}
@@ -0,0 +1,46 @@
+#ifndef LIB_SHARDED_INPUTS
+#define LIB_SHARDED_INPUTS
+
+#include "error.hpp"
+#include "mapped_file.hpp"
+#include "pair.hpp"
+#include "sharded_merge.hpp"
+#include "stats.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <vector>
+
+// Maps all segments of both channels in memory, and merges them in shards on a work_stealing_pool, see
+// sharded_merge. Unlike implementations of Inputs, this produces stats by itself rather than through stats::make.
+// TODO: this is untestable, because mapped_file calls the OS directly (but sharded_merge is tested)
+struct sharded_inputs final {
+  static constexpr std::size_t shard_size = 32 * 1024 * 1024; // bytes of channel A, at least
+  static constexpr std::size_t shards_per_thread = 4;         // more shards than threads, for work stealing
+
+  // Create sharded_inputs from lists of segments for both channels, in order
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(pair<std::vector<std::string>> filenames) const
+        -> std::expected<sharded_inputs, error>;
+  } make = {};
+
+  // Merge both channels on the pool, the result and the log are identical to stats::make
+  [[nodiscard]] auto merge(work_stealing_pool &pool, stats::error_callback_t log = {}) const -> stats;
+
+private:
+  struct files final {
+    std::vector<mapped_file> segments;
+  };
+
+  sharded_inputs(pair<files> f, pair<sharded_merge::channel> c) noexcept
+      : files_(std::move(f)), channels_(std::move(c))
+  {
+  }
+
+  pair<files> files_; // NOTE: channels_ point to the mapped data
+  pair<sharded_merge::channel> channels_;
+};
+
+#endif // LIB_SHARDED_INPUTS
@@ -0,0 +1,227 @@
+#include "sharded_merge.hpp"
+
+#include <array>
+#include <string>
+#include <utility>
+
+namespace {
+using channel = sharded_merge::channel;
+using position = sharded_merge::position;
+
+// Sequence number of the first packet which can be parsed, among a few records starting at offset, and
+// the offset after its record
+struct probe final {
+  std::uint32_t sequence;
+  std::size_t end;
+};
+
+auto first_sequence(channel const &input, std::size_t segment, std::size_t offset) -> std::optional<probe>
+{
+  auto records = input.segments[segment];
+  records.offset = offset;
+  packet::batch_properties parsed;
+  for (std::size_t i = 0; i < sharded_merge::probe_records; ++i) {
+    auto const record = records.next();
+    if (not record.has_value()) {
+      return std::nullopt;
+    }
+    // NOTE: Same as in PcapInputs, incomplete packet is of no use to us
+    auto const frames = std::array{record->header.caplen == record->header.len ? record->data : record->data.first(0)};
+    packet::parse_batch(frames, parsed, input.link);
+    if (auto const properties = parsed.at(0); properties.has_value()) {
+      return probe{.sequence = properties->sequence, .end = records.offset};
+    }
+  }
+  return std::nullopt;
+}
+
+// Offset just after the first packet with given sequence number in a segment of channel B
+auto search(channel const &input, std::size_t segment, std::uint32_t sequence) -> std::optional<std::size_t>
+{
+  auto const &records = input.segments[segment];
+  auto const size = records.file.size();
+
+  // Binary search for a record with sequence number lower than wanted, which is not far from it
+  std::size_t low = savefile::file_header_length;
+  std::size_t high = size;
+  while (high - low > sharded_merge::search_window) {
+    auto const middle = low + (high - low) / 2;
+    auto const start = savefile::resync(records.header, records.file, middle, high);
+    auto const found = start < high ? first_sequence(input, segment, start) : std::nullopt;
+    if (found.has_value() && found->sequence < sequence) {
+      low = start;
+    } else {
+      high = middle;
+    }
+  }
+
+  // NOTE: sequence numbers are only roughly in order, search a little further than high
+  auto walk = records;
+  walk.offset = low;
+  packet::batch_properties parsed;
+  while (walk.offset < high + sharded_merge::search_window) {
+    auto const record = walk.next();
+    if (not record.has_value()) {
+      break;
+    }
+    auto const frames = std::array{record->header.caplen == record->header.len ? record->data : record->data.first(0)};
+    packet::parse_batch(frames, parsed, input.link);
+    if (auto const properties = parsed.at(0); properties.has_value() && properties->sequence == sequence) {
+      return walk.offset;
+    }
+  }
+  return std::nullopt;
+}
+} // namespace
+
+auto sharded_merge::find_boundary(pair<channel> const &channels, position near) -> std::optional<boundary>
+{
+  if (near.segment >= channels.A.segments.size() || channels.B.segments.empty()) {
+    return std::nullopt;
+  }
+  auto const from = near.offset < savefile::file_header_length ? savefile::file_header_length : near.offset;
+  auto const &a = channels.A.segments[near.segment];
+  auto offset = savefile::resync(a.header, a.file, from, a.file.size());
+
+  // NOTE: the packet might have been dropped by channel B, try a few more
+  for (std::size_t attempt = 0; attempt < probe_attempts; ++attempt) {
+    auto found = first_sequence(channels.A, near.segment, offset);
+    // NOTE: too close to the end of a segment, try the start of the next one
+    if (not found.has_value() && near.segment + 1 < channels.A.segments.size()) {
+      near = {.segment = near.segment + 1, .offset = savefile::file_header_length};
+      found = first_sequence(channels.A, near.segment, near.offset);
+      offset = near.offset;
+    }
+    if (not found.has_value()) {
+      return std::nullopt;
+    }
+    offset = found->end;
+
+    // Last segment of channel B which starts at or before the sequence number found in channel A
+    std::size_t segment = 0;
+    for (std::size_t i = 1; i < channels.B.segments.size(); ++i) {
+      auto const first = first_sequence(channels.B, i, savefile::file_header_length);
+      if (first.has_value() && first->sequence > found->sequence) {
+        break;
+      }
+      segment = i;
+    }
+
+    if (auto const end = search(channels.B, segment, found->sequence); end.has_value()) {
+      return boundary{.at = {.A = {.segment = near.segment, .offset = found->end},
+                             .B = {.segment = segment, .offset = *end}},
+                      .sequence = found->sequence};
+    }
+  }
+  return std::nullopt;
+}
+
+auto sharded_merge::find_boundaries(pair<channel> const &channels, std::size_t shards, work_stealing_pool &pool)
+    -> std::vector<boundary>
+{
+  std::size_t total = 0;
+  for (auto const &records : channels.A.segments) {
+    total += records.file.size();
+  }
+
+  std::vector<std::optional<boundary>> found(shards > 1 ? shards - 1 : 0);
+  for (std::size_t k = 0; k < found.size(); ++k) {
+    // Translate offset in all of channel A to a segment and offset in it
+    auto target = total / shards * (k + 1);
+    std::size_t segment = 0;
+    while (segment + 1 < channels.A.segments.size() && target >= channels.A.segments[segment].file.size()) {
+      target -= channels.A.segments[segment++].file.size();
+    }
+    pool.submit([&, k, near = position{.segment = segment, .offset = target}] { //
+      found[k] = find_boundary(channels, near);
+    });
+  }
+  pool.wait();
+
+  // NOTE: shards must not overlap, drop boundaries which are not after the previous one in both channels
+  std::vector<boundary> ret;
+  auto last = boundary{};
+  for (auto const &item : found) {
+    if (item.has_value() && last.at.A < item->at.A && last.at.B < item->at.B) {
+      ret.push_back(*item);
+      last = *item;
+    }
+  }
+  return ret;
+}
+
+auto sharded_merge::merge(pair<channel> const &channels, std::vector<boundary> const &boundaries,
+                          work_stealing_pool &pool, stats::error_callback_t log) -> stats
+{
+  std::vector<boundary> starts = {boundary{}};
+  starts.insert(starts.end(), boundaries.begin(), boundaries.end());
+  auto const size = starts.size();
+
+  std::vector<stats> results(size);
+  std::vector<std::size_t> reached(size); // boundary at which each shard stopped, or size if at the end of input
+  std::vector<std::vector<std::string>> logged(size);
+  for (std::size_t k = 0; k < size; ++k) {
+    pool.submit([&, k] {
+      pair<reader> readers = {.A = reader(channels.A, starts[k].at.A), .B = reader(channels.B, starts[k].at.B)};
+      std::size_t next = k + 1;
+      auto const stop = [&](std::uint32_t a, std::uint32_t b, stats const &) -> bool {
+        while (next < size && (starts[next].at.A < readers.A.at() || starts[next].at.B < readers.B.at())) {
+          ++next; // this boundary cannot be reached anymore
+        }
+        return next < size && readers.A.at() == starts[next].at.A && readers.B.at() == starts[next].at.B
+               && a == starts[next].sequence && b == starts[next].sequence;
+      };
+      // NOTE: without log, lines are not even formatted, same as in stats::make
+      stats::error_callback_t shard_log = {};
+      if (log) {
+        shard_log = [&lines = logged[k]](std::string line) { lines.push_back(std::move(line)); };
+      }
+      results[k] = stats::make_t::merge_from(readers, shard_log, starts[k].sequence, stop);
+      reached[k] = next;
+    });
+  }
+  pool.wait();
+
+  stats ret = results[0];
+  for (auto &line : logged[0]) {
+    log(std::move(line));
+  }
+  for (auto k = reached[0]; k < size; k = reached[k]) {
+    ret += results[k];
+    for (auto &line : logged[k]) {
+      log(std::move(line));
+    }
+  }
+  return ret;
+}
+
+sharded_merge::reader::reader(channel const &input, position at)
+    : input_(&input), at_(at),
+      current_(at.segment < input.segments.size() ? input.segments[at.segment] : savefile::records{})
+{
+  current_.offset = at.offset;
+}
+
+auto sharded_merge::reader::fill_() -> bool
+{
+  views_.clear();
+  ends_.clear();
+  // NOTE: Same as SegmentedPcapInputs, the end of data in a segment moves to the next segment
+  while (views_.size() < batch_size) {
+    auto const record = current_.next();
+    if (not record.has_value()) {
+      if (not views_.empty() || at_.segment + 1 >= input_->segments.size()) {
+        break;
+      }
+      at_ = {.segment = at_.segment + 1, .offset = savefile::file_header_length};
+      current_ = input_->segments[at_.segment];
+      continue;
+    }
+    // NOTE: Same as in PcapInputs, incomplete packet is of no use to us, just report that we had "something"
+    views_.push_back(record->header.caplen == record->header.len ? record->data : record->data.first(0));
+    ends_.push_back(current_.offset);
+  }
+  index_ = 0;
+  packet::parse_batch(views_, parsed_, input_->link);
+  return not views_.empty();
+}
@@ -0,0 +1,99 @@
+#ifndef LIB_SHARDED_MERGE
+#define LIB_SHARDED_MERGE
+
+#include "link_layer.hpp"
+#include "pair.hpp"
+#include "parse_batch.hpp"
+#include "savefile.hpp"
+#include "stats.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Split the merge loop of stats::make into shards, which are merged in parallel on a work_stealing_pool, and
+// add up their partial stats. The result is identical to the serial stats::make over the same records.
+//
+// Shards start at boundaries aligned on sequence numbers, i.e. a position in channel A just after a packet with
+// sequence number S, and a position in channel B just after a packet with the same sequence number. At such a
+// point the whole state of the merge loop is the sequence number S, so a shard can resume the loop from there.
+// Boundaries are only a guess (found with savefile::resync and a search of channel B), hence each shard ends as
+// soon as it reaches any later boundary in the exact expected state. If it misses a boundary, it simply carries
+// on to the next one, and the result of the shard which started there is discarded. The combined result only
+// includes shards chained from the start of the input, so packets across the boundaries are counted exactly once.
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct sharded_merge final {
+  // Records of all segments of a channel, in memory
+  struct channel final {
+    std::vector<savefile::records> segments;
+    packet::link_t link = packet::link_t::ethernet;
+  };
+
+  // Position in a channel: index of a segment, and offset in it after the last record read
+  struct position final {
+    std::size_t segment = 0;
+    std::size_t offset = savefile::file_header_length;
+
+    [[nodiscard]] constexpr auto operator<=>(position const &) const noexcept = default;
+  };
+
+  struct boundary final {
+    pair<position> at = {};
+    std::uint32_t sequence = 0;
+
+    [[nodiscard]] constexpr auto operator==(boundary const &) const noexcept -> bool = default;
+  };
+
+  static constexpr std::size_t search_window = 64 * 1024; // bytes of channel B searched for sequence number
+  static constexpr std::size_t probe_records = 64;        // records searched for a packet which can be parsed
+  static constexpr std::size_t probe_attempts = 4;        // packets of channel A searched for in channel B
+
+  // Find a boundary just after the given position of channel A, if any
+  [[nodiscard]] static auto find_boundary(pair<channel> const &channels, position near) -> std::optional<boundary>;
+
+  // Find boundaries which split channel A into up to shards parts of similar size, in strictly increasing order
+  [[nodiscard]] static auto find_boundaries(pair<channel> const &channels, std::size_t shards,
+                                            work_stealing_pool &pool) -> std::vector<boundary>;
+
+  // Merge shards starting at the start of input and at each of boundaries, and combine their stats. If log is set,
+  // lines logged by each shard are kept in memory, and those of the combined shards are passed to it in order, so
+  // the log is the same as of stats::make.
+  [[nodiscard]] static auto merge(pair<channel> const &channels, std::vector<boundary> const &boundaries,
+                                  work_stealing_pool &pool, stats::error_callback_t log = {}) -> stats;
+
+  // Reader for stats::make_t::merge_from, which knows its position
+  struct reader final {
+    static constexpr std::size_t batch_size = 256; // packets parsed together with packet::parse_batch
+
+    reader(channel const &input, position at);
+
+    auto next(auto &&callback) -> bool
+    {
+      if (index_ == parsed_.size() && not fill_()) {
+        return false;
+      }
+      at_.offset = ends_[index_];
+      callback(parsed_.at(index_++));
+      return true;
+    }
+
+    [[nodiscard]] auto at() const noexcept -> position const & { return at_; }
+
+  private:
+    auto fill_() -> bool;
+
+    channel const *input_;
+    position at_;
+    savefile::records current_;
+    std::vector<savefile::data_t> views_ = {};
+    std::vector<std::size_t> ends_ = {}; // offset after each record in views_
+    packet::batch_properties parsed_ = {};
+    std::size_t index_ = 0;
+  };
+};
+
+#endif // LIB_SHARDED_MERGE
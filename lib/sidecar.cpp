@@ -0,0 +1,65 @@
+#include "sidecar.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+auto sidecar::stamp(std::string const &filename) -> std::optional<file_stamp>
+{
+  std::error_code ec;
+  auto const size = std::filesystem::file_size(filename, ec);
+  if (ec) {
+    return std::nullopt;
+  }
+  auto const time = std::filesystem::last_write_time(filename, ec);
+  if (ec) {
+    return std::nullopt;
+  }
+  return file_stamp{
+      .size = size,
+      .mtime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count()};
+}
+
+auto sidecar::write(std::string const &filename, std::span<unsigned char const> data) -> bool
+{
+  return write(filename, data.size(), [data](std::span<unsigned char> out) { std::ranges::copy(data, out.begin()); });
+}
+
+auto sidecar::write(std::string const &filename, std::size_t size,
+                    std::function<void(std::span<unsigned char>)> const &fill) -> bool
+{
+  std::error_code ec;
+  auto const temporary = filename + std::string(temporary_suffix);
+  int const fd = ::open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  // NOTE: blocks are allocated first, because writing to a mapped hole when the disk is full raises SIGBUS
+  bool written = size == 0 || ::posix_fallocate(fd, 0, static_cast<off_t>(size)) == 0;
+  if (written && size == 0) {
+    fill({}); // mmap does not accept zero length
+  } else if (written) {
+    void *const data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    written = data != MAP_FAILED;
+    if (written) {
+      fill(std::span(static_cast<unsigned char *>(data), size));
+      written = ::munmap(data, size) == 0;
+    }
+  }
+  if (::close(fd) != 0 || not written) {
+    std::filesystem::remove(temporary, ec);
+    return false;
+  }
+
+  std::filesystem::rename(temporary, filename, ec);
+  if (ec) {
+    std::filesystem::remove(temporary, ec);
+    return false;
+  }
+  return true;
+}
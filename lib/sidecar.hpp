@@ -0,0 +1,40 @@
+#ifndef LIB_SIDECAR
+#define LIB_SIDECAR
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Sidecar files are written next to a capture file, e.g. by pcap_index or packet_cache, and named after it. Each
+// stores the size and modification time of the capture file, so that it is not used after the capture changes.
+namespace sidecar {
+
+// Sidecar is written to a file named with this appended first, and then renamed
+inline constexpr std::string_view temporary_suffix = ".tmp";
+
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct file_stamp final {
+  std::uint64_t size = 0;
+  std::int64_t mtime_ns = 0; // NOTE: file_time_type of libstdc++ counts nanoseconds
+
+  [[nodiscard]] constexpr auto operator==(file_stamp const &) const noexcept -> bool = default;
+};
+
+// Size and modification time of a file, or nullopt if it cannot be read
+[[nodiscard]] auto stamp(std::string const &filename) -> std::optional<file_stamp>;
+
+// Write the whole sidecar file before replacing the old one, so that readers never see a partial sidecar
+[[nodiscard]] auto write(std::string const &filename, std::span<unsigned char const> data) -> bool;
+
+// Same, but fill writes the sidecar of given size in place, into a writable mapping of the file, so that a large
+// sidecar is never held in memory as a whole
+[[nodiscard]] auto write(std::string const &filename, std::size_t size,
+                         std::function<void(std::span<unsigned char>)> const &fill) -> bool;
+
+} // namespace sidecar
+
+#endif // LIB_SIDECAR
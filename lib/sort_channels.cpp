@@ -1,50 +1,134 @@
 #include "sort_channels.hpp"
+#include "packet_cache.hpp"
+#include "pcap_index.hpp"
+#include "sidecar.hpp"
 
+#include <algorithm>
 #include <regex>
+#include <string_view>
+#include <utility>
 
 std::string const channel_A = "14310";
 std::string const channel_B = "15310";
 
-auto sort_channels_t::operator()(std::array<std::string, 2> const &files) const
-    -> std::expected<pair<std::string>, error>
+namespace {
+// NOTE: Assumption that channel is encoded as a penultimate group of numbers, '_' on one side and '-' on the other,
+// followed by the segment number of a rotated capture. File is either .pcap or .pcapng, and can be also
+// compressed, with .gz or .zst appended.
+std::regex const channel_regex(R"(^.*_([0-9]+)-([0-9]+)\.pcap(ng)?(\.gz|\.zst)?$)");
+
+struct parsed_name final {
+  std::string channel;
+  std::string segment;
+};
+
+auto parse_name(std::string const &file) -> std::expected<parsed_name, error>
+{
+  if (file.empty()) {
+    return error::make(error::find_channels, "filename is empty");
+  }
+  std::smatch matches;
+  std::regex_search(file, matches, channel_regex);
+  if (matches.size() != 5) {
+    return error::make(error::find_channels, "unexpected channel of file: ", file);
+  }
+  return parsed_name{.channel = matches[1].str(), .segment = matches[2].str()};
+}
+
+// NOTE: sidecar files written next to captures, e.g. by pcap_index or packet_cache, are not inputs; neither are
+// temporary files left behind when writing a sidecar was interrupted
+auto is_sidecar(std::string const &file) -> bool
 {
-  pair<std::string> ret;
+  auto name = std::string_view(file);
+  if (name.ends_with(sidecar::temporary_suffix)) {
+    name.remove_suffix(sidecar::temporary_suffix.size());
+  }
+  return name.ends_with(sidecar_suffix) || name.ends_with(cache_suffix);
+}
 
-  if (files[0].empty()) {
-    return error::make(error::find_channels, "first filename is empty");
+// NOTE: numbers may have different lengths, compare as numbers rather than strings
+auto less_number(std::string const &a, std::string const &b) -> bool
+{
+  return std::make_pair(a.size(), std::string_view(a)) < std::make_pair(b.size(), std::string_view(b));
+}
+
+// Order segments of one channel by segment number, each number must be unique
+auto sort_segments(std::vector<std::pair<std::string, std::string>> &&segments, std::string const &name)
+    -> std::expected<std::vector<std::string>, error>
+{
+  if (segments.empty()) {
+    return error::make(error::find_channels, "no files of channel ", name);
   }
-  if (files[1].empty()) {
-    return error::make(error::find_channels, "second filename is empty");
+  std::ranges::sort(segments, [](auto const &a, auto const &b) { return less_number(a.first, b.first); });
+  auto const duplicate
+      = std::ranges::adjacent_find(segments, [](auto const &a, auto const &b) { return a.first == b.first; });
+  if (duplicate != segments.end()) {
+    return error::make(error::find_channels, "duplicate segment ", duplicate->first, " of channel ", name, ": ",
+                       duplicate->second, ", ", std::next(duplicate)->second);
   }
-  if (files[0] == files[1]) {
-    return error::make(error::find_channels, "both filenames are identical");
+
+  std::vector<std::string> ret;
+  ret.reserve(segments.size());
+  for (auto &segment : segments) {
+    ret.push_back(std::move(segment.second));
   }
+  return ret;
+}
+} // namespace
 
-  // NOTE: Assumption that channel is encoded as a penultimate group of numbers, '_' on one side and '-' on the other
-  std::regex const regex(R"(^.*_([0-9]+)-[0-9]+.pcap$)");
-  {
-    std::smatch matches;
-    std::regex_search(files[0], matches, regex);
-    if (matches.size() == 2 && matches[1].str() == channel_A) {
-      ret.A = files[0];
-    } else if (matches.size() == 2 && matches[1].str() == channel_B) {
-      ret.B = files[0];
+auto sort_channels_t::operator()(std::vector<std::string> const &files) const
+    -> std::expected<pair<std::vector<std::string>>, error>
+{
+  pair<std::vector<std::pair<std::string, std::string>>> segments;
+  for (auto const &file : files) {
+    if (is_sidecar(file)) {
+      continue;
+    }
+    auto const name = parse_name(file);
+    if (!name) {
+      return std::unexpected<error>(name.error());
+    }
+    if (name->channel == channel_A) {
+      segments.A.emplace_back(name->segment, file);
+    } else if (name->channel == channel_B) {
+      segments.B.emplace_back(name->segment, file);
     } else {
-      return error::make(error::find_channels, "unexpected channel of first file: ", files[0]);
+      return error::make(error::find_channels, "unexpected channel of file: ", file);
     }
   }
 
-  {
-    std::smatch matches;
-    std::regex_search(files[1], matches, regex);
-    std::string const expected = ret.A.empty() ? channel_A : channel_B;
-    if (matches.size() == 2 && matches[1].str() == expected) {
-      (ret.A.empty() ? ret.A : ret.B) = files[1];
-    } else {
-      return error::make(error::find_channels, "unexpected channel of second file: ", files[1]);
+  auto a = sort_segments(std::move(segments.A), "A");
+  if (!a) {
+    return std::unexpected<error>(a.error());
+  }
+  auto b = sort_segments(std::move(segments.B), "B");
+  if (!b) {
+    return std::unexpected<error>(b.error());
+  }
+  return pair<std::vector<std::string>>{.A = std::move(*a), .B = std::move(*b)};
+}
+
+auto sort_feeds_t::operator()(std::vector<std::string> const &files) const
+    -> std::expected<std::vector<feed_file>, error>
+{
+  std::vector<feed_file> ret;
+  for (auto const &file : files) {
+    if (is_sidecar(file)) {
+      continue;
     }
+    auto const name = parse_name(file);
+    if (!name) {
+      return std::unexpected<error>(name.error());
+    }
+    ret.push_back({.channel = name->channel, .file = file});
   }
 
+  std::ranges::sort(ret, [](feed_file const &a, feed_file const &b) { return less_number(a.channel, b.channel); });
+  auto const duplicate
+      = std::ranges::adjacent_find(ret, [](auto const &a, auto const &b) { return a.channel == b.channel; });
+  if (duplicate != ret.end()) {
+    return error::make(error::find_channels, "duplicate channel ", duplicate->channel, ": ", duplicate->file, ", ",
+                       std::next(duplicate)->file);
+  }
   return ret;
 }
-
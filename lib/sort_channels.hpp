@@ -4,13 +4,34 @@
 #include "error.hpp"
 #include "pair.hpp"
 
-#include <array>
 #include <expected>
+#include <string>
+#include <vector>
 
-// For given two files, sort them into channel A and channel B, based on their filenames
+// Channel numbers of A and B, as encoded in filenames e.g. some_14310-0.pcap
+extern std::string const channel_A;
+extern std::string const channel_B;
+
+// For given files, sort them into channel A and channel B, based on their filenames. Each channel
+// can be split into segments by a rotating recorder, these are ordered by their segment number.
 constexpr inline struct sort_channels_t final {
-  [[nodiscard]] auto
-  operator()(std::array<std::string, 2> const &files) const -> std::expected<pair<std::string>, error>;
+  [[nodiscard]] auto operator()(std::vector<std::string> const &files) const
+      -> std::expected<pair<std::vector<std::string>>, error>;
 } sort_channels;
 
+// One file of many feeds, with the channel encoded in its filename
+struct feed_file final {
+  std::string channel;
+  std::string file;
+
+  [[nodiscard]] auto operator==(feed_file const &other) const noexcept -> bool = default;
+};
+
+// For given files, find the channel of each one and sort them by channel number. Any channel is accepted,
+// but each at most once.
+constexpr inline struct sort_feeds_t final {
+  [[nodiscard]] auto operator()(std::vector<std::string> const &files) const
+      -> std::expected<std::vector<feed_file>, error>;
+} sort_feeds;
+
 #endif // LIB_SORT_CHANNELS
@@ -0,0 +1,77 @@
+#ifndef LIB_SPSC_RING
+#define LIB_SPSC_RING
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Bounded, lock-free queue for exactly one producer thread and one consumer thread
+//
+// Each side keeps a private copy of the other side's position, so it only needs to touch the
+// shared atomic (and its cache line) when the ring appears to be full (producer) or empty (consumer).
+template <typename T> struct spsc_ring final {
+  // Capacity is rounded up to a power of 2
+  explicit spsc_ring(std::size_t capacity)
+      : mask_(std::bit_ceil(capacity < 2 ? 2 : capacity) - 1), slots_(std::make_unique<T[]>(mask_ + 1))
+  {
+  }
+
+  // noncopyable, nonmoveable (shared between threads)
+  spsc_ring(spsc_ring const &) = delete;
+  auto operator=(spsc_ring const &) -> spsc_ring & = delete;
+
+  [[nodiscard]] auto capacity() const noexcept -> std::size_t { return mask_ + 1; }
+
+  // Producer only. Returns false if the ring is full, in which case value is not moved from.
+  [[nodiscard]] auto try_push(T &&value) -> bool
+  {
+    auto const tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ > mask_) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail - head_cache_ > mask_) {
+        return false;
+      }
+    }
+    slots_[tail & mask_] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Producer only. Signal to the consumer that nothing more will be pushed.
+  void close() noexcept { closed_.store(true, std::memory_order_release); }
+
+  // Consumer only. Returns false if the ring is empty.
+  [[nodiscard]] auto try_pop(T &value) -> bool
+  {
+    auto const head = head_.load(std::memory_order_relaxed);
+    if (head == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head == tail_cache_) {
+        return false;
+      }
+    }
+    value = std::move(slots_[head & mask_]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. If this returns true and try_pop returns false afterwards, then the ring is drained.
+  [[nodiscard]] auto closed() const noexcept -> bool { return closed_.load(std::memory_order_acquire); }
+
+private:
+  // NOTE: std::hardware_destructive_interference_size triggers -Winterference-size in gcc
+  static constexpr std::size_t cache_line = 64;
+
+  std::size_t const mask_;
+  std::unique_ptr<T[]> const slots_;
+  alignas(cache_line) std::atomic<std::size_t> head_ = 0; // written by consumer
+  std::size_t tail_cache_ = 0;                            // consumer's copy of tail_
+  alignas(cache_line) std::atomic<std::size_t> tail_ = 0; // written by producer
+  std::size_t head_cache_ = 0;                            // producer's copy of head_
+  alignas(cache_line) std::atomic<bool> closed_ = false;
+};
+
+#endif // LIB_SPSC_RING
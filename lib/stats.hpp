@@ -1,11 +1,180 @@
 #ifndef LIB_STATS
 #define LIB_STATS
 
+#include "batch_reader.hpp"
+#include "functional.hpp"
 #include "inputs.hpp"
+#include "latency_histogram.hpp"
+#include "match_export.hpp"
+#include "packet.hpp"
+#include "packet_range.hpp"
 #include "pair.hpp"
+#include "prefetch_inputs.hpp"
+#include "profiler.hpp"
+#include "reorder_window.hpp"
+#include "sequence_gaps.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <expected>
 #include <functional>
+#include <optional>
 #include <ostream>
+#include <stop_token>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Reader which records sequence numbers of all packets read by another reader into gaps, if set, see merge_extras
+template <typename Reader> struct gaps_reader final {
+  Reader reader;
+  sequence_gaps *gaps;
+
+  auto next(auto &&callback) -> bool
+  {
+    if (gaps == nullptr) {
+      return reader.next(callback);
+    }
+    return reader.next([&](packet::parsed_t &&parsed) {
+      if (parsed.has_value()) {
+        gaps->record(parsed->sequence);
+      }
+      callback(std::move(parsed));
+    });
+  }
+};
+
+// Reader which only passes packets of another reader within range, if it is not empty, see merge_extras. Packets
+// which cannot be parsed are passed if the packet before them was in range, so they are logged as usual, and
+// skipped otherwise, same as in PcapInputs::seek.
+// NOTE: a packet after the range can be followed by late ones in it, hence the channel is read to its end; with
+// PcapInputs::seek, the end is where its index shows that all packets left are after the range
+template <typename Reader> struct range_reader final {
+  Reader reader;
+  packet_range range;
+  bool inside = std::holds_alternative<std::monostate>(range.from);
+
+  auto next(auto &&callback) -> bool
+  {
+    if (range.empty()) {
+      return reader.next(callback);
+    }
+    bool passed = false;
+    while (not passed) {
+      bool const read = reader.next([&](packet::parsed_t &&parsed) {
+        if (parsed.has_value()) {
+          inside = not range.before(*parsed) && not range.after(*parsed);
+        }
+        if (inside) {
+          passed = true;
+          callback(std::move(parsed));
+        }
+      });
+      if (not read) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+// Reader of inputs which can be woken while waiting for packets, e.g. FollowPcapInputs: when another reader ends
+// before stop is requested, it was only woken, so this calls idle and reads again. The merge loop does not step
+// without a packet, since that would change which packets it matches, see stats::make with snapshot.
+template <typename Reader, typename Idle> struct wake_reader final {
+  Reader reader;
+  std::stop_token stop;
+  Idle idle;
+
+  auto next(auto &&callback) -> bool
+  {
+    while (not reader.next(callback)) {
+      if (stop.stop_requested()) {
+        return false;
+      }
+      idle();
+    }
+    return true;
+  }
+};
+
+// Observer of the merge loop of stats::make which does nothing, see stats::make_t::merge_from
+struct ignore_matches final {
+  constexpr void matched(packet::properties const &, packet::properties const &) const noexcept {}
+  constexpr void dropped(pair_select, packet::properties const &) const noexcept {}
+};
+
+// Observer of the merge loop of stats::make which passes each packet counted as matched or dropped to output, if
+// set, see merge_extras
+struct export_matches final {
+  match_export *output;
+
+  void matched(packet::properties const &a, packet::properties const &b) const
+  {
+    if (output != nullptr) {
+      output->matched(a, b);
+    }
+  }
+  void dropped(pair_select which, packet::properties const &other) const
+  {
+    if (output != nullptr) {
+      output->dropped(which, other);
+    }
+  }
+};
+
+// State of one channel in the merge loop of stats::make
+struct merge_state_t final {
+  using duration = std::chrono::system_clock::duration;
+  static_assert(std::same_as<duration, std::chrono::nanoseconds>);
+  using time_point = std::chrono::system_clock::time_point;
+
+  packet::properties last = {};
+  bool read_next = true;
+  pair_select const which;
+};
+
+} // namespace detail
+
+// Source of parsed packets for both channels, e.g. prefetch_inputs. Each reader must provide
+// next(callback) -> bool, which invokes callback with the result of packet::parse
+template <typename T>
+concept some_readers = requires(T &inputs) {
+  { inputs.readers().A.next([](packet::parsed_t &&) {}) } -> std::same_as<bool>;
+  { inputs.readers().B.next([](packet::parsed_t &&) {}) } -> std::same_as<bool>;
+};
+
+// Optional additions to the merge loop of stats::make, which compose with each other and with any inputs. Range
+// and gaps wrap the readers of both channels, in the order of fields below, the profiler is passed to the readers
+// and the output observes the merge, so the merge loop itself is unchanged; window selects the merge loop. An
+// addition which is not set only costs a predictable branch per packet; with none set, use stats::make without
+// merge_extras, which does not wrap the readers at all.
+//
+// NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
+struct merge_extras final {
+  packet_range range = {};             // only merge packets within range, see packet_range
+  pair<sequence_gaps> *gaps = nullptr; // record sequence numbers of all packets read, see sequence_gaps
+  // Attribute time and hardware counters to stages of merging, i.e. reading and parsing each batch, calls to log
+  // and the rest of the merge loop. Reading and parsing are only attributed for some_inputs, for some_readers they
+  // happen in background threads and the time spent waiting for them is attributed to merge.
+  profiler *prof = nullptr;
+  // Export each sequence number counted as matched or dropped, see match_export. This observes the merge loop
+  // rather than the readers, so only packets within range are exported.
+  match_export *output = nullptr;
+  // Match copies of a sequence number in both channels whenever both arrive within this many sequence numbers,
+  // instead of the strict merge, see reorder_window; 0 for the strict merge. A copy is only counted as dropped
+  // when its sequence number falls out of the window, and the other channel has already moved past it.
+  std::uint32_t window = 0;
+
+  [[nodiscard]] auto empty() const noexcept -> bool
+  {
+    return range.empty() && gaps == nullptr && prof == nullptr && output == nullptr && window == 0;
+  }
+};
 
 // NOTE: I am using snake_case for simple types, e.g. non-polymorphic, aggregate etc.
 struct stats final {
@@ -13,6 +182,9 @@ struct stats final {
   pair<std::size_t> dropped_count;
   pair<std::size_t> faster_count;
   pair<double> advantage_total_ns;
+  pair<latency_histogram> advantage_histogram = {}; // of advantage in ns, when faster
+  pair<packet::parse_error_counts> error_count = {}; // of packets which could not be parsed, for each reason
+  pair<std::size_t> late_count = {}; // of packets in packet_count which arrived after they fell out of the window
 
   [[nodiscard]] constexpr auto advantage_ns() const noexcept -> pair<double>
   {
@@ -22,20 +194,395 @@ struct stats final {
 
   // Produce feed statistics based on network inputs, in pcap format
   using error_callback_t = std::move_only_function<void(std::string)>;
+  using snapshot_callback_t = std::move_only_function<void(stats const &)>;
   static constexpr struct make_t final {
+    // Dynamic dispatch, i.e. one virtual call per batch of packets
     [[nodiscard]] auto operator()(Inputs &&inputs, error_callback_t log = {}) const -> stats;
+
+    // Static dispatch for a concrete type of inputs, which enables the compiler to inline reading
+    // of packets into the merge loop. Both overloads produce identical results.
+    template <some_inputs T>
+      requires(not std::is_reference_v<T>) && (not std::same_as<T, Inputs>)
+    [[nodiscard]] auto operator()(T &&inputs, error_callback_t log = {}) const -> stats
+    {
+      auto readers = pair<detail::batch_reader<T>>{.A = {.inputs = inputs, .which = pair_select::A},
+                                                   .B = {.inputs = inputs, .which = pair_select::B}};
+      return merge_(readers, log);
+    }
+
+    // Packets are read and parsed elsewhere, e.g. in background threads, see prefetch_inputs or parallel_inputs
+    template <some_readers T>
+      requires(not std::is_reference_v<T>)
+    [[nodiscard]] auto operator()(T &&inputs, error_callback_t log = {}) const -> stats
+    {
+      auto readers = inputs.readers();
+      return merge_(readers, log);
+    }
+
+    // Same as both of the above, with any of merge_extras
+    template <typename T>
+      requires(not std::is_reference_v<T>) && (some_inputs<T> || some_readers<T>) && (not std::same_as<T, Inputs>)
+    [[nodiscard]] auto operator()(T &&inputs, merge_extras const &extras, error_callback_t log = {}) const -> stats
+    {
+      auto readers = readers_(inputs, extras.prof);
+      auto ranged = wrap_<detail::range_reader>(readers, extras.range, extras.range);
+      auto gapped = wrap_<detail::gaps_reader>(ranged, extras.gaps ? &extras.gaps->A : nullptr,
+                                               extras.gaps ? &extras.gaps->B : nullptr);
+      auto const observe = detail::export_matches{.output = extras.output};
+      auto const merge = [&](error_callback_t &log) {
+        if (extras.window > 0) {
+          return join_(gapped, log, reorder_window(extras.window), observe);
+        }
+        return merge_(gapped, log, observe);
+      };
+      if (extras.prof == nullptr) {
+        return merge(log);
+      }
+
+      error_callback_t profiled_log = {};
+      if (log) {
+        profiled_log = [prof = extras.prof, &log](std::string line) {
+          auto const scope = prof->scope(profile::stage_t::log);
+          log(std::move(line));
+        };
+      }
+      auto const scope = extras.prof->scope(profile::stage_t::merge);
+      return merge(profiled_log);
+    }
+
+    // Same as static dispatch above, and also call snapshot with statistics so far whenever due is set, e.g. by
+    // a timer in follow mode. Each snapshot is only a copy of stats, so it costs the same regardless of how many
+    // packets were merged so far. Checking due is a relaxed load, once per step of the merge loop.
+    // Inputs only end when stop is requested; before that, an empty batch means that inputs were woken while
+    // waiting for packets, e.g. FollowPcapInputs when due is set, and the snapshot is taken while they are idle.
+    template <some_inputs T>
+      requires(not std::is_reference_v<T>) && (not std::same_as<T, Inputs>)
+    [[nodiscard]] auto operator()(T &&inputs, std::stop_token stop, std::atomic<bool> &due,
+                                  snapshot_callback_t snapshot, error_callback_t log = {}) const -> stats
+    {
+      // NOTE: statistics of the merge loop are only updated after both channels were read in a step, so they can
+      // be copied while a reader waits
+      stats const *so_far = nullptr;
+      auto const take = [&due, &snapshot, &so_far] {
+        if (due.load(std::memory_order_relaxed)) [[unlikely]] {
+          due.store(false, std::memory_order_relaxed);
+          snapshot(*so_far);
+        }
+      };
+      auto batched = readers_(inputs);
+      using reader_t = detail::wake_reader<decltype(batched.A), decltype(take)>;
+      auto readers = pair<reader_t>{.A = {.reader = std::move(batched.A), .stop = stop, .idle = take},
+                                    .B = {.reader = std::move(batched.B), .stop = stop, .idle = take}};
+      return merge_from(readers, log, 0, [&so_far, &take](std::uint32_t, std::uint32_t, stats const &ret) {
+        so_far = &ret;
+        take();
+        return false;
+      });
+    }
+
+    // Merge loop of all the above, resumed from the state where the last packets of both channels had the same
+    // sequence number, e.g. at the start of a shard, see sharded_inputs. Before each step of the loop
+    // stop(A, B, so_far) is called with sequence numbers of the last packets of both channels and statistics so
+    // far, and the loop ends if it returns true. Each packet counted as matched or dropped is also passed to
+    // observe, with the same interface as match_export.
+    // Reader must provide next(callback) -> bool, which invokes callback with the result of packet::parse
+    template <typename Reader, typename Stop, typename Observe = detail::ignore_matches>
+    static auto merge_from(pair<Reader> &readers, error_callback_t &log, std::uint32_t sequence, Stop &&stop,
+                           Observe &&observe = {}) -> stats;
+
+  private:
+    // Readers of both channels of inputs, which is either some_inputs or some_readers
+    template <typename T> static auto readers_(T &inputs, profiler *prof = nullptr)
+    {
+      if constexpr (some_readers<T>) {
+        return inputs.readers();
+      } else {
+        return pair<detail::batch_reader<T>>{.A = {.inputs = inputs, .which = pair_select::A, .prof = prof},
+                                             .B = {.inputs = inputs, .which = pair_select::B, .prof = prof}};
+      }
+    }
+
+    // Readers wrapped in Wrapper<Reader>, each initialized with the reader and its argument
+    template <template <typename> typename Wrapper, typename Reader>
+    static auto wrap_(pair<Reader> &readers, auto &&a, auto &&b) -> pair<Wrapper<Reader>>
+    {
+      return {.A = {std::move(readers.A), std::forward<decltype(a)>(a)},
+              .B = {std::move(readers.B), std::forward<decltype(b)>(b)}};
+    }
+
+    template <typename Reader, typename Observe = detail::ignore_matches>
+    static auto merge_(pair<Reader> &readers, error_callback_t &log, Observe &&observe = {}) -> stats
+    {
+      return merge_from(
+          readers, log, 0, [](std::uint32_t, std::uint32_t, stats const &) { return false; },
+          std::forward<Observe>(observe));
+    }
+
+    // Reorder-tolerant alternative to the merge loop, see merge_extras::window
+    template <typename Reader, typename Observe>
+    static auto join_(pair<Reader> &readers, error_callback_t &log, reorder_window window, Observe &&observe) -> stats;
   } make = {};
 
+  // Statistics of consecutive parts of the input add up to the statistics of the whole input
+  constexpr auto operator+=(stats const &other) noexcept -> stats &
+  {
+    packet_count = {.A = packet_count.A + other.packet_count.A, .B = packet_count.B + other.packet_count.B};
+    dropped_count = {.A = dropped_count.A + other.dropped_count.A, .B = dropped_count.B + other.dropped_count.B};
+    faster_count = {.A = faster_count.A + other.faster_count.A, .B = faster_count.B + other.faster_count.B};
+    advantage_total_ns = {.A = advantage_total_ns.A + other.advantage_total_ns.A,
+                          .B = advantage_total_ns.B + other.advantage_total_ns.B};
+    advantage_histogram.A += other.advantage_histogram.A;
+    advantage_histogram.B += other.advantage_histogram.B;
+    error_count.A += other.error_count.A;
+    error_count.B += other.error_count.B;
+    late_count = {.A = late_count.A + other.late_count.A, .B = late_count.B + other.late_count.B};
+    return *this;
+  }
+
   [[nodiscard]] constexpr auto operator==(stats const &other) const noexcept -> bool = default;
 };
 
+[[nodiscard]] constexpr auto operator+(stats lh, stats const &rh) noexcept -> stats { return lh += rh; }
+
+template <typename Reader, typename Stop, typename Observe>
+auto stats::make_t::merge_from(pair<Reader> &readers, error_callback_t &log, std::uint32_t sequence, Stop &&stop,
+                               Observe &&observe) -> stats
+{
+  using parsed_t = packet::parsed_t;
+  stats ret{.packet_count = {}, .dropped_count = {}, .faster_count = {}, .advantage_total_ns = {}};
+
+  using state_t = detail::merge_state_t;
+  pair<state_t> state = {.A = {.last = {.sequence = sequence}, .which = pair_select::A},
+                         .B = {.last = {.sequence = sequence}, .which = pair_select::B}};
+  // NOTE: parse errors are only counted, the message is only formatted if there is a log to write it to
+  constexpr auto update = [](state_t &state, packet::parse_error_counts &errors, error_callback_t &log,
+                             parsed_t &&parsed) -> void {
+    std::move(parsed)                                //
+        | transform([&state](packet::properties p) { //
+            state.last = std::move(p);
+          })
+        | or_else([&state, &errors, &log](packet::parse_error e) -> std::expected<void, packet::parse_error> {
+            errors.record(e);
+            if (log) [[unlikely]] {
+              log(std::to_string((int)state.which) + ',' + packet::message(e));
+            }
+            return {};
+          })
+        | discard();
+  };
+
+  while (not stop(state.A.last.sequence, state.B.last.sequence, std::as_const(ret))) {
+    auto const old = pair<packet::properties>{.A = state.A.last, .B = state.B.last};
+    bool const read_a = state.A.read_next && readers.A.next([&](parsed_t &&parsed) { //
+      update(state.A, ret.error_count.A, log, std::move(parsed));
+    });
+    bool const read_b = state.B.read_next && readers.B.next([&](parsed_t &&parsed) { //
+      update(state.B, ret.error_count.B, log, std::move(parsed));
+    });
+
+    if (!read_a && !read_b) {
+      break;
+    }
+
+    state.A.read_next = (state.A.last.sequence <= state.B.last.sequence);
+    state.B.read_next = (state.B.last.sequence <= state.A.last.sequence);
+
+    // NOTE: out-of-order & late packets count as dropped, since they failed to arrive when they were needed
+    bool const updated_a = old.A.sequence < state.A.last.sequence;
+    if (updated_a) {
+      ret.packet_count.A += 1;
+    } else if (old.A.sequence != state.A.last.sequence) {
+      if (log) {
+        log("0,out of sequence");
+      }
+    }
+
+    bool const updated_b = old.B.sequence < state.B.last.sequence;
+    if (updated_b) {
+      ret.packet_count.B += 1;
+    } else if (old.B.sequence != state.B.last.sequence) {
+      if (log) {
+        log("1,out of sequence");
+      }
+    }
+
+    if (updated_a && updated_b) {
+      if (state.A.last.sequence < state.B.last.sequence) [[unlikely]] {
+        ret.dropped_count.B += 1;
+        observe.dropped(pair_select::B, state.A.last);
+        continue;
+      }
+      if (state.B.last.sequence < state.A.last.sequence) [[unlikely]] {
+        ret.dropped_count.A += 1;
+        observe.dropped(pair_select::A, state.B.last);
+        continue;
+      }
+
+      // state.B.last.sequence == state.A.last.sequence
+      observe.matched(state.A.last, state.B.last);
+      if (state.A.last.timestamp < state.B.last.timestamp) {
+        auto const advantage = static_cast<std::uint64_t>(state.B.last.timestamp.time_since_epoch().count()
+                                                          - state.A.last.timestamp.time_since_epoch().count());
+        ret.faster_count.A += 1;
+        ret.advantage_total_ns.A += static_cast<double>(advantage);
+        ret.advantage_histogram.A.record(advantage);
+      } else if (state.B.last.timestamp < state.A.last.timestamp) {
+        auto const advantage = static_cast<std::uint64_t>(state.A.last.timestamp.time_since_epoch().count()
+                                                          - state.B.last.timestamp.time_since_epoch().count());
+        ret.faster_count.B += 1;
+        ret.advantage_total_ns.B += static_cast<double>(advantage);
+        ret.advantage_histogram.B.record(advantage);
+      }
+      // else neither channel has advantage, that's unusual but possible
+    }
+  }
+
+  return ret;
+}
+
+template <typename Reader, typename Observe>
+auto stats::make_t::join_(pair<Reader> &readers, error_callback_t &log, reorder_window window, Observe &&observe)
+    -> stats
+{
+  using parsed_t = packet::parsed_t;
+  stats ret{.packet_count = {}, .dropped_count = {}, .faster_count = {}, .advantage_total_ns = {}};
+
+  // NOTE: same as in the merge loop, a channel which has ended cannot drop packets; highest includes the next packet
+  // of each channel, which has been read but not added to the window yet
+  pair<std::uint32_t> highest = {.A = 0, .B = 0};
+  auto const evicted = [&](reorder_window::slot const &item) {
+    auto const first = packet::properties{.timestamp = item.timestamp, .sequence = item.sequence};
+    if (not item.received.B && highest.B > item.sequence) {
+      ret.dropped_count.B += 1;
+      observe.dropped(pair_select::B, first);
+    } else if (not item.received.A && highest.A > item.sequence) {
+      ret.dropped_count.A += 1;
+      observe.dropped(pair_select::A, first);
+    }
+  };
+
+  auto const faster = [&ret](pair_select which, std::uint64_t advantage) {
+    auto &count = which == pair_select::A ? ret.faster_count.A : ret.faster_count.B;
+    auto &total = which == pair_select::A ? ret.advantage_total_ns.A : ret.advantage_total_ns.B;
+    auto &histogram = which == pair_select::A ? ret.advantage_histogram.A : ret.advantage_histogram.B;
+    count += 1;
+    total += static_cast<double>(advantage);
+    histogram.record(advantage);
+  };
+
+  auto const add = [&](pair_select which, packet::properties const &p) {
+    // NOTE: too late to be matched, but still counted as received by its channel; it is neither matched nor dropped
+    if (not window.advance(which, p.sequence, evicted)) [[unlikely]] {
+      (which == pair_select::A ? ret.packet_count.A : ret.packet_count.B) += 1;
+      (which == pair_select::A ? ret.late_count.A : ret.late_count.B) += 1;
+      if (log) {
+        log(std::to_string((int)which) + ",out of window");
+      }
+      return;
+    }
+
+    auto &item = window.at(p.sequence);
+    auto &received = which == pair_select::A ? item.received.A : item.received.B;
+    if (received) [[unlikely]] {
+      if (log) {
+        log(std::to_string((int)which) + ",duplicate");
+      }
+      return;
+    }
+    (which == pair_select::A ? ret.packet_count.A : ret.packet_count.B) += 1;
+    received = true;
+    if (not item.received.A || not item.received.B) {
+      item.sequence = p.sequence;
+      item.timestamp = p.timestamp;
+      item.first = which;
+      return;
+    }
+
+    // Both copies are here, the earlier one has advantage; if they are equal neither does
+    auto const first = packet::properties{.timestamp = item.timestamp, .sequence = item.sequence};
+    if (which == pair_select::A) {
+      observe.matched(p, first);
+    } else {
+      observe.matched(first, p);
+    }
+    if (item.timestamp < p.timestamp) {
+      faster(item.first, static_cast<std::uint64_t>((p.timestamp - item.timestamp).count()));
+    } else if (p.timestamp < item.timestamp) {
+      faster(which, static_cast<std::uint64_t>((item.timestamp - p.timestamp).count()));
+    }
+  };
+
+  // Next packet of the channel which can be parsed, if any
+  auto const pull = [&](pair_select which, Reader &reader) -> std::optional<packet::properties> {
+    std::optional<packet::properties> next;
+    while (not next.has_value() && reader.next([&](parsed_t &&parsed) {
+      std::move(parsed) //
+          | transform([&](packet::properties const &p) { next = p; })
+          | or_else([&](packet::parse_error e) -> std::expected<void, packet::parse_error> {
+              (which == pair_select::A ? ret.error_count.A : ret.error_count.B).record(e);
+              if (log) [[unlikely]] {
+                log(std::to_string((int)which) + ',' + packet::message(e));
+              }
+              return {};
+            })
+          | discard();
+    })) {
+    }
+    if (next.has_value()) {
+      auto &last = which == pair_select::A ? highest.A : highest.B;
+      last = next->sequence > last ? next->sequence : last;
+    }
+    return next;
+  };
+
+  // NOTE: add the next packet of the channel which is behind, so that a burst lost by one channel does not move
+  // the window past the other one; both are added if their sequence numbers are the same
+  pair<std::optional<packet::properties>> next = {.A = pull(pair_select::A, readers.A),
+                                                  .B = pull(pair_select::B, readers.B)};
+  while (next.A.has_value() || next.B.has_value()) {
+    bool const add_a = next.A.has_value() && (not next.B.has_value() || next.A->sequence <= next.B->sequence);
+    bool const add_b = next.B.has_value() && (not next.A.has_value() || next.B->sequence <= next.A->sequence);
+    if (add_a) {
+      add(pair_select::A, *next.A);
+      next.A = pull(pair_select::A, readers.A);
+    }
+    if (add_b) {
+      add(pair_select::B, *next.B);
+      next.B = pull(pair_select::B, readers.B);
+    }
+  }
+  window.flush(evicted);
+
+  return ret;
+}
+
 inline auto operator<<(std::ostream &output, stats const &self) -> std::ostream &
 {
   output << "packet count: " << self.packet_count << '\n' //
          << "dropped packets count: " << self.dropped_count << '\n'
          << "faster packets count: " << self.faster_count << '\n'
-         << "average advantage in ns: " << self.advantage_ns();
+         << "average advantage in ns: " << self.advantage_ns() << '\n';
+
+  auto const percentile = [&self](double percent) -> pair<std::uint64_t> {
+    return {.A = self.advantage_histogram.A.percentile(percent), .B = self.advantage_histogram.B.percentile(percent)};
+  };
+  output << "p50 advantage in ns: " << percentile(50.0) << '\n'
+         << "p99 advantage in ns: " << percentile(99.0) << '\n'
+         << "p99.9 advantage in ns: " << percentile(99.9) << '\n'
+         << "max advantage in ns: "
+         << pair<std::uint64_t>{.A = self.advantage_histogram.A.max, .B = self.advantage_histogram.B.max};
 
+  if (self.late_count.A > 0 || self.late_count.B > 0) {
+    output << "\nlate packets count: " << self.late_count;
+  }
+  // NOTE: only reasons which occurred, so the report is unchanged for clean captures
+  for (std::size_t i = 1; i < packet::parse_error_count; ++i) {
+    auto const reason = static_cast<packet::parse_error>(i);
+    if (self.error_count.A[reason] > 0 || self.error_count.B[reason] > 0) {
+      output << "\nparse errors, " << reason << ": "
+             << pair<std::size_t>{.A = self.error_count.A[reason], .B = self.error_count.B[reason]};
+    }
+  }
   return output;
 }
 
@@ -0,0 +1,241 @@
+#include "synthetic.hpp"
+#include "pcap_writer.hpp"
+#include "sort_channels.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <queue>
+#include <random>
+#include <utility>
+
+#include <netinet/in.h>
+
+namespace {
+using latency_t = generate_options::latency_t;
+using random_t = std::mt19937_64;
+
+// NOTE: same addresses and ports as example_packet in tests/packet_tools.hpp
+constexpr unsigned char ethernet_header[] = {0x01, 0x00, 0x5e, 0x00, 0x1f, 0x01, 0x10, 0x0e, 0x7e, 0xe7, 0x20, 0x44,
+                                             0x08, 0x00};
+constexpr unsigned char source_address[] = {0xcd, 0xd1, 0xdd, 0x46};
+constexpr unsigned char destination_address[] = {0xe0, 0x00, 0x1f, 0x01};
+constexpr std::uint16_t port = 14310;
+constexpr std::size_t ip_header_length = 20;
+constexpr std::size_t udp_header_length = 8;
+constexpr std::size_t metamako_trailer_length = 20;
+
+// Start of the capture, i.e. 2023-11-14
+constexpr auto start = synthetic::time_point(std::chrono::seconds(1'700'000'000));
+
+void put_u16(std::uint16_t value, unsigned char *out)
+{
+  value = ::htons(value);
+  std::memcpy(out, &value, sizeof(value));
+}
+
+void put_u32(std::uint32_t value, unsigned char *out)
+{
+  value = ::htonl(value);
+  std::memcpy(out, &value, sizeof(value));
+}
+
+// Packet in flight on one channel, ordered by the time of its capture
+struct in_flight final {
+  synthetic::time_point timestamp;
+  std::uint32_t sequence;
+  std::uint16_t payload;
+
+  [[nodiscard]] constexpr auto operator<=>(in_flight const &) const noexcept = default;
+};
+using queue_t = std::priority_queue<in_flight, std::vector<in_flight>, std::greater<>>;
+
+auto sample(latency_t const &latency, random_t &random) -> std::chrono::nanoseconds
+{
+  double ret = latency.mean_ns;
+  switch (latency.kind) {
+  case latency_t::kind_t::constant:
+    break;
+  case latency_t::kind_t::uniform:
+    ret = std::uniform_real_distribution<double>(latency.mean_ns - latency.jitter_ns,
+                                                 latency.mean_ns + latency.jitter_ns)(random);
+    break;
+  case latency_t::kind_t::normal:
+    ret = latency.jitter_ns > 0 ? std::normal_distribution<double>(latency.mean_ns, latency.jitter_ns)(random) : ret;
+    break;
+  case latency_t::kind_t::exponential:
+    ret = latency.mean_ns > 0 ? std::exponential_distribution<double>(1.0 / latency.mean_ns)(random) : ret;
+    break;
+  }
+  // NOTE: nothing is captured before it was sent
+  return std::chrono::nanoseconds(std::max(0L, std::lround(ret)));
+}
+} // namespace
+
+void synthetic::frame(std::uint32_t sequence, time_point timestamp, std::uint16_t payload,
+                      std::vector<unsigned char> &out)
+{
+  auto const udp_length = static_cast<std::uint16_t>(udp_header_length + payload);
+  auto const ip_length = static_cast<std::uint16_t>(ip_header_length + udp_length);
+  out.assign(sizeof(ethernet_header) + ip_length + metamako_trailer_length, 0);
+  std::memcpy(out.data(), ethernet_header, sizeof(ethernet_header));
+
+  auto *const ip = out.data() + sizeof(ethernet_header);
+  ip[0] = 0x45; // IPv4, header without options
+  put_u16(ip_length, ip + 2);
+  put_u16(0x4000, ip + 6); // don't fragment
+  ip[8] = 0x3d;            // TTL
+  ip[9] = IPPROTO_UDP;
+  std::memcpy(ip + 12, source_address, sizeof(source_address));
+  std::memcpy(ip + 16, destination_address, sizeof(destination_address));
+  std::uint32_t checksum = 0;
+  for (std::size_t i = 0; i < ip_header_length; i += 2) {
+    checksum += (std::uint32_t{ip[i]} << 8) | ip[i + 1];
+  }
+  checksum = (checksum & 0xFFFF) + (checksum >> 16);
+  put_u16(static_cast<std::uint16_t>(~(checksum + (checksum >> 16))), ip + 10);
+
+  auto *const udp = ip + ip_header_length;
+  put_u16(port, udp);
+  put_u16(port, udp + 2);
+  put_u16(udp_length, udp + 4);
+  // NOTE: sequence number is in host byte order, same as packet::parse reads it
+  std::memcpy(udp + udp_header_length, &sequence, sizeof(sequence));
+
+  auto *const trailer = udp + udp_length;
+  auto const exact = std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+  put_u32(static_cast<std::uint32_t>(exact / 1'000'000'000), trailer + 8);
+  put_u32(static_cast<std::uint32_t>(exact % 1'000'000'000), trailer + 12);
+}
+
+auto synthetic::generate_t::operator()(generate_options const &options, packet_callback_t callback) const -> stats
+{
+  random_t random(options.seed);
+  auto const mean_gap_ns = 1e9 / options.rate;
+  std::exponential_distribution<double> gap(1.0 / mean_gap_ns);
+  std::uniform_int_distribution<std::uint16_t> payload(options.payload_min, options.payload_max);
+  std::uniform_int_distribution<int> reorder_gaps(1, 8);
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+  stats ret{.packet_count = {}, .dropped_count = {}, .faster_count = {}, .advantage_total_ns = {}};
+  auto const faster = [&ret](pair_select which, std::uint64_t advantage) {
+    auto &count = which == pair_select::A ? ret.faster_count.A : ret.faster_count.B;
+    auto &total = which == pair_select::A ? ret.advantage_total_ns.A : ret.advantage_total_ns.B;
+    auto &histogram = which == pair_select::A ? ret.advantage_histogram.A : ret.advantage_histogram.B;
+    count += 1;
+    total += static_cast<double>(advantage);
+    histogram.record(advantage);
+  };
+
+  // Packets sent, in the order they will be captured, and the frame to pass to callback
+  pair<queue_t> queues;
+  std::vector<unsigned char> buffer;
+  bool stopped = false;
+  auto const emit = [&](pair_select which, time_point until) {
+    auto &queue = which == pair_select::A ? queues.A : queues.B;
+    while (not stopped && not queue.empty() && queue.top().timestamp <= until) {
+      auto const &next = queue.top();
+      frame(next.sequence, next.timestamp, next.payload, buffer);
+      stopped = not callback(which, next.timestamp, packet::data_t(buffer.data(), buffer.size()));
+      queue.pop();
+    }
+  };
+
+  // Sends a packet on one channel, unless dropped; returns the time of its first capture
+  auto const send = [&](pair_select which, std::uint32_t sequence, std::uint16_t size,
+                        time_point sent) -> std::optional<time_point> {
+    auto const select = [which](auto const &both) -> auto const & { return which == pair_select::A ? both.A : both.B; };
+    auto &queue = which == pair_select::A ? queues.A : queues.B;
+    if (chance(random) < select(options.drop)) {
+      return std::nullopt;
+    }
+    auto captured = sent + sample(select(options.latency), random);
+    if (chance(random) < select(options.reorder)) {
+      captured += std::chrono::nanoseconds(std::lround(reorder_gaps(random) * mean_gap_ns));
+    }
+    queue.push({.timestamp = captured, .sequence = sequence, .payload = size});
+    if (chance(random) < select(options.duplicate)) {
+      auto const delay = std::chrono::nanoseconds(1 + std::lround(chance(random) * mean_gap_ns));
+      queue.push({.timestamp = captured + delay, .sequence = sequence, .payload = size});
+    }
+    return captured;
+  };
+
+  // NOTE: a drop only counts once the channel received a later packet, same as in the merge loops
+  pair<std::size_t> pending = {.A = 0, .B = 0};
+  auto sent = start;
+  for (std::uint64_t i = 0; i < options.packets && not stopped; ++i) {
+    auto const sequence = static_cast<std::uint32_t>(options.first_sequence + i);
+    sent += std::chrono::nanoseconds(std::max(1L, std::lround(gap(random))));
+    auto const size = payload(random);
+    auto const a = send(pair_select::A, sequence, size, sent);
+    auto const b = send(pair_select::B, sequence, size, sent);
+
+    if (a) {
+      ret.packet_count.A += 1;
+      ret.dropped_count.A += std::exchange(pending.A, 0);
+    }
+    if (b) {
+      ret.packet_count.B += 1;
+      ret.dropped_count.B += std::exchange(pending.B, 0);
+    }
+    if (a && b) {
+      if (*a < *b) {
+        faster(pair_select::A, static_cast<std::uint64_t>((*b - *a).count()));
+      } else if (*b < *a) {
+        faster(pair_select::B, static_cast<std::uint64_t>((*a - *b).count()));
+      }
+    } else if (a) {
+      pending.B += 1;
+    } else if (b) {
+      pending.A += 1;
+    }
+
+    // NOTE: packets sent later are captured after they are sent, i.e. after now
+    emit(pair_select::A, sent);
+    emit(pair_select::B, sent);
+  }
+  emit(pair_select::A, time_point::max());
+  emit(pair_select::B, time_point::max());
+
+  return ret;
+}
+
+auto synthetic::write_t::operator()(generate_options const &options) const -> std::expected<stats, error>
+{
+  std::error_code ec;
+  std::filesystem::create_directories(options.path, ec);
+  if (ec) {
+    return error::make(error::write_pcap, "failed to create directory: ", options.path);
+  }
+  auto a = pcap_writer::make(options.path, options.prefix, channel_A, options.segment_packets);
+  if (not a) {
+    return std::unexpected<error>(a.error());
+  }
+  auto b = pcap_writer::make(options.path, options.prefix, channel_B, options.segment_packets);
+  if (not b) {
+    return std::unexpected<error>(b.error());
+  }
+
+  std::optional<error> failed;
+  auto const ret = generate(options, [&](pair_select which, time_point timestamp, packet::data_t data) {
+    auto written = (which == pair_select::A ? *a : *b).write(timestamp, data);
+    if (not written) {
+      failed = written.error();
+    }
+    return written.has_value();
+  });
+  for (auto *writer : {&*a, &*b}) {
+    auto closed = writer->close();
+    if (not closed && not failed) {
+      failed = closed.error();
+    }
+  }
+  if (failed) {
+    return std::unexpected<error>(*failed);
+  }
+  return ret;
+}
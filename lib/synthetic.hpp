@@ -0,0 +1,46 @@
+#ifndef LIB_SYNTHETIC
+#define LIB_SYNTHETIC
+
+#include "error.hpp"
+#include "generate_options.hpp"
+#include "packet.hpp"
+#include "pair.hpp"
+#include "stats.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <vector>
+
+namespace synthetic {
+
+using time_point = packet::properties::time_point;
+
+// Ethernet frame of a UDP packet with given sequence number and Metamako timestamp, as parsed by packet::parse
+void frame(std::uint32_t sequence, time_point timestamp, std::uint16_t payload, std::vector<unsigned char> &out);
+
+// Receives packets of each channel, in the order they were captured; returns false to stop generating
+using packet_callback_t = std::move_only_function<bool(pair_select, time_point, packet::data_t)>;
+
+// Generate captures of both channels from one simulated source, and return the stats they should produce.
+//
+// The source sends packets with consecutive sequence numbers as a Poisson process, and each channel drops,
+// delays, reorders and duplicates them independently. A channel emits a packet as soon as no packet sent later
+// can be captured before it, so captures are in the order of timestamps and memory is proportional to the
+// packets in flight, rather than all packets.
+//
+// Expected stats follow from the fate of each sequence number, i.e. they are the same as stats::make with a
+// reorder_window large enough for the reordering generated. The strict merge produces the same result only if
+// there are no drops, reorders or duplicates.
+constexpr inline struct generate_t final {
+  auto operator()(generate_options const &options, packet_callback_t callback) const -> stats;
+} generate = {};
+
+// Generate captures into files of options.path (see pcap_writer), and return the stats they should produce
+constexpr inline struct write_t final {
+  [[nodiscard]] auto operator()(generate_options const &options) const -> std::expected<stats, error>;
+} write = {};
+
+} // namespace synthetic
+
+#endif // LIB_SYNTHETIC
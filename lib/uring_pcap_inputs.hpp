@@ -0,0 +1,12 @@
+#ifndef LIB_URING_PCAP_INPUTS
+#define LIB_URING_PCAP_INPUTS
+
+#include "chunked_pcap_inputs.hpp"
+#include "uring_source.hpp"
+
+// Alternative to PcapInputs which reads both files with io_uring, keeping several large reads in flight
+// per file. Fails with error::open_uring if io_uring is not available, in which case the caller is
+// expected to fall back to a different Inputs.
+using UringPcapInputs = ChunkedPcapInputs<uring_source>;
+
+#endif // LIB_URING_PCAP_INPUTS
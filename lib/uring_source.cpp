@@ -0,0 +1,139 @@
+#include "uring_source.hpp"
+
+#include <cerrno>
+#include <optional>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef PCAP_PARSER_HAVE_LIBURING
+#include <liburing.h>
+
+struct uring_source::state final {
+  // One read per slot, resubmitted until dest is filled or end of file is reached
+  struct request final {
+    std::span<unsigned char> dest = {};
+    std::size_t offset = 0;         // of dest in the file
+    std::size_t done = 0;           // bytes read into dest so far
+    std::optional<int> result = {}; // completed, but not finished yet
+  };
+
+  int fd = -1;
+  ::io_uring ring = {};
+  std::size_t size = 0;   // of the file when opened
+  std::size_t offset = 0; // of the next read to start
+  int failed = 0;         // first error of io_uring_submit, if any
+  std::vector<request> requests = {};
+
+  ~state() noexcept
+  {
+    ::io_uring_queue_exit(&ring);
+    ::close(fd);
+  }
+
+  // Submit a read of the remainder of dest of a slot, return false if that fails
+  auto submit(std::size_t slot) noexcept -> bool
+  {
+    // NOTE: a read which failed to submit stays in the submission queue, and would be submitted by the next call;
+    // after that, every read fails, so that no buffer can be written to after its slot was finished
+    if (failed != 0) {
+      return false;
+    }
+    // NOTE: queue depth is equal to the number of slots, and a slot has at most one read queued
+    auto const &request = requests[slot];
+    auto const rest = request.dest.subspan(request.done);
+    ::io_uring_sqe *const sqe = ::io_uring_get_sqe(&ring);
+    ::io_uring_prep_read(sqe, fd, rest.data(), static_cast<unsigned>(rest.size()), request.offset + request.done);
+    ::io_uring_sqe_set_data64(sqe, slot);
+    int err = 0;
+    while ((err = ::io_uring_submit(&ring)) == -EINTR) {
+    }
+    failed = err < 0 ? err : 0;
+    return failed == 0;
+  }
+};
+
+void uring_source::state_delete::operator()(state *s) const noexcept { delete s; }
+
+auto uring_source::make_t::operator()(std::string const &filename, std::size_t slots) const
+    -> std::expected<uring_source, error>
+{
+  int const fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::make(error::open_pcap, "failed to open file: ", filename);
+  }
+  struct ::stat st = {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    return error::make(error::open_pcap, "failed to open file: ", filename);
+  }
+
+  // NOTE: state owns the ring only once it is set up, because ~state must not exit a ring which was never set up
+  ::io_uring ring = {};
+  if (int const err = ::io_uring_queue_init(static_cast<unsigned>(slots), &ring, 0); err < 0) {
+    ::close(fd);
+    return error::make(error::open_uring, "io_uring not available, error: ", -err);
+  }
+  auto ret = std::unique_ptr<state, state_delete>(
+      new state{.fd = fd, .ring = ring, .size = static_cast<std::size_t>(st.st_size)});
+  ret->requests.resize(slots);
+  return uring_source(std::move(ret));
+}
+
+void uring_source::start(std::size_t slot, std::span<unsigned char> dest)
+{
+  state_->requests[slot] = {.dest = dest, .offset = state_->offset};
+  state_->offset += dest.size();
+  if (not state_->submit(slot)) {
+    state_->requests[slot].result = state_->failed; // see finish
+  }
+}
+
+auto uring_source::finish(std::size_t slot) -> std::size_t
+{
+  auto &requests = state_->requests;
+  auto &request = requests[slot];
+  while (true) {
+    while (not request.result.has_value()) {
+      ::io_uring_cqe *cqe = nullptr;
+      if (int const err = ::io_uring_wait_cqe(&state_->ring, &cqe); err == -EINTR) {
+        continue;
+      } else if (err < 0) {
+        request.result = err;
+        break;
+      }
+      requests[::io_uring_cqe_get_data64(cqe)].result = cqe->res;
+      ::io_uring_cqe_seen(&state_->ring, cqe);
+    }
+
+    // NOTE: a read can return fewer bytes than requested before the end of file, e.g. when interrupted by a
+    // signal, and then the rest is read again; only a read of zero bytes or up to the size of file ends it.
+    // Read error, or failure to submit a read, is reported as end of file, same as libpcap would stop reading.
+    int const res = *request.result;
+    request.result.reset();
+    request.done += res > 0 ? static_cast<std::size_t>(res) : 0;
+    if (res <= 0 || request.done == request.dest.size() || request.offset + request.done >= state_->size
+        || not state_->submit(slot)) {
+      break;
+    }
+  }
+  return request.done;
+}
+
+#else
+
+struct uring_source::state final {};
+
+void uring_source::state_delete::operator()(state *s) const noexcept { delete s; }
+
+auto uring_source::make_t::operator()(std::string const &, std::size_t) const -> std::expected<uring_source, error>
+{
+  return error::make(error::open_uring, "io_uring not available, built without liburing");
+}
+
+void uring_source::start(std::size_t, std::span<unsigned char>) { std::unreachable(); }
+auto uring_source::finish(std::size_t) -> std::size_t { std::unreachable(); }
+
+#endif
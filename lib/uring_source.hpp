@@ -0,0 +1,36 @@
+#ifndef LIB_URING_SOURCE
+#define LIB_URING_SOURCE
+
+#include "error.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <span>
+#include <string>
+
+// Sequential reading of a file with io_uring, with many reads in flight. Meets some_chunk_source; a short read
+// is submitted again for the rest, until a read of zero bytes or one which ends at the size of file.
+// If the project is built without liburing, or io_uring is not available at runtime (e.g. disabled
+// by seccomp), make will fail with error::open_uring
+struct uring_source final {
+  static constexpr struct make_t final {
+    [[nodiscard]] auto operator()(std::string const &filename, std::size_t slots) const
+        -> std::expected<uring_source, error>;
+  } make = {};
+
+  void start(std::size_t slot, std::span<unsigned char> dest);
+  auto finish(std::size_t slot) -> std::size_t;
+
+private:
+  struct state;
+  struct state_delete final {
+    void operator()(state *) const noexcept;
+  };
+
+  explicit uring_source(std::unique_ptr<state, state_delete> state) noexcept : state_(std::move(state)) {}
+
+  std::unique_ptr<state, state_delete> state_;
+};
+
+#endif // LIB_URING_SOURCE
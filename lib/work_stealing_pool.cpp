@@ -0,0 +1,98 @@
+#include "work_stealing_pool.hpp"
+
+#include <utility>
+
+namespace {
+// Worker run by this thread, if any, see work_stealing_pool::worker
+thread_local work_stealing_pool const *current_pool = nullptr;
+thread_local std::size_t current_worker = 0;
+} // namespace
+
+work_stealing_pool::work_stealing_pool(std::size_t threads)
+{
+  threads = threads < 1 ? 1 : threads;
+  queues_.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    queues_.push_back(std::make_unique<queue>());
+  }
+  threads_.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    threads_.emplace_back([this, i](std::stop_token stop) { run_(stop, i); });
+  }
+}
+
+work_stealing_pool::~work_stealing_pool() noexcept
+{
+  for (auto &thread : threads_) {
+    thread.request_stop();
+  }
+  threads_.clear(); // join
+}
+
+void work_stealing_pool::submit(task_t task)
+{
+  unfinished_.fetch_add(1, std::memory_order_relaxed);
+  auto &target = *queues_[next_.fetch_add(1, std::memory_order_relaxed) % queues_.size()];
+  {
+    // NOTE: queued_ is updated under the same lock, so it never drops below zero in take_
+    std::scoped_lock const lock(mutex_, target.mutex);
+    target.tasks.push_back(std::move(task));
+    queued_ += 1;
+  }
+  wake_.notify_one();
+}
+
+auto work_stealing_pool::worker() const noexcept -> std::size_t
+{
+  return current_pool == this ? current_worker : size();
+}
+
+void work_stealing_pool::wait()
+{
+  std::unique_lock lock(mutex_);
+  done_.wait(lock, [this] { return unfinished_.load(std::memory_order_acquire) == 0; });
+}
+
+auto work_stealing_pool::take_(std::size_t worker) -> task_t
+{
+  task_t ret;
+  for (std::size_t i = 0; i < queues_.size() && not ret; ++i) {
+    auto &source = *queues_[(worker + i) % queues_.size()];
+    std::scoped_lock const lock(source.mutex);
+    if (source.tasks.empty()) {
+      continue;
+    }
+    // NOTE: own queue is used as a stack, for locality; others are stolen from in submission order
+    if (i == 0) {
+      ret = std::move(source.tasks.back());
+      source.tasks.pop_back();
+    } else {
+      ret = std::move(source.tasks.front());
+      source.tasks.pop_front();
+    }
+  }
+  if (ret) {
+    std::scoped_lock const lock(mutex_);
+    queued_ -= 1;
+  }
+  return ret;
+}
+
+void work_stealing_pool::run_(std::stop_token stop, std::size_t worker)
+{
+  current_pool = this;
+  current_worker = worker;
+  while (not stop.stop_requested()) {
+    if (auto task = take_(worker); task) {
+      task();
+      if (unfinished_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::scoped_lock const lock(mutex_);
+        done_.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock lock(mutex_);
+    wake_.wait(lock, stop, [this] { return queued_ > 0; });
+  }
+}
@@ -0,0 +1,60 @@
+#ifndef LIB_WORK_STEALING_POOL
+#define LIB_WORK_STEALING_POOL
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own queue of tasks. Tasks are submitted to queues in turn;
+// a worker takes tasks from the back of its own queue and, when that is empty, steals from the front of
+// the queues of other workers. This way workers which drew short tasks help the ones which drew long tasks.
+//
+// NOTE: Not moveable (threads refer to this object). Destructor waits for the running tasks, but discards the
+// queued ones, call wait() first to run them all.
+struct work_stealing_pool final {
+  using task_t = std::move_only_function<void()>;
+
+  explicit work_stealing_pool(std::size_t threads);
+  ~work_stealing_pool() noexcept;
+
+  work_stealing_pool(work_stealing_pool const &) = delete;
+  auto operator=(work_stealing_pool const &) -> work_stealing_pool & = delete;
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t { return queues_.size(); }
+
+  // Index of the worker of this pool which runs the calling thread, or size() if it is not one of them
+  [[nodiscard]] auto worker() const noexcept -> std::size_t;
+
+  // Can be called from any thread, including tasks run by this pool
+  void submit(task_t task);
+
+  // Wait until all submitted tasks are finished, including tasks submitted by other tasks
+  void wait();
+
+private:
+  struct queue final {
+    std::mutex mutex;
+    std::deque<task_t> tasks;
+  };
+
+  auto take_(std::size_t worker) -> task_t;
+  void run_(std::stop_token stop, std::size_t worker);
+
+  std::vector<std::unique_ptr<queue>> queues_;
+  std::atomic<std::size_t> next_ = 0;       // queue for the next submitted task
+  std::atomic<std::size_t> unfinished_ = 0; // submitted but not finished tasks
+  std::size_t queued_ = 0;                  // tasks in all queues, guarded by mutex_
+  std::mutex mutex_;
+  std::condition_variable_any wake_;
+  std::condition_variable_any done_;
+  std::vector<std::jthread> threads_; // must be the last member, so threads are joined first
+};
+
+#endif // LIB_WORK_STEALING_POOL
@@ -1,28 +1,48 @@
+#include "lib/analyse.hpp"
 #include "lib/find_inputs.hpp"
 #include "lib/functional.hpp"
-#include "lib/pcap_inputs.hpp"
+#include "lib/options.hpp"
+#include "lib/profiler.hpp"
 #include "lib/sort_channels.hpp"
-#include "lib/stats.hpp"
+#include "lib/report.hpp"
 
 #include <expected>
 #include <iostream>
+#include <span>
 #include <string>
+#include <vector>
 
 auto main(int argc, char const **argv) -> int
 try {
-  auto path = [&]() -> std::expected<std::string, error> {
-    if (argc != 2) {
-      return error::make(error::main, "received ", argc - 1, " parameters but expected 1");
-    }
-    return {argv[1]};
-  }();
+  auto const args = std::span<char const *const>(argv, argc).subspan(1);
 
-  return (std::move(path)              //
-          | and_then(find_inputs)      // untested (direct filesystem calls)
-          | and_then(sort_channels)    // tested in sort_channels.cpp
-          | and_then(PcapInputs::make) // untested (direct libpcap calls)
-          | transform(stats::make)     // tested in stats.cpp (minimal) and packet.cpp
-          | transform([](stats const &result) -> int {
+  return (options::make(args) // tested in options.cpp
+          | and_then([](options const &opts) -> std::expected<report, error> {
+              if (opts.feeds) {
+                return find_inputs(opts.path)  // untested (direct filesystem calls)
+                       | and_then(sort_feeds) // tested in sort_channels.cpp
+                       | and_then([&opts](std::vector<feed_file> const &feeds) {
+                           return analyse_feeds(opts, feeds); // untested (direct OS calls)
+                         });
+              }
+              // NOTE: a disabled profiler does nothing, see profiler
+              profiler prof(opts.profile);
+              return [&] {
+                       auto const scope = prof.scope(profile::stage_t::find_inputs);
+                       return find_inputs(opts.path); // untested (direct filesystem calls)
+                     }()
+                     | and_then([&prof](input_files const &files) {
+                         auto const scope = prof.scope(profile::stage_t::sort_channels);
+                         return sort_channels(files); // tested in sort_channels.cpp
+                       })
+                     | and_then([&opts, &prof](pair<std::vector<std::string>> const &segments) {
+                         // untested (direct libpcap and OS calls)
+                         return analyse(opts, segments, prof, [](stats const &so_far) {
+                           std::cout << so_far << '\n' << std::endl; // only in follow mode
+                         });
+                       });
+            })
+          | transform([](report const &result) -> int {
               std::cout << result << std::endl;
               return 0;
             })
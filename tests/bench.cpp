@@ -0,0 +1,115 @@
+#include "temp_directory.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "lib/bench.hpp"
+
+namespace {
+auto result(char const *name, std::uint64_t packets, double seconds) -> bench_result
+{
+  return {.mode = "mmap", .packets = packets, .bytes = packets * 100, .seconds = seconds, .peak_rss_kb = 5000,
+          .name = name};
+}
+} // namespace
+
+TEST_CASE("benchmark results")
+{
+  SECTION("derived measurements")
+  {
+    auto const item = result("mmap/1000", 2000, 0.5);
+    CHECK(item.packets_per_second() == 4000.0);
+    CHECK(item.megabytes_per_second() == 0.4);
+    CHECK(item.ns_per_packet() == 250'000.0);
+    CHECK(bench_result{}.ns_per_packet() == 0.0);
+    CHECK(bench_result{}.packets_per_second() == 0.0);
+  }
+
+  SECTION("written and parsed as JSON")
+  {
+    std::vector<bench_result> const results = {result("mmap/1000", 2000, 0.5), result("a \"quoted\\\" name", 7, 1e-6),
+                                               result("pcap/10000000", 19'980'000, 1.234567891)};
+    std::ostringstream ss;
+    bench::write_json(ss, results);
+    CHECK(bench::parse_json(ss.str()).value() == results);
+
+    std::ostringstream empty;
+    bench::write_json(empty, {});
+    CHECK(empty.str() == "{\"results\": [\n]}\n");
+    CHECK(bench::parse_json(empty.str()).value().empty());
+  }
+
+  SECTION("unknown fields are ignored")
+  {
+    auto const parsed = bench::parse_json(R"({"results": [{"name": "x", "foo": "bar", "packets": 10, "baz": -1.5}]})");
+    CHECK(parsed.value() == std::vector<bench_result>{{.packets = 10, .name = "x"}});
+  }
+
+  SECTION("invalid JSON")
+  {
+    CHECK(bench::parse_json("").error() == error(error::bench, "expected {\"results\": [...]} in baseline"));
+    CHECK(bench::parse_json(R"({"other": []})").error()
+          == error(error::bench, "expected {\"results\": [...]} in baseline"));
+    CHECK(bench::parse_json(R"({"results": [{"name": 1 2}]})").error()
+          == error(error::bench, "invalid result in baseline, at: 2}]}"));
+    CHECK(bench::parse_json(R"({"results": [{}{}]})").error()
+          == error(error::bench, "expected ',' or ']' in baseline, at: {}]}"));
+    CHECK(bench::parse_json(R"({"results": []} extra)").error() == error(error::bench, "unexpected end of baseline"));
+  }
+
+  SECTION("regressions above threshold")
+  {
+    std::vector<bench_result> const baseline = {result("a", 1000, 1.0), result("b", 1000, 1.0),
+                                                result("c", 1000, 1.0)};
+    std::vector<bench_result> const results = {result("a", 1000, 1.05), result("b", 1000, 1.2),
+                                               result("c", 1000, 0.5), result("d", 1000, 10.0)};
+    CHECK(bench::compare(baseline, results, 10).empty() == false);
+    CHECK(bench::compare(baseline, results, 10)
+          == std::vector<bench_regression>{{.name = "b", .baseline_ns_per_packet = 1e6, .ns_per_packet = 1.2e6}});
+    CHECK(bench::compare(baseline, results, 1).size() == 2);
+    CHECK(bench::compare(baseline, results, 50).empty());
+    CHECK(bench::compare({}, results, 0).empty());
+  }
+}
+
+TEST_CASE("benchmark runs")
+{
+  temp_directory const dir;
+  auto const capture = bench::prepare(dir.path.string(), 1000).value();
+  CHECK(capture.directory == dir.file("1000"));
+  CHECK(capture.packets > 1900);
+  CHECK(capture.packets <= 2000);
+  CHECK(std::filesystem::exists(dir.file("1000.done")));
+
+  SECTION("capture is generated only once")
+  {
+    std::ofstream(dir.file("1000.done")) << 1234 << '\n';
+    CHECK(bench::prepare(dir.path.string(), 1000).value()
+          == bench_capture{.directory = capture.directory, .packets = 1234});
+  }
+
+  SECTION("run in this process")
+  {
+    auto const result = bench::run({"--reader=mmap"}, capture).value();
+    CHECK(result.packets == capture.packets);
+    CHECK(result.bytes > 24 * 2 + capture.packets * 16);
+    CHECK(result.seconds > 0);
+    CHECK(result.peak_rss_kb > 0);
+
+    CHECK(bench::run({"--reader=nonsense"}, capture).has_value() == false);
+  }
+
+  SECTION("run in a started process")
+  {
+    auto const missing = dir.file("missing");
+    CHECK(bench::measure(missing, {}, capture).error() == error(error::bench, "failed to start process: " + missing));
+    // NOTE: exits without writing any measurement
+    CHECK(bench::measure("/bin/true", {}, capture).error()
+          == error(error::bench, "process running the pipeline failed, with status 0"));
+  }
+}
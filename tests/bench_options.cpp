@@ -0,0 +1,49 @@
+#include <catch2/catch_all.hpp>
+
+#include <vector>
+
+#include "lib/bench_options.hpp"
+
+namespace {
+auto parse(std::vector<char const *> const &args) { return bench_options::make(args); }
+} // namespace
+
+TEST_CASE("benchmark command line options")
+{
+  SECTION("invalid inputs")
+  {
+    CHECK(parse({}).error() == error(error::main, "received 0 parameters but expected 1"));
+    CHECK(parse({"a", "b"}).error() == error(error::main, "received 2 parameters but expected 1"));
+    CHECK(parse({"--foo", "a"}).error() == error(error::main, "unknown option: --foo"));
+    CHECK(parse({"--sizes=100,0", "a"}).error()
+          == error(error::main, "invalid sizes: 100,0, expected positive numbers of packets"));
+    CHECK(parse({"--sizes", "a"}).error() == error(error::main, "invalid sizes: , expected positive numbers of packets"));
+    CHECK(parse({"--modes=mmap,foo", "a"}).error()
+          == error(error::main,
+                   "unknown mode: foo, expected one of: pcap, mmap, uring, parallel, sharded, prefetch, window, gaps"));
+    CHECK(parse({"--repeat=0", "a"}).error() == error(error::main, "invalid repeat: 0, expected positive number of runs"));
+    CHECK(parse({"--threshold=-5", "a"}).error() == error(error::main, "invalid threshold: -5, expected percent"));
+    CHECK(parse({"--baseline", "a"}).error() == error(error::main, "unknown option: --baseline"));
+    CHECK(parse({"--output=", "a"}).error() == error(error::main, "unknown option: --output="));
+  }
+
+  SECTION("valid inputs")
+  {
+    auto const defaults = parse({"a"}).value();
+    CHECK(defaults == bench_options{.path = "a"});
+    CHECK(defaults.modes.size() == 8);
+    CHECK(defaults.repeat == 3);
+
+    auto const all = parse({"--sizes=1000,20", "--modes=prefetch,pcap", "--repeat=5", "--baseline=x.json",
+                            "--threshold=2.5", "--output=y.json", "b"});
+    CHECK(all.value()
+          == bench_options{.path = "b",
+                           .sizes = {1000, 20},
+                           .modes = {{.name = "prefetch", .args = {"--reader=mmap", "--prefetch"}},
+                                     {.name = "pcap", .args = {"--reader=pcap"}}},
+                           .repeat = 5,
+                           .baseline = "x.json",
+                           .threshold = 2.5,
+                           .output = "y.json"});
+  }
+}
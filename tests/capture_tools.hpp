@@ -0,0 +1,49 @@
+#ifndef TESTS_CAPTURE_TOOLS
+#define TESTS_CAPTURE_TOOLS
+
+#include "savefile_tools.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "lib/packet.hpp"
+#include "lib/savefile.hpp"
+#include "lib/synthetic.hpp"
+
+inline auto at(std::int64_t ns) -> packet::properties::time_point
+{
+  return packet::properties::time_point(std::chrono::nanoseconds(ns));
+}
+
+// Pcap file with nanosecond timestamps, built one record at a time. For every record, frames holds its data as
+// read by inputs, i.e. empty for an incomplete packet; offsets, sequences and timestamps are of packets only.
+struct synthetic_capture final {
+  packet_t file = make_savefile_header(false, savefile::magic_nanoseconds);
+  std::vector<packet_t> frames = {};
+  std::vector<std::uint64_t> offsets = {};
+  std::vector<std::uint32_t> sequences = {};
+  std::vector<packet::properties::time_point> timestamps = {};
+
+  // Record of a packet, see synthetic::frame
+  void append(std::uint32_t sequence, packet::properties::time_point timestamp)
+  {
+    packet_t frame;
+    synthetic::frame(sequence, timestamp, 16, frame);
+    offsets.push_back(file.size());
+    sequences.push_back(sequence);
+    timestamps.push_back(timestamp);
+    append_record(std::move(frame));
+  }
+
+  // Record of any data, e.g. garbage which cannot be parsed; with len other than the size of data, the record is
+  // of an incomplete packet
+  void append_record(packet_t data, std::uint32_t len = 0)
+  {
+    append_savefile_record(data, file, false, 0, 0, len);
+    frames.push_back(len == 0 ? std::move(data) : packet_t{});
+  }
+};
+
+#endif // TESTS_CAPTURE_TOOLS
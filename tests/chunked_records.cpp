@@ -0,0 +1,93 @@
+#include "record_tools.hpp"
+#include "savefile_tools.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "lib/chunked_records.hpp"
+
+namespace {
+// Chunk source reading from memory; requests are completed by finish, in any order
+struct memory_source final {
+  struct request final {
+    std::span<unsigned char> dest;
+    std::size_t offset;
+  };
+
+  packet_t const *file;
+  std::vector<request> requests = std::vector<request>(16);
+  std::size_t offset = 0;
+
+  void start(std::size_t slot, std::span<unsigned char> dest)
+  {
+    requests.at(slot) = {.dest = dest, .offset = offset};
+    offset += dest.size();
+  }
+
+  auto finish(std::size_t slot) -> std::size_t
+  {
+    auto const &req = requests.at(slot);
+    auto const begin = std::min(req.offset, file->size());
+    auto const size = std::min(req.dest.size(), file->size() - begin);
+    std::copy_n(file->begin() + static_cast<std::ptrdiff_t>(begin), size, req.dest.begin());
+    return size;
+  }
+};
+static_assert(some_chunk_source<memory_source>);
+
+using records_t = chunked_records<memory_source>;
+} // namespace
+
+TEST_CASE("chunked records")
+{
+  packet_t file = make_sample_savefile();
+  REQUIRE(savefile_records(file).size() == 200);
+
+  SECTION("invalid header")
+  {
+    packet_t const bad = make_savefile_header(false, 0x0a0d0d0a);
+    CHECK(records_t::make(memory_source{.file = &bad}, {.chunk = 64, .slack = 256, .alignment = 8}).error()
+          == error(error::open_pcap, "unknown file format"));
+
+    packet_t const empty = {};
+    CHECK(records_t::make(memory_source{.file = &empty}, {.chunk = 64, .slack = 256, .alignment = 8}).error()
+          == error(error::open_pcap, "truncated dump file header"));
+  }
+
+  for (std::size_t const buffers : {1, 2, 3, 8}) {
+    for (std::size_t const chunk : {24, 37, 64, 4096, 65536}) {
+      for (std::size_t const count : {1, 7, 256}) {
+        DYNAMIC_SECTION("buffers " << buffers << " chunk " << chunk << " count " << count)
+        {
+          auto records = records_t::make(memory_source{.file = &file},
+                                         {.buffers = buffers, .chunk = chunk, .slack = 256, .alignment = 8});
+          REQUIRE(records.has_value());
+          CHECK(records->header().snaplen == 262144);
+          CHECK(walk_records(*records, count) == savefile_records(file));
+        }
+      }
+    }
+  }
+
+  SECTION("truncated last record")
+  {
+    packet_t truncated = file;
+    truncated.resize(truncated.size() - 1);
+    auto records = records_t::make(memory_source{.file = &truncated}, {.chunk = 37, .slack = 256, .alignment = 8});
+    REQUIRE(records.has_value());
+    CHECK(walk_records(*records, 7).size() == 199);
+  }
+
+  SECTION("record larger than slack")
+  {
+    append_savefile_record(packet_t(300), file);
+    append_savefile_record(packet_t(1), file);
+    auto records = records_t::make(memory_source{.file = &file}, {.chunk = 64, .slack = 256, .alignment = 8});
+    REQUIRE(records.has_value());
+    CHECK(walk_records(*records, 7).size() == 200);
+  }
+}
@@ -0,0 +1,104 @@
+#include <catch2/catch_all.hpp>
+
+#include <netinet/in.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "mock_inputs.hpp"
+#include "packet_tools.hpp"
+
+#include "lib/feed_stats.hpp"
+
+static_assert(some_feed_inputs<MockFeedInputs>);
+static_assert(some_feed_inputs<FeedInputs>);
+
+TEST_CASE("feed stats calculation from inputs")
+{
+  std::vector<std::string> log;
+  auto const logger = [&log]() -> feed_stats::error_callback_t {
+    return [&log](std::string line) { log.push_back(std::move(line)); };
+  };
+
+  SECTION("no channels")
+  {
+    CHECK(feed_stats::make(MockFeedInputs({}), logger()) == feed_stats{});
+    CHECK(log.empty());
+  }
+
+  SECTION("bad packets")
+  {
+    packet::parse_error_counts not_enough_data = {};
+    not_enough_data.record(packet::parse_error::not_enough_data);
+    packet::parse_error_counts not_udp = {};
+    not_udp.record(packet::parse_error::not_udp);
+    packet_t bad = example_packet;
+    REQUIRE(set_ip_protocol(IPPROTO_TCP, bad));
+    feed_stats const expected = {.channels = {"0", "1", "2"},
+                                 .packet_count = {0, 0, 0},
+                                 .dropped_count = {0, 0, 0},
+                                 .first_count = {0, 0, 0},
+                                 .advantage_total_ns = {0, 0, 0},
+                                 .error_count = {not_enough_data, {}, not_udp}};
+    CHECK(feed_stats::make(MockFeedInputs({{{}}, {}, {bad}}), logger()) == expected);
+    CHECK(log == std::vector<std::string>{"0,not enough data", "2,not UDP"});
+  }
+
+  SECTION("three channels")
+  {
+    // Sequence 1 is first in channel 0 by 50ns and dropped by channel 2, sequence 2 is first in channel 2 by 10ns
+    // and dropped by channel 1, sequence 3 is a tie, sequence 4 is only in channel 1, after the others ended
+    feed_stats const expected = {.channels = {"0", "1", "2"},
+                                 .packet_count = {3, 3, 2},
+                                 .dropped_count = {0, 1, 1},
+                                 .first_count = {1, 0, 1},
+                                 .advantage_total_ns = {50, 0, 10},
+                                 .error_count = {{}, {}, {}}};
+    for (std::size_t const batch_size : {1, 2, 256}) {
+      auto const inputs = [&] {
+        return MockFeedInputs({{make_packet(1, 100), make_packet(2, 200), make_packet(3, 300)},
+                               {make_packet(1, 150), make_packet(3, 250), make_packet(4, 400)},
+                               {make_packet(2, 190), make_packet(3, 250), make_packet(1, 10), make_packet(3, 260)}},
+                              batch_size);
+      };
+
+      log.clear();
+      CHECK(feed_stats::make(inputs(), logger()) == expected);
+      CHECK(log == std::vector<std::string>{"2,out of sequence"});
+
+      // Same as above, but through dynamic dispatch
+      log.clear();
+      auto dynamic = inputs();
+      CHECK(feed_stats::make(static_cast<FeedInputs &&>(dynamic), logger()) == expected);
+      CHECK(log == std::vector<std::string>{"2,out of sequence"});
+    }
+
+    CHECK(expected.advantage_ns() == std::vector<double>{50, 0, 10});
+  }
+}
+
+TEST_CASE("feed stats printing")
+{
+  feed_stats const stats = {.channels = {"14310", "15310"},
+                            .packet_count = {3, 2},
+                            .dropped_count = {0, 1},
+                            .first_count = {2, 0},
+                            .advantage_total_ns = {5, 0}};
+  std::ostringstream ss;
+  ss << stats;
+  CHECK(ss.str()
+        == "packet count: (14310=3, 15310=2)\n"
+           "dropped packets count: (14310=0, 15310=1)\n"
+           "first arrivals count: (14310=2, 15310=0)\n"
+           "average advantage in ns: (14310=2.5, 15310=0)");
+
+  // Only reasons which occurred are printed, for all channels
+  auto with_errors = stats;
+  with_errors.error_count.resize(2);
+  with_errors.error_count[1].record(packet::parse_error::not_udp);
+  std::ostringstream errors;
+  errors << with_errors;
+  CHECK(errors.str().ends_with("average advantage in ns: (14310=2.5, 15310=0)\n"
+                               "parse errors, not UDP: (14310=0, 15310=1)"));
+}
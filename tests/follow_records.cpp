@@ -0,0 +1,103 @@
+#include "record_tools.hpp"
+#include "savefile_tools.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "lib/follow_records.hpp"
+
+namespace {
+// File in memory which is "written" step bytes at a time, on every wait; stops waiting when all is written
+struct growing_source final {
+  packet_t const *file;
+  std::size_t step;
+  std::size_t written = 0;
+  std::size_t offset = 0;
+  std::size_t waits = 0;
+
+  auto read(std::span<unsigned char> dest) -> std::size_t
+  {
+    auto const size = std::min(dest.size(), written - offset);
+    std::copy_n(file->begin() + static_cast<std::ptrdiff_t>(offset), size, dest.begin());
+    offset += size;
+    return size;
+  }
+
+  auto wait() -> bool
+  {
+    if (written == file->size()) {
+      return false;
+    }
+    ++waits;
+    written = std::min(written + step, file->size());
+    return true;
+  }
+};
+static_assert(some_follow_source<growing_source>);
+
+using records_t = follow_records<growing_source>;
+} // namespace
+
+TEST_CASE("follow records")
+{
+  packet_t const file = make_sample_savefile();
+  REQUIRE(savefile_records(file).size() == 200);
+
+  SECTION("invalid header")
+  {
+    packet_t const bad = make_savefile_header(false, 0x0a0d0d0a);
+    CHECK(records_t::make(growing_source{.file = &bad, .step = 1}).error()
+          == error(error::open_pcap, "unknown file format"));
+
+    packet_t const empty = {};
+    CHECK(records_t::make(growing_source{.file = &empty, .step = 1}).error()
+          == error(error::open_pcap, "truncated dump file header"));
+  }
+
+  for (std::size_t const step : {1, 7, 24, 4096, 65536}) {
+    for (std::size_t const size : {1, 64, 1024 * 1024}) {
+      for (std::size_t const count : {1, 7, 256}) {
+        DYNAMIC_SECTION("step " << step << " size " << size << " count " << count)
+        {
+          auto records = records_t::make(growing_source{.file = &file, .step = step}, size);
+          REQUIRE(records.has_value());
+          CHECK(records->header().snaplen == 262144);
+          CHECK(walk_records(*records, count) == savefile_records(file));
+        }
+      }
+    }
+  }
+
+  SECTION("peek waits for the first record")
+  {
+    auto records = records_t::make(growing_source{.file = &file, .step = 1});
+    REQUIRE(records.has_value());
+    auto const first = records->peek();
+    REQUIRE(first.has_value());
+    CHECK(first->data.empty()); // i % 101 == 0
+    CHECK(walk_records(*records, 7) == savefile_records(file));
+  }
+
+  SECTION("batch holds records written so far")
+  {
+    auto records = records_t::make(growing_source{.file = &file, .step = file.size() / 4});
+    REQUIRE(records.has_value());
+    auto const first = records->next(256, [](savefile::record const &) {});
+    CHECK(first > 0);
+    CHECK(first < 100);
+    CHECK(first + walk_records(*records, 256).size() == 200);
+  }
+
+  SECTION("truncated last record")
+  {
+    packet_t truncated = file;
+    truncated.resize(truncated.size() - 1);
+    auto records = records_t::make(growing_source{.file = &truncated, .step = 37});
+    REQUIRE(records.has_value());
+    CHECK(walk_records(*records, 7).size() == 199);
+  }
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch_all.hpp>
+
+#include <vector>
+
+#include "lib/generate_options.hpp"
+
+namespace {
+auto parse(std::vector<char const *> const &args) { return generate_options::make(args); }
+using kind_t = generate_options::latency_t::kind_t;
+} // namespace
+
+TEST_CASE("generator command line options")
+{
+  SECTION("invalid inputs")
+  {
+    CHECK(parse({}).error() == error(error::main, "received 0 parameters but expected 1"));
+    CHECK(parse({"a", "b"}).error() == error(error::main, "received 2 parameters but expected 1"));
+    CHECK(parse({"--foo", "a"}).error() == error(error::main, "unknown option: --foo"));
+    CHECK(parse({"--packets=0", "a"}).error()
+          == error(error::main, "invalid packets: 0, expected positive number of packets"));
+    CHECK(parse({"--packets=1k", "a"}).error()
+          == error(error::main, "invalid packets: 1k, expected positive number of packets"));
+    CHECK(parse({"--first=-1", "a"}).error() == error(error::main, "invalid first: -1, expected sequence number"));
+    CHECK(parse({"--rate=0", "a"}).error()
+          == error(error::main, "invalid rate: 0, expected positive number of packets per second"));
+    CHECK(parse({"--payload=3", "a"}).error()
+          == error(error::main, "invalid payload: 3, expected size or range of sizes between 4 and 1472"));
+    CHECK(parse({"--payload=100-50", "a"}).error()
+          == error(error::main, "invalid payload: 100-50, expected size or range of sizes between 4 and 1472"));
+    CHECK(parse({"--payload=16-1473", "a"}).error()
+          == error(error::main, "invalid payload: 16-1473, expected size or range of sizes between 4 and 1472"));
+    CHECK(parse({"--drop=1.5", "a"}).error()
+          == error(error::main, "invalid drop: 1.5, expected probability between 0 and 1, or two separated with ','"));
+    CHECK(parse({"--reorder=0.1,", "a"}).error()
+          == error(error::main,
+                   "invalid reorder: 0.1,, expected probability between 0 and 1, or two separated with ','"));
+    CHECK(parse({"--duplicate=nan", "a"}).error()
+          == error(error::main,
+                   "invalid duplicate: nan, expected probability between 0 and 1, or two separated with ','"));
+    for (char const *latency : {"--latency=foo:1", "--latency=constant", "--latency=uniform:100",
+                                "--latency=exponential:100:10", "--latency=normal:-1:10"}) {
+      CHECK(parse({latency, "a"}).error().what().starts_with("invalid latency: "));
+    }
+    CHECK(parse({"--segment=0", "a"}).error()
+          == error(error::main, "invalid segment: 0, expected positive number of packets"));
+    CHECK(parse({"--seed=x", "a"}).error() == error(error::main, "invalid seed: x, expected number"));
+    CHECK(parse({"--prefix=a/b", "a"}).error() == error(error::main, "invalid prefix: a/b, expected file name"));
+    CHECK(parse({"--first=4294967295", "--packets=2", "a"}).error()
+          == error(error::main, "too many packets: 2 after first sequence number 4294967295"));
+  }
+
+  SECTION("valid inputs")
+  {
+    CHECK(parse({"a"}).value() == generate_options{.path = "a"});
+    CHECK(parse({"--first=4294967295", "--packets=1", "a"}).value()
+          == generate_options{.path = "a", .packets = 1, .first_sequence = 4294967295});
+
+    auto const all = parse({"--packets=1000", "--first=7", "--rate=2.5e6", "--payload=4-1472", "--drop=0.01",
+                            "--reorder=0,0.5", "--duplicate=1,0", "--latency=uniform:800:100,normal:900:50.5",
+                            "--segment=100", "--seed=42", "--prefix=test", "b"});
+    CHECK(all.value()
+          == generate_options{.path = "b",
+                              .prefix = "test",
+                              .packets = 1000,
+                              .first_sequence = 7,
+                              .rate = 2.5e6,
+                              .payload_min = 4,
+                              .payload_max = 1472,
+                              .drop = {.A = 0.01, .B = 0.01},
+                              .reorder = {.A = 0, .B = 0.5},
+                              .duplicate = {.A = 1, .B = 0},
+                              .latency = {.A = {.kind = kind_t::uniform, .mean_ns = 800, .jitter_ns = 100},
+                                          .B = {.kind = kind_t::normal, .mean_ns = 900, .jitter_ns = 50.5}},
+                              .segment_packets = 100,
+                              .seed = 42});
+    CHECK(parse({"--latency=constant:0", "--payload=100", "c"}).value()
+          == generate_options{.path = "c",
+                              .payload_min = 100,
+                              .payload_max = 100,
+                              .latency = {.A = {.kind = kind_t::constant}, .B = {.kind = kind_t::constant}}});
+  }
+}
@@ -0,0 +1,112 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstdint>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "lib/interval_set.hpp"
+
+namespace {
+using interval = interval_set::interval;
+
+auto print(interval_set const &set) -> std::string
+{
+  std::ostringstream ss;
+  ss << set;
+  return ss.str();
+}
+} // namespace
+
+TEST_CASE("interval set")
+{
+  interval_set set;
+  CHECK(set.empty());
+  CHECK(set.size() == 0);
+  CHECK(print(set) == "none");
+  CHECK(not set.erase(1));
+
+  SECTION("insert in order")
+  {
+    set.insert(5, 7);
+    set.insert(8);
+    set.insert(10);
+    set.insert(12, 20);
+    CHECK(set.intervals() == std::vector<interval>{{5, 8}, {10, 10}, {12, 20}});
+    CHECK(set.size() == 14);
+    CHECK(print(set) == "5-8, 10, 12-20");
+    CHECK(set.contains(5));
+    CHECK(set.contains(8));
+    CHECK(not set.contains(9));
+    CHECK(set.contains(10));
+    CHECK(not set.contains(21));
+    CHECK(not set.contains(0));
+  }
+
+  SECTION("insert out of order")
+  {
+    set.insert(100);
+    set.insert(10, 20);
+    set.insert(50, 60);
+    CHECK(set.intervals() == std::vector<interval>{{10, 20}, {50, 60}, {100, 100}});
+    set.insert(21, 49); // adjacent on both sides
+    CHECK(set.intervals() == std::vector<interval>{{10, 60}, {100, 100}});
+    set.insert(5, 101); // overlapping everything
+    CHECK(set.intervals() == std::vector<interval>{{5, 101}});
+    set.insert(20, 30); // already included
+    CHECK(set.intervals() == std::vector<interval>{{5, 101}});
+    set.insert(1, 2);
+    CHECK(set.intervals() == std::vector<interval>{{1, 2}, {5, 101}});
+    set.insert(3);
+    CHECK(set.intervals() == std::vector<interval>{{1, 3}, {5, 101}});
+    set.insert(7, 6); // empty
+    CHECK(set.size() == 100);
+  }
+
+  SECTION("erase")
+  {
+    set.insert(5, 10);
+    set.insert(20);
+    CHECK(set.erase(20));
+    CHECK(not set.erase(20));
+    CHECK(set.erase(5));
+    CHECK(set.erase(10));
+    CHECK(set.intervals() == std::vector<interval>{{6, 9}});
+    CHECK(set.erase(7));
+    CHECK(set.intervals() == std::vector<interval>{{6, 6}, {8, 9}});
+    CHECK(not set.erase(7));
+  }
+
+  SECTION("limits")
+  {
+    set.insert(UINT32_MAX);
+    set.insert(0);
+    set.insert(UINT32_MAX - 1);
+    CHECK(set.intervals() == std::vector<interval>{{0, 0}, {UINT32_MAX - 1, UINT32_MAX}});
+    CHECK(set.erase(UINT32_MAX));
+    CHECK(set.size() == 2);
+  }
+
+  SECTION("same as std::set")
+  {
+    std::set<std::uint32_t> expected;
+    for (std::uint32_t i = 0; i < 2000; ++i) {
+      auto const value = (i * 7919u) % 1000u;
+      if (i % 3 == 0) {
+        CHECK(set.erase(value) == (expected.erase(value) > 0));
+      } else {
+        set.insert(value);
+        expected.insert(value);
+      }
+    }
+    CHECK(set.size() == expected.size());
+    std::size_t wrong = 0;
+    for (std::uint32_t value = 0; value < 1000; ++value) {
+      wrong += set.contains(value) == expected.contains(value) ? 0 : 1;
+    }
+    CHECK(wrong == 0);
+    for (std::size_t i = 1; i < set.intervals().size(); ++i) {
+      CHECK(set.intervals()[i - 1].last + 1 < set.intervals()[i].first);
+    }
+  }
+}
@@ -0,0 +1,75 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "lib/latency_histogram.hpp"
+
+TEST_CASE("latency histogram")
+{
+  using T = latency_histogram;
+
+  SECTION("buckets")
+  {
+    // Small values are exact
+    for (std::uint64_t value = 0; value < 2 * T::half; ++value) {
+      CHECK(T::bucket(value) == value);
+      CHECK(T::highest(T::bucket(value)) == value);
+    }
+
+    // Buckets are contiguous, and every value is within precision of the highest value in its bucket
+    std::size_t last = T::bucket(2 * T::half - 1);
+    std::size_t wrong = 0;
+    for (std::uint64_t value = 2 * T::half; value < (std::uint64_t{1} << 20); ++value) {
+      auto const bucket = T::bucket(value);
+      bool const contiguous = bucket == last || bucket == last + 1;
+      bool const precise = T::highest(bucket) >= value && T::highest(bucket) - value <= value / T::half;
+      wrong += (contiguous && precise) ? 0 : 1;
+      last = bucket;
+    }
+    CHECK(wrong == 0);
+    CHECK(last == T::bucket((std::uint64_t{1} << 20) - 1));
+
+    CHECK(T::bucket((std::uint64_t{1} << T::value_bits) - 1) == T::bucket_count - 1);
+    CHECK(T::bucket(std::uint64_t{1} << T::value_bits) == T::bucket_count - 1);
+    CHECK(T::bucket(~std::uint64_t{0}) == T::bucket_count - 1);
+    CHECK(T::highest(T::bucket_count - 1) == (std::uint64_t{1} << T::value_bits) - 1);
+  }
+
+  SECTION("percentiles")
+  {
+    T histogram;
+    CHECK(histogram.percentile(50.0) == 0);
+    CHECK(histogram.max == 0);
+
+    for (std::uint64_t value = 1; value <= 1000; ++value) {
+      histogram.record(value);
+    }
+    CHECK(histogram.count == 1000);
+    CHECK(histogram.max == 1000);
+    CHECK(histogram.percentile(0.0) == 1);
+    CHECK(histogram.percentile(50.0) == 503);  // 500 within 1/64
+    CHECK(histogram.percentile(99.0) == 991);  // 990 within 1/64
+    CHECK(histogram.percentile(99.9) == 999);
+    CHECK(histogram.percentile(100.0) == 1000); // 1007, but never more than max
+
+    histogram.record(1'000'000);
+    CHECK(histogram.max == 1'000'000);
+    CHECK(histogram.percentile(99.9) == 1007); // 1000 within 1/64
+    CHECK(histogram.percentile(100.0) == 1'000'000);
+  }
+
+  SECTION("merge")
+  {
+    T a;
+    T b;
+    T all;
+    for (std::uint64_t value = 0; value < 5000; value += 3) {
+      (value % 2 == 0 ? a : b).record(value * value);
+      all.record(value * value);
+    }
+    CHECK(a + b == all);
+    CHECK(b + a == all);
+    CHECK(a + T{} == a);
+  }
+}
@@ -0,0 +1,108 @@
+#include "packet_tools.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <vector>
+
+#include "lib/link_layer.hpp"
+#include "lib/parse_batch.hpp"
+
+namespace {
+// Insert 802.1Q or 802.1ad tag after destination and source MAC address
+auto add_tag(packet_t frame, std::uint16_t tpid, std::uint16_t vlan) -> packet_t
+{
+  packet_t const tag = {static_cast<unsigned char>(tpid >> 8), static_cast<unsigned char>(tpid & 0xFF),
+                        static_cast<unsigned char>(vlan >> 8), static_cast<unsigned char>(vlan & 0xFF)};
+  frame.insert(frame.begin() + 12, tag.begin(), tag.end());
+  return frame;
+}
+
+// Replace Ethernet header with Linux cooked capture header
+auto make_sll(packet_t const &frame) -> packet_t
+{
+  packet_t ret = {0x00, 0x00, 0x00, 0x01, 0x00, 0x06, 0x10, 0x0e, 0x7e, 0xe7, 0x20, 0x44, 0x00, 0x00};
+  ret.insert(ret.end(), frame.begin() + 12, frame.end()); // protocol, followed by IPv4
+  return ret;
+}
+
+auto make_sll2(packet_t const &frame) -> packet_t
+{
+  packet_t ret = {frame[12], frame[13], 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x01,
+                  0x00,      0x06,      0x10, 0x0e, 0x7e, 0xe7, 0x20, 0x44, 0x00, 0x00};
+  ret.insert(ret.end(), frame.begin() + 14, frame.end());
+  return ret;
+}
+} // namespace
+
+TEST_CASE("link layer detection")
+{
+  using packet::link_t;
+  packet_t const vlan = add_tag(example_packet, 0x8100, 42);
+
+  CHECK(packet::detect_link(packet::linktype_ethernet, example_packet) == link_t::ethernet);
+  CHECK(packet::detect_link(packet::linktype_ethernet, {}) == link_t::ethernet);
+  CHECK(packet::detect_link(packet::linktype_ethernet, vlan) == link_t::vlan);
+  CHECK(packet::detect_link(packet::linktype_ethernet, add_tag(vlan, 0x88a8, 7)) == link_t::qinq);
+  CHECK(packet::detect_link(packet::linktype_ethernet, add_tag(vlan, 0x8100, 7)) == link_t::qinq);
+  CHECK(packet::detect_link(packet::linktype_ethernet, add_tag(vlan, 0x9100, 7)) == link_t::qinq);
+  CHECK(packet::detect_link(packet::linktype_linux_sll, example_packet) == link_t::sll);
+  CHECK(packet::detect_link(packet::linktype_linux_sll2, {}) == link_t::sll2);
+  CHECK(packet::detect_link(12345, vlan) == link_t::vlan);
+}
+
+TEST_CASE("batch packet parsing with link layer")
+{
+  using packet::link_t;
+  packet_t not_udp = example_packet;
+  set_ip_protocol(IPPROTO_TCP, not_udp);
+  std::vector<packet_t> const ethernet = {example_packet, not_udp, packet_t(40)};
+
+  auto const check = [&ethernet](link_t link, auto &&wrap) {
+    std::vector<packet_t> frames;
+    for (auto const &frame : ethernet) {
+      frames.push_back(frame.size() < 14 + 20 ? frame : wrap(frame));
+    }
+    std::vector<packet::data_t> const views(frames.begin(), frames.end());
+    for (auto const level : {packet::simd_level::scalar, packet::simd_level::sse2, packet::simd_level::avx2}) {
+      packet::batch_properties parsed;
+      packet::parse_batch(views, parsed, link, level);
+      REQUIRE(parsed.size() == ethernet.size());
+      for (std::size_t i = 0; i < ethernet.size(); ++i) {
+        CHECK(parsed.at(i) == packet::parse(ethernet[i]));
+      }
+    }
+  };
+
+  SECTION("ethernet")
+  {
+    check(link_t::ethernet, [](packet_t const &frame) { return frame; });
+  }
+
+  SECTION("vlan")
+  {
+    check(link_t::vlan, [](packet_t const &frame) { return add_tag(frame, 0x8100, 42); });
+  }
+
+  SECTION("qinq")
+  {
+    check(link_t::qinq, [](packet_t const &frame) { return add_tag(add_tag(frame, 0x8100, 42), 0x88a8, 7); });
+  }
+
+  SECTION("sll")
+  {
+    check(link_t::sll, make_sll);
+  }
+
+  SECTION("sll2")
+  {
+    check(link_t::sll2, make_sll2);
+  }
+
+  SECTION("unexpected encapsulation")
+  {
+    packet::batch_properties parsed;
+    std::vector<packet::data_t> const views = {example_packet};
+    packet::parse_batch(views, parsed, link_t::vlan);
+    CHECK(parsed.at(0).error() == packet::parse_error::not_ipv4);
+  }
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "lib/loser_tree.hpp"
+
+namespace {
+// Merge sorted inputs with loser_tree, returning (input, key) in the order of winners
+auto merge(std::vector<std::vector<int>> const &inputs) -> std::vector<std::pair<std::size_t, int>>
+{
+  std::vector<std::size_t> next(inputs.size());
+  auto const pull = [&](std::size_t i) -> std::optional<int> {
+    if (next[i] < inputs[i].size()) {
+      return inputs[i][next[i]++];
+    }
+    return std::nullopt;
+  };
+
+  std::vector<std::optional<int>> keys;
+  for (std::size_t i = 0; i < inputs.size(); ++i) {
+    keys.push_back(pull(i));
+  }
+  loser_tree<int> tree(std::move(keys));
+  std::vector<std::pair<std::size_t, int>> ret;
+  while (not tree.empty()) {
+    auto const winner = tree.winner();
+    ret.emplace_back(winner, *tree.key(winner));
+    tree.replace(pull(winner));
+  }
+  return ret;
+}
+} // namespace
+
+TEST_CASE("loser tree")
+{
+  using T = std::vector<std::pair<std::size_t, int>>;
+
+  SECTION("no inputs")
+  {
+    loser_tree<int> const tree({});
+    CHECK(tree.size() == 0);
+    CHECK(tree.empty());
+  }
+
+  SECTION("single input")
+  {
+    CHECK(merge({{}}) == T{});
+    CHECK(merge({{1, 2, 3}}) == T{{0, 1}, {0, 2}, {0, 3}});
+  }
+
+  SECTION("ties are won by the lower input")
+  {
+    CHECK(merge({{1, 2}, {1, 2}, {1}}) == T{{0, 1}, {1, 1}, {2, 1}, {0, 2}, {1, 2}});
+    CHECK(merge({{2}, {}, {1, 2}}) == T{{2, 1}, {0, 2}, {2, 2}});
+  }
+
+  SECTION("any number of inputs")
+  {
+    for (std::size_t size = 1; size <= 9; ++size) {
+      std::vector<std::vector<int>> inputs(size);
+      std::vector<int> expected;
+      for (std::size_t i = 0; i < size; ++i) {
+        for (int j = 0; j < 20; ++j) {
+          if ((j * 7 + static_cast<int>(i) * 3) % 5 != 0) {
+            inputs[i].push_back(j * 3 + static_cast<int>(i % 2));
+            expected.push_back(inputs[i].back());
+          }
+        }
+      }
+      std::ranges::sort(expected);
+
+      auto const merged = merge(inputs);
+      REQUIRE(merged.size() == expected.size());
+      for (std::size_t i = 0; i < merged.size(); ++i) {
+        CHECK(merged[i].second == expected[i]);
+      }
+    }
+  }
+}
@@ -0,0 +1,111 @@
+#include "mock_inputs.hpp"
+#include "packet_tools.hpp"
+#include "temp_directory.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "lib/match_export.hpp"
+#include "lib/stats.hpp"
+
+namespace {
+using time_point = match_export::time_point;
+
+auto at(std::int64_t ns) -> time_point { return time_point(std::chrono::nanoseconds(ns)); }
+
+// Column of fixed width numbers, as written by match_export
+template <typename T> auto read_column(std::string const &filename) -> std::vector<T>
+{
+  auto const data = temp_directory::read(filename);
+  std::vector<T> ret(data.size() / sizeof(T));
+  std::memcpy(ret.data(), data.data(), ret.size() * sizeof(T));
+  return ret;
+}
+} // namespace
+
+TEST_CASE("match export")
+{
+  temp_directory const dir;
+
+  SECTION("invalid prefix")
+  {
+    auto const prefix = dir.file("missing/some");
+    CHECK(match_export::make(prefix).error()
+          == error(error::write_export, "failed to create file: " + prefix + ".sequence.u32"));
+  }
+
+  SECTION("columns are written in order of rows")
+  {
+    using status_t = match_export::status_t;
+    auto const prefix = dir.file("some");
+    auto output = match_export::make(prefix).value();
+
+    // NOTE: more rows than fit in one buffer, so that some are written in the background before close
+    constexpr std::size_t count = match_export::buffer_rows + 10;
+    std::vector<std::uint32_t> sequences;
+    std::vector<std::int64_t> a_timestamps;
+    std::vector<std::int64_t> b_timestamps;
+    std::vector<std::int64_t> deltas;
+    std::vector<status_t> statuses;
+    for (std::size_t i = 0; i < count; ++i) {
+      auto const sequence = static_cast<std::uint32_t>(i + 1);
+      auto const a = packet::properties{.timestamp = at(1000 * std::int64_t{sequence}), .sequence = sequence};
+      auto const b = packet::properties{.timestamp = at(1000 * std::int64_t{sequence} + 7), .sequence = sequence};
+      sequences.push_back(sequence);
+      switch (i % 3) {
+      case 0:
+        output.matched(a, b);
+        a_timestamps.push_back(a.timestamp.time_since_epoch().count());
+        b_timestamps.push_back(b.timestamp.time_since_epoch().count());
+        deltas.push_back(7);
+        statuses.push_back(status_t::matched);
+        break;
+      case 1:
+        output.dropped(pair_select::A, b);
+        a_timestamps.push_back(0);
+        b_timestamps.push_back(b.timestamp.time_since_epoch().count());
+        deltas.push_back(0);
+        statuses.push_back(status_t::dropped_a);
+        break;
+      default:
+        output.dropped(pair_select::B, a);
+        a_timestamps.push_back(a.timestamp.time_since_epoch().count());
+        b_timestamps.push_back(0);
+        deltas.push_back(0);
+        statuses.push_back(status_t::dropped_b);
+        break;
+      }
+    }
+    CHECK(output.rows() == count);
+    REQUIRE(output.close().has_value());
+
+    CHECK(read_column<std::uint32_t>(prefix + ".sequence.u32") == sequences);
+    CHECK(read_column<std::int64_t>(prefix + ".a_timestamp.i64") == a_timestamps);
+    CHECK(read_column<std::int64_t>(prefix + ".b_timestamp.i64") == b_timestamps);
+    CHECK(read_column<std::int64_t>(prefix + ".delta.i64") == deltas);
+    CHECK(read_column<status_t>(prefix + ".status.u8") == statuses);
+  }
+
+  SECTION("rows of the merge loop within range")
+  {
+    std::vector<packet_t> packets;
+    for (std::uint32_t i = 1; i <= 10; ++i) {
+      packets.push_back(make_packet(i, i * 1000L));
+    }
+    auto const prefix = dir.file("range");
+    auto output = match_export::make(prefix).value();
+    auto const range = packet_range{.from = std::uint32_t{3}, .to = std::uint32_t{6}};
+    auto const result = stats::make(MockInputs(packets, packets, 4), merge_extras{.range = range, .output = &output});
+    CHECK(result.packet_count == pair<std::size_t>{.A = 4, .B = 4});
+    REQUIRE(output.close().has_value());
+
+    CHECK(read_column<std::uint32_t>(prefix + ".sequence.u32") == std::vector<std::uint32_t>{3, 4, 5, 6});
+    CHECK(read_column<match_export::status_t>(prefix + ".status.u8")
+          == std::vector<match_export::status_t>(4, match_export::status_t::matched));
+  }
+}
@@ -1,18 +1,33 @@
 #ifndef TESTS_MOCK_INPUTS
 #define TESTS_MOCK_INPUTS
 
+#include "lib/feed_inputs.hpp"
 #include "lib/inputs.hpp"
 #include "lib/pair.hpp"
 
+#include <algorithm>
 #include <initializer_list>
+#include <vector>
 
 using packet_t = std::vector<unsigned char>;
 
 struct MockInputs : Inputs {
-  MockInputs(pair<std::initializer_list<packet_t>> inputs)
-      : cursor_{.A = 0, .B = 0}, inputs_{.A = inputs.A, .B = inputs.B}
+  MockInputs(pair<std::initializer_list<packet_t>> inputs, std::size_t batch_size = Inputs::batch_size,
+             packet::link_t link = packet::link_t::ethernet)
+      : cursor_{.A = 0, .B = 0}, inputs_{.A = inputs.A, .B = inputs.B}, batch_size_(batch_size), link_(link)
   {
   }
+  MockInputs(std::vector<packet_t> a, std::vector<packet_t> b, std::size_t batch_size = Inputs::batch_size)
+      : cursor_{.A = 0, .B = 0}, inputs_{.A = std::move(a), .B = std::move(b)}, batch_size_(batch_size),
+        link_(packet::link_t::ethernet)
+  {
+  }
+
+  // Hides Inputs::next_batch, to enable static dispatch in stats::make
+  auto next_batch(pair_select which) -> batch_t
+  {
+    return which == pair_select::A ? batch_(cursor_.A, inputs_.A, views_a_) : batch_(cursor_.B, inputs_.B, views_b_);
+  }
 
 private:
   static auto next_(std::size_t &next, std::vector<packet_t> const &input, auto &&callback) -> bool
@@ -33,8 +48,58 @@ private:
     return next_(cursor_.B, inputs_.B, std::move(fn));
   }
 
+  auto batch_(std::size_t &next, std::vector<packet_t> const &input, std::vector<data_t> &views) -> batch_t
+  {
+    views.clear();
+    auto const end = std::min(input.size(), next + batch_size_);
+    for (; next < end; ++next) {
+      views.emplace_back(input[next].data(), input[next].size());
+    }
+    return views;
+  }
+  auto batch_a() -> batch_t override { return next_batch(pair_select::A); }
+  auto batch_b() -> batch_t override { return next_batch(pair_select::B); }
+  auto link_a() const -> packet::link_t override { return link_; }
+  auto link_b() const -> packet::link_t override { return link_; }
+
   pair<std::size_t> cursor_;
   pair<std::vector<packet_t>> inputs_;
+  // NOTE: not pair<std::vector<data_t>> because std::span has no operator==, which pair<> would need
+  std::vector<data_t> views_a_ = {};
+  std::vector<data_t> views_b_ = {};
+  std::size_t batch_size_;
+  packet::link_t link_;
+};
+
+struct MockFeedInputs : FeedInputs {
+  MockFeedInputs(std::initializer_list<std::vector<packet_t>> inputs, std::size_t batch_size = FeedInputs::batch_size)
+      : inputs_(inputs), cursor_(inputs_.size()), views_(inputs_.size()), batch_size_(batch_size)
+  {
+  }
+
+  // Hides FeedInputs::next_batch, to enable static dispatch in feed_stats::make
+  auto next_batch(std::size_t channel) -> batch_t
+  {
+    auto &views = views_[channel];
+    auto &next = cursor_[channel];
+    auto const &input = inputs_[channel];
+    views.clear();
+    auto const end = std::min(input.size(), next + batch_size_);
+    for (; next < end; ++next) {
+      views.emplace_back(input[next].data(), input[next].size());
+    }
+    return views;
+  }
+
+private:
+  auto channels_() const -> std::size_t override { return inputs_.size(); }
+  auto batch_(std::size_t channel) -> batch_t override { return next_batch(channel); }
+  auto link_(std::size_t) const -> packet::link_t override { return packet::link_t::ethernet; }
+
+  std::vector<std::vector<packet_t>> inputs_;
+  std::vector<std::size_t> cursor_;
+  std::vector<std::vector<data_t>> views_;
+  std::size_t batch_size_;
 };
 
 #endif // TESTS_MOCK_INPUTS
@@ -0,0 +1,124 @@
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <vector>
+
+#include "lib/options.hpp"
+
+namespace {
+auto parse(std::vector<char const *> const &args) { return options::make(args); }
+} // namespace
+
+TEST_CASE("command line options")
+{
+  SECTION("invalid inputs")
+  {
+    CHECK(parse({}).error() == error(error::main, "received 0 parameters but expected 1"));
+    CHECK(parse({"a", "b"}).error() == error(error::main, "received 2 parameters but expected 1"));
+    CHECK(parse({"--reader=mmap"}).error() == error(error::main, "received 0 parameters but expected 1"));
+    CHECK(parse({"--foo", "a"}).error() == error(error::main, "unknown option: --foo"));
+    CHECK(parse({"--reader=foo", "a"}).error()
+          == error(error::main, "unknown reader: foo, expected one of: pcap, mmap, uring, parallel, sharded"));
+    CHECK(parse({"--reader", "a"}).error() == error(error::main, "unknown reader: , expected one of: pcap, mmap, uring, parallel, sharded"));
+    CHECK(parse({"--prefetch=1", "a"}).error() == error(error::main, "unknown option: --prefetch=1"));
+    CHECK(parse({"--throughput=1", "a"}).error() == error(error::main, "unknown option: --throughput=1"));
+    CHECK(parse({"--reader=parallel", "--prefetch", "a"}).error()
+          == error(error::main, "option --prefetch cannot be used with --reader=parallel"));
+    CHECK(parse({"--reader=sharded", "--prefetch", "a"}).error()
+          == error(error::main, "option --prefetch cannot be used with --reader=sharded"));
+    CHECK(parse({"--feeds=1", "a"}).error() == error(error::main, "unknown option: --feeds=1"));
+    CHECK(parse({"--feeds", "--prefetch", "a"}).error()
+          == error(error::main, "options --reader and --prefetch cannot be used with --feeds"));
+    CHECK(parse({"--reader=pcap", "--feeds", "a"}).error()
+          == error(error::main, "options --reader and --prefetch cannot be used with --feeds"));
+    CHECK(parse({"--gaps=1", "a"}).error() == error(error::main, "unknown option: --gaps=1"));
+    CHECK(parse({"--window=0", "a"}).error()
+          == error(error::main, "invalid window: 0, expected positive number of packets"));
+    CHECK(parse({"--window=-1", "a"}).error()
+          == error(error::main, "invalid window: -1, expected positive number of packets"));
+    CHECK(parse({"--window", "a"}).error() == error(error::main, "invalid window: , expected positive number of packets"));
+    CHECK(parse({"--profile=1", "a"}).error() == error(error::main, "unknown option: --profile=1"));
+    CHECK(parse({"--from=x", "a"}).error()
+          == error(error::main, "invalid from: x, expected sequence number or UTC time e.g. 2023-11-14T14:30:00.5"));
+    CHECK(parse({"--to=", "a"}).error()
+          == error(error::main, "invalid to: , expected sequence number or UTC time e.g. 2023-11-14T14:30:00.5"));
+    CHECK(parse({"--from=10", "--to=9", "a"}).error() == error(error::main, "option --from cannot be after --to"));
+    CHECK(parse({"--from=2023-11-14T14:30:01", "--to=2023-11-14T14:30:00", "a"}).error()
+          == error(error::main, "option --from cannot be after --to"));
+    CHECK(parse({"--export=", "a"}).error()
+          == error(error::main, "invalid export: , expected prefix of output files"));
+    CHECK(parse({"--cache=1", "a"}).error() == error(error::main, "unknown option: --cache=1"));
+    for (char const *other : {"--reader=pcap", "--prefetch", "--follow", "--feeds"}) {
+      CHECK(parse({"--cache", other, "a"}).error()
+            == error(error::main, "option --cache cannot be used with --reader, --prefetch, --follow or --feeds"));
+    }
+    for (char const *extra : {"--gaps", "--window=8", "--profile", "--from=1", "--to=9", "--export=x"}) {
+      for (char const *other : {"--reader=sharded", "--follow", "--feeds"}) {
+        CHECK(parse({extra, other, "a"}).error()
+              == error(error::main, "options --gaps, --window, --profile, --from, --to and --export cannot be used "
+                                    "with --reader=sharded, --follow or --feeds"));
+      }
+    }
+    CHECK(parse({"--follow=1", "a"}).error() == error(error::main, "unknown option: --follow=1"));
+    CHECK(parse({"--follow", "--reader=mmap", "a"}).error()
+          == error(error::main, "options --reader, --prefetch and --feeds cannot be used with --follow"));
+    CHECK(parse({"--follow", "--prefetch", "a"}).error()
+          == error(error::main, "options --reader, --prefetch and --feeds cannot be used with --follow"));
+    CHECK(parse({"--follow", "--feeds", "a"}).error()
+          == error(error::main, "options --reader, --prefetch and --feeds cannot be used with --follow"));
+    CHECK(parse({"--interval=5", "a"}).error() == error(error::main, "option --interval requires --follow"));
+    CHECK(parse({"--follow", "--interval", "a"}).error()
+          == error(error::main, "invalid interval: , expected positive number of seconds"));
+    CHECK(parse({"--follow", "--interval=0", "a"}).error()
+          == error(error::main, "invalid interval: 0, expected positive number of seconds"));
+    CHECK(parse({"--follow", "--interval=5s", "a"}).error()
+          == error(error::main, "invalid interval: 5s, expected positive number of seconds"));
+  }
+
+  SECTION("valid inputs")
+  {
+    using T = options;
+    CHECK(parse({"a"}).value() == T{.path = "a", .reader = T::reader_t::pcap});
+    CHECK(parse({"--reader=pcap", "a"}).value() == T{.path = "a", .reader = T::reader_t::pcap});
+    CHECK(parse({"--reader=mmap", "a"}).value() == T{.path = "a", .reader = T::reader_t::mmap});
+    CHECK(parse({"a", "--reader=mmap"}).value() == T{.path = "a", .reader = T::reader_t::mmap});
+    CHECK(parse({"--reader=uring", "a"}).value() == T{.path = "a", .reader = T::reader_t::uring});
+    CHECK(parse({"--reader=parallel", "a"}).value() == T{.path = "a", .reader = T::reader_t::parallel});
+    CHECK(parse({"--reader=sharded", "a"}).value() == T{.path = "a", .reader = T::reader_t::sharded});
+    CHECK(parse({"--prefetch", "a"}).value() == T{.path = "a", .reader = T::reader_t::pcap, .prefetch = true});
+    CHECK(parse({"--throughput", "--reader=uring", "a"}).value()
+          == T{.path = "a", .reader = T::reader_t::uring, .throughput = true});
+    CHECK(parse({"--feeds", "--throughput", "a"}).value()
+          == T{.path = "a", .reader = T::reader_t::pcap, .throughput = true, .feeds = true});
+    CHECK(parse({"--follow", "a"}).value() == T{.path = "a", .follow = true});
+    CHECK(parse({"--window=64", "--prefetch", "a"}).value() == T{.path = "a", .prefetch = true, .window = 64});
+    CHECK(parse({"--window=64", "--gaps", "--from=10", "--export=x", "a"}).value()
+          == T{.path = "a",
+               .gaps = true,
+               .window = 64,
+               .range = {.from = std::uint32_t{10}, .to = {}},
+               .export_prefix = "x"});
+    CHECK(parse({"--gaps", "--reader=parallel", "a"}).value()
+          == T{.path = "a", .reader = T::reader_t::parallel, .gaps = true});
+    CHECK(parse({"--profile", "--reader=mmap", "a"}).value()
+          == T{.path = "a", .reader = T::reader_t::mmap, .profile = true});
+    CHECK(parse({"--profile", "--gaps", "--from=10", "a"}).value()
+          == T{.path = "a", .gaps = true, .profile = true, .range = {.from = std::uint32_t{10}, .to = {}}});
+    CHECK(parse({"--export=some/prefix", "--reader=parallel", "a"}).value()
+          == T{.path = "a", .reader = T::reader_t::parallel, .export_prefix = "some/prefix"});
+    CHECK(parse({"--export=x", "--to=20", "--profile", "a"}).value()
+          == T{.path = "a", .profile = true, .range = {.from = {}, .to = std::uint32_t{20}}, .export_prefix = "x"});
+    CHECK(parse({"--cache", "--gaps", "a"}).value() == T{.path = "a", .gaps = true, .cache = true});
+    CHECK(parse({"--from=10", "--cache", "a"}).value()
+          == T{.path = "a", .range = {.from = std::uint32_t{10}, .to = {}}, .cache = true});
+    CHECK(parse({"--from=10", "--to=10", "--prefetch", "a"}).value()
+          == T{.path = "a", .prefetch = true, .range = {.from = std::uint32_t{10}, .to = std::uint32_t{10}}});
+    CHECK(parse({"--from=2023-11-14T22:13:20", "--reader=pcap", "--to=20", "a"}).value()
+          == T{.path = "a",
+               .range = {.from = packet_range::time_point(std::chrono::seconds(1700000000)), .to = std::uint32_t{20}}});
+    CHECK(parse({"--to=9", "--reader=mmap", "--gaps", "a"}).value()
+          == T{.path = "a", .reader = T::reader_t::mmap, .gaps = true, .range = {.from = {}, .to = std::uint32_t{9}}});
+    CHECK(parse({"--follow", "--interval=2", "a"}).value()
+          == T{.path = "a", .follow = true, .interval = std::chrono::seconds{2}});
+  }
+}
@@ -0,0 +1,218 @@
+#include "capture_tools.hpp"
+#include "mock_inputs.hpp"
+#include "savefile_tools.hpp"
+#include "temp_directory.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <expected>
+#include <vector>
+
+#include "lib/cached_inputs.hpp"
+#include "lib/packet.hpp"
+#include "lib/packet_cache.hpp"
+#include "lib/savefile.hpp"
+#include "lib/sidecar.hpp"
+#include "lib/stats.hpp"
+#include "lib/synthetic.hpp"
+
+namespace {
+// Sequence numbers from first, skipping every skip-th, with a garbage and an incomplete record in the middle
+auto make_capture(std::uint32_t first, std::uint32_t count, std::uint32_t skip) -> synthetic_capture
+{
+  synthetic_capture ret;
+  for (std::uint32_t i = first; i < first + count; ++i) {
+    if (i % skip == 0) {
+      continue;
+    }
+    auto const timestamp = at(1'000'000'000 + std::int64_t{i} * 1000 + i % 3);
+    if (i == first + count / 2) {
+      packet_t frame;
+      synthetic::frame(i, timestamp, 16, frame);
+      ret.append_record({0x01, 0x02});
+      ret.append_record(frame, static_cast<std::uint32_t>(frame.size() + 1));
+    }
+    ret.append(i, timestamp);
+  }
+  return ret;
+}
+
+// Columns must be aligned, same as a mapped cache file
+auto aligned(std::vector<unsigned char> const &data) -> std::vector<std::uint64_t>
+{
+  std::vector<std::uint64_t> ret((data.size() + 7) / 8);
+  std::memcpy(ret.data(), data.data(), data.size());
+  return ret;
+}
+
+auto view(std::vector<std::uint64_t> const &data, std::size_t size) -> packet_cache::data_t
+{
+  return {reinterpret_cast<unsigned char const *>(data.data()), size};
+}
+
+// Same as cached_inputs, without files
+struct cached_readers final {
+  pair<packet_cache> caches;
+
+  [[nodiscard]] auto readers() const noexcept -> pair<packet_cache::reader>
+  {
+    return {.A = {.cache = caches.A}, .B = {.cache = caches.B}};
+  }
+};
+} // namespace
+
+TEST_CASE("packet cache")
+{
+  SECTION("build and decode")
+  {
+    CHECK(packet_cache::build({}).error() == error(error::open_pcap, "truncated dump file header"));
+
+    auto const empty = packet_cache::build(make_savefile_header(), 42).value();
+    auto const empty_data = aligned(empty);
+    auto const empty_cache = packet_cache::decode(view(empty_data, empty.size())).value();
+    CHECK(empty_cache.size() == 0);
+    CHECK(empty_cache.file_size == savefile::file_header_length);
+    CHECK(empty_cache.file_mtime_ns == 42);
+
+    auto const input = make_capture(1, 10'000, 7);
+    auto const encoded = packet_cache::build(input.file, -1).value();
+    CHECK(encoded.size() == 40 + input.frames.size() * 13);
+    auto const data = aligned(encoded);
+    auto const cache = packet_cache::decode(view(data, encoded.size())).value();
+    CHECK(cache.file_size == input.file.size());
+    CHECK(cache.file_mtime_ns == -1);
+    REQUIRE(cache.size() == input.frames.size());
+    std::size_t mismatched = 0;
+    for (std::size_t i = 0; i < cache.size(); ++i) {
+      mismatched += cache.at(i) == packet::parse(input.frames[i]) ? 0 : 1;
+    }
+    CHECK(mismatched == 0);
+    auto const garbage = std::ranges::find(input.frames, packet_t{0x01, 0x02}) - input.frames.begin();
+    REQUIRE(garbage > 0);
+    CHECK(cache.at(static_cast<std::size_t>(garbage)).error() == packet::parse_error::not_enough_data);
+    CHECK(cache.at(static_cast<std::size_t>(garbage) + 1).error() == packet::parse_error::not_enough_data);
+  }
+
+  SECTION("invalid cache")
+  {
+    auto const encoded = packet_cache::build(make_capture(1, 100, 7).file).value();
+    auto const invalid = [](std::vector<unsigned char> const &data) {
+      auto const copy = aligned(data);
+      return packet_cache::decode(view(copy, data.size())).error();
+    };
+
+    CHECK(invalid({}) == error(error::open_cache, "invalid cache: unknown file format"));
+    auto data = encoded;
+    data[0] = 'X';
+    CHECK(invalid(data) == error(error::open_cache, "invalid cache: unknown file format"));
+    data = encoded;
+    data[7] = 2;
+    CHECK(invalid(data) == error(error::open_cache, "invalid cache: unsupported version 2"));
+    data = encoded;
+    data.resize(20);
+    CHECK(invalid(data) == error(error::open_cache, "invalid cache: truncated header"));
+    data = encoded;
+    std::reverse(data.begin() + 8, data.begin() + 16);
+    CHECK(invalid(data) == error(error::open_cache, "invalid cache: byte order of another host"));
+    data = encoded;
+    data.pop_back();
+    CHECK(invalid(data) == error(error::open_cache, "invalid cache: size does not match number of records"));
+    data = encoded;
+    data[23] = 0x80;
+    CHECK(invalid(data) == error(error::open_cache, "invalid cache: size does not match number of records"));
+    data = encoded;
+    data.back() = 0xff;
+    CHECK(invalid(data) == error(error::open_cache, "invalid cache: unknown parse error"));
+    data.back() = packet::parse_error_count;
+    CHECK(invalid(data) == error(error::open_cache, "invalid cache: unknown parse error"));
+    data.back() = packet::parse_error_count - 1;
+    CHECK(packet_cache::decode(view(aligned(data), data.size())).has_value());
+
+    data = encoded;
+    data.insert(data.begin(), 0);
+    auto const copy = aligned(data);
+    CHECK(packet_cache::decode(view(copy, data.size()).subspan(1)).error()
+          == error(error::open_cache, "invalid cache: misaligned data"));
+  }
+
+  SECTION("stats calculation from cache")
+  {
+    auto const a = make_capture(1, 5000, 13);
+    auto const b = make_capture(3, 5000, 17);
+    auto const encoded = pair<std::vector<unsigned char>>{.A = packet_cache::build(a.file).value(),
+                                                          .B = packet_cache::build(b.file).value()};
+    auto const data = pair<std::vector<std::uint64_t>>{.A = aligned(encoded.A), .B = aligned(encoded.B)};
+    auto const caches = pair<packet_cache>{.A = packet_cache::decode(view(data.A, encoded.A.size())).value(),
+                                           .B = packet_cache::decode(view(data.B, encoded.B.size())).value()};
+
+    std::vector<std::string> expected_log;
+    auto const expected = stats::make(MockInputs(a.frames, b.frames),
+                                      [&expected_log](std::string line) { expected_log.push_back(std::move(line)); });
+    std::vector<std::string> log;
+    auto const result
+        = stats::make(cached_readers{.caches = caches}, [&log](std::string line) { log.push_back(std::move(line)); });
+    CHECK(result == expected);
+    CHECK(log == expected_log);
+    CHECK(result.dropped_count.A > 0);
+    CHECK(result.dropped_count.B > 0);
+  }
+
+  SECTION("save and load")
+  {
+    temp_directory const dir;
+    auto const input = make_capture(1, 3000, 7);
+    auto const file = dir.write("some_14310-0.pcap", input.file);
+    auto const name = file + std::string(cache_suffix);
+
+    CHECK(packet_cache::load(file).error() == error(error::open_cache, "failed to open cache: " + name));
+    CHECK(packet_cache::save(dir.file("missing.pcap")).error()
+          == error(error::write_cache, "failed to cache file: " + dir.file("missing.pcap")));
+
+    REQUIRE(packet_cache::save(file).has_value());
+    CHECK(not std::filesystem::exists(name + std::string(sidecar::temporary_suffix)));
+    auto const mapped = packet_cache::load(file).value();
+    auto const cache = packet_cache::decode(mapped.data()).value();
+    CHECK(cache.file_size == input.file.size());
+    CHECK(cache.file_mtime_ns == sidecar::stamp(file)->mtime_ns);
+    CHECK(cache.size() == input.frames.size());
+    // NOTE: columns are written in place into the cache file, same as build writes them into memory
+    CHECK(temp_directory::read(name) == packet_cache::build(input.file, cache.file_mtime_ns).value());
+
+    // Cache is stale once the file is modified, even if its size is the same
+    std::filesystem::last_write_time(file, std::filesystem::last_write_time(file) + std::chrono::seconds(1));
+    CHECK(packet_cache::load(file).error() == error(error::open_cache, "stale cache: " + name));
+    REQUIRE(packet_cache::save(file).has_value());
+    CHECK(packet_cache::load(file).has_value());
+  }
+
+  SECTION("cached inputs")
+  {
+    temp_directory const dir;
+    auto const a = make_capture(1, 5000, 13);
+    auto const b = make_capture(3, 5000, 17);
+    auto const files = pair<std::string>{.A = dir.write("some_14310-0.pcap", a.file),
+                                         .B = dir.write("some_15310-0.pcap", b.file)};
+
+    CHECK(cached_inputs::make({.A = files.A, .B = dir.file("missing.pcap")}).error()
+          == error(error::open_cache, "failed to open file B: " + dir.file("missing.pcap")
+                                          + ", error: failed to cache file: " + dir.file("missing.pcap")));
+
+    auto const expected = stats::make(MockInputs(a.frames, b.frames));
+    // NOTE: first run writes the caches, second run reads them
+    CHECK(stats::make(cached_inputs::make(files).value()) == expected);
+    CHECK(std::filesystem::exists(files.A + std::string(cache_suffix)));
+    CHECK(std::filesystem::exists(files.B + std::string(cache_suffix)));
+    CHECK(stats::make(cached_inputs::make(files).value()) == expected);
+
+    // Cache which cannot be decoded is written again
+    dir.write("some_14310-0.pcap" + std::string(cache_suffix), {'X'});
+    CHECK(stats::make(cached_inputs::make(files).value()) == expected);
+    CHECK(packet_cache::load(files.A).has_value());
+  }
+}
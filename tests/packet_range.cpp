@@ -0,0 +1,58 @@
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+#include "lib/packet_range.hpp"
+
+TEST_CASE("packet range")
+{
+  using namespace std::chrono_literals;
+  using time_point = packet_range::time_point;
+  auto const start = time_point(1700000000s); // 2023-11-14T22:13:20
+
+  SECTION("invalid bounds")
+  {
+    for (auto const *value : {"", "-1", "4294967296", "12a", "2023-11-14", "2023-11-14T22:13", "2023-11-14 22:13:20",
+                              "2023-13-14T22:13:20", "2023-02-29T22:13:20", "2023-11-14T24:00:00",
+                              "2023-11-14T22:60:00", "2023-11-14T22:13:20.", "2023-11-14T22:13:20.1234567890",
+                              "2023-11-14T22:13:20+01:00", "2023-11-14T22:13:20Zx", "+023-11-14T22:13:20"}) {
+      CAPTURE(value);
+      CHECK(not packet_range::parse(value).has_value());
+    }
+  }
+
+  SECTION("valid bounds")
+  {
+    using T = packet_range::bound_t;
+    CHECK(packet_range::parse("0").value() == T{std::uint32_t{0}});
+    CHECK(packet_range::parse("4294967295").value() == T{std::uint32_t{4294967295}});
+    CHECK(packet_range::parse("2023-11-14T22:13:20").value() == T{start});
+    CHECK(packet_range::parse("2023-11-14T22:13:20Z").value() == T{start});
+    CHECK(packet_range::parse("2023-11-14T22:13:20.5").value() == T{start + 500ms});
+    CHECK(packet_range::parse("2023-11-14T22:13:20.000000001").value() == T{start + 1ns});
+    CHECK(packet_range::parse("2024-02-29T00:00:00.25Z").value()
+          == T{time_point(std::chrono::sys_days(std::chrono::year(2024) / 2 / 29)) + 250ms});
+  }
+
+  SECTION("before and after")
+  {
+    auto const p = packet::properties{.timestamp = start, .sequence = 10};
+    CHECK(packet_range{}.empty());
+    CHECK(not packet_range{}.before(p));
+    CHECK(not packet_range{}.after(p));
+
+    auto const sequences = packet_range{.from = std::uint32_t{10}, .to = std::uint32_t{12}};
+    CHECK(not sequences.empty());
+    CHECK(not sequences.before(p));
+    CHECK(sequences.before({.timestamp = start, .sequence = 9}));
+    CHECK(not sequences.after({.timestamp = start, .sequence = 12}));
+    CHECK(sequences.after({.timestamp = start, .sequence = 13}));
+
+    auto const times = packet_range{.from = {}, .to = start};
+    CHECK(not times.empty());
+    CHECK(not times.before({.timestamp = start - 1h, .sequence = 0}));
+    CHECK(not times.after(p));
+    CHECK(times.after({.timestamp = start + 1ns, .sequence = 0}));
+  }
+}
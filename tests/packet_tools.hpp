@@ -127,4 +127,13 @@ inline auto get_timestamp(packet_t const &data) -> std::optional<std::chrono::sy
   return {};
 }
 
+// Copy of example_packet with given sequence number and timestamp, in ns since epoch
+inline auto make_packet(std::uint32_t sequence, long nanoseconds) -> packet_t
+{
+  packet_t ret = example_packet;
+  set_sequence(sequence, ret);
+  set_timestamp(std::chrono::system_clock::time_point(std::chrono::nanoseconds(nanoseconds)), ret);
+  return ret;
+}
+
 #endif // TESTS_PACKET_TOOLS
@@ -0,0 +1,124 @@
+#include "packet_tools.hpp"
+#include "savefile_tools.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <expected>
+#include <vector>
+
+#include "lib/parallel_decode.hpp"
+
+namespace {
+using parsed_t = parallel_decoder::parsed_t;
+
+// Record which contains a valid pcap file as its payload, which will fool savefile::resync
+auto nested_savefile(std::size_t count) -> packet_t
+{
+  packet_t ret;
+  for (std::size_t i = 0; i < count; ++i) {
+    append_savefile_record(packet_t(8, 0x33), ret);
+  }
+  return ret;
+}
+
+auto make_file() -> packet_t
+{
+  packet_t file = make_savefile_header();
+  for (std::uint32_t i = 1; i <= 300; ++i) {
+    packet_t data = example_packet;
+    set_sequence(i, data);
+    if (i % 17 == 0) {
+      set_ip_protocol(IPPROTO_TCP, data); // "not UDP"
+    }
+    if (i % 41 == 0) {
+      append_savefile_record(data, file, false, 0, 0, data.size() + 10); // incomplete
+    } else if (i % 29 == 0) {
+      append_savefile_record(nested_savefile(i % 7 + 10), file);
+    } else {
+      append_savefile_record(data, file, false, i, 0);
+    }
+  }
+  return file;
+}
+
+auto serial(packet_t const &file) -> std::vector<parsed_t>
+{
+  std::vector<parsed_t> ret;
+  savefile::records records{.header = savefile::file_header::make(file).value(), .file = file};
+  for (auto record = records.next(); record.has_value(); record = records.next()) {
+    ret.push_back(packet::parse(record->header.caplen == record->header.len ? record->data : record->data.first(0)));
+  }
+  return ret;
+}
+
+auto parallel(packet_t const &file, std::size_t range_size, std::size_t window) -> std::vector<parsed_t>
+{
+  std::vector<parsed_t> ret;
+  parallel_decoder decoder(savefile::file_header::make(file).value(), file, range_size, window);
+  while (decoder.next([&ret](parsed_t &&parsed) { ret.push_back(std::move(parsed)); })) {
+  }
+  return ret;
+}
+} // namespace
+
+TEST_CASE("savefile resync")
+{
+  packet_t file = make_savefile_header();
+  for (int i = 0; i < 10; ++i) {
+    append_savefile_record(example_packet, file);
+  }
+  auto const header = savefile::file_header::make(file).value();
+  auto const record = savefile::record_header_length + example_packet.size();
+  auto const second = savefile::file_header_length + record;
+
+  CHECK(savefile::resync(header, file, 0, file.size()) == savefile::file_header_length);
+  CHECK(savefile::resync(header, file, savefile::file_header_length, file.size()) == savefile::file_header_length);
+  CHECK(savefile::resync(header, file, savefile::file_header_length + 1, file.size()) == second);
+  CHECK(savefile::resync(header, file, second, file.size()) == second);
+  CHECK(savefile::resync(header, file, savefile::file_header_length + 1, second) == second);
+  CHECK(savefile::resync(header, file, savefile::file_header_length + 1, second - 1) == second - 1);
+  CHECK(savefile::resync(header, file, file.size() - 1, file.size()) == file.size());
+
+  // chain ending at the end of file is accepted, even if it is shorter than required
+  auto const last = file.size() - record;
+  CHECK(savefile::resync(header, file, last - 1, file.size()) == last);
+
+  // nested file is a plausible chain of records, the guess is wrong
+  packet_t nested = make_savefile_header();
+  append_savefile_record(nested_savefile(10), nested);
+  append_savefile_record(example_packet, nested);
+  CHECK(savefile::resync(header, nested, savefile::file_header_length + 1, nested.size())
+        == savefile::file_header_length + savefile::record_header_length);
+}
+
+TEST_CASE("parallel decoder")
+{
+  packet_t const file = make_file();
+  auto const expected = serial(file);
+  REQUIRE(expected.size() == 300);
+
+  for (std::size_t const range_size : {1, 24, 77, 100, 1000, 1 << 20}) {
+    for (std::size_t const window : {1, 3}) {
+      DYNAMIC_SECTION("range size " << range_size << " window " << window)
+      {
+        CHECK(parallel(file, range_size, window) == expected);
+      }
+    }
+  }
+
+  SECTION("truncated file")
+  {
+    packet_t truncated = file;
+    truncated.resize(truncated.size() / 2);
+    auto const expected = serial(truncated);
+    REQUIRE(expected.size() < 300);
+    CHECK(parallel(truncated, 77, 3) == expected);
+    CHECK(parallel(truncated, 1000, 2) == expected);
+  }
+
+  SECTION("no records")
+  {
+    CHECK(parallel(make_savefile_header(), 77, 3).empty());
+  }
+}
@@ -0,0 +1,94 @@
+#include "packet_tools.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <net/ethernet.h>
+#include <netinet/in.h>
+
+#include <vector>
+
+#include "lib/parse_batch.hpp"
+
+TEST_CASE("batch packet parsing")
+{
+  using packet::parse_error;
+  CHECK(packet::message(parse_error::not_enough_data) == std::string("not enough data"));
+  CHECK(packet::message(parse_error::bad_udp_header) == std::string("bad UDP header"));
+
+  // One frame of each kind, several times, so that all lanes see all kinds of frames
+  std::vector<packet_t> frames;
+  for (std::uint32_t i = 0; i < 7; ++i) {
+    packet_t example = example_packet;
+    set_sequence(i * 7 + 1, example);
+    set_timestamp(std::chrono::system_clock::time_point(std::chrono::nanoseconds(i * 1'000'000'123)), example);
+    frames.push_back(example);
+
+    packet_t not_ipv4 = example;
+    set_ethertype(ETHERTYPE_ARP, not_ipv4);
+    frames.push_back(not_ipv4);
+
+    packet_t not_udp = example;
+    set_ip_protocol(IPPROTO_TCP, not_udp);
+    frames.push_back(not_udp);
+
+    packet_t small_ip_header = example;
+    set_ip_header_len(8, small_ip_header);
+    frames.push_back(small_ip_header);
+
+    packet_t large_ip_header = example;
+    large_ip_header.resize(example.size() + 80);
+    set_ip_header_len(80, large_ip_header);
+    frames.push_back(large_ip_header);
+
+    packet_t bad_udp = example;
+    set_udp_payload_len(80 + i, bad_udp);
+    frames.push_back(bad_udp);
+
+    packet_t short_udp = example;
+    set_udp_payload_len(4, short_udp);
+    frames.push_back(short_udp);
+
+    frames.push_back(packet_t(i * 10));
+    frames.push_back({});
+  }
+
+  std::vector<packet::data_t> views;
+  for (auto const &frame : frames) {
+    views.emplace_back(frame);
+  }
+
+  for (auto const level : {packet::simd_level::scalar, packet::simd_level::sse2, packet::simd_level::avx2}) {
+    if (level > packet::parse_batch_t::supported()) {
+      continue;
+    }
+
+    DYNAMIC_SECTION("simd level " << static_cast<int>(level))
+    {
+      for (std::size_t const size : {0UL, 1UL, 7UL, 8UL, 9UL, 17UL, views.size()}) {
+        packet::batch_properties parsed;
+        packet::parse_batch(std::span(views).first(size), parsed, packet::link_t::ethernet, level);
+        REQUIRE(parsed.size() == size);
+        for (std::size_t i = 0; i < size; ++i) {
+          CHECK(parsed.at(i) == packet::parse(views[i]));
+        }
+      }
+    }
+  }
+
+  SECTION("default level")
+  {
+    packet::batch_properties parsed;
+    packet::parse_batch(views, parsed);
+    REQUIRE(parsed.size() == views.size());
+    CHECK(parsed.errors[0] == parse_error::none);
+    CHECK(parsed.errors[1] == parse_error::not_ipv4);
+    CHECK(parsed.errors[2] == parse_error::not_udp);
+    CHECK(parsed.errors[3] == parse_error::bad_ip_header);
+    CHECK(parsed.errors[4] == parse_error::bad_ip_header);
+    CHECK(parsed.errors[5] == parse_error::bad_udp_header);
+    CHECK(parsed.errors[6] == parse_error::bad_udp_header);
+    CHECK(parsed.errors[7] == parse_error::not_enough_data);
+    CHECK(parsed.errors[8] == parse_error::not_enough_data);
+    CHECK(parsed.at(0) == packet::parse(views[0]));
+  }
+}
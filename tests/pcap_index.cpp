@@ -0,0 +1,200 @@
+#include "capture_tools.hpp"
+#include "savefile_tools.hpp"
+#include "temp_directory.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "lib/pcap_index.hpp"
+#include "lib/savefile.hpp"
+#include "lib/sidecar.hpp"
+#include "lib/synthetic.hpp"
+
+namespace {
+using time_point = pcap_index::time_point;
+
+// Sequence numbers 1, 2, ... with every 7th packet swapped with the one before it, and one garbage record
+auto make_capture(std::uint32_t count) -> synthetic_capture
+{
+  synthetic_capture ret;
+  for (std::uint32_t i = 1; i <= count; ++i) {
+    auto const sequence = i % 7 == 0 ? i + 1 : i % 7 == 1 && i > 1 ? i - 1 : i;
+    ret.append(sequence, at(1'000'000'000 + std::int64_t{sequence} * 1000));
+  }
+  ret.append_record({0x01, 0x02});
+  return ret;
+}
+} // namespace
+
+TEST_CASE("pcap index")
+{
+  SECTION("build")
+  {
+    CHECK(pcap_index::build({}).error() == error(error::open_pcap, "truncated dump file header"));
+    CHECK(pcap_index::build(make_savefile_header(), 0).error()
+          == error(error::write_index, "invalid index interval: 0, expected positive number of records"));
+    CHECK(pcap_index::build(make_savefile_header()).value()
+          == pcap_index{.records = 0, .file_size = savefile::file_header_length, .file_mtime_ns = 0, .entries = {}});
+
+    auto const input = make_capture(100);
+    auto const index = pcap_index::build(input.file, 10).value();
+    CHECK(index.interval == 10);
+    CHECK(index.records == 101);
+    CHECK(index.file_size == input.file.size());
+    REQUIRE(index.entries.size() == 10);
+    for (std::size_t i = 0; i < index.entries.size(); ++i) {
+      auto const first = (i + 1) * 10;
+      auto const &entry = index.entries[i];
+      CHECK(entry.offset == (first < 100 ? input.offsets[first] : input.file.size() - 18));
+      auto const sequence = *std::max_element(input.sequences.begin(), input.sequences.begin() + first);
+      CHECK(entry.sequence == sequence);
+      CHECK(entry.timestamp == at(1'000'000'000 + std::int64_t{sequence} * 1000));
+      // NOTE: the last record cannot be parsed
+      if (first < 100) {
+        auto const rest = *std::min_element(input.sequences.begin() + first, input.sequences.end());
+        CHECK(entry.rest_sequence == rest);
+        CHECK(entry.rest_timestamp == at(1'000'000'000 + std::int64_t{rest} * 1000));
+      } else {
+        CHECK(entry.rest_sequence == std::numeric_limits<std::uint32_t>::max());
+        CHECK(entry.rest_timestamp == time_point::max());
+      }
+    }
+  }
+
+  SECTION("seek")
+  {
+    auto const input = make_capture(1000);
+    auto const index = pcap_index::build(input.file, 16).value();
+    CHECK(index.seek(std::uint32_t{0}) == savefile::file_header_length);
+    CHECK(index.seek(std::uint32_t{16}) == savefile::file_header_length);
+    CHECK(index.seek(std::uint32_t{17}) == index.entries.front().offset);
+    CHECK(index.seek(at(0)) == savefile::file_header_length);
+    CHECK(index.seek(std::uint32_t{1001}) == index.entries.back().offset);
+
+    // Records skipped are all lower than the target, and the next entry would skip some which are not
+    for (std::uint32_t target = 1; target <= 1002; ++target) {
+      auto const offset = index.seek(target);
+      auto const time_offset = index.seek(at(1'000'000'000 + std::int64_t{target} * 1000));
+      CHECK(offset == time_offset);
+      auto const skipped = static_cast<std::size_t>(
+          std::ranges::lower_bound(input.offsets, offset) - input.offsets.begin());
+      CHECK(std::all_of(input.sequences.begin(), input.sequences.begin() + skipped,
+                        [target](std::uint32_t sequence) { return sequence < target; }));
+      CHECK((skipped == input.offsets.size() || input.offsets[skipped] == offset));
+      auto const next = skipped + index.interval;
+      if (next < input.offsets.size()) {
+        CHECK(*std::max_element(input.sequences.begin(), input.sequences.begin() + next) >= target);
+      }
+    }
+  }
+
+  SECTION("end")
+  {
+    auto const input = make_capture(1000);
+    auto const index = pcap_index::build(input.file, 16).value();
+    CHECK(index.end(std::uint32_t{0}) == index.entries.front().offset);
+    CHECK(index.end(std::uint32_t{16}) == index.entries.front().offset);
+    CHECK(index.end(std::uint32_t{17}) == index.entries[1].offset);
+    CHECK(index.end(std::uint32_t{1000}) == input.file.size());
+    CHECK(index.end(time_point::max()) == input.file.size());
+    CHECK(pcap_index::build(make_savefile_header()).value().end(std::uint32_t{0}) == savefile::file_header_length);
+
+    // Records after the end are all higher than the target, and the previous entry would include some which are not
+    for (std::uint32_t target = 1; target <= 1002; ++target) {
+      auto const offset = index.end(target);
+      CHECK(offset == index.end(at(1'000'000'000 + std::int64_t{target} * 1000)));
+      auto const kept
+          = static_cast<std::size_t>(std::ranges::lower_bound(input.offsets, offset) - input.offsets.begin());
+      CHECK(std::all_of(input.sequences.begin() + kept, input.sequences.end(),
+                        [target](std::uint32_t sequence) { return sequence > target; }));
+      if (kept >= index.interval && kept < input.offsets.size()) {
+        auto const previous = kept - index.interval;
+        CHECK(*std::min_element(input.sequences.begin() + previous, input.sequences.end()) <= target);
+      }
+    }
+  }
+
+  SECTION("encode and decode")
+  {
+    auto const input = make_capture(5000);
+    auto index = pcap_index::build(input.file, 64).value();
+    index.file_mtime_ns = 1'700'000'000'123'456'789;
+    auto const data = index.encode();
+    CHECK(pcap_index::decode(data).value() == index);
+    // NOTE: delta encoding keeps entries small
+    CHECK(data.size() < 8 + 30 + index.entries.size() * 12);
+
+    auto const empty = pcap_index{.records = 0, .file_size = 24, .file_mtime_ns = -1, .entries = {}};
+    CHECK(pcap_index::decode(empty.encode()).value() == empty);
+  }
+
+  SECTION("invalid sidecar")
+  {
+    auto const index = pcap_index::build(make_capture(100).file, 10).value();
+    auto const invalid = [](std::vector<unsigned char> const &data) { return pcap_index::decode(data).error(); };
+
+    CHECK(invalid({}) == error(error::open_index, "invalid index: unknown file format"));
+    auto data = index.encode();
+    data[0] = 'X';
+    CHECK(invalid(data) == error(error::open_index, "invalid index: unknown file format"));
+    data = index.encode();
+    data[7] = 1;
+    CHECK(invalid(data) == error(error::open_index, "invalid index: unsupported version 1"));
+    data = index.encode();
+    data.resize(10);
+    CHECK(invalid(data) == error(error::open_index, "invalid index: truncated header"));
+    data = index.encode();
+    data.pop_back();
+    CHECK(invalid(data) == error(error::open_index, "invalid index: truncated entries"));
+    data = index.encode();
+    data.push_back(0);
+    CHECK(invalid(data) == error(error::open_index, "invalid index: unexpected data after entries"));
+
+    auto copy = index;
+    copy.records = 200;
+    CHECK(invalid(copy.encode()) == error(error::open_index, "invalid index: inconsistent header"));
+    copy = index;
+    copy.entries[3].offset = copy.entries[2].offset;
+    CHECK(invalid(copy.encode()) == error(error::open_index, "invalid index: inconsistent entries"));
+    copy = index;
+    copy.file_size = copy.entries.back().offset;
+    CHECK(invalid(copy.encode()) == error(error::open_index, "invalid index: inconsistent entries"));
+  }
+
+  SECTION("save and load")
+  {
+    temp_directory const dir;
+    auto const input = make_capture(1000);
+    auto const file = dir.write("some_14310-0.pcap", input.file);
+    auto const name = file + std::string(sidecar_suffix);
+
+    CHECK(pcap_index::load(file).error() == error(error::open_index, "failed to open index: " + name));
+    CHECK(pcap_index::save(dir.file("missing.pcap")).error()
+          == error(error::write_index, "failed to index file: " + dir.file("missing.pcap")));
+
+    auto const saved = pcap_index::save(file, 64).value();
+    auto expected = pcap_index::build(input.file, 64).value();
+    expected.file_mtime_ns = saved.file_mtime_ns;
+    CHECK(saved == expected);
+    CHECK(saved.file_mtime_ns == sidecar::stamp(file)->mtime_ns);
+    CHECK(pcap_index::load(file).value() == saved);
+    CHECK(not std::filesystem::exists(name + std::string(sidecar::temporary_suffix)));
+
+    // Index is stale once the file is modified, even if its size is the same
+    std::filesystem::last_write_time(file, std::filesystem::last_write_time(file) + std::chrono::seconds(1));
+    CHECK(pcap_index::load(file).error() == error(error::open_index, "stale index: " + name));
+    auto changed = input.file;
+    append_savefile_record({0x01, 0x02}, changed);
+    dir.write("some_14310-0.pcap", changed);
+    CHECK(pcap_index::load(file).error() == error(error::open_index, "stale index: " + name));
+    CHECK(pcap_index::save(file, 64).value().records == saved.records + 1);
+    CHECK(pcap_index::load(file).value().records == saved.records + 1);
+  }
+}
@@ -0,0 +1,82 @@
+#include "temp_directory.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "lib/pcap_writer.hpp"
+#include "lib/savefile.hpp"
+
+namespace {
+using time_point = pcap_writer::time_point;
+
+// Timestamp of i-th packet, with a different fraction of second for each
+auto at(long i) -> time_point
+{ //
+  return time_point(std::chrono::nanoseconds(1'700'000'000'000'000'000L + i * 1'000'000'001L));
+}
+
+// Timestamps and data of all records in a pcap file
+struct contents final {
+  savefile::file_header header = {};
+  std::vector<time_point> timestamps = {};
+  std::vector<std::vector<unsigned char>> frames = {};
+};
+
+auto read(std::string const &filename) -> contents
+{
+  auto const data = temp_directory::read(filename);
+  contents ret{.header = savefile::file_header::make(data).value()};
+  auto records = savefile::records{.header = ret.header, .file = data};
+  while (auto const record = records.next()) {
+    ret.timestamps.push_back(time_point(std::chrono::seconds(record->header.seconds)
+                                        + std::chrono::nanoseconds(record->header.fraction)));
+    ret.frames.emplace_back(record->data.begin(), record->data.end());
+    CHECK(record->header.caplen == record->header.len);
+  }
+  return ret;
+}
+} // namespace
+
+TEST_CASE("pcap writer")
+{
+  temp_directory const dir;
+
+  SECTION("invalid directory")
+  {
+    auto const missing = dir.file("missing");
+    CHECK(pcap_writer::make(missing, "some", "14310", 0).error()
+          == error(error::write_pcap, "failed to create file: " + missing + "/some_14310-0.pcap"));
+  }
+
+  SECTION("segments are rotated")
+  {
+    auto writer = pcap_writer::make(dir.path.string(), "some", "14310", 2).value();
+    std::vector<std::vector<unsigned char>> frames;
+    for (unsigned char i = 0; i < 5; ++i) {
+      frames.push_back(std::vector<unsigned char>(10 + i, i));
+      REQUIRE(writer.write(at(i), frames.back()).has_value());
+    }
+    REQUIRE(writer.close().has_value());
+    CHECK(writer.close().has_value()); // already closed
+
+    CHECK(writer.bytes() == 3 * 24 + 5 * 16 + (10 + 11 + 12 + 13 + 14));
+    CHECK(not std::filesystem::exists(dir.file("some_14310-3.pcap")));
+    std::vector<std::vector<unsigned char>> read_frames;
+    for (auto const *name : {"some_14310-0.pcap", "some_14310-1.pcap", "some_14310-2.pcap"}) {
+      auto const file = read(dir.file(name));
+      CHECK(file.header.nanoseconds);
+      CHECK(file.header.linktype == 1);
+      CHECK(file.frames.size() == (read_frames.size() < 4 ? 2 : 1));
+      for (std::size_t i = 0; i < file.frames.size(); ++i) {
+        CHECK(file.timestamps[i] == at(static_cast<long>(read_frames.size())));
+        read_frames.push_back(file.frames[i]);
+      }
+    }
+    CHECK(read_frames == frames);
+  }
+}
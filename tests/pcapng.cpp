@@ -0,0 +1,136 @@
+#include "packet_tools.hpp"
+#include "pcapng_tools.hpp"
+#include "savefile_tools.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "lib/pcapng.hpp"
+
+TEST_CASE("pcapng blocks")
+{
+  SECTION("invalid inputs")
+  {
+    CHECK(pcapng::blocks::make({}).error() == error(error::open_pcap, "truncated section header block"));
+    CHECK(pcapng::blocks::make(make_savefile_header()).error() == error(error::open_pcap, "unknown file format"));
+
+    packet_t file;
+    append_section(false, file);
+    file[8] = 0;
+    CHECK(pcapng::blocks::make(file).error() == error(error::open_pcap, "invalid byte order magic"));
+  }
+
+  SECTION("no packets")
+  {
+    packet_t file;
+    append_section(false, file);
+    append_interface(1, 0, -1, false, file);
+    auto blocks = pcapng::blocks::make(file).value();
+    CHECK(pcapng::is_pcapng(file));
+    CHECK(not blocks.next().has_value());
+    CHECK(blocks.interfaces.size() == 1);
+  }
+
+  for (bool const swapped : {false, true}) {
+    SECTION(swapped ? "swapped" : "native")
+    {
+      packet_t file;
+      append_section(swapped, file);
+      append_interface(1, 262144, -1, swapped, file);
+      append_block(0x0BAD, {1, 2, 3, 4, 5}, swapped, file); // unknown block, skipped
+      append_interface(113, 262144, 9, swapped, file);
+      append_packet(0, 0x1'0000'0002, example_packet, swapped, file);
+      append_packet(1, 1'700'000'000'123'456'789, {0x01, 0x02, 0x03}, swapped, file, 60);
+      packet_t simple;
+      append_u32(static_cast<std::uint32_t>(example_packet.size()), swapped, simple);
+      simple.insert(simple.end(), example_packet.begin(), example_packet.end());
+      append_block(pcapng::simple_packet_block, simple, swapped, file);
+
+      // Second section, with the opposite byte order
+      append_section(not swapped, file);
+      append_interface(276, 0, 0x80 | 10, not swapped, file);
+      append_packet(0, 7, example_packet, not swapped, file);
+
+      auto blocks = pcapng::blocks::make(file).value();
+      CHECK(blocks.peek()->timestamp == 0x1'0000'0002 * 1000);
+
+      auto const first = blocks.next();
+      REQUIRE(first.has_value());
+      CHECK(first->interface == 0);
+      CHECK(first->timestamp == 0x1'0000'0002 * 1000); // in microseconds, if_tsresol not present
+      CHECK(first->caplen == example_packet.size());
+      CHECK(std::ranges::equal(first->data, example_packet));
+      CHECK(first->data.data() > file.data()); // points inside the file, not copied
+      CHECK(first->data.data() < file.data() + file.size());
+      REQUIRE(blocks.interfaces.size() == 2);
+      CHECK(blocks.interfaces[0].linktype == 1);
+      CHECK(blocks.interfaces[0].ticks_per_second == 1'000'000);
+      CHECK(blocks.interfaces[1].linktype == 113);
+      CHECK(blocks.interfaces[1].ticks_per_second == 1'000'000'000);
+
+      auto const second = blocks.next();
+      REQUIRE(second.has_value());
+      CHECK(second->interface == 1);
+      CHECK(second->caplen == 3);
+      CHECK(second->len == 60);
+      CHECK(second->timestamp == 1'700'000'000'123'456'789); // in nanoseconds, if_tsresol=9
+      CHECK(std::ranges::equal(second->data, packet_t{0x01, 0x02, 0x03}));
+
+      auto const third = blocks.next();
+      REQUIRE(third.has_value());
+      CHECK(third->timestamp == 0);
+      CHECK(std::ranges::equal(third->data, example_packet));
+
+      auto const fourth = blocks.next();
+      REQUIRE(fourth.has_value());
+      CHECK(fourth->timestamp == 6'835'937); // 7/1024 s, if_tsresol=0x8a
+      CHECK(std::ranges::equal(fourth->data, example_packet));
+      CHECK(blocks.swapped == not swapped);
+      REQUIRE(blocks.interfaces.size() == 1);
+      CHECK(blocks.interfaces[0].linktype == 276);
+      CHECK(blocks.interfaces[0].ticks_per_second == 1024);
+
+      CHECK(not blocks.next().has_value());
+      CHECK(blocks.offset == file.size());
+    }
+  }
+
+  SECTION("timestamp resolution")
+  {
+    CHECK(pcapng::to_nanoseconds(1'700'000'000'123'456, 1'000'000) == 1'700'000'000'123'456'000);
+    CHECK(pcapng::to_nanoseconds(1'700'000'000'123'456'789, 1'000'000'000) == 1'700'000'000'123'456'789);
+    CHECK(pcapng::to_nanoseconds(3 * 1024 + 512, 1024) == 3'500'000'000);
+    CHECK(pcapng::to_nanoseconds(15'000'000'000'000'000'001U, 10'000'000'000'000'000'000U) == 1'500'000'000);
+    CHECK(pcapng::to_nanoseconds(42, 0) == 0);
+  }
+
+  SECTION("invalid blocks")
+  {
+    packet_t file;
+    append_section(false, file);
+    append_interface(1, 0, -1, false, file);
+    append_packet(0, 1, example_packet, false, file);
+    auto const complete = file.size();
+
+    SECTION("unknown interface")
+    {
+      append_packet(1, 1, example_packet, false, file);
+      auto blocks = pcapng::blocks::make(file).value();
+      CHECK(blocks.next().has_value());
+      CHECK(not blocks.next().has_value());
+      CHECK(blocks.offset == complete);
+    }
+
+    SECTION("truncated block")
+    {
+      append_packet(0, 1, example_packet, false, file);
+      file.resize(file.size() - 1);
+      auto blocks = pcapng::blocks::make(file).value();
+      CHECK(blocks.next().has_value());
+      CHECK(not blocks.next().has_value());
+      CHECK(blocks.offset == complete);
+    }
+  }
+}
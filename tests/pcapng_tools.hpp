@@ -0,0 +1,61 @@
+#ifndef TESTS_PCAPNG_TOOLS
+#define TESTS_PCAPNG_TOOLS
+
+#include "savefile_tools.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "lib/pcapng.hpp"
+
+inline void append_block(std::uint32_t type, packet_t const &body, bool swapped, packet_t &out)
+{
+  auto const length = static_cast<std::uint32_t>(8 + ((body.size() + 3) & ~std::size_t{3}) + 4);
+  append_u32(type, swapped, out);
+  append_u32(length, swapped, out);
+  out.insert(out.end(), body.begin(), body.end());
+  out.resize(out.size() + (length - 12 - body.size()));
+  append_u32(length, swapped, out);
+}
+
+inline void append_section(bool swapped, packet_t &out)
+{
+  packet_t body;
+  append_u32(0x1A2B3C4D, swapped, body);
+  append_u16(1, swapped, body); // version major
+  append_u16(0, swapped, body); // version minor
+  append_u32(0xFFFFFFFF, swapped, body);
+  append_u32(0xFFFFFFFF, swapped, body); // section length, unknown
+  append_block(pcapng::section_header_block, body, swapped, out);
+}
+
+inline void append_interface(std::uint16_t linktype, std::uint32_t snaplen, int tsresol, bool swapped, packet_t &out)
+{
+  packet_t body;
+  append_u16(linktype, swapped, body);
+  append_u16(0, swapped, body);
+  append_u32(snaplen, swapped, body);
+  if (tsresol >= 0) {
+    append_u16(9, swapped, body); // if_tsresol
+    append_u16(1, swapped, body);
+    body.insert(body.end(), {static_cast<unsigned char>(tsresol), 0, 0, 0});
+    append_u16(0, swapped, body); // opt_endofopt
+    append_u16(0, swapped, body);
+  }
+  append_block(pcapng::interface_description_block, body, swapped, out);
+}
+
+inline void append_packet(std::uint32_t interface, std::uint64_t timestamp, packet_t const &data, bool swapped, packet_t &out,
+                   std::uint32_t len = 0)
+{
+  packet_t body;
+  append_u32(interface, swapped, body);
+  append_u32(static_cast<std::uint32_t>(timestamp >> 32), swapped, body);
+  append_u32(static_cast<std::uint32_t>(timestamp), swapped, body);
+  append_u32(static_cast<std::uint32_t>(data.size()), swapped, body);
+  append_u32(len == 0 ? static_cast<std::uint32_t>(data.size()) : len, swapped, body);
+  body.insert(body.end(), data.begin(), data.end());
+  append_block(pcapng::enhanced_packet_block, body, swapped, out);
+}
+
+#endif // TESTS_PCAPNG_TOOLS
@@ -0,0 +1,172 @@
+#include "mock_inputs.hpp"
+#include "packet_tools.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib/profiler.hpp"
+#include "lib/stats.hpp"
+
+namespace {
+using stage_t = profile::stage_t;
+
+auto make_packets(std::uint32_t count) -> std::vector<packet_t>
+{
+  std::vector<packet_t> ret;
+  for (std::uint32_t i = 1; i <= count; ++i) {
+    ret.push_back(make_packet(i, i * 1000L));
+  }
+  ret.push_back({0x00, 0x01}); // not enough data, passed to log
+  return ret;
+}
+} // namespace
+
+TEST_CASE("profiler")
+{
+  SECTION("disabled profiler records nothing")
+  {
+    profiler prof(false);
+    {
+      auto const scope = prof.scope(stage_t::merge);
+      prof.enter(stage_t::read);
+      prof.leave();
+    }
+    CHECK(not prof.enabled());
+    CHECK(prof.result() == profile{});
+  }
+
+  SECTION("time of nested stages is exclusive")
+  {
+    using namespace std::chrono_literals;
+    profiler prof(true);
+    {
+      auto const outer = prof.scope(stage_t::merge);
+      for (int i = 0; i < 2; ++i) {
+        auto const inner = prof.scope(stage_t::read);
+        std::this_thread::sleep_for(10ms);
+      }
+      std::this_thread::sleep_for(1ms);
+    }
+    prof.leave(); // unbalanced, ignored
+
+    auto const &result = prof.result();
+    CHECK(result[stage_t::merge].calls == 1);
+    CHECK(result[stage_t::read].calls == 2);
+    CHECK(result[stage_t::parse].calls == 0);
+    CHECK(result[stage_t::read].elapsed >= 20ms);
+    CHECK(result[stage_t::merge].elapsed >= 1ms);
+    CHECK(result[stage_t::merge].elapsed < 10ms);
+    CHECK(result[stage_t::parse].elapsed == 0ms);
+
+    // NOTE: hardware counters are not available in some environments, e.g. virtual machines
+    if (result.counters_error.empty()) {
+      CHECK(result[stage_t::merge].counters.instructions > 0);
+    } else {
+      CHECK(result.counters_error.starts_with("failed to open counter of "));
+      CHECK(result[stage_t::merge].counters == perf_counters::values{});
+    }
+  }
+
+  SECTION("same stats with profiler")
+  {
+    auto const a = make_packets(1000);
+    auto const b = make_packets(900);
+    profiler prof(true);
+    std::vector<std::string> logged;
+    auto const result = stats::make(MockInputs(a, b, 100), merge_extras{.prof = &prof}, [&logged](std::string line) {
+      logged.push_back(std::move(line));
+    });
+    CHECK(result == stats::make(MockInputs(a, b, 100)));
+    CHECK(not logged.empty());
+
+    auto const &profiled = prof.result();
+    CHECK(profiled[stage_t::merge].calls == 1);
+    CHECK(profiled[stage_t::read].calls >= 19); // at least 10 batches of A and 9 of B
+    CHECK(profiled[stage_t::parse].calls == profiled[stage_t::read].calls);
+    CHECK(profiled[stage_t::log].calls == logged.size());
+    CHECK(profiled[stage_t::find_inputs].calls == 0);
+  }
+
+  SECTION("combined with other extras")
+  {
+    auto const a = make_packets(1000);
+    auto const b = make_packets(900);
+    auto const range = packet_range{.from = std::uint32_t{100}, .to = std::uint32_t{500}};
+    pair<sequence_gaps> gaps = {};
+    pair<sequence_gaps> profiled_gaps = {};
+    profiler prof(true);
+    auto const result
+        = stats::make(MockInputs(a, b, 100), merge_extras{.range = range, .gaps = &profiled_gaps, .prof = &prof});
+    CHECK(result == stats::make(MockInputs(a, b, 100), merge_extras{.range = range, .gaps = &gaps}));
+    CHECK(profiled_gaps == gaps);
+    CHECK(prof.result()[stage_t::merge].calls == 1);
+    CHECK(prof.result()[stage_t::read].calls >= 19);
+  }
+
+  SECTION("printed as a table")
+  {
+    profile item;
+    item.stages[static_cast<std::size_t>(stage_t::read)] = {.elapsed = std::chrono::microseconds(1500), .calls = 3};
+    item.counters_error = "failed to open counter of cycles: No such file or directory";
+    item.counters_scaled = true; // not printed without counters
+    std::ostringstream ss;
+    ss << item;
+    CHECK(ss.str()
+          == "stage                calls     time ms\n"
+             "find inputs              0       0.000\n"
+             "sort channels            0       0.000\n"
+             "open                     0       0.000\n"
+             "read                     3       1.500\n"
+             "parse                    0       0.000\n"
+             "merge                    0       0.000\n"
+             "log                      0       0.000\n"
+             "hardware counters not available: failed to open counter of cycles: No such file or directory");
+
+    item.counters_error.clear();
+    std::ostringstream scaled;
+    scaled << item;
+    CHECK(scaled.str().ends_with("\nhardware counters are estimates, scaled for time shared with other events"));
+  }
+}
+
+TEST_CASE("perf counters")
+{
+  SECTION("multiplexed counts are scaled")
+  {
+    CHECK(perf_counters::scale(1000, 0, 0) == 1000);
+    CHECK(perf_counters::scale(1000, 500, 500) == 1000);
+    CHECK(perf_counters::scale(1000, 500, 250) == 2000);
+    CHECK(perf_counters::scale(1000, 300, 100) == 3000);
+  }
+
+  SECTION("difference saturates at zero")
+  {
+    perf_counters::values const a{.cycles = 10, .instructions = 20, .cache_misses = 3, .branch_misses = 4};
+    perf_counters::values const b{.cycles = 15, .instructions = 18, .cache_misses = 3, .branch_misses = 5};
+    CHECK(b - a == perf_counters::values{.cycles = 5, .instructions = 0, .cache_misses = 0, .branch_misses = 1});
+  }
+
+  SECTION("counters of the calling thread")
+  {
+    // NOTE: hardware counters are not available in some environments, e.g. virtual machines
+    auto counters = perf_counters::make();
+    if (not counters) {
+      CHECK(counters.error().code() == error::open_perf);
+      CHECK(counters.error().what().starts_with("failed to open counter of "));
+      return;
+    }
+    auto const first = counters->read().value();
+    volatile std::uint64_t sum = 0;
+    for (std::uint64_t i = 0; i < 100'000; ++i) {
+      sum = sum + i;
+    }
+    auto const second = counters->read().value();
+    CHECK((second - first).instructions >= 100'000);
+  }
+}
+
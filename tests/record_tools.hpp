@@ -0,0 +1,46 @@
+#ifndef TESTS_RECORD_TOOLS
+#define TESTS_RECORD_TOOLS
+
+#include "savefile_tools.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "lib/savefile.hpp"
+
+// Pcap file of 200 records, with data of record i being i % 101 bytes, each equal to i
+inline auto make_sample_savefile() -> packet_t
+{
+  packet_t ret = make_savefile_header();
+  for (std::size_t i = 0; i < 200; ++i) {
+    packet_t data(i % 101);
+    std::ranges::fill(data, static_cast<unsigned char>(i));
+    append_savefile_record(data, ret);
+  }
+  return ret;
+}
+
+// Data of all records read from records, e.g. chunked_records or follow_records, up to count at a time
+auto walk_records(auto &records, std::size_t count) -> std::vector<packet_t>
+{
+  std::vector<packet_t> ret;
+  while (records.next(count, [&ret](savefile::record const &record) {
+    ret.emplace_back(record.data.begin(), record.data.end());
+  }) > 0) {
+  }
+  return ret;
+}
+
+// Data of all records of a pcap file held in memory, as read by savefile::records
+inline auto savefile_records(packet_t const &file) -> std::vector<packet_t>
+{
+  std::vector<packet_t> ret;
+  savefile::records records{.header = savefile::file_header::make(file).value(), .file = file};
+  for (auto record = records.next(); record.has_value(); record = records.next()) {
+    ret.emplace_back(record->data.begin(), record->data.end());
+  }
+  return ret;
+}
+
+#endif // TESTS_RECORD_TOOLS
@@ -0,0 +1,210 @@
+#include "mock_inputs.hpp"
+#include "packet_tools.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lib/reorder_window.hpp"
+#include "lib/stats.hpp"
+
+namespace {
+// Packets with given sequence numbers, each sent at sequence * 1000ns plus delay
+auto make_packets(std::vector<std::uint32_t> const &sequences, long delay) -> std::vector<packet_t>
+{
+  std::vector<packet_t> ret;
+  for (auto const sequence : sequences) {
+    ret.push_back(make_packet(sequence, sequence * 1000L + delay));
+  }
+  return ret;
+}
+
+// Sequence numbers of slots evicted from the window
+struct evictions final {
+  std::vector<std::uint32_t> sequences = {};
+  auto operator()(reorder_window::slot const &item) -> void { sequences.push_back(item.sequence); }
+};
+} // namespace
+
+TEST_CASE("reorder window")
+{
+  reorder_window window(6); // NOTE: table of 8 slots
+  CHECK(window.size() == 6);
+  evictions evicted;
+
+  auto const put = [&](std::uint32_t sequence) {
+    REQUIRE(window.advance(pair_select::A, sequence, std::ref(evicted)));
+    auto &item = window.at(sequence);
+    item.sequence = sequence;
+    item.received.A = true;
+  };
+
+  SECTION("slots fall out of the window")
+  {
+    for (std::uint32_t const sequence : {1, 2, 3, 5, 4, 6}) {
+      put(sequence);
+    }
+    CHECK(evicted.sequences.empty());
+    CHECK(window.at(4).used());
+    CHECK(not window.at(7).used());
+
+    put(8); // window is now [3, 8]
+    CHECK(evicted.sequences == std::vector<std::uint32_t>{1, 2});
+    CHECK(not window.advance(pair_select::A, 2, std::ref(evicted)));
+    CHECK(window.advance(pair_select::A, 3, std::ref(evicted)));
+    CHECK(window.at(3).used());
+
+    put(9);
+    CHECK(evicted.sequences == std::vector<std::uint32_t>{1, 2, 3});
+    CHECK(window.at(9).used());
+
+    put(100); // everything falls out
+    CHECK(evicted.sequences.size() == 8); // 1, 2, 3 and 4, 5, 6, 8, 9
+    evicted.sequences.clear();
+    window.flush(std::ref(evicted));
+    CHECK(evicted.sequences == std::vector<std::uint32_t>{100});
+  }
+
+  SECTION("window of each channel")
+  {
+    put(10);
+    CHECK(window.advance(pair_select::B, 5, std::ref(evicted))); // before the window of A, but not of B
+    CHECK(not window.advance(pair_select::B, 4, std::ref(evicted))); // before the window of the table
+    CHECK(window.advance(pair_select::B, 12, std::ref(evicted)));
+    CHECK(not window.advance(pair_select::B, 6, std::ref(evicted))); // before the window of B now
+    CHECK(window.advance(pair_select::A, 11, std::ref(evicted)));
+    CHECK(evicted.sequences.empty());
+  }
+
+  SECTION("start near zero")
+  {
+    put(0);
+    put(2);
+    put(4);
+    CHECK(evicted.sequences.empty());
+    put(6);
+    CHECK(evicted.sequences == std::vector<std::uint32_t>{0});
+    CHECK(window.at(2).used());
+  }
+}
+
+TEST_CASE("stats calculation with reorder window")
+{
+  SECTION("same as strict merge when packets are in order")
+  {
+    auto const a = make_packets({1, 2, 3, 4, 5, 6, 7, 8}, 10);
+    auto const b = make_packets({1, 2, 3, 4, 5, 6, 7, 8, 9}, 20);
+    auto const expected = stats::make(MockInputs(a, b));
+    for (std::uint32_t const size : {1, 2, 8, 1000}) {
+      CHECK(stats::make(MockInputs(a, b), merge_extras{.window = size}) == expected);
+    }
+  }
+
+  SECTION("packets dropped in order")
+  {
+    auto const a = make_packets({1, 2, 3, 5, 6, 7, 9, 10, 11, 12}, 10);
+    auto const b = make_packets({1, 2, 3, 4, 5, 7, 8, 9, 11, 12, 13}, 20);
+    for (std::uint32_t const size : {4, 1000}) {
+      auto const joined = stats::make(MockInputs(a, b), merge_extras{.window = size});
+      CHECK(joined.packet_count == pair<std::size_t>{.A = 10, .B = 11});
+      CHECK(joined.dropped_count == pair<std::size_t>{.A = 2, .B = 2}); // 4, 8 and 6, 10
+      CHECK(joined.faster_count == pair<std::size_t>{.A = 8, .B = 0});
+    }
+  }
+
+  SECTION("reordered packets are matched within the window")
+  {
+    auto const a = make_packets({1, 2, 4, 3, 5, 6, 8, 9, 7, 10}, 10);
+    auto const b = make_packets({1, 2, 3, 4, 5, 7, 6, 8, 9, 10}, 20);
+    auto const strict = stats::make(MockInputs(a, b));
+    CHECK(strict.dropped_count.A + strict.dropped_count.B > 0);
+
+    auto const joined = stats::make(MockInputs(a, b), merge_extras{.window = 4});
+    CHECK(joined.packet_count == pair<std::size_t>{.A = 10, .B = 10});
+    CHECK(joined.dropped_count == pair<std::size_t>{.A = 0, .B = 0});
+    CHECK(joined.faster_count == pair<std::size_t>{.A = 10, .B = 0});
+    CHECK(joined.advantage_total_ns.A == 100.0);
+    CHECK(joined.advantage_histogram.A.max == 10);
+
+    // Too late for a smaller window
+    auto const narrow = stats::make(MockInputs(a, b), merge_extras{.window = 1});
+    CHECK(narrow.dropped_count.A + narrow.dropped_count.B > 0);
+  }
+
+  SECTION("burst lost by one channel is longer than the window")
+  {
+    std::vector<std::uint32_t> all;
+    std::vector<std::uint32_t> burst;
+    for (std::uint32_t i = 1; i <= 100; ++i) {
+      all.push_back(i);
+      if (i <= 10 || i >= 60) {
+        burst.push_back(i);
+      }
+    }
+    auto const a = make_packets(all, 10);
+    auto const b = make_packets(burst, 20);
+    for (std::uint32_t const size : {1, 8, 1000}) {
+      auto const joined = stats::make(MockInputs(a, b), merge_extras{.window = size});
+      CHECK(joined.packet_count == pair<std::size_t>{.A = 100, .B = 51});
+      CHECK(joined.late_count == pair<std::size_t>{.A = 0, .B = 0});
+      CHECK(joined.dropped_count == pair<std::size_t>{.A = 0, .B = 49});
+      CHECK(joined.faster_count == pair<std::size_t>{.A = 51, .B = 0});
+
+      // Same when the burst is lost by the other channel
+      auto const swapped = stats::make(MockInputs(b, a), merge_extras{.window = size});
+      CHECK(swapped.late_count == pair<std::size_t>{.A = 0, .B = 0});
+      CHECK(swapped.dropped_count == pair<std::size_t>{.A = 49, .B = 0});
+    }
+  }
+
+  SECTION("duplicates, late packets and the end of a channel")
+  {
+    auto const a = make_packets({1, 2, 2, 3, 4, 5, 6, 7, 8, 1, 9}, 20);
+    auto const b = make_packets({1, 2, 4, 5}, 10);
+    std::vector<std::string> logged;
+    auto const joined = stats::make(MockInputs(a, b), merge_extras{.window = 4}, [&logged](std::string line) { //
+      logged.push_back(std::move(line));
+    });
+    CHECK(joined.packet_count == pair<std::size_t>{.A = 10, .B = 4}); // including the late 1
+    CHECK(joined.late_count == pair<std::size_t>{.A = 1, .B = 0});
+    CHECK(joined.dropped_count == pair<std::size_t>{.A = 0, .B = 1}); // 3, but not after B ended
+    CHECK(joined.faster_count == pair<std::size_t>{.A = 0, .B = 4});
+    CHECK(logged == std::vector<std::string>{"0,duplicate", "0,out of window"});
+  }
+
+  SECTION("any readers")
+  {
+    auto const a = make_packets({1, 3, 2, 4, 5, 7, 6, 8}, 10);
+    auto const b = make_packets({2, 1, 3, 5, 4, 6, 8, 7}, 5);
+    auto const expected = stats::make(MockInputs(a, b), merge_extras{.window = 4});
+    for (std::size_t const batch_size : {1, 3, 256}) {
+      CHECK(stats::make(MockInputs(a, b, batch_size), merge_extras{.window = 4}) == expected);
+      CHECK(stats::make(prefetch_inputs<MockInputs>(MockInputs(a, b, batch_size)), merge_extras{.window = 4})
+            == expected);
+    }
+    CHECK(expected.dropped_count == pair<std::size_t>{.A = 0, .B = 0});
+    CHECK(expected.faster_count == pair<std::size_t>{.A = 0, .B = 8});
+  }
+
+  SECTION("combined with other extras")
+  {
+    auto const a = make_packets({1, 3, 2, 4, 5, 7, 6, 8, 9, 10}, 10);
+    auto const b = make_packets({2, 1, 3, 5, 4, 6, 8, 7, 9, 10}, 5);
+    pair<sequence_gaps> gaps = {};
+    auto const range = packet_range{.from = std::uint32_t{3}, .to = std::uint32_t{8}};
+    auto const result = stats::make(MockInputs(a, b), merge_extras{.range = range, .gaps = &gaps, .window = 4});
+
+    pair<sequence_gaps> expected_gaps = {};
+    auto const expected = stats::make(MockInputs(make_packets({3, 4, 5, 7, 6, 8}, 10), //
+                                                 make_packets({3, 5, 4, 6, 8, 7}, 5)),
+                                      merge_extras{.gaps = &expected_gaps, .window = 4});
+    CHECK(result == expected);
+    CHECK(result.packet_count == pair<std::size_t>{.A = 6, .B = 6});
+    CHECK(result.faster_count == pair<std::size_t>{.A = 0, .B = 6});
+    CHECK(gaps == expected_gaps);
+  }
+}
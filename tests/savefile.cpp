@@ -0,0 +1,156 @@
+#include "packet_tools.hpp"
+#include "savefile_tools.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "lib/savefile.hpp"
+
+TEST_CASE("savefile header")
+{
+  SECTION("invalid inputs")
+  {
+    CHECK(savefile::file_header::make({}).error() == error(error::open_pcap, "truncated dump file header"));
+
+    packet_t header = make_savefile_header();
+    header.resize(savefile::file_header_length - 1);
+    CHECK(savefile::file_header::make(header).error() == error(error::open_pcap, "truncated dump file header"));
+
+    CHECK(savefile::file_header::make(make_savefile_header(false, 0x0a0d0d0a)).error()
+          == error(error::open_pcap, "unknown file format"));
+  }
+
+  SECTION("valid inputs")
+  {
+    using T = savefile::file_header;
+    CHECK(savefile::file_header::make(make_savefile_header()).value()
+          == T{.swapped = false, .nanoseconds = false, .snaplen = 262144, .linktype = 1});
+    CHECK(savefile::file_header::make(make_savefile_header(true)).value()
+          == T{.swapped = true, .nanoseconds = false, .snaplen = 262144, .linktype = 1});
+    CHECK(savefile::file_header::make(make_savefile_header(false, savefile::magic_nanoseconds, 113)).value()
+          == T{.swapped = false, .nanoseconds = true, .snaplen = 262144, .linktype = 113});
+    CHECK(savefile::file_header::make(make_savefile_header(true, savefile::magic_nanoseconds, 0x0400'0001)).value()
+          == T{.swapped = true, .nanoseconds = true, .snaplen = 262144, .linktype = 1});
+  }
+}
+
+TEST_CASE("savefile records")
+{
+  auto const records = [](packet_t const &file) -> savefile::records {
+    return {.header = savefile::file_header::make(file).value(), .file = file};
+  };
+
+  SECTION("no records")
+  {
+    packet_t const file = make_savefile_header();
+    auto r = records(file);
+    CHECK(not r.next().has_value());
+  }
+
+  for (bool const swapped : {false, true}) {
+    SECTION(swapped ? "swapped" : "native")
+    {
+      packet_t file = make_savefile_header(swapped);
+      append_savefile_record(example_packet, file, swapped, 12, 34);
+      append_savefile_record({}, file, swapped);
+      append_savefile_record({0x01, 0x02}, file, swapped, 0, 0, 60);
+
+      auto r = records(file);
+      CHECK(r.peek()->header.fraction == 34);
+      CHECK(r.offset == savefile::file_header_length);
+      auto const first = r.next();
+      REQUIRE(first.has_value());
+      CHECK(first->header
+            == savefile::record_header{.seconds = 12,
+                                       .fraction = 34,
+                                       .caplen = static_cast<uint32_t>(example_packet.size()),
+                                       .len = static_cast<uint32_t>(example_packet.size())});
+      CHECK(std::ranges::equal(first->data, example_packet));
+      CHECK(first->data.data() == file.data() + savefile::file_header_length + savefile::record_header_length);
+
+      auto const second = r.next();
+      REQUIRE(second.has_value());
+      CHECK(second->header.caplen == 0);
+      CHECK(second->data.empty());
+
+      auto const third = r.next();
+      REQUIRE(third.has_value());
+      CHECK(third->header.caplen == 2);
+      CHECK(third->header.len == 60);
+      CHECK(std::ranges::equal(third->data, packet_t{0x01, 0x02}));
+
+      CHECK(not r.next().has_value());
+      CHECK(r.offset == file.size());
+    }
+  }
+
+  SECTION("truncated record")
+  {
+    packet_t file = make_savefile_header();
+    append_savefile_record(example_packet, file);
+    auto const complete = file.size();
+    append_savefile_record(example_packet, file);
+
+    SECTION("truncated data")
+    {
+      file.resize(file.size() - 1);
+      auto r = records(file);
+      CHECK(r.next().has_value());
+      CHECK(not r.next().has_value());
+      CHECK(r.offset == complete);
+    }
+
+    SECTION("truncated header")
+    {
+      file.resize(complete + savefile::record_header_length - 1);
+      auto r = records(file);
+      CHECK(r.next().has_value());
+      CHECK(not r.next().has_value());
+      CHECK(r.offset == complete);
+    }
+  }
+}
+
+TEST_CASE("savefile bisect")
+{
+  // Records with seconds 0, 1, 2, ... and every 10th record with len different from caplen
+  constexpr std::uint32_t count = 20000;
+  packet_t file = make_savefile_header();
+  std::vector<std::size_t> offsets;
+  for (std::uint32_t i = 0; i < count; ++i) {
+    offsets.push_back(file.size());
+    append_savefile_record(example_packet, file, false, i, 0, i % 10 == 9 ? 1000 : 0);
+  }
+  auto const header = savefile::file_header::make(file).value();
+
+  for (std::uint32_t const target : {0u, 1u, 2u, 500u, 10000u, 19998u, 19999u, 20000u, 30000u}) {
+    CAPTURE(target);
+    std::size_t calls = 0;
+    auto const offset = savefile::bisect(header, file, [&](savefile::record const &r) -> std::optional<bool> {
+      calls += 1;
+      if (r.header.caplen != r.header.len) {
+        return std::nullopt;
+      }
+      return r.header.seconds < target;
+    });
+
+    // Result is the start of a record before the target, and close to it
+    auto const found = std::ranges::find(offsets, offset);
+    if (offset != savefile::file_header_length) {
+      REQUIRE(found != offsets.end());
+      CHECK(static_cast<std::uint32_t>(found - offsets.begin()) < target);
+    }
+    auto const first = std::min<std::size_t>(target, count);
+    CHECK((first == count ? file.size() : offsets[first]) - offset <= 64 * 1024 + example_packet.size() * 20);
+    CHECK(calls < 100);
+  }
+
+  // Nothing to search in an empty file
+  packet_t const empty = make_savefile_header();
+  CHECK(savefile::bisect(header, empty, [](savefile::record const &) { return std::optional<bool>(true); })
+        == savefile::file_header_length);
+}
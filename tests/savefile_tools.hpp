@@ -0,0 +1,54 @@
+#ifndef TESTS_SAVEFILE_TOOLS
+#define TESTS_SAVEFILE_TOOLS
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using packet_t = std::vector<unsigned char>;
+
+inline void append_u32(uint32_t value, bool swapped, packet_t &out)
+{
+  if (swapped) {
+    value = std::byteswap(value);
+  }
+  unsigned char bytes[sizeof(value)] = {};
+  std::memcpy(bytes, &value, sizeof(value));
+  out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+inline void append_u16(uint16_t value, bool swapped, packet_t &out)
+{
+  if (swapped) {
+    value = std::byteswap(value);
+  }
+  unsigned char bytes[sizeof(value)] = {};
+  std::memcpy(bytes, &value, sizeof(value));
+  out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+inline auto make_savefile_header(bool swapped = false, uint32_t magic = 0xa1b2c3d4, uint32_t linktype = 1) -> packet_t
+{
+  packet_t ret;
+  append_u32(magic, swapped, ret);
+  append_u16(2, swapped, ret); // version major
+  append_u16(4, swapped, ret); // version minor
+  append_u32(0, swapped, ret); // thiszone
+  append_u32(0, swapped, ret); // sigfigs
+  append_u32(262144, swapped, ret);
+  append_u32(linktype, swapped, ret);
+  return ret;
+}
+
+inline void append_savefile_record(packet_t const &data, packet_t &out, bool swapped = false, uint32_t seconds = 0,
+                                   uint32_t fraction = 0, uint32_t len = 0)
+{
+  append_u32(seconds, swapped, out);
+  append_u32(fraction, swapped, out);
+  append_u32(static_cast<uint32_t>(data.size()), swapped, out);
+  append_u32(len == 0 ? static_cast<uint32_t>(data.size()) : len, swapped, out);
+  out.insert(out.end(), data.begin(), data.end());
+}
+
+#endif // TESTS_SAVEFILE_TOOLS
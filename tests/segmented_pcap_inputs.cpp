@@ -0,0 +1,96 @@
+#include "mock_inputs.hpp"
+#include "packet_tools.hpp"
+#include "pcapng_tools.hpp"
+#include "savefile_tools.hpp"
+#include "temp_directory.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lib/segmented_pcap_inputs.hpp"
+#include "lib/stats.hpp"
+
+namespace {
+auto make_packets(std::uint32_t from, std::uint32_t to) -> std::vector<packet_t>
+{
+  std::vector<packet_t> ret;
+  for (std::uint32_t i = from; i < to; ++i) {
+    ret.push_back(make_packet(i, i * 1000L));
+  }
+  return ret;
+}
+
+auto make_pcap(std::vector<packet_t> const &packets) -> packet_t
+{
+  auto ret = make_savefile_header();
+  for (auto const &packet : packets) {
+    append_savefile_record(packet, ret);
+  }
+  return ret;
+}
+
+auto make_pcapng(std::vector<packet_t> const &packets) -> packet_t
+{
+  packet_t ret;
+  append_section(false, ret);
+  append_interface(1, 262144, 9, false, ret);
+  for (auto const &packet : packets) {
+    append_packet(0, 0, packet, false, ret);
+  }
+  return ret;
+}
+
+auto concat(std::vector<std::vector<packet_t>> const &segments) -> std::vector<packet_t>
+{
+  std::vector<packet_t> ret;
+  for (auto const &segment : segments) {
+    ret.insert(ret.end(), segment.begin(), segment.end());
+  }
+  return ret;
+}
+} // namespace
+
+TEST_CASE("segmented pcap inputs")
+{
+  temp_directory const dir;
+
+  SECTION("segments of any format are read as one stream")
+  {
+    // NOTE: a file which is not compressed is read as is by decompress_source, the name selects how it is opened
+    auto const a = std::vector{make_packets(1, 300), make_packets(300, 400), make_packets(400, 1000)};
+    auto const b = std::vector{make_packets(1, 600), make_packets(600, 1000)};
+    pair<std::vector<std::string>> const segments
+        = {.A = {dir.write("a-0.pcap", make_pcap(a[0])), dir.write("a-1.pcap", make_pcapng(a[1])),
+                 dir.write("a-2.pcap.gz", make_pcap(a[2]))},
+           .B = {dir.write("b-0.pcap.zst", make_pcap(b[0])), dir.write("b-1.pcapng", make_pcapng(b[1]))}};
+
+    auto const expected = stats::make(MockInputs(concat(a), concat(b)));
+    CHECK(expected.packet_count == pair<std::size_t>{.A = 999, .B = 999});
+    CHECK(stats::make(SegmentedPcapInputs::make(segments).value()) == expected);
+    auto dynamic = SegmentedPcapInputs::make(segments).value();
+    CHECK(stats::make(static_cast<Inputs &&>(dynamic)) == expected);
+  }
+
+  SECTION("every segment is checked when opening")
+  {
+    auto const first = dir.write("a-0.pcap", make_pcap(make_packets(1, 10)));
+    auto const invalid = dir.write("a-1.pcap", {0x01, 0x02});
+    auto const missing = dir.file("b-1.pcap.gz");
+
+    CHECK(SegmentedPcapInputs::make({.A = {}, .B = {first}}).error()
+          == error(error::open_pcap, "no segments of channel A"));
+
+    auto const opened = SegmentedPcapInputs::make({.A = {first, invalid}, .B = {first}});
+    REQUIRE(not opened);
+    CHECK(opened.error().code() == error::open_pcap);
+    CHECK(opened.error().what().starts_with("failed to open file A: " + invalid + ", error: invalid file: " + invalid));
+
+    auto const found = SegmentedPcapInputs::make({.A = {first}, .B = {first, missing}});
+    REQUIRE(not found);
+    CHECK(found.error().code() == error::open_pcap);
+    CHECK(found.error().what().starts_with("failed to open file B: " + missing + ", error: "));
+  }
+}
@@ -0,0 +1,99 @@
+#include "mock_inputs.hpp"
+#include "packet_tools.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <cstdint>
+#include <initializer_list>
+#include <sstream>
+#include <vector>
+
+#include "lib/sequence_gaps.hpp"
+#include "lib/stats.hpp"
+
+namespace {
+using interval = interval_set::interval;
+
+auto record(std::initializer_list<std::uint32_t> sequences) -> sequence_gaps
+{
+  sequence_gaps ret;
+  for (auto const sequence : sequences) {
+    ret.record(sequence);
+  }
+  return ret;
+}
+
+auto print(sequence_gaps const &gaps) -> std::string
+{
+  std::ostringstream ss;
+  ss << gaps;
+  return ss.str();
+}
+
+auto packets(std::initializer_list<std::uint32_t> sequences) -> std::vector<packet_t>
+{
+  std::vector<packet_t> ret;
+  for (auto const sequence : sequences) {
+    ret.push_back(example_packet);
+    set_sequence(sequence, ret.back());
+  }
+  return ret;
+}
+} // namespace
+
+TEST_CASE("sequence gaps")
+{
+  SECTION("in sequence")
+  {
+    auto const gaps = record({10, 11, 12, 13});
+    CHECK(gaps.first == 10);
+    CHECK(gaps.highest == 13);
+    CHECK(gaps.missing.empty());
+    CHECK(gaps.late.empty());
+    CHECK(gaps.duplicate.empty());
+    CHECK(print(gaps) == "missing 0, late 0, duplicate 0");
+    CHECK(record({}) == sequence_gaps{});
+  }
+
+  SECTION("missing")
+  {
+    auto const gaps = record({10, 12, 13, 17, 18, 20});
+    CHECK(gaps.missing.intervals() == std::vector<interval>{{11, 11}, {14, 16}, {19, 19}});
+    CHECK(gaps.late.empty());
+    CHECK(gaps.duplicate.empty());
+    CHECK(print(gaps) == "missing 5 (11, 14-16, 19), late 0, duplicate 0");
+  }
+
+  SECTION("late and duplicate")
+  {
+    auto const gaps = record({10, 12, 13, 11, 14, 11, 14, 16, 8});
+    CHECK(gaps.first == 8);
+    CHECK(gaps.highest == 16);
+    CHECK(gaps.missing.intervals() == std::vector<interval>{{9, 9}, {15, 15}});
+    CHECK(gaps.late.intervals() == std::vector<interval>{{8, 8}, {11, 11}});
+    CHECK(gaps.duplicate.intervals() == std::vector<interval>{{11, 11}, {14, 14}});
+    CHECK(print(gaps) == "missing 2 (9, 15), late 2 (8, 11), duplicate 2 (11, 14)");
+  }
+}
+
+TEST_CASE("stats calculation with sequence gaps")
+{
+  auto const a = packets({1, 2, 3, 5, 6, 4, 7, 8, 9});
+  auto const b = packets({1, 2, 3, 4, 4, 5, 8, 9});
+  auto const expected = stats::make(MockInputs(a, b));
+
+  for (std::size_t const batch_size : {1, 3, 256}) {
+    pair<sequence_gaps> gaps;
+    CHECK(stats::make(MockInputs(a, b, batch_size), merge_extras{.gaps = &gaps}) == expected);
+    CHECK(gaps.A == record({1, 2, 3, 5, 6, 4, 7, 8, 9}));
+    CHECK(gaps.B == record({1, 2, 3, 4, 4, 5, 8, 9}));
+    CHECK(print(gaps.A) == "missing 0, late 1 (4), duplicate 0");
+    CHECK(print(gaps.B) == "missing 2 (6-7), late 0, duplicate 1 (4)");
+
+    // Same as above, but read and parsed in background threads
+    pair<sequence_gaps> prefetched;
+    CHECK(stats::make(prefetch_inputs<MockInputs>(MockInputs(a, b, batch_size)), merge_extras{.gaps = &prefetched})
+          == expected);
+    CHECK(prefetched == gaps);
+  }
+}
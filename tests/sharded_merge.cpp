@@ -0,0 +1,112 @@
+#include "mock_inputs.hpp"
+#include "packet_tools.hpp"
+#include "savefile_tools.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <netinet/in.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lib/sharded_merge.hpp"
+
+namespace {
+// Packets of one channel, with some dropped, swapped and broken
+auto make_packets(std::uint32_t count, std::uint32_t drop, std::uint32_t swap, std::uint32_t bad, long jitter)
+    -> std::vector<packet_t>
+{
+  std::vector<packet_t> ret;
+  for (std::uint32_t i = 1; i <= count; ++i) {
+    if (i % drop == 0) {
+      continue;
+    }
+    ret.push_back(make_packet(i, i * 1000L + (i * 7L) % jitter));
+    if (i % bad == 0) {
+      set_ip_protocol(IPPROTO_TCP, ret.back());
+    }
+    if (i % swap == 0 && ret.size() > 1) {
+      std::swap(ret[ret.size() - 1], ret[ret.size() - 2]);
+    }
+  }
+  return ret;
+}
+
+// Savefiles of consecutive parts of packets
+auto make_segments(std::vector<packet_t> const &packets, std::size_t segments) -> std::vector<packet_t>
+{
+  std::vector<packet_t> ret(segments, make_savefile_header());
+  for (std::size_t i = 0; i < packets.size(); ++i) {
+    append_savefile_record(packets[i], ret[i * segments / packets.size()]);
+  }
+  return ret;
+}
+
+auto make_channel(std::vector<packet_t> const &files) -> sharded_merge::channel
+{
+  sharded_merge::channel ret;
+  for (auto const &file : files) {
+    ret.segments.push_back({.header = savefile::file_header::make(file).value(), .file = file});
+  }
+  return ret;
+}
+} // namespace
+
+TEST_CASE("sharded merge")
+{
+  auto const packets_a = make_packets(4000, 37, 101, 53, 13);
+  auto const packets_b = make_packets(4000, 23, 89, 61, 1500);
+  auto const files_a = make_segments(packets_a, 3);
+  auto const files_b = make_segments(packets_b, 2);
+  auto const channels = pair<sharded_merge::channel>{.A = make_channel(files_a), .B = make_channel(files_b)};
+
+  work_stealing_pool pool(4);
+  std::vector<std::string> expected_log;
+  auto const expected = stats::make(MockInputs(packets_a, packets_b), [&expected_log](std::string line) {
+    expected_log.push_back(std::move(line));
+  });
+  CHECK(sharded_merge::merge(channels, {}, pool) == expected);
+  CHECK(not expected_log.empty());
+
+  // Log of the combined shards, in order
+  auto const merge_logged = [&](std::vector<sharded_merge::boundary> const &boundaries) {
+    std::vector<std::string> ret;
+    CHECK(sharded_merge::merge(channels, boundaries, pool, [&ret](std::string line) {
+            ret.push_back(std::move(line));
+          })
+          == expected);
+    return ret;
+  };
+  CHECK(expected.packet_count.A > 3000);
+  CHECK(expected.dropped_count.A > 0);
+  CHECK(expected.faster_count.B > 0);
+
+  SECTION("boundaries")
+  {
+    for (std::size_t shards = 1; shards <= 24; ++shards) {
+      auto const boundaries = sharded_merge::find_boundaries(channels, shards, pool);
+      CHECK(boundaries.size() < shards);
+      for (std::size_t i = 1; i < boundaries.size(); ++i) {
+        CHECK(boundaries[i - 1].at.A < boundaries[i].at.A);
+        CHECK(boundaries[i - 1].at.B < boundaries[i].at.B);
+      }
+      CHECK(sharded_merge::merge(channels, boundaries, pool) == expected);
+      CHECK(merge_logged(boundaries) == expected_log);
+    }
+    CHECK(sharded_merge::find_boundaries(channels, 8, pool).size() > 4);
+  }
+
+  SECTION("wrong boundaries are skipped")
+  {
+    auto boundaries = sharded_merge::find_boundaries(channels, 6, pool);
+    REQUIRE(boundaries.size() > 3);
+    boundaries[0].sequence += 1;            // never in this state
+    boundaries[2].at.B.offset += 16 + 1;    // not a record boundary
+    boundaries[3].at.A = boundaries[1].at.A; // behind the previous one
+    CHECK(sharded_merge::merge(channels, boundaries, pool) == expected);
+    CHECK(merge_logged(boundaries) == expected_log);
+  }
+}
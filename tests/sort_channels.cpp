@@ -1,6 +1,7 @@
 #include <catch2/catch_all.hpp>
 
 #include <string>
+#include <vector>
 
 #include "lib/sort_channels.hpp"
 
@@ -8,29 +9,92 @@ TEST_CASE("sorting of channels")
 {
   SECTION("invalid inputs")
   {
-    CHECK(sort_channels({"", ""}).error() == error(error::find_channels, "first filename is empty"));
-    CHECK(sort_channels({"a", ""}).error() == error(error::find_channels, "second filename is empty"));
-
-    CHECK(sort_channels({"a", "a"}).error() == error(error::find_channels, "both filenames are identical"));
-    CHECK(sort_channels({"_14310-0.pcap", "_14310-0.pcap"}).error()
-          == error(error::find_channels, "both filenames are identical"));
-
-    CHECK(sort_channels({"a", "b"}).error() == error(error::find_channels, "unexpected channel of first file: a"));
-
-    CHECK(sort_channels({"_14310-0.pcap", "b"}).error()
-          == error(error::find_channels, "unexpected channel of second file: b"));
-    CHECK(sort_channels({"_15310-0.pcap", "b"}).error()
-          == error(error::find_channels, "unexpected channel of second file: b"));
-    CHECK(sort_channels({"_14310-0.pcap", "R_14310-0.pcap"}).error()
-          == error(error::find_channels, "unexpected channel of second file: R_14310-0.pcap"));
-    CHECK(sort_channels({"_15310-0.pcap", "R_15310-0.pcap"}).error()
-          == error(error::find_channels, "unexpected channel of second file: R_15310-0.pcap"));
+    CHECK(sort_channels({"", ""}).error() == error(error::find_channels, "filename is empty"));
+    CHECK(sort_channels({"_14310-0.pcap", ""}).error() == error(error::find_channels, "filename is empty"));
+
+    CHECK(sort_channels({"a", "b"}).error() == error(error::find_channels, "unexpected channel of file: a"));
+    CHECK(sort_channels({"_14310-0.pcap", "b"}).error() == error(error::find_channels, "unexpected channel of file: b"));
+    CHECK(sort_channels({"_14310-0.pcap", "_16310-0.pcap"}).error()
+          == error(error::find_channels, "unexpected channel of file: _16310-0.pcap"));
+    CHECK(sort_channels({"_14310-0.pcap.bz2", "_15310-0.pcap"}).error()
+          == error(error::find_channels, "unexpected channel of file: _14310-0.pcap.bz2"));
+    CHECK(sort_channels({"_14310-0.pcap", "_15310-0.pcap.gz.zst"}).error()
+          == error(error::find_channels, "unexpected channel of file: _15310-0.pcap.gz.zst"));
+    CHECK(sort_channels({"_14310-0.pcap", "_15310-.pcap"}).error()
+          == error(error::find_channels, "unexpected channel of file: _15310-.pcap"));
+    CHECK(sort_channels({"_14310-0xpcap", "_15310-0.pcap"}).error()
+          == error(error::find_channels, "unexpected channel of file: _14310-0xpcap"));
+    CHECK(sort_channels({"_14310-0.pcapn", "_15310-0.pcap"}).error()
+          == error(error::find_channels, "unexpected channel of file: _14310-0.pcapn"));
+    CHECK(sort_channels({"_14310-0.pcap", "_15310-0.pcapng.idx.gz"}).error()
+          == error(error::find_channels, "unexpected channel of file: _15310-0.pcapng.idx.gz"));
+
+    CHECK(sort_channels({}).error() == error(error::find_channels, "no files of channel A"));
+    CHECK(sort_channels({"_14310-0.pcap", "R_14310-1.pcap"}).error()
+          == error(error::find_channels, "no files of channel B"));
+    CHECK(sort_channels({"_15310-0.pcap", "R_15310-1.pcap"}).error()
+          == error(error::find_channels, "no files of channel A"));
+    CHECK(sort_channels({"_14310-0.pcap", "R_14310-0.pcap", "_15310-0.pcap"}).error()
+          == error(error::find_channels, "duplicate segment 0 of channel A: _14310-0.pcap, R_14310-0.pcap"));
+  }
+
+  SECTION("valid inputs")
+  {
+    using T = pair<std::vector<std::string>>;
+    CHECK(sort_channels({"_14310-0.pcap", "_15310-0.pcap"}).value()
+          == T{.A = {"_14310-0.pcap"}, .B = {"_15310-0.pcap"}});
+    CHECK(sort_channels({"_15310-0.pcap", "_14310-0.pcap"}).value()
+          == T{.A = {"_14310-0.pcap"}, .B = {"_15310-0.pcap"}});
+    CHECK(sort_channels({"_15310-0.pcap.gz", "_14310-0.pcap.zst"}).value()
+          == T{.A = {"_14310-0.pcap.zst"}, .B = {"_15310-0.pcap.gz"}});
+    CHECK(sort_channels({"_15310-0.pcapng", "_14310-0.pcapng.gz"}).value()
+          == T{.A = {"_14310-0.pcapng.gz"}, .B = {"_15310-0.pcapng"}});
+    CHECK(sort_channels({"_14310-0.pcapng", "_14310-0.pcapng.idx", "_15310-0.pcapng.cols", "_15310-0.pcapng.zst"})
+              .value()
+          == T{.A = {"_14310-0.pcapng"}, .B = {"_15310-0.pcapng.zst"}});
+    CHECK(sort_channels({"_14310-0.pcap", "_14310-0.pcap.idx", "_15310-0.pcap.idx", "_15310-0.pcap"}).value()
+          == T{.A = {"_14310-0.pcap"}, .B = {"_15310-0.pcap"}});
+    CHECK(sort_channels({"_14310-0.pcap.cols", "_14310-0.pcap", "_15310-0.pcap", "_15310-0.pcap.cols"}).value()
+          == T{.A = {"_14310-0.pcap"}, .B = {"_15310-0.pcap"}});
+    CHECK(sort_channels({"_14310-0.pcap.idx.tmp", "_14310-0.pcap", "_15310-0.pcap", "_15310-0.pcap.cols.tmp"}).value()
+          == T{.A = {"_14310-0.pcap"}, .B = {"_15310-0.pcap"}});
+  }
+
+  SECTION("segments")
+  {
+    using T = pair<std::vector<std::string>>;
+    CHECK(sort_channels({"x_15310-10.pcap", "x_14310-2.pcap", "x_15310-9.pcap", "x_14310-10.pcap", "x_14310-1.pcap"})
+              .value()
+          == T{.A = {"x_14310-1.pcap", "x_14310-2.pcap", "x_14310-10.pcap"}, .B = {"x_15310-9.pcap", "x_15310-10.pcap"}});
+    CHECK(sort_channels({"x_14310-1.pcapng.zst", "x_15310-0.pcap", "x_14310-0.pcap.gz", "x_15310-1.pcapng"}).value()
+          == T{.A = {"x_14310-0.pcap.gz", "x_14310-1.pcapng.zst"}, .B = {"x_15310-0.pcap", "x_15310-1.pcapng"}});
+  }
+}
+
+TEST_CASE("sorting of feeds")
+{
+  SECTION("invalid inputs")
+  {
+    CHECK(sort_feeds({"_14310-0.pcap", ""}).error() == error(error::find_channels, "filename is empty"));
+    CHECK(sort_feeds({"a", "_14310-0.pcap"}).error() == error(error::find_channels, "unexpected channel of file: a"));
+    CHECK(sort_feeds({"x/_14310-0.pcap", "y/_14310-1.pcap"}).error()
+          == error(error::find_channels, "duplicate channel 14310: x/_14310-0.pcap, y/_14310-1.pcap"));
   }
 
   SECTION("valid inputs")
   {
-    using T = pair<std::string>;
-    CHECK(sort_channels({"_14310-0.pcap", "_15310-0.pcap"}).value() == T{.A = "_14310-0.pcap", .B = "_15310-0.pcap"});
-    CHECK(sort_channels({"_15310-0.pcap", "_14310-0.pcap"}).value() == T{.A = "_14310-0.pcap", .B = "_15310-0.pcap"});
+    using T = std::vector<feed_file>;
+    CHECK(sort_feeds({}).value() == T{});
+    CHECK(sort_feeds({"_9-0.pcap.idx"}).value() == T{});
+    CHECK(sort_feeds({"_9-0.pcap.cols"}).value() == T{});
+    CHECK(sort_feeds({"_9-0.pcap.idx.tmp"}).value() == T{});
+    CHECK(sort_feeds({"_9-0.pcapng.idx"}).value() == T{});
+    CHECK(sort_feeds({"_15310-0.pcap", "_9-0.pcap", "_14310-0.pcap.gz", "_16310-0.pcap"}).value()
+          == T{{.channel = "9", .file = "_9-0.pcap"},
+               {.channel = "14310", .file = "_14310-0.pcap.gz"},
+               {.channel = "15310", .file = "_15310-0.pcap"},
+               {.channel = "16310", .file = "_16310-0.pcap"}});
+    CHECK(sort_feeds({"_15310-0.pcapng", "_14310-0.pcapng.zst"}).value()
+          == T{{.channel = "14310", .file = "_14310-0.pcapng.zst"}, {.channel = "15310", .file = "_15310-0.pcapng"}});
   }
 }
@@ -0,0 +1,79 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <thread>
+
+#include "lib/spsc_ring.hpp"
+
+TEST_CASE("spsc ring")
+{
+  SECTION("capacity")
+  {
+    CHECK(spsc_ring<int>(0).capacity() == 2);
+    CHECK(spsc_ring<int>(3).capacity() == 4);
+    CHECK(spsc_ring<int>(4).capacity() == 4);
+    CHECK(spsc_ring<int>(1000).capacity() == 1024);
+  }
+
+  SECTION("single thread")
+  {
+    spsc_ring<int> ring(4);
+    int value = 0;
+    CHECK(not ring.try_pop(value));
+    CHECK(not ring.closed());
+
+    // Wrap around the end of slots a few times
+    for (int i = 0; i < 10; ++i) {
+      CHECK(ring.try_push(i * 10 + 1));
+      CHECK(ring.try_push(i * 10 + 2));
+      CHECK(ring.try_push(i * 10 + 3));
+      CHECK(ring.try_push(i * 10 + 4));
+      CHECK(not ring.try_push(-1));
+      CHECK(ring.try_pop(value));
+      CHECK(value == i * 10 + 1);
+      CHECK(ring.try_pop(value));
+      CHECK(value == i * 10 + 2);
+      CHECK(ring.try_pop(value));
+      CHECK(value == i * 10 + 3);
+      CHECK(ring.try_pop(value));
+      CHECK(value == i * 10 + 4);
+      CHECK(not ring.try_pop(value));
+    }
+
+    CHECK(ring.try_push(42));
+    ring.close();
+    CHECK(ring.closed());
+    CHECK(ring.try_pop(value));
+    CHECK(value == 42);
+    CHECK(not ring.try_pop(value));
+  }
+
+  SECTION("two threads")
+  {
+    constexpr std::size_t count = 100'000;
+    spsc_ring<std::size_t> ring(64);
+    std::jthread producer([&ring]() {
+      for (std::size_t i = 0; i < count; ++i) {
+        while (not ring.try_push(std::size_t{i})) {
+          std::this_thread::yield();
+        }
+      }
+      ring.close();
+    });
+
+    std::size_t expected = 0;
+    bool in_order = true;
+    std::size_t value = 0;
+    while (true) {
+      // Must check closed before try_pop, otherwise we might miss the last values
+      bool const closed = ring.closed();
+      if (ring.try_pop(value)) {
+        in_order = in_order && (value == expected++);
+      } else if (closed) {
+        break;
+      }
+    }
+    CHECK(in_order);
+    CHECK(expected == count);
+  }
+}
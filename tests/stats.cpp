@@ -1,5 +1,13 @@
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <sstream>
+#include <stop_token>
+#include <vector>
+
 #include <net/ethernet.h>
 #include <netinet/in.h>
 
@@ -8,6 +16,9 @@
 
 #include "lib/stats.hpp"
 
+static_assert(some_inputs<MockInputs>);
+static_assert(some_inputs<Inputs>);
+
 TEST_CASE("average calc")
 {
   stats const zero{.packet_count = {}, .dropped_count = {}, .faster_count = {}, .advantage_total_ns = {}};
@@ -32,6 +43,17 @@ TEST_CASE("average calc")
   }
 }
 
+namespace {
+auto histogram(std::initializer_list<std::uint64_t> values) -> latency_histogram
+{
+  latency_histogram ret;
+  for (auto const value : values) {
+    ret.record(value);
+  }
+  return ret;
+}
+} // namespace
+
 struct Logger {
   std::vector<std::string> log;
 
@@ -48,6 +70,19 @@ struct Logger {
 
 Logger const Logger::empty = {};
 
+// Same as self, with given parse errors counted in each channel
+auto with_errors(stats self, std::initializer_list<packet::parse_error> a, std::initializer_list<packet::parse_error> b)
+    -> stats
+{
+  for (auto const e : a) {
+    self.error_count.A.record(e);
+  }
+  for (auto const e : b) {
+    self.error_count.B.record(e);
+  }
+  return self;
+}
+
 inline auto operator<<(std::ostream &output, Logger const &self) -> std::ostream &
 {
   for (auto const &line : self.log) {
@@ -59,6 +94,8 @@ inline auto operator<<(std::ostream &output, Logger const &self) -> std::ostream
 TEST_CASE("stats calculation from inputs")
 {
   stats const zero{.packet_count = {}, .dropped_count = {}, .faster_count = {}, .advantage_total_ns = {}};
+  auto constexpr no_data = packet::parse_error::not_enough_data;
+  auto constexpr not_udp = packet::parse_error::not_udp;
 
   SECTION("empty inputs")
   {
@@ -71,17 +108,19 @@ TEST_CASE("stats calculation from inputs")
   {
     {
       Logger logger;
-      CHECK(stats::make(MockInputs({.A = {{}, {}}, .B = {}}), logger.fn()) == zero);
+      CHECK(stats::make(MockInputs({.A = {{}, {}}, .B = {}}), logger.fn())
+            == with_errors(zero, {no_data, no_data}, {}));
       CHECK(logger == Logger{{{"0,not enough data"}, {"0,not enough data"}}});
     }
     {
       Logger logger;
-      CHECK(stats::make(MockInputs({.A = {}, .B = {{}, {}}}), logger.fn()) == zero);
+      CHECK(stats::make(MockInputs({.A = {}, .B = {{}, {}}}), logger.fn())
+            == with_errors(zero, {}, {no_data, no_data}));
       CHECK(logger == Logger{{{"1,not enough data"}, {"1,not enough data"}}});
     }
     {
       Logger logger;
-      CHECK(stats::make(MockInputs({.A = {{}}, .B = {{}}}), logger.fn()) == zero);
+      CHECK(stats::make(MockInputs({.A = {{}}, .B = {{}}}), logger.fn()) == with_errors(zero, {no_data}, {no_data}));
       CHECK(logger == Logger{{{"0,not enough data"}, {"1,not enough data"}}});
     }
   }
@@ -95,13 +134,14 @@ TEST_CASE("stats calculation from inputs")
     {
       {
         Logger logger;
-        CHECK(stats::make(MockInputs({.A = {example}, .B = {}}), logger.fn()) == zero);
+        CHECK(stats::make(MockInputs({.A = {example}, .B = {}}), logger.fn()) == with_errors(zero, {not_udp}, {}));
         CHECK(logger == Logger{{{"0,not UDP"}}});
       }
 
       {
         Logger logger;
-        CHECK(stats::make(MockInputs({.A = {example}, .B = {{}}}), logger.fn()) == zero);
+        CHECK(stats::make(MockInputs({.A = {example}, .B = {{}}}), logger.fn())
+              == with_errors(zero, {not_udp}, {no_data}));
         CHECK(logger == Logger{{{"0,not UDP"}, {"1,not enough data"}}});
       }
     }
@@ -110,16 +150,28 @@ TEST_CASE("stats calculation from inputs")
     {
       {
         Logger logger;
-        CHECK(stats::make(MockInputs({.A = {}, .B = {example}}), logger.fn()) == zero);
+        CHECK(stats::make(MockInputs({.A = {}, .B = {example}}), logger.fn()) == with_errors(zero, {}, {not_udp}));
         CHECK(logger == Logger{{{"1,not UDP"}}});
       }
 
       {
         Logger logger;
-        CHECK(stats::make(MockInputs({.A = {{}}, .B = {example}}), logger.fn()) == zero);
+        CHECK(stats::make(MockInputs({.A = {{}}, .B = {example}}), logger.fn())
+              == with_errors(zero, {no_data}, {not_udp}));
         CHECK(logger == Logger{{{"0,not enough data"}, {"1,not UDP"}}});
       }
     }
+
+    SECTION("counted without log")
+    {
+      auto const result = stats::make(MockInputs({.A = {{}, example}, .B = {example}}));
+      CHECK(result == with_errors(zero, {no_data, not_udp}, {not_udp}));
+      CHECK(result.error_count.A.total() == 2);
+
+      std::ostringstream output;
+      output << result;
+      CHECK(output.str().ends_with("\nparse errors, not enough data: (A=1, B=0)\nparse errors, not UDP: (A=1, B=1)"));
+    }
   }
 
   SECTION("some packets with data")
@@ -164,7 +216,8 @@ TEST_CASE("stats calculation from inputs")
           {.packet_count{.A = 1, .B = 1},
            .dropped_count{.A = 0, .B = 0},
            .faster_count{.A = 1, .B = 0},
-           .advantage_total_ns{.A = 40.0, .B = 0}};
+           .advantage_total_ns{.A = 40.0, .B = 0},
+           .advantage_histogram{.A = histogram({40}), .B = {}}};
       CHECK(stats::make(MockInputs({.A = {exampleA}, .B = {exampleB}}), logger.fn()) == expected);
       CHECK(logger == Logger::empty);
     }
@@ -188,7 +241,8 @@ TEST_CASE("stats calculation from inputs")
           {.packet_count{.A = 1, .B = 2},
            .dropped_count{.A = 0, .B = 0},
            .faster_count{.A = 0, .B = 1},
-           .advantage_total_ns{.A = 0, .B = 2000.0}};
+           .advantage_total_ns{.A = 0, .B = 2000.0},
+           .advantage_histogram{.A = {}, .B = histogram({2000})}};
       CHECK(stats::make(MockInputs({.A = {exampleA1}, .B = {exampleB1, exampleB2}}), logger.fn()) == expected);
       CHECK(logger == Logger::empty);
     }
@@ -215,7 +269,8 @@ TEST_CASE("stats calculation from inputs")
           {.packet_count{.A = 2, .B = 2},
            .dropped_count{.A = 0, .B = 0},
            .faster_count{.A = 0, .B = 1},
-           .advantage_total_ns{.A = 0, .B = 2000.0}};
+           .advantage_total_ns{.A = 0, .B = 2000.0},
+           .advantage_histogram{.A = {}, .B = histogram({2000})}};
       CHECK(stats::make(MockInputs({.A = {exampleA1, exampleA2}, .B = {exampleB1, exampleB2}}), logger.fn())
             == expected);
       CHECK(logger == Logger::empty);
@@ -243,10 +298,262 @@ TEST_CASE("stats calculation from inputs")
           {.packet_count{.A = 2, .B = 2},
            .dropped_count{.A = 0, .B = 1},
            .faster_count{.A = 0, .B = 1},
-           .advantage_total_ns{.A = 0, .B = 2000.0}};
+           .advantage_total_ns{.A = 0, .B = 2000.0},
+           .advantage_histogram{.A = {}, .B = histogram({2000})}};
       CHECK(stats::make(MockInputs({.A = {exampleA1, exampleA2}, .B = {exampleB1, exampleB2}}), logger.fn())
             == expected);
       CHECK(logger == Logger::empty);
     }
   }
 }
+
+TEST_CASE("stats calculation from batches of different size")
+{
+  using namespace std::chrono_literals;
+  auto const sequence = get_sequence(example_packet);
+  REQUIRE(sequence.has_value());
+  auto const timestamp = get_timestamp(example_packet);
+  REQUIRE(timestamp.has_value());
+
+  packet_t exampleA1 = example_packet;
+  packet_t exampleA2 = exampleA1;
+  set_timestamp(*timestamp + 120us, exampleA2);
+  set_sequence(*sequence + 1, exampleA2);
+  packet_t exampleA3 = exampleA1;
+  set_timestamp(*timestamp + 300us, exampleA3);
+  set_sequence(*sequence + 2, exampleA3);
+  packet_t exampleB1 = exampleA1;
+  set_timestamp(*timestamp - 2us, exampleB1);
+  packet_t exampleB3 = exampleA3;
+  set_timestamp(*timestamp + 301us, exampleB3);
+  packet_t bad = example_packet;
+  REQUIRE(set_ip_protocol(IPPROTO_TCP, bad));
+
+  stats const expected = with_errors({.packet_count{.A = 3, .B = 2},
+                                      .dropped_count{.A = 0, .B = 0},
+                                      .faster_count{.A = 0, .B = 1},
+                                      .advantage_total_ns{.A = 0, .B = 2000.0},
+                                      .advantage_histogram{.A = {}, .B = histogram({2000})}},
+                                     {packet::parse_error::not_udp}, {});
+  for (std::size_t const batch_size : {1, 2, 3, 256}) {
+    {
+      Logger logger;
+      MockInputs inputs({.A = {exampleA1, bad, exampleA2, exampleA3}, .B = {exampleB1, exampleB3}}, batch_size);
+      CHECK(stats::make(std::move(inputs), logger.fn()) == expected);
+      CHECK(logger == Logger{{{"0,not UDP"}}});
+    }
+
+    // Same as above, but through dynamic dispatch
+    {
+      Logger logger;
+      MockInputs inputs({.A = {exampleA1, bad, exampleA2, exampleA3}, .B = {exampleB1, exampleB3}}, batch_size);
+      CHECK(stats::make(static_cast<Inputs &&>(inputs), logger.fn()) == expected);
+      CHECK(logger == Logger{{{"0,not UDP"}}});
+    }
+
+    // Same as above, but read and parsed in background threads
+    {
+      Logger logger;
+      MockInputs inputs({.A = {exampleA1, bad, exampleA2, exampleA3}, .B = {exampleB1, exampleB3}}, batch_size);
+      CHECK(stats::make(prefetch_inputs<MockInputs>(std::move(inputs)), logger.fn()) == expected);
+      CHECK(logger == Logger{{{"0,not UDP"}}});
+    }
+  }
+}
+
+TEST_CASE("stats calculation of a range of packets")
+{
+  using namespace std::chrono_literals;
+  auto const start = std::chrono::system_clock::time_point(1700000000s);
+  auto const make_packet = [&start](std::uint32_t sequence, std::chrono::nanoseconds delay) -> packet_t {
+    packet_t ret = example_packet;
+    set_sequence(sequence, ret);
+    set_timestamp(start + sequence * 1us + delay, ret);
+    return ret;
+  };
+  packet_t bad = example_packet;
+  REQUIRE(set_ip_protocol(IPPROTO_TCP, bad));
+
+  // Sequence number 3 arrives late in A, B is always 200ns behind and drops 5
+  auto const a = std::vector<packet_t>{make_packet(1, 0ns), make_packet(2, 0ns), make_packet(4, 0ns),
+                                       make_packet(3, 0ns), bad,                 make_packet(5, 0ns),
+                                       make_packet(6, 0ns), make_packet(7, 0ns)};
+  auto const b = std::vector<packet_t>{make_packet(1, 200ns), make_packet(2, 200ns), make_packet(3, 200ns),
+                                       make_packet(4, 200ns), make_packet(6, 200ns), make_packet(7, 200ns)};
+
+  // Same as stats of only the packets given, e.g. those within range
+  auto const check = [&](packet_range const &range, std::vector<packet_t> const &in_a,
+                         std::vector<packet_t> const &in_b) {
+    Logger expected_log;
+    auto const expected = stats::make(MockInputs(in_a, in_b), expected_log.fn());
+    for (std::size_t const batch_size : {1, 3, 256}) {
+      Logger logger;
+      CHECK(stats::make(MockInputs(a, b, batch_size), merge_extras{.range = range}, logger.fn()) == expected);
+      CHECK(logger == expected_log);
+
+      // Same as above, but read and parsed in background threads
+      Logger prefetched;
+      CHECK(stats::make(prefetch_inputs<MockInputs>(MockInputs(a, b, batch_size)), merge_extras{.range = range},
+                        prefetched.fn())
+            == expected);
+      CHECK(prefetched == expected_log);
+    }
+  };
+
+  SECTION("empty range")
+  { //
+    check({}, a, b);
+  }
+
+  SECTION("range of sequence numbers")
+  {
+    // NOTE: 3 is skipped in A, because it arrived after 4, and so is the packet after it which cannot be parsed;
+    // 7 is after the range in both channels
+    check({.from = std::uint32_t{4}, .to = std::uint32_t{6}},
+          {make_packet(4, 0ns), make_packet(5, 0ns), make_packet(6, 0ns)},
+          {make_packet(4, 200ns), make_packet(6, 200ns)});
+    check({.from = std::uint32_t{6}, .to = {}}, {make_packet(6, 0ns), make_packet(7, 0ns)},
+          {make_packet(6, 200ns), make_packet(7, 200ns)});
+
+    // NOTE: 3 arrived late in A, after 4 which is after the range, so A does not end there
+    check({.from = {}, .to = std::uint32_t{3}}, {make_packet(1, 0ns), make_packet(2, 0ns), make_packet(3, 0ns), bad},
+          {make_packet(1, 200ns), make_packet(2, 200ns), make_packet(3, 200ns)});
+  }
+
+  SECTION("range of timestamps")
+  {
+    // NOTE: 3 is included in A although it arrived after 4, 4 is not in B since it is 200ns later
+    check({.from = start + 2us + 100ns, .to = start + 4us + 100ns}, {make_packet(4, 0ns), make_packet(3, 0ns), bad},
+          {make_packet(2, 200ns), make_packet(3, 200ns)});
+    check({.from = {}, .to = start + 1us + 100ns}, {make_packet(1, 0ns)}, {});
+  }
+}
+
+TEST_CASE("stats calculation with observer of matches")
+{
+  using namespace std::chrono_literals;
+  auto const start = std::chrono::system_clock::time_point(1700000000s);
+  auto const make_packet = [&start](std::uint32_t sequence, std::chrono::nanoseconds delay) -> packet_t {
+    packet_t ret = example_packet;
+    set_sequence(sequence, ret);
+    set_timestamp(start + sequence * 1us + delay, ret);
+    return ret;
+  };
+  auto const at = [&start](std::uint32_t sequence, std::chrono::nanoseconds delay) -> packet::properties {
+    return {.timestamp = start + sequence * 1us + delay, .sequence = sequence};
+  };
+
+  // Same interface as match_export
+  using status_t = match_export::status_t;
+  struct observer final {
+    struct row final {
+      status_t status;
+      packet::properties a;
+      packet::properties b;
+
+      auto operator==(row const &) const -> bool = default;
+    };
+    std::vector<row> rows = {};
+
+    void matched(packet::properties const &a, packet::properties const &b) { rows.push_back({status_t::matched, a, b}); }
+    void dropped(pair_select which, packet::properties const &other)
+    {
+      rows.push_back(which == pair_select::A ? row{status_t::dropped_a, {}, other} : row{status_t::dropped_b, other, {}});
+    }
+  };
+
+  // A drops 3 and 6, B drops 2, and B is 200ns behind, except for 5 where it is 100ns ahead
+  auto const a = std::vector<packet_t>{make_packet(1, 0ns), make_packet(2, 0ns), make_packet(4, 0ns),
+                                       make_packet(5, 0ns), make_packet(7, 0ns), make_packet(8, 0ns),
+                                       make_packet(9, 0ns)};
+  auto const b = std::vector<packet_t>{make_packet(1, 200ns), make_packet(3, 200ns), make_packet(4, 200ns),
+                                       make_packet(5, -100ns), make_packet(6, 200ns), make_packet(8, 200ns),
+                                       make_packet(9, 200ns)};
+  for (std::size_t const batch_size : {1, 3, 256}) {
+    Logger expected_log;
+    auto const expected = stats::make(MockInputs(a, b, batch_size), expected_log.fn());
+
+    MockInputs inputs(a, b, batch_size);
+    auto readers = pair<detail::batch_reader<MockInputs>>{.A = {.inputs = inputs, .which = pair_select::A},
+                                                          .B = {.inputs = inputs, .which = pair_select::B}};
+    Logger logger;
+    auto log = logger.fn();
+    observer seen;
+    auto const result = stats::make_t::merge_from(
+        readers, log, 0, [](std::uint32_t, std::uint32_t, stats const &) { return false; }, seen);
+    CHECK(result == expected);
+    CHECK(logger == expected_log);
+
+    // NOTE: same as in stats, a packet is only matched or dropped when both channels move to a new one at once
+    CHECK(seen.rows
+          == std::vector<observer::row>{{status_t::matched, at(1, 0ns), at(1, 200ns)},
+                                        {status_t::dropped_b, at(2, 0ns), {}},
+                                        {status_t::matched, at(5, 0ns), at(5, -100ns)},
+                                        {status_t::dropped_a, {}, at(6, 200ns)},
+                                        {status_t::matched, at(9, 0ns), at(9, 200ns)}});
+    auto const count = [&seen](status_t status) {
+      return static_cast<std::size_t>(std::ranges::count(seen.rows, status, &observer::row::status));
+    };
+    CHECK(count(status_t::dropped_a) == result.dropped_count.A);
+    CHECK(count(status_t::dropped_b) == result.dropped_count.B);
+  }
+}
+
+namespace {
+// Inputs which are woken while idle before each batch of MockInputs, same as FollowPcapInputs when a snapshot is
+// due: the batch is empty and due is set. Stop is requested at the end of either channel, otherwise the merge would
+// wait for it forever, same as in follow mode.
+struct IdleInputs final {
+  MockInputs inputs;
+  std::atomic<bool> *due;
+  std::stop_source stop = {};
+  pair<bool> idle = {.A = true, .B = true};
+
+  auto next_batch(pair_select which) -> Inputs::batch_t
+  {
+    auto &channel_idle = which == pair_select::A ? idle.A : idle.B;
+    if (std::exchange(channel_idle, not channel_idle) && not stop.stop_requested()) {
+      due->store(true);
+      return {};
+    }
+    auto const ret = inputs.next_batch(which);
+    if (ret.empty()) {
+      stop.request_stop();
+    }
+    return ret;
+  }
+  auto link(pair_select which) const -> packet::link_t { return inputs.link(which); }
+};
+static_assert(some_inputs<IdleInputs>);
+} // namespace
+
+TEST_CASE("stats calculation with snapshots")
+{
+  std::vector<packet_t> a;
+  std::vector<packet_t> b;
+  for (std::uint32_t i = 1; i <= 20; ++i) {
+    if (i % 7 != 0) {
+      a.push_back(make_packet(i, i * 1000L));
+    }
+    b.push_back(make_packet(i, i * 1000L + 10));
+  }
+  a.push_back({0x00, 0x01}); // not enough data
+
+  for (std::size_t const batch_size : {1, 3, 256}) {
+    auto const expected = stats::make(MockInputs(a, b, batch_size));
+    std::atomic<bool> due = false;
+    IdleInputs inputs{.inputs = MockInputs(a, b, batch_size), .due = &due};
+    auto const stop = inputs.stop.get_token();
+    std::vector<stats> snapshots;
+    auto const result = stats::make(std::move(inputs), stop, due, [&snapshots](stats const &so_far) { //
+      snapshots.push_back(so_far);
+    });
+    CHECK(result == expected);
+
+    // NOTE: the first snapshot is taken while both channels are idle, before any packet was read
+    REQUIRE(snapshots.size() > 1);
+    CHECK(snapshots.front().packet_count == pair<std::size_t>{.A = 0, .B = 0});
+    CHECK(std::ranges::is_sorted(snapshots, {}, [](stats const &s) { return s.packet_count.A + s.packet_count.B; }));
+    CHECK(snapshots.back().packet_count.B <= expected.packet_count.B);
+  }
+}
@@ -0,0 +1,153 @@
+#include "mock_inputs.hpp"
+#include "temp_directory.hpp"
+
+#include <catch2/catch_all.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lib/find_inputs.hpp"
+#include "lib/packet.hpp"
+#include "lib/reorder_window.hpp"
+#include "lib/savefile.hpp"
+#include "lib/sort_channels.hpp"
+#include "lib/stats.hpp"
+#include "lib/synthetic.hpp"
+
+namespace {
+struct capture final {
+  pair<std::vector<packet_t>> packets = {};
+  pair<std::vector<synthetic::time_point>> timestamps = {};
+  stats truth = {};
+};
+
+auto generate(generate_options const &options) -> capture
+{
+  capture ret;
+  ret.truth = synthetic::generate(options, [&ret](pair_select which, synthetic::time_point timestamp,
+                                                  packet::data_t data) {
+    (which == pair_select::A ? ret.packets.A : ret.packets.B).emplace_back(data.begin(), data.end());
+    (which == pair_select::A ? ret.timestamps.A : ret.timestamps.B).push_back(timestamp);
+    return true;
+  });
+  return ret;
+}
+
+using kind_t = generate_options::latency_t::kind_t;
+
+// All frames of segments of one channel, in order
+auto read_frames(std::vector<std::string> const &segments) -> std::vector<packet_t>
+{
+  std::vector<packet_t> ret;
+  for (auto const &segment : segments) {
+    auto const data = temp_directory::read(segment);
+    auto records = savefile::records{.header = savefile::file_header::make(data).value(), .file = data};
+    while (auto const record = records.next()) {
+      ret.emplace_back(record->data.begin(), record->data.end());
+    }
+  }
+  return ret;
+}
+} // namespace
+
+TEST_CASE("synthetic captures")
+{
+  SECTION("frames are parsed")
+  {
+    std::vector<unsigned char> buffer;
+    for (std::uint16_t const payload : {4, 16, 1472}) {
+      auto const timestamp = synthetic::time_point(std::chrono::nanoseconds(1'700'000'000'123'456'789L));
+      synthetic::frame(12345, timestamp, payload, buffer);
+      CHECK(buffer.size() == std::size_t{14} + 20 + 8 + payload + 20);
+      CHECK(packet::parse(buffer) == packet::properties{.timestamp = timestamp, .sequence = 12345});
+    }
+  }
+
+  SECTION("same as strict merge when nothing is dropped, reordered or duplicated")
+  {
+    // NOTE: with constant latency, packets of each channel are captured in the order they were sent
+    auto const result = generate({.packets = 5000,
+                                  .payload_min = 4,
+                                  .payload_max = 200,
+                                  .latency = {.A = {.kind = kind_t::constant, .mean_ns = 1000},
+                                              .B = {.kind = kind_t::constant, .mean_ns = 1250}}});
+    CHECK(result.packets.A.size() == 5000);
+    CHECK(result.packets.B.size() == 5000);
+    CHECK(result.truth.packet_count == pair<std::size_t>{.A = 5000, .B = 5000});
+    CHECK(result.truth.faster_count == pair<std::size_t>{.A = 5000, .B = 0});
+    CHECK(result.truth.advantage_histogram.A.max == 250);
+    CHECK(stats::make(MockInputs(result.packets.A, result.packets.B)) == result.truth);
+  }
+
+  SECTION("same as merge within a window when packets are dropped, reordered and duplicated")
+  {
+    auto const result = generate({.packets = 20000,
+                                  .drop = {.A = 0.01, .B = 0.03},
+                                  .reorder = {.A = 0.02, .B = 0.0},
+                                  .duplicate = {.A = 0.0, .B = 0.01},
+                                  .latency = {.A = {.kind = kind_t::normal, .mean_ns = 2000, .jitter_ns = 500},
+                                              .B = {.kind = kind_t::uniform, .mean_ns = 1500, .jitter_ns = 1500}},
+                                  .seed = 7});
+    CHECK(result.truth.dropped_count.A > 100);
+    CHECK(result.truth.dropped_count.B > 400);
+    CHECK(result.packets.B.size() > result.truth.packet_count.B); // duplicates are captured, but not counted
+    CHECK(stats::make(MockInputs(result.packets.A, result.packets.B), merge_extras{.window = 64}) == result.truth);
+    CHECK(stats::make(MockInputs(result.packets.A, result.packets.B)) != result.truth);
+  }
+
+  SECTION("captures are in order of timestamps")
+  {
+    auto const result = generate({.packets = 10000,
+                                  .reorder = {.A = 0.1, .B = 0.1},
+                                  .duplicate = {.A = 0.1, .B = 0.1},
+                                  .latency = {.A = {.kind = kind_t::exponential, .mean_ns = 5000},
+                                              .B = {.kind = kind_t::constant, .mean_ns = 0}}});
+    CHECK(std::ranges::is_sorted(result.timestamps.A));
+    CHECK(std::ranges::is_sorted(result.timestamps.B));
+  }
+
+  SECTION("deterministic for the same seed")
+  {
+    generate_options const options{.packets = 1000, .drop = {.A = 0.1, .B = 0.1}, .seed = 3};
+    auto const first = generate(options);
+    auto const second = generate(options);
+    CHECK(first.packets == second.packets);
+    CHECK(first.truth == second.truth);
+    CHECK(generate({.packets = 1000, .drop = {.A = 0.1, .B = 0.1}, .seed = 4}).packets != first.packets);
+  }
+
+  SECTION("stops when asked to")
+  {
+    std::size_t count = 0;
+    synthetic::generate({.packets = 1000}, [&count](pair_select, synthetic::time_point, packet::data_t) {
+      return ++count < 10;
+    });
+    CHECK(count == 10);
+  }
+
+  SECTION("written to files")
+  {
+    temp_directory const dir;
+    generate_options const options{.path = dir.file("nested/captures"),
+                                   .prefix = "some",
+                                   .packets = 3000,
+                                   .drop = {.A = 0.01, .B = 0.02},
+                                   .segment_packets = 1000,
+                                   .seed = 5};
+    auto const truth = synthetic::write(options).value();
+    auto const expected = generate(options);
+    CHECK(truth == expected.truth);
+
+    auto const segments = sort_channels(find_inputs(options.path).value()).value();
+    CHECK(segments.A.size() == 3);
+    CHECK(segments.B.size() == 3);
+    CHECK(segments.A.front() == options.path + "/some_14310-0.pcap");
+    CHECK(read_frames(segments.A) == expected.packets.A);
+    CHECK(read_frames(segments.B) == expected.packets.B);
+
+    auto const file = dir.write("file", {});
+    CHECK(synthetic::write({.path = file + "/captures"}).error()
+          == error(error::write_pcap, "failed to create directory: " + file + "/captures"));
+  }
+}
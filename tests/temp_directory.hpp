@@ -0,0 +1,55 @@
+#ifndef TESTS_TEMP_DIRECTORY
+#define TESTS_TEMP_DIRECTORY
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// Unique directory under the system temporary directory, removed with all its contents when destroyed
+struct temp_directory final {
+  std::filesystem::path path = make_();
+
+  temp_directory() = default;
+  temp_directory(temp_directory const &) = delete;
+  auto operator=(temp_directory const &) -> temp_directory & = delete;
+  ~temp_directory() noexcept
+  {
+    std::error_code ec;
+    std::filesystem::remove_all(path, ec);
+  }
+
+  [[nodiscard]] auto file(std::string const &name) const -> std::string { return (path / name).string(); }
+
+  // Write data to a file in this directory, and return its full name
+  auto write(std::string const &name, std::vector<unsigned char> const &data) const -> std::string
+  {
+    auto ret = file(name);
+    std::ofstream output(ret, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<char const *>(data.data()), static_cast<std::streamsize>(data.size()));
+    return ret;
+  }
+
+  // Whole content of a file, empty if it cannot be read
+  static auto read(std::string const &name) -> std::vector<unsigned char>
+  {
+    std::ifstream input(name, std::ios::binary);
+    return {std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+  }
+
+private:
+  static auto make_() -> std::filesystem::path
+  {
+    auto pattern = (std::filesystem::temp_directory_path() / "pcap_parser_tests_XXXXXX").string();
+    if (::mkdtemp(pattern.data()) == nullptr) {
+      throw std::runtime_error("failed to create temporary directory");
+    }
+    return pattern;
+  }
+};
+
+#endif // TESTS_TEMP_DIRECTORY
@@ -0,0 +1,79 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "lib/work_stealing_pool.hpp"
+
+TEST_CASE("work stealing pool")
+{
+  SECTION("size")
+  {
+    CHECK(work_stealing_pool(0).size() == 1);
+    CHECK(work_stealing_pool(3).size() == 3);
+  }
+
+  for (std::size_t const threads : {1, 2, 5}) {
+    work_stealing_pool pool(threads);
+
+    DYNAMIC_SECTION("all tasks are run, threads: " << threads)
+    {
+      std::atomic<int> total = 0;
+      for (int i = 1; i <= 1000; ++i) {
+        pool.submit([&total, i] { total += i; });
+      }
+      pool.wait();
+      CHECK(total == 500500);
+
+      // Pool can be reused after wait
+      pool.submit([&total] { total = 0; });
+      pool.wait();
+      CHECK(total == 0);
+    }
+
+    DYNAMIC_SECTION("tasks submitted by tasks, threads: " << threads)
+    {
+      std::atomic<int> total = 0;
+      for (int i = 0; i < 10; ++i) {
+        pool.submit([&] {
+          for (int j = 0; j < 10; ++j) {
+            pool.submit([&total] { total += 1; });
+          }
+        });
+      }
+      pool.wait();
+      CHECK(total == 100);
+    }
+
+    DYNAMIC_SECTION("idle workers steal long tasks, threads: " << threads)
+    {
+      // First queue receives all slow tasks, which other workers must take over to finish in time. Tasks are
+      // submitted to queues in turn, so task i is queued for worker i % threads.
+      std::atomic<int> done = 0;
+      std::vector<std::size_t> ran(threads * 4, pool.size()); // worker which ran each task
+      for (std::size_t i = 0; i < threads * 4; ++i) {
+        pool.submit([&done, &ran, &pool, i, slow = i % threads == 0] {
+          if (slow) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+          }
+          ran[i] = pool.worker();
+          done += 1;
+        });
+      }
+      pool.wait();
+      CHECK(done == static_cast<int>(threads * 4));
+      CHECK(std::ranges::none_of(ran, [&pool](std::size_t worker) { return worker == pool.size(); }));
+      if (threads > 1) {
+        std::size_t stolen = 0;
+        for (std::size_t i = 0; i < ran.size(); ++i) {
+          stolen += ran[i] != i % threads ? 1 : 0;
+        }
+        CHECK(stolen > 0);
+      }
+      CHECK(pool.worker() == pool.size());
+    }
+  }
+}